@@ -0,0 +1,72 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace ai {
+namespace bench {
+
+// A square grid with a share of its cells blocked at random. The corners are
+// kept clear for corner to corner searches.
+struct BenchGrid {
+  BenchGrid(std::uint32_t side, int blocked_percent, unsigned seed = 7)
+      : size{side, side}, blocked(std::size_t{side} * side) {
+    auto generator = std::mt19937{seed};
+    auto distribution = std::uniform_int_distribution<int>{0, 99};
+    for (auto& cell : blocked) {
+      cell = distribution(generator) < blocked_percent;
+    }
+    blocked.front() = 0;
+    blocked.back() = 0;
+  }
+
+  bool operator()(std::uint32_t x, std::uint32_t y) const noexcept {
+    return !blocked[std::size_t{y} * size.x + x];
+  }
+
+  glm::uvec2 size;
+  std::vector<std::uint8_t> blocked;
+};
+
+inline void GridArgs(benchmark::internal::Benchmark* b) {
+  for (int side : {64, 256, 1024}) {
+    for (int blocked_percent : {0, 20}) {
+      b->Args({side, blocked_percent});
+    }
+  }
+}
+
+// The size of the maps of a full game, for the searches meant for them.
+inline void LargeGridArgs(benchmark::internal::Benchmark* b) {
+  for (int blocked_percent : {0, 20}) {
+    b->Args({4096, blocked_percent});
+  }
+}
+
+}  // namespace bench
+}  // namespace ai
+}  // namespace einu
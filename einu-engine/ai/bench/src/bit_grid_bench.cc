@@ -0,0 +1,131 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/bit_grid.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "einu-engine/ai/flow_field.h"
+#include "einu-engine/ai/grid_astar.h"
+#include "einu-engine/ai/grid_jps.h"
+#include "src/bench_grid.h"
+
+namespace einu {
+namespace ai {
+namespace bench {
+
+template <typename Passable>
+void SumStepMasks(benchmark::State& state, glm::uvec2 size,
+                  const Passable& passable) {
+  for (auto _ : state) {
+    auto sum = 0u;
+    for (std::uint32_t y = 0; y != size.y; ++y) {
+      for (std::uint32_t x = 0; x != size.x; ++x) {
+        sum += GetStepMask(size, passable, x, y);
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * size.x * size.y);
+}
+
+// The step masks of every cell, asking BenchGrid cell by cell.
+void BM_GetStepMask(benchmark::State& state) {
+  auto grid = BenchGrid(static_cast<std::uint32_t>(state.range(0)),
+                        static_cast<int>(state.range(1)));
+  SumStepMasks(state, grid.size, grid);
+}
+BENCHMARK(BM_GetStepMask)->Apply(GridArgs);
+
+void BM_BitGridGetStepMask(benchmark::State& state) {
+  auto bench_grid = BenchGrid(static_cast<std::uint32_t>(state.range(0)),
+                              static_cast<int>(state.range(1)));
+  SumStepMasks(state, bench_grid.size, BitGrid(bench_grid.size, bench_grid));
+}
+BENCHMARK(BM_BitGridGetStepMask)->Apply(GridArgs);
+
+// Compare with BM_GridAStarCornerToCorner.
+void BM_BitGridAStarCornerToCorner(benchmark::State& state) {
+  auto bench_grid = BenchGrid(static_cast<std::uint32_t>(state.range(0)),
+                              static_cast<int>(state.range(1)));
+  auto grid = BitGrid(bench_grid.size, bench_grid);
+  auto search = GridAStar{};
+  auto path = std::vector<glm::uvec2>{};
+  auto goal = bench_grid.size - glm::uvec2{1, 1};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        search.FindPath(bench_grid.size, grid, glm::uvec2{0, 0}, goal, path));
+  }
+}
+BENCHMARK(BM_BitGridAStarCornerToCorner)
+    ->Apply(GridArgs)
+    ->Unit(benchmark::kMicrosecond);
+
+// Compare with BM_GridJPSCornerToCorner.
+void BM_BitGridJPSCornerToCorner(benchmark::State& state) {
+  auto bench_grid = BenchGrid(static_cast<std::uint32_t>(state.range(0)),
+                              static_cast<int>(state.range(1)));
+  auto grid = BitGrid(bench_grid.size, bench_grid);
+  auto search = GridJPS{};
+  auto path = std::vector<glm::uvec2>{};
+  auto goal = bench_grid.size - glm::uvec2{1, 1};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        search.FindPath(bench_grid.size, grid, glm::uvec2{0, 0}, goal, path));
+  }
+}
+BENCHMARK(BM_BitGridJPSCornerToCorner)
+    ->Apply(GridArgs)
+    ->Apply(LargeGridArgs)
+    ->Unit(benchmark::kMicrosecond);
+
+// Compare with BM_FlowFieldCompute.
+void BM_BitGridFlowFieldCompute(benchmark::State& state) {
+  auto bench_grid = BenchGrid(static_cast<std::uint32_t>(state.range(0)),
+                              static_cast<int>(state.range(1)));
+  auto grid = BitGrid(bench_grid.size, bench_grid);
+  auto field = FlowField{};
+  auto goal = bench_grid.size - glm::uvec2{1, 1};
+  for (auto _ : state) {
+    field.Compute(bench_grid.size, grid, goal);
+    benchmark::DoNotOptimize(field.GetCost(glm::uvec2{0, 0}));
+  }
+}
+BENCHMARK(BM_BitGridFlowFieldCompute)
+    ->Apply(GridArgs)
+    ->Unit(benchmark::kMicrosecond);
+
+// Blocks and clears a wall a tenth of the grid wide on every row.
+void BM_BitGridFill(benchmark::State& state) {
+  auto side = static_cast<std::uint32_t>(state.range(0));
+  auto grid = BitGrid({side, side}, true);
+  auto wall = glm::uvec2{side / 10, side};
+  auto passable = false;
+  for (auto _ : state) {
+    grid.Fill({side / 2, 0}, wall, passable);
+    passable = !passable;
+  }
+  state.SetItemsProcessed(state.iterations() * wall.x * wall.y);
+}
+BENCHMARK(BM_BitGridFill)->Arg(1024)->Arg(4096);
+
+}  // namespace bench
+}  // namespace ai
+}  // namespace einu
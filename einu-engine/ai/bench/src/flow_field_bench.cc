@@ -0,0 +1,70 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/flow_field.h"
+
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/bench_grid.h"
+
+namespace einu {
+namespace ai {
+namespace bench {
+
+// One field to the far corner. Compare with BM_GridAStarCornerToCorner: the
+// field serves every agent heading there, a search serves one.
+void BM_FlowFieldCompute(benchmark::State& state) {
+  auto grid = BenchGrid(static_cast<std::uint32_t>(state.range(0)),
+                        static_cast<int>(state.range(1)));
+  auto field = FlowField{};
+  auto goal = grid.size - glm::uvec2{1, 1};
+  for (auto _ : state) {
+    field.Compute(grid.size, grid, goal);
+    benchmark::DoNotOptimize(field.GetCost(glm::uvec2{0, 0}));
+  }
+}
+BENCHMARK(BM_FlowFieldCompute)->Apply(GridArgs)->Unit(benchmark::kMicrosecond);
+
+// A step for each of 10000 agents scattered over the grid, through the cache
+// as an agent system would do each frame.
+void BM_FlowFieldSample(benchmark::State& state) {
+  auto grid = BenchGrid(static_cast<std::uint32_t>(state.range(0)),
+                        static_cast<int>(state.range(1)));
+  auto cache = FlowFieldCache{};
+  auto goal = grid.size - glm::uvec2{1, 1};
+  auto generator = std::mt19937{7};
+  auto agents = std::vector<glm::uvec2>(10000);
+  for (auto& agent : agents) {
+    agent = glm::uvec2{generator() % grid.size.x, generator() % grid.size.y};
+  }
+  for (auto _ : state) {
+    const auto& field = cache.Get(grid.size, grid, goal);
+    for (auto& agent : agents) {
+      benchmark::DoNotOptimize(field.GetDirection(agent));
+    }
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          static_cast<std::int64_t>(agents.size()));
+}
+BENCHMARK(BM_FlowFieldSample)->Apply(GridArgs);
+
+}  // namespace bench
+}  // namespace ai
+}  // namespace einu
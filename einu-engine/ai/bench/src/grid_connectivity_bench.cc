@@ -0,0 +1,104 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/grid_connectivity.h"
+
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "einu-engine/ai/grid_astar.h"
+#include "src/bench_grid.h"
+
+namespace einu {
+namespace ai {
+namespace bench {
+
+void BM_GridConnectivityBuild(benchmark::State& state) {
+  auto grid = BenchGrid(static_cast<std::uint32_t>(state.range(0)),
+                        static_cast<int>(state.range(1)));
+  auto connectivity = GridConnectivity{};
+  for (auto _ : state) {
+    connectivity.Build(grid.size, grid);
+  }
+  state.counters["components"] =
+      static_cast<double>(connectivity.ComponentCount());
+}
+BENCHMARK(BM_GridConnectivityBuild)
+    ->Apply(GridArgs)
+    ->Unit(benchmark::kMicrosecond);
+
+// Random cells blocked and cleared again, splits included.
+void BM_GridConnectivityUpdateCell(benchmark::State& state) {
+  auto grid = BenchGrid(static_cast<std::uint32_t>(state.range(0)),
+                        static_cast<int>(state.range(1)));
+  auto connectivity = GridConnectivity{};
+  connectivity.Build(grid.size, grid);
+  auto generator = std::mt19937{7};
+  for (auto _ : state) {
+    auto cell = glm::uvec2{generator() % grid.size.x,
+                           generator() % grid.size.y};
+    auto index = std::size_t{cell.y} * grid.size.x + cell.x;
+    grid.blocked[index] = !grid.blocked[index];
+    connectivity.UpdateCell(grid, cell);
+    grid.blocked[index] = !grid.blocked[index];
+    connectivity.UpdateCell(grid, cell);
+  }
+}
+BENCHMARK(BM_GridConnectivityUpdateCell)->Apply(GridArgs);
+
+// A goal walled off from the start: the search visits all it can reach
+// before it gives up, the labels answer at once.
+BenchGrid WalledGrid(std::uint32_t side, int blocked_percent) {
+  auto grid = BenchGrid(side, blocked_percent);
+  for (std::uint32_t y = 0; y != side; ++y) {
+    grid.blocked[std::size_t{y} * side + side / 2] = 1;
+  }
+  return grid;
+}
+
+void BM_GridAStarUnreachable(benchmark::State& state) {
+  auto grid = WalledGrid(static_cast<std::uint32_t>(state.range(0)),
+                         static_cast<int>(state.range(1)));
+  auto search = GridAStar{};
+  auto path = std::vector<glm::uvec2>{};
+  auto goal = grid.size - glm::uvec2{1, 1};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        search.FindPath(grid.size, grid, glm::uvec2{0, 0}, goal, path));
+  }
+}
+BENCHMARK(BM_GridAStarUnreachable)
+    ->Apply(GridArgs)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_GridConnectivityUnreachable(benchmark::State& state) {
+  auto grid = WalledGrid(static_cast<std::uint32_t>(state.range(0)),
+                         static_cast<int>(state.range(1)));
+  auto connectivity = GridConnectivity{};
+  connectivity.Build(grid.size, grid);
+  auto goal = grid.size - glm::uvec2{1, 1};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(connectivity.Reachable(glm::uvec2{0, 0}, goal));
+  }
+}
+BENCHMARK(BM_GridConnectivityUnreachable)->Apply(GridArgs);
+
+}  // namespace bench
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,120 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/grid_dstar_lite.h"
+
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "einu-engine/ai/grid_astar.h"
+#include "src/bench_grid.h"
+
+namespace einu {
+namespace ai {
+namespace bench {
+
+// Flips cells of a BenchGrid and flips them back on the next call, so the
+// share of blocked cells stays put however long a benchmark runs.
+class ObstacleChurn {
+ public:
+  ObstacleChurn(BenchGrid& grid, std::size_t cells_per_change)
+      : grid_{grid}, cells_(cells_per_change) {}
+
+  // Calls changed(cell) for every flipped cell.
+  template <typename Changed>
+  void Change(Changed&& changed) {
+    if (!flipped_) {
+      for (auto& cell : cells_) {
+        // the corners are the start and the goal
+        do {
+          cell = glm::uvec2{generator_() % grid_.size.x,
+                            generator_() % grid_.size.y};
+        } while (cell == glm::uvec2{0, 0} ||
+                 cell == grid_.size - glm::uvec2{1, 1});
+      }
+    }
+    for (auto cell : cells_) {
+      auto index = std::size_t{cell.y} * grid_.size.x + cell.x;
+      grid_.blocked[index] = !grid_.blocked[index];
+      changed(cell);
+    }
+    flipped_ = !flipped_;
+  }
+
+ private:
+  BenchGrid& grid_;
+  std::vector<glm::uvec2> cells_;
+  std::mt19937 generator_{11};
+  bool flipped_ = false;
+};
+
+inline void ChurnArgs(benchmark::internal::Benchmark* b) {
+  for (int side : {256, 1024}) {
+    for (int cells_per_change : {1, 16, 256}) {
+      b->Args({side, 20, cells_per_change});
+    }
+  }
+}
+
+// Corner to corner, searching again from scratch after every change.
+void BM_GridAStarChurn(benchmark::State& state) {
+  auto grid = BenchGrid(static_cast<std::uint32_t>(state.range(0)),
+                        static_cast<int>(state.range(1)));
+  auto churn = ObstacleChurn(grid, static_cast<std::size_t>(state.range(2)));
+  auto search = GridAStar{};
+  auto path = std::vector<glm::uvec2>{};
+  auto goal = grid.size - glm::uvec2{1, 1};
+  auto expanded = std::size_t{0};
+  for (auto _ : state) {
+    churn.Change([](glm::uvec2) {});
+    benchmark::DoNotOptimize(
+        search.FindPath(grid.size, grid, glm::uvec2{0, 0}, goal, path));
+    expanded += search.GetStats().expanded;
+  }
+  state.counters["expanded"] = benchmark::Counter(
+      static_cast<double>(expanded), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_GridAStarChurn)->Apply(ChurnArgs)->Unit(benchmark::kMicrosecond);
+
+// The same, repairing the costs of one D* Lite planner after every change.
+void BM_GridDStarLiteChurn(benchmark::State& state) {
+  auto grid = BenchGrid(static_cast<std::uint32_t>(state.range(0)),
+                        static_cast<int>(state.range(1)));
+  auto churn = ObstacleChurn(grid, static_cast<std::size_t>(state.range(2)));
+  auto planner = GridDStarLite{};
+  auto path = std::vector<glm::uvec2>{};
+  planner.Reset(grid.size, glm::uvec2{0, 0}, grid.size - glm::uvec2{1, 1});
+  planner.Plan(grid);
+  auto expanded = std::size_t{0};
+  for (auto _ : state) {
+    churn.Change([&](glm::uvec2 cell) { planner.UpdateCell(grid, cell); });
+    benchmark::DoNotOptimize(planner.Plan(grid));
+    planner.GetPath(grid, path);
+    expanded += planner.GetStats().expanded;
+  }
+  state.counters["expanded"] = benchmark::Counter(
+      static_cast<double>(expanded), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_GridDStarLiteChurn)
+    ->Apply(ChurnArgs)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace bench
+}  // namespace ai
+}  // namespace einu
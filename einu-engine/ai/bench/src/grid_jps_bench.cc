@@ -0,0 +1,51 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/grid_jps.h"
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/bench_grid.h"
+
+namespace einu {
+namespace ai {
+namespace bench {
+
+// Compare with BM_GridAStarCornerToCorner on the same grids.
+void BM_GridJPSCornerToCorner(benchmark::State& state) {
+  auto grid = BenchGrid(static_cast<std::uint32_t>(state.range(0)),
+                        static_cast<int>(state.range(1)));
+  auto search = GridJPS{};
+  auto path = std::vector<glm::uvec2>{};
+  auto goal = grid.size - glm::uvec2{1, 1};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        search.FindPath(grid.size, grid, glm::uvec2{0, 0}, goal, path));
+  }
+  state.counters["expanded"] =
+      static_cast<double>(search.GetStats().expanded);
+}
+BENCHMARK(BM_GridJPSCornerToCorner)
+    ->Apply(GridArgs)
+    ->Apply(LargeGridArgs)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace bench
+}  // namespace ai
+}  // namespace einu
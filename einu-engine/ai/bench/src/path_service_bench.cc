@@ -0,0 +1,78 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/path_service.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+
+#include "benchmark/benchmark.h"
+#include "src/bench_grid.h"
+
+namespace einu {
+namespace ai {
+namespace bench {
+
+// Every agent re-plans to one of a few goals, as a crowd heading for the same
+// places does. Searches run on the workers; results are drained with a budget
+// of 256 per frame until every agent has its path.
+void BM_PathServiceReplan(benchmark::State& state) {
+  auto agent_count = static_cast<EID>(state.range(0));
+  auto grid = BenchGrid(256, 20);
+  auto jobs = JobSystem{};
+  auto service = PathService{jobs};
+  service.SetGrid(std::make_shared<GridSnapshot>(grid.size, grid));
+
+  auto generator = std::mt19937{11};
+  auto coord = std::uniform_int_distribution<std::uint32_t>{0, 15};
+  auto requests = std::vector<PathRequest>{};
+  for (EID agent = 0; agent != agent_count; ++agent) {
+    requests.push_back({agent, glm::uvec2{coord(generator), coord(generator)},
+                        glm::uvec2{255 - coord(generator) % 4, 255}});
+  }
+  for (auto& request : requests) {
+    if (!grid(request.start.x, request.start.y)) request.start = {0, 0};
+    if (!grid(request.goal.x, request.goal.y)) request.goal = {255, 255};
+  }
+
+  for (auto _ : state) {
+    for (const auto& request : requests) service.Request(request);
+    service.Schedule();
+    auto delivered = std::size_t{0};
+    while (delivered != requests.size()) {
+      jobs.RunReady();
+      delivered += service.Deliver(256, [](const PathResult& result) {
+        benchmark::DoNotOptimize(result.path.data());
+      });
+    }
+  }
+  const auto& stats = service.GetStats();
+  state.counters["searches/iter"] =
+      static_cast<double>(stats.searched) / state.iterations();
+}
+BENCHMARK(BM_PathServiceReplan)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace bench
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,227 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "einu-engine/ai/grid_search.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace ai {
+
+namespace internal {
+
+// A grid of bits stored row by row, with the first cell of a row in the most
+// significant bit of its first word. Rows are padded with zero bits: a word to
+// the left, at least a word to the right, and a row above and below, so reads
+// just outside the grid need no bounds checks.
+class BitPlane {
+ public:
+  using Word = std::uint64_t;
+
+  static constexpr int kWordBits = 64;
+
+  BitPlane() = default;
+
+  explicit BitPlane(glm::uvec2 size)
+      : size_{size},
+        row_words_{size.x / kWordBits + 3},
+        words_(std::size_t{row_words_} * (size.y + 2), 0) {}
+
+  bool Get(std::uint32_t x, std::uint32_t y) const noexcept {
+    auto column = std::size_t{x} + kWordBits;
+    return (Row(y)[column / kWordBits] & BitMask(column)) != 0;
+  }
+
+  void Set(std::uint32_t x, std::uint32_t y, bool value) noexcept {
+    auto column = std::size_t{x} + kWordBits;
+    auto& word = Row(y)[column / kWordBits];
+    word = value ? word | BitMask(column) : word & ~BitMask(column);
+  }
+
+  void Fill(glm::uvec2 pos, glm::uvec2 count, bool value) noexcept {
+    if (count.x == 0) return;
+    auto first = std::size_t{pos.x} + kWordBits;
+    auto last = first + count.x - 1;
+    auto first_word = first / kWordBits;
+    auto last_word = last / kWordBits;
+    auto first_mask = ~Word{0} >> (first % kWordBits);
+    auto last_mask = ~Word{0} << (kWordBits - 1 - last % kWordBits);
+    for (auto y = pos.y; y != pos.y + count.y; ++y) {
+      auto row = Row(y);
+      for (auto i = first_word; i <= last_word; ++i) {
+        auto mask = ~Word{0};
+        if (i == first_word) mask &= first_mask;
+        if (i == last_word) mask &= last_mask;
+        row[i] = value ? row[i] | mask : row[i] & ~mask;
+      }
+    }
+  }
+
+  // The 64 bits of row y from column x on, x from -64 to size.x and y from -1
+  // to size.y.
+  Word GetBits(std::int64_t x, std::int64_t y) const noexcept {
+    assert(x >= -kWordBits && x <= size_.x && y >= -1 && y <= size_.y &&
+           "read beyond the padding");
+    auto column = static_cast<std::size_t>(x + kWordBits);
+    const auto* words = words_.data() +
+                        static_cast<std::size_t>(y + 1) * row_words_ +
+                        column / kWordBits;
+    auto shift = column % kWordBits;
+    if (shift == 0) return words[0];
+    return words[0] << shift | words[1] >> (kWordBits - shift);
+  }
+
+  std::size_t CountSet() const noexcept {
+    auto count = std::size_t{0};
+    for (auto word : words_) {
+      for (; word != 0; word &= word - 1) ++count;
+    }
+    return count;
+  }
+
+  std::size_t BufferBytes() const noexcept {
+    return words_.capacity() * sizeof(Word);
+  }
+
+ private:
+  static constexpr Word BitMask(std::size_t column) noexcept {
+    return Word{1} << (kWordBits - 1 - column % kWordBits);
+  }
+
+  const Word* Row(std::uint32_t y) const noexcept {
+    return words_.data() + (std::size_t{y} + 1) * row_words_;
+  }
+
+  Word* Row(std::uint32_t y) noexcept {
+    return words_.data() + (std::size_t{y} + 1) * row_words_;
+  }
+
+  glm::uvec2 size_{};
+  std::uint32_t row_words_ = 0;
+  std::vector<Word> words_;
+};
+
+}  // namespace internal
+
+// Which cells of a grid are passable, at one bit per cell. It is a passable
+// callable, so every search and flow field runs on it as is, and it offers
+// word-wide reads for the ones that make use of them: GetStepMask tests all 8
+// neighbours of a cell with three reads, and GetRowBits and GetColumnBits
+// return 64 cells of a line at once for line scans.
+//
+// The grid is kept both by rows and by columns, so that lines run along words
+// either way; an edit writes both. Cells just outside the grid read as
+// blocked.
+class BitGrid {
+ public:
+  using Word = internal::BitPlane::Word;
+
+  static constexpr int kWordBits = internal::BitPlane::kWordBits;
+
+  BitGrid() = default;
+
+  explicit BitGrid(glm::uvec2 size, bool passable = false)
+      : size_{size}, rows_{size}, columns_{{size.y, size.x}} {
+    if (passable) Fill({0, 0}, size, true);
+  }
+
+  template <typename Passable>
+  BitGrid(glm::uvec2 size, const Passable& passable) : BitGrid{size} {
+    for (std::uint32_t y = 0; y != size.y; ++y) {
+      for (std::uint32_t x = 0; x != size.x; ++x) {
+        if (passable(x, y)) Set(x, y, true);
+      }
+    }
+  }
+
+  bool operator()(std::uint32_t x, std::uint32_t y) const noexcept {
+    return rows_.Get(x, y);
+  }
+
+  void Set(std::uint32_t x, std::uint32_t y, bool passable) noexcept {
+    assert(x < size_.x && y < size_.y && "cell out of grid");
+    rows_.Set(x, y, passable);
+    columns_.Set(y, x, passable);
+  }
+
+  // Sets the cells of the box of count cells from pos, a word at a time.
+  void Fill(glm::uvec2 pos, glm::uvec2 count, bool passable) noexcept {
+    assert(pos.x + count.x <= size_.x && pos.y + count.y <= size_.y &&
+           "box out of grid");
+    rows_.Fill(pos, count, passable);
+    columns_.Fill({pos.y, pos.x}, {count.y, count.x}, passable);
+  }
+
+  // The 64 cells of row y from column x on, cell x in the most significant
+  // bit. x may be from -64 to size.x and y from -1 to size.y.
+  Word GetRowBits(std::int64_t x, std::int64_t y) const noexcept {
+    return rows_.GetBits(x, y);
+  }
+
+  // The 64 cells of column x from row y on, cell y in the most significant
+  // bit. x may be from -1 to size.x and y from -64 to size.y.
+  Word GetColumnBits(std::int64_t x, std::int64_t y) const noexcept {
+    return columns_.GetBits(y, x);
+  }
+
+  // Same as the GetStepMask of any passable, from three reads.
+  std::uint8_t GetStepMask(std::uint32_t x, std::uint32_t y) const noexcept {
+    // bit 2 is column x - 1, bit 1 is x and bit 0 is x + 1
+    auto left = std::int64_t{x} - 1;
+    auto above = GetRowBits(left, std::int64_t{y} - 1) >> 61;
+    auto middle = GetRowBits(left, y) >> 61;
+    auto below = GetRowBits(left, std::int64_t{y} + 1) >> 61;
+    // in the order of kGridSteps
+    auto neighbours = (middle & 1) | (middle >> 2 & 1) << 1 |
+                      (below >> 1 & 1) << 2 | (above >> 1 & 1) << 3 |
+                      (below & 1) << 4 | (above & 1) << 5 |
+                      (below >> 2 & 1) << 6 | (above >> 2 & 1) << 7;
+    return internal::ClearCorners(static_cast<std::uint8_t>(neighbours));
+  }
+
+  std::size_t CountPassable() const noexcept { return rows_.CountSet(); }
+
+  glm::uvec2 GetSize() const noexcept { return size_; }
+
+  std::size_t BufferBytes() const noexcept {
+    return rows_.BufferBytes() + columns_.BufferBytes();
+  }
+
+ private:
+  glm::uvec2 size_{};
+  internal::BitPlane rows_;
+  internal::BitPlane columns_;
+};
+
+// Picked over the generic GetStepMask by the searches for a BitGrid.
+inline std::uint8_t GetStepMask([[maybe_unused]] glm::uvec2 size,
+                                const BitGrid& grid, std::uint32_t x,
+                                std::uint32_t y) noexcept {
+  assert(size == grid.GetSize() && "size of another grid");
+  return grid.GetStepMask(x, y);
+}
+
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,300 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "einu-engine/ai/grid_search.h"
+#include "einu-engine/ai/indexed_heap.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace ai {
+
+namespace internal {
+
+// The index in kGridSteps of the step undoing step.
+constexpr std::uint8_t ReverseGridStep(std::uint8_t step) noexcept {
+  for (std::uint8_t i = 0; i != std::size(kGridSteps); ++i) {
+    if (kGridSteps[i].dx == -kGridSteps[step].dx &&
+        kGridSteps[i].dy == -kGridSteps[step].dy) {
+      return i;
+    }
+  }
+  return step;
+}
+
+}  // namespace internal
+
+// The shortest paths from every cell of a grid to one goal. Compute runs a
+// single Dijkstra search outwards from the goal, recording for each cell its
+// cost to the goal and the first step of a shortest path, so any number of
+// agents heading for the goal each follow it in O(1) per cell:
+//
+//   auto cell = field.GetNextCell(cell);
+//
+// Moves are those of GridAStar.
+class FlowField {
+ public:
+  static constexpr float kUnreached = std::numeric_limits<float>::max();
+
+  template <typename Passable>
+  void Compute(glm::uvec2 size, const Passable& passable, glm::uvec2 goal) {
+    assert(goal.x < size.x && goal.y < size.y && "goal out of grid");
+    size_ = size;
+    goal_ = goal;
+    auto cell_count = std::size_t{size.x} * size.y;
+    costs_.assign(cell_count, kUnreached);
+    steps_.assign(cell_count, kNoStep);
+    if (!passable(goal.x, goal.y)) return;
+
+    // only the costs are kept between computes, so share the heap
+    thread_local auto open = IndexedMinHeap<float>{};
+    open.Reserve(cell_count);
+    open.Clear();
+    auto goal_index = CellIndex(size, goal.x, goal.y);
+    costs_[goal_index] = 0;
+    open.Push(goal_index, 0.f);
+    while (!open.Empty()) {
+      auto current = open.Pop();
+      auto x = current % size.x;
+      auto y = current / size.x;
+      // moves are symmetric, so a step out of current is a step into it
+      auto steps = GetStepMask(size, passable, x, y);
+      for (std::uint8_t i = 0; i != std::size(kGridSteps); ++i) {
+        if ((steps >> i & 1) == 0) continue;
+        const auto& step = kGridSteps[i];
+        auto next = CellIndex(size, x + step.dx, y + step.dy);
+        auto cost = costs_[current] + step.cost;
+        if (cost >= costs_[next]) continue;
+        // a settled cell never costs more than current, so next is either
+        // new or still open
+        auto open_before = costs_[next] != kUnreached;
+        costs_[next] = cost;
+        steps_[next] = kReverseSteps[i];
+        if (open_before) {
+          open.DecreaseKey(next, cost);
+        } else {
+          open.Push(next, cost);
+        }
+      }
+    }
+  }
+
+  glm::uvec2 GetSize() const noexcept { return size_; }
+
+  glm::uvec2 GetGoal() const noexcept { return goal_; }
+
+  bool Reaches(glm::uvec2 cell) const noexcept {
+    return GetCost(cell) != kUnreached;
+  }
+
+  // kUnreached if no path leads from cell to the goal.
+  float GetCost(glm::uvec2 cell) const noexcept {
+    return costs_[Index(cell)];
+  }
+
+  // The first step of a shortest path from cell, or (0, 0) at the goal and
+  // where the goal cannot be reached.
+  glm::ivec2 GetDirection(glm::uvec2 cell) const noexcept {
+    auto step = steps_[Index(cell)];
+    if (step == kNoStep) return glm::ivec2{0, 0};
+    return glm::ivec2{kGridSteps[step].dx, kGridSteps[step].dy};
+  }
+
+  glm::uvec2 GetNextCell(glm::uvec2 cell) const noexcept {
+    auto direction = GetDirection(cell);
+    return glm::uvec2{cell.x + direction.x, cell.y + direction.y};
+  }
+
+  std::size_t BufferBytes() const noexcept {
+    return costs_.capacity() * sizeof(float) +
+           steps_.capacity() * sizeof(std::uint8_t);
+  }
+
+ private:
+  static constexpr std::uint8_t kNoStep = std::size(kGridSteps);
+
+  static constexpr std::uint8_t kReverseSteps[] = {
+      internal::ReverseGridStep(0), internal::ReverseGridStep(1),
+      internal::ReverseGridStep(2), internal::ReverseGridStep(3),
+      internal::ReverseGridStep(4), internal::ReverseGridStep(5),
+      internal::ReverseGridStep(6), internal::ReverseGridStep(7)};
+
+  std::size_t Index(glm::uvec2 cell) const noexcept {
+    assert(cell.x < size_.x && cell.y < size_.y && "cell out of grid");
+    return CellIndex(size_, cell.x, cell.y);
+  }
+
+  glm::uvec2 size_{};
+  glm::uvec2 goal_{};
+  std::vector<float> costs_;
+  std::vector<std::uint8_t> steps_;
+};
+
+struct FlowFieldCacheStats {
+  std::size_t hits = 0;
+  // misses each compute a field
+  std::size_t misses = 0;
+  // fields dropped to make room for another goal
+  std::size_t evicted = 0;
+  // fields dropped because the grid changed under them
+  std::size_t invalidated = 0;
+};
+
+// Flow fields of the goals asked for most recently, so agents sharing a
+// destination share one field. A field stays until capacity other goals
+// have been asked for since it was last used, or until a change of the grid
+// can alter it. References returned by Get are valid until the next call to
+// a non-const member.
+class FlowFieldCache {
+ public:
+  explicit FlowFieldCache(std::size_t capacity = 8) noexcept
+      : capacity_{capacity} {
+    assert(capacity != 0 && "cache without room");
+  }
+
+  template <typename Passable>
+  const FlowField& Get(glm::uvec2 size, const Passable& passable,
+                       glm::uvec2 goal) {
+    auto& entry = fields_[Key(goal)];
+    entry.last_used = ++clock_;
+    if (entry.field) {
+      ++stats_.hits;
+      return *entry.field;
+    }
+    ++stats_.misses;
+    if (spare_.empty()) {
+      entry.field = std::make_unique<FlowField>();
+    } else {
+      entry.field = std::move(spare_.back());
+      spare_.pop_back();
+    }
+    entry.field->Compute(size, passable, goal);
+    const auto& field = *entry.field;
+    if (fields_.size() > capacity_) EvictLeastRecentlyUsed();
+    return field;
+  }
+
+  // The field of goal if it is cached, without computing it.
+  const FlowField* Find(glm::uvec2 goal) const {
+    auto it = fields_.find(Key(goal));
+    return it == fields_.end() ? nullptr : it->second.field.get();
+  }
+
+  // Drops the fields that a change of the passability of cell can alter:
+  // those reaching the cell, which it may now block, or one of its
+  // neighbours, from which it may now be entered, and the field of the cell
+  // itself.
+  void InvalidateCell(glm::uvec2 cell) {
+    for (auto it = fields_.begin(); it != fields_.end();) {
+      auto next = std::next(it);
+      if (MayChange(*it->second.field, cell)) {
+        ++stats_.invalidated;
+        Drop(it);
+      }
+      it = next;
+    }
+  }
+
+  // Drops every field, as after the whole grid changed.
+  void Invalidate() {
+    stats_.invalidated += fields_.size();
+    for (auto& [key, entry] : fields_) {
+      spare_.push_back(std::move(entry.field));
+    }
+    fields_.clear();
+  }
+
+  std::size_t Size() const noexcept { return fields_.size(); }
+
+  std::size_t Capacity() const noexcept { return capacity_; }
+
+  std::size_t BufferBytes() const noexcept {
+    auto bytes = std::size_t{0};
+    for (const auto& [key, entry] : fields_) {
+      bytes += entry.field->BufferBytes();
+    }
+    for (const auto& field : spare_) bytes += field->BufferBytes();
+    return bytes;
+  }
+
+  const FlowFieldCacheStats& GetStats() const noexcept { return stats_; }
+
+ private:
+  struct Entry {
+    std::unique_ptr<FlowField> field;
+    std::uint64_t last_used = 0;
+  };
+
+  using Map = absl::flat_hash_map<std::uint64_t, Entry>;
+
+  static std::uint64_t Key(glm::uvec2 goal) noexcept {
+    return std::uint64_t{goal.x} << 32 | goal.y;
+  }
+
+  static bool MayChange(const FlowField& field, glm::uvec2 cell) noexcept {
+    auto size = field.GetSize();
+    if (cell.x >= size.x || cell.y >= size.y) return false;
+    if (cell == field.GetGoal() || field.Reaches(cell)) return true;
+    for (const auto& step : kGridSteps) {
+      auto x = static_cast<std::int64_t>(cell.x) + step.dx;
+      auto y = static_cast<std::int64_t>(cell.y) + step.dy;
+      if (InGrid(size, x, y) &&
+          field.Reaches(glm::uvec2{static_cast<std::uint32_t>(x),
+                                   static_cast<std::uint32_t>(y)})) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Drop(Map::iterator it) {
+    spare_.push_back(std::move(it->second.field));
+    fields_.erase(it);
+    // keep memory bounded by the capacity, spares included
+    while (fields_.size() + spare_.size() > capacity_) spare_.pop_back();
+  }
+
+  void EvictLeastRecentlyUsed() {
+    auto oldest = fields_.begin();
+    for (auto it = fields_.begin(); it != fields_.end(); ++it) {
+      if (it->second.last_used < oldest->second.last_used) oldest = it;
+    }
+    ++stats_.evicted;
+    Drop(oldest);
+  }
+
+  std::size_t capacity_;
+  Map fields_;
+  std::vector<std::unique_ptr<FlowField>> spare_;
+  std::uint64_t clock_ = 0;
+  FlowFieldCacheStats stats_;
+};
+
+}  // namespace ai
+}  // namespace einu
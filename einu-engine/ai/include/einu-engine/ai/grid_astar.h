@@ -0,0 +1,184 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "einu-engine/ai/grid_search.h"
+#include "einu-engine/ai/indexed_heap.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace ai {
+
+// A* on an 8-connected grid. The open set is an indexed binary heap and the
+// per-cell scores live in flat arrays marked with generation stamps, so the
+// buffers grow to the largest grid searched and are reused by every search
+// without being cleared. A search can run to the end at once with FindPath,
+// or a few expansions at a time with Start and Step:
+//
+//   search.Start(size, start, goal);
+//   while (search.Step(passable, 256) == SearchStatus::Searching) {
+//     ...
+//   }
+//   search.GetPath(path);
+class GridAStar {
+ public:
+  static constexpr std::size_t kUnlimited =
+      std::numeric_limits<std::size_t>::max();
+
+  void Start(glm::uvec2 size, glm::uvec2 start, glm::uvec2 goal) {
+    assert(start.x < size.x && start.y < size.y && "start out of grid");
+    assert(goal.x < size.x && goal.y < size.y && "goal out of grid");
+    size_ = size;
+    start_ = CellIndex(size, start.x, start.y);
+    goal_ = CellIndex(size, goal.x, goal.y);
+    goal_pos_ = goal;
+    stats_ = SearchStats{};
+    status_ = SearchStatus::Searching;
+
+    auto cell_count = static_cast<std::size_t>(size.x) * size.y;
+    if (g_.size() < cell_count) {
+      g_.resize(cell_count);
+      parents_.resize(cell_count);
+    }
+    marks_.Resize(cell_count);
+    marks_.NextGeneration();
+    open_.Reserve(cell_count);
+    open_.Clear();
+
+    g_[start_] = 0;
+    parents_[start_] = start_;
+    marks_.Set(start_, kOpen);
+    open_.Push(start_, {OctileDistance(start, goal), 0});
+    ++stats_.pushed;
+  }
+
+  // Expands up to max_expansions cells of the search started last.
+  template <typename Passable>
+  SearchStatus Step(const Passable& passable,
+                    std::size_t max_expansions = kUnlimited) {
+    if (status_ != SearchStatus::Searching) return status_;
+    if (!passable(goal_pos_.x, goal_pos_.y)) {
+      return status_ = SearchStatus::NoPath;
+    }
+    for (; max_expansions != 0; --max_expansions) {
+      if (open_.Empty()) return status_ = SearchStatus::NoPath;
+      auto current = open_.Pop();
+      marks_.Set(current, kClosed);
+      ++stats_.expanded;
+      if (current == goal_) return status_ = SearchStatus::Found;
+      Expand(passable, current);
+    }
+    return status_;
+  }
+
+  // The path of the last search that found one, from the goal back to the
+  // first cell after the start, so the next waypoint is path.back(). Empty
+  // when start and goal are the same cell or no path was found.
+  void GetPath(std::vector<glm::uvec2>& path) const {
+    path.clear();
+    if (status_ != SearchStatus::Found) return;
+    for (auto cell = goal_; cell != start_; cell = parents_[cell]) {
+      path.emplace_back(cell % size_.x, cell / size_.x);
+    }
+  }
+
+  template <typename Passable>
+  bool FindPath(glm::uvec2 size, const Passable& passable, glm::uvec2 start,
+                glm::uvec2 goal, std::vector<glm::uvec2>& path) {
+    Start(size, start, goal);
+    Step(passable);
+    GetPath(path);
+    return status_ == SearchStatus::Found;
+  }
+
+  SearchStatus GetStatus() const noexcept { return status_; }
+
+  const SearchStats& GetStats() const noexcept { return stats_; }
+
+  // Bytes held by the reusable buffers.
+  std::size_t BufferBytes() const noexcept {
+    return g_.capacity() * sizeof(float) +
+           parents_.capacity() * sizeof(std::uint32_t) +
+           marks_.Size() * sizeof(std::uint32_t) +
+           open_.Capacity() * 2 * sizeof(std::uint32_t);
+  }
+
+ private:
+  enum Mark : GenerationStamps::Mark { kOpen = 1, kClosed = 2 };
+
+  // Ties on f go to the cell closer to the goal, which expands fewer cells on
+  // open ground.
+  struct Key {
+    float f;
+    float h;
+
+    bool operator<(const Key& other) const noexcept {
+      return f < other.f || (f == other.f && h < other.h);
+    }
+  };
+
+  template <typename Passable>
+  void Expand(const Passable& passable, std::uint32_t current) {
+    auto x = current % size_.x;
+    auto y = current / size_.x;
+    auto g = g_[current];
+    auto steps = GetStepMask(size_, passable, x, y);
+    for (auto i = 0; i != 8; ++i) {
+      if ((steps >> i & 1) == 0) continue;
+      const auto& step = kGridSteps[i];
+      auto next_pos = glm::uvec2(x + step.dx, y + step.dy);
+      auto next = CellIndex(size_, next_pos.x, next_pos.y);
+      auto mark = marks_.Get(next);
+      if (mark == kClosed) continue;
+      auto next_g = g + step.cost;
+      if (mark == kOpen && next_g >= g_[next]) continue;
+      g_[next] = next_g;
+      parents_[next] = current;
+      auto h = OctileDistance(next_pos, goal_pos_);
+      if (mark == kOpen) {
+        open_.DecreaseKey(next, {next_g + h, h});
+      } else {
+        marks_.Set(next, kOpen);
+        open_.Push(next, {next_g + h, h});
+        ++stats_.pushed;
+      }
+    }
+  }
+
+  glm::uvec2 size_{};
+  std::uint32_t start_ = 0;
+  std::uint32_t goal_ = 0;
+  glm::uvec2 goal_pos_{};
+  SearchStatus status_ = SearchStatus::NoPath;
+  SearchStats stats_;
+
+  std::vector<float> g_;
+  std::vector<std::uint32_t> parents_;
+  GenerationStamps marks_;
+  IndexedMinHeap<Key> open_;
+};
+
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,317 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "einu-engine/ai/grid_search.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace ai {
+
+// Which cells of a grid can reach each other, so a search that cannot
+// succeed is rejected in O(1) instead of exhausting everything reachable
+// from its start. Since a diagonal step needs both cells beside it passable,
+// cells connected under the moves of GridAStar are exactly the 4-connected
+// components of passable cells.
+//
+// Every passable cell carries a label; labels merged by a union-find name
+// the same component. A cell turning passable merges the labels around it.
+// A cell turning blocked can split its component: when its neighbours stay
+// linked around it nothing happens, otherwise searches from each side run in
+// lockstep until all sides meet or a side runs out, and the cells of a side
+// that ran out get a new label. The cost is the size of the smaller side.
+class GridConnectivity {
+ public:
+  static constexpr std::uint32_t kNoLabel =
+      std::numeric_limits<std::uint32_t>::max();
+
+  template <typename Passable>
+  void Build(glm::uvec2 size, const Passable& passable) {
+    size_ = size;
+    auto cell_count = std::size_t{size.x} * size.y;
+    labels_.assign(cell_count, kNoLabel);
+    parents_.clear();
+    for (std::uint32_t y = 0; y != size.y; ++y) {
+      for (std::uint32_t x = 0; x != size.x; ++x) {
+        auto index = CellIndex(size, x, y);
+        if (labels_[index] != kNoLabel || !passable(x, y)) continue;
+        auto label = NewLabel();
+        labels_[index] = label;
+        frontier_.assign(1, index);
+        while (!frontier_.empty()) {
+          auto current = frontier_.back();
+          frontier_.pop_back();
+          ForEachNeighbour(current, [&](std::uint32_t next) {
+            if (labels_[next] != kNoLabel) return;
+            auto pos = Position(next);
+            if (!passable(pos.x, pos.y)) return;
+            labels_[next] = label;
+            frontier_.push_back(next);
+          });
+        }
+      }
+    }
+    component_count_ = parents_.size();
+  }
+
+  // Brings the labels up to date after the passability of cell changed.
+  template <typename Passable>
+  void UpdateCell(const Passable& passable, glm::uvec2 cell) {
+    assert(cell.x < size_.x && cell.y < size_.y && "cell out of grid");
+    auto index = CellIndex(size_, cell.x, cell.y);
+    auto open = passable(cell.x, cell.y);
+    if (open == (labels_[index] != kNoLabel)) return;
+    if (open) {
+      Connect(index);
+    } else {
+      Disconnect(passable, index);
+    }
+    // splits only ever add labels; start afresh before they pile up
+    if (parents_.size() > 2 * labels_.size() + 64) Build(size_, passable);
+  }
+
+  // Whether a and b are passable and in the same component.
+  bool Connected(glm::uvec2 a, glm::uvec2 b) {
+    auto label_a = GetLabel(a);
+    return label_a != kNoLabel && label_a == GetLabel(b);
+  }
+
+  // Whether a search of GridAStar from start can reach goal. Unlike
+  // Connected, it lets a blocked start step out into any of its passable
+  // neighbours.
+  bool Reachable(glm::uvec2 start, glm::uvec2 goal) {
+    if (start == goal) return true;
+    auto goal_label = GetLabel(goal);
+    if (goal_label == kNoLabel) return false;
+    auto start_index = CellIndex(size_, start.x, start.y);
+    if (labels_[start_index] != kNoLabel) {
+      return Find(labels_[start_index]) == goal_label;
+    }
+    auto reachable = false;
+    ForEachNeighbour(start_index, [&](std::uint32_t next) {
+      reachable = reachable || (labels_[next] != kNoLabel &&
+                                Find(labels_[next]) == goal_label);
+    });
+    return reachable;
+  }
+
+  // The same for every cell of a component; kNoLabel for blocked cells.
+  std::uint32_t GetLabel(glm::uvec2 cell) {
+    assert(cell.x < size_.x && cell.y < size_.y && "cell out of grid");
+    auto label = labels_[CellIndex(size_, cell.x, cell.y)];
+    return label == kNoLabel ? kNoLabel : Find(label);
+  }
+
+  std::size_t ComponentCount() const noexcept { return component_count_; }
+
+  glm::uvec2 GetSize() const noexcept { return size_; }
+
+ private:
+  static constexpr std::size_t kMaxSides = 4;
+
+  glm::uvec2 Position(std::uint32_t index) const noexcept {
+    return glm::uvec2{index % size_.x, index / size_.x};
+  }
+
+  std::uint32_t NewLabel() {
+    auto label = static_cast<std::uint32_t>(parents_.size());
+    parents_.push_back(label);
+    return label;
+  }
+
+  std::uint32_t Find(std::uint32_t label) noexcept {
+    while (parents_[label] != label) {
+      parents_[label] = parents_[parents_[label]];
+      label = parents_[label];
+    }
+    return label;
+  }
+
+  // Calls fn(neighbour) for the 4-neighbours of index inside the grid.
+  template <typename Fn>
+  void ForEachNeighbour(std::uint32_t index, Fn&& fn) const {
+    auto pos = Position(index);
+    if (pos.x != 0) fn(index - 1);
+    if (pos.x + 1 != size_.x) fn(index + 1);
+    if (pos.y != 0) fn(index - size_.x);
+    if (pos.y + 1 != size_.y) fn(index + size_.x);
+  }
+
+  void Connect(std::uint32_t index) {
+    auto label = kNoLabel;
+    ForEachNeighbour(index, [&](std::uint32_t next) {
+      if (labels_[next] == kNoLabel) return;
+      auto root = Find(labels_[next]);
+      if (label == kNoLabel) {
+        label = root;
+      } else if (root != label) {
+        parents_[root] = label;
+        --component_count_;
+      }
+    });
+    if (label == kNoLabel) {
+      label = NewLabel();
+      ++component_count_;
+    }
+    labels_[index] = label;
+  }
+
+  template <typename Passable>
+  void Disconnect(const Passable& passable, std::uint32_t index) {
+    labels_[index] = kNoLabel;
+    auto sides = NeighbourSides(passable, index);
+    if (sides.empty()) {
+      --component_count_;
+      return;
+    }
+    if (sides.size() == 1) return;
+    SeparateSides(sides);
+  }
+
+  // One passable 4-neighbour of index for each run of passable cells in the
+  // ring around it. Sides in one run stay linked through the ring.
+  template <typename Passable>
+  std::vector<std::uint32_t>& NeighbourSides(const Passable& passable,
+                                             std::uint32_t index) {
+    // clockwise from the top, 4-neighbours at even positions
+    static constexpr int kRing[8][2] = {{0, -1}, {1, -1}, {1, 0}, {1, 1},
+                                        {0, 1},  {-1, 1}, {-1, 0}, {-1, -1}};
+    auto pos = Position(index);
+    bool open[8];
+    for (auto i = 0; i != 8; ++i) {
+      auto x = static_cast<std::int64_t>(pos.x) + kRing[i][0];
+      auto y = static_cast<std::int64_t>(pos.y) + kRing[i][1];
+      open[i] = InGrid(size_, x, y) &&
+                passable(static_cast<std::uint32_t>(x),
+                         static_cast<std::uint32_t>(y));
+    }
+    sides_.clear();
+    // start right after a blocked cell so that no run wraps around
+    auto first = 0;
+    while (first != 8 && open[first]) ++first;
+    if (first == 8) {
+      sides_.push_back(CellIndex(size_, pos.x, pos.y - 1));
+      return sides_;
+    }
+    auto in_run = false;
+    for (auto step = 1; step <= 8; ++step) {
+      auto i = (first + step) % 8;
+      if (!open[i]) {
+        in_run = false;
+        continue;
+      }
+      if (i % 2 == 0 && !in_run) {
+        sides_.push_back(CellIndex(size_, pos.x + kRing[i][0],
+                                   pos.y + kRing[i][1]));
+        in_run = true;
+      }
+    }
+    return sides_;
+  }
+
+  // Searches from every side in lockstep. A group of sides whose searches
+  // met and ran out is cut off from the rest and gets a new label.
+  void SeparateSides(const std::vector<std::uint32_t>& sides) {
+    side_count_ = sides.size();
+    assert(side_count_ <= kMaxSides && "more sides than neighbours");
+    marks_.Resize(labels_.size());
+    marks_.NextGeneration();
+    for (std::size_t side = 0; side != side_count_; ++side) {
+      groups_[side] = side;
+      cut_off_[side] = false;
+      queues_[side].assign(1, sides[side]);
+      heads_[side] = 0;
+      marks_.Set(sides[side], static_cast<GenerationStamps::Mark>(side + 1));
+    }
+    auto live_groups = side_count_;
+    while (live_groups > 1) {
+      for (std::size_t side = 0; side != side_count_; ++side) {
+        if (cut_off_[GroupOf(side)] || heads_[side] == queues_[side].size()) {
+          continue;
+        }
+        auto current = queues_[side][heads_[side]++];
+        ForEachNeighbour(current, [&](std::uint32_t next) {
+          if (labels_[next] == kNoLabel) return;
+          auto mark = marks_.Get(next);
+          if (mark == 0) {
+            marks_.Set(next, static_cast<GenerationStamps::Mark>(side + 1));
+            queues_[side].push_back(next);
+          } else if (auto other = GroupOf(mark - 1); other != GroupOf(side)) {
+            groups_[other] = GroupOf(side);
+            --live_groups;
+          }
+        });
+      }
+      for (std::size_t group = 0; group != side_count_ && live_groups > 1;
+           ++group) {
+        if (GroupOf(group) != group || cut_off_[group] || Searching(group)) {
+          continue;
+        }
+        // every cell a search of the group queued is on the cut-off side
+        auto label = NewLabel();
+        ++component_count_;
+        for (std::size_t side = 0; side != side_count_; ++side) {
+          if (GroupOf(side) != group) continue;
+          for (auto cell : queues_[side]) labels_[cell] = label;
+        }
+        cut_off_[group] = true;
+        --live_groups;
+      }
+    }
+  }
+
+  std::size_t GroupOf(std::size_t side) const noexcept {
+    while (groups_[side] != side) side = groups_[side];
+    return side;
+  }
+
+  // Whether a search of a side in group has cells left to visit.
+  bool Searching(std::size_t group) const noexcept {
+    for (std::size_t side = 0; side != side_count_; ++side) {
+      if (GroupOf(side) == group && heads_[side] != queues_[side].size()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  glm::uvec2 size_{};
+  std::vector<std::uint32_t> labels_;
+  std::vector<std::uint32_t> parents_;
+  std::size_t component_count_ = 0;
+
+  // scratch
+  std::vector<std::uint32_t> frontier_;
+  std::vector<std::uint32_t> sides_;
+  GenerationStamps marks_;
+  std::size_t side_count_ = 0;
+  std::vector<std::uint32_t> queues_[kMaxSides];
+  std::size_t heads_[kMaxSides] = {};
+  std::size_t groups_[kMaxSides] = {};
+  bool cut_off_[kMaxSides] = {};
+};
+
+}  // namespace ai
+}  // namespace einu
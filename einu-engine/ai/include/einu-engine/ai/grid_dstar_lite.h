@@ -0,0 +1,278 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "einu-engine/ai/grid_search.h"
+#include "einu-engine/ai/indexed_heap.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace ai {
+
+// D* Lite on an 8-connected grid, with the moves of GridAStar. The search
+// runs backwards from the goal and keeps its state between plans, so after
+// cells change only the costs the change reaches are repaired, rather than
+// searching again from scratch. One planner serves one goal and one moving
+// start, typically an agent:
+//
+//   planner.Reset(size, start, goal);
+//   planner.Plan(passable);
+//   ...
+//   planner.MoveStart(cell);        // the agent moved
+//   planner.UpdateCell(passable, changed_cell);
+//   planner.Plan(passable);
+//   planner.GetPath(passable, path);
+//
+// The buffers hold a few values per cell of the grid.
+class GridDStarLite {
+ public:
+  static constexpr float kUnreached = std::numeric_limits<float>::infinity();
+
+  void Reset(glm::uvec2 size, glm::uvec2 start, glm::uvec2 goal) {
+    assert(start.x < size.x && start.y < size.y && "start out of grid");
+    assert(goal.x < size.x && goal.y < size.y && "goal out of grid");
+    size_ = size;
+    start_ = start;
+    goal_ = goal;
+    key_modifier_ = 0;
+    stats_ = SearchStats{};
+
+    auto cell_count = std::size_t{size.x} * size.y;
+    g_.assign(cell_count, kUnreached);
+    rhs_.assign(cell_count, kUnreached);
+    open_.Reserve(cell_count);
+    open_.Clear();
+    auto goal_index = CellIndex(size, goal.x, goal.y);
+    rhs_[goal_index] = 0;
+    open_.Push(goal_index, {Heuristic(start, goal), 0});
+  }
+
+  // Brings the costs up to date for the current start. Returns whether the
+  // goal can be reached from it.
+  template <typename Passable>
+  bool Plan(const Passable& passable) {
+    stats_ = SearchStats{};
+    auto start = CellIndex(size_, start_.x, start_.y);
+    // runs until the start itself is consistent, so its g is its cost
+    while (!open_.Empty() && (open_.TopKey() < CalculateKey(start) ||
+                              rhs_[start] != g_[start])) {
+      auto current = open_.Top();
+      auto old_key = open_.TopKey();
+      auto new_key = CalculateKey(current);
+      if (old_key < new_key) {
+        open_.UpdateKey(current, new_key);
+        continue;
+      }
+      ++stats_.expanded;
+      auto x = current % size_.x;
+      auto y = current / size_.x;
+      if (g_[current] > rhs_[current]) {
+        g_[current] = rhs_[current];
+        open_.Remove(current);
+        ForEachPredecessor(passable, x, y, [&](std::uint32_t pred, float cost) {
+          if (pred == GoalIndex()) return;
+          rhs_[pred] = std::min(rhs_[pred], cost + g_[current]);
+          UpdateVertex(pred);
+        });
+      } else {
+        auto old_g = g_[current];
+        g_[current] = kUnreached;
+        ForEachPredecessor(passable, x, y, [&](std::uint32_t pred, float cost) {
+          if (rhs_[pred] == cost + old_g && pred != GoalIndex()) {
+            rhs_[pred] = BestSuccessor(passable, pred);
+          }
+          UpdateVertex(pred);
+        });
+        if (rhs_[current] == old_g && current != GoalIndex()) {
+          rhs_[current] = BestSuccessor(passable, current);
+        }
+        UpdateVertex(current);
+      }
+    }
+    return rhs_[start] != kUnreached;
+  }
+
+  // The agent moved to start; costs stay valid, only the heuristic shifts.
+  void MoveStart(glm::uvec2 start) {
+    assert(start.x < size_.x && start.y < size_.y && "start out of grid");
+    key_modifier_ += Heuristic(start_, start);
+    start_ = start;
+  }
+
+  // Repairs the costs around cell after its passability changed, to be
+  // followed by Plan. Several cells may change between plans.
+  template <typename Passable>
+  void UpdateCell(const Passable& passable, glm::uvec2 cell) {
+    assert(cell.x < size_.x && cell.y < size_.y && "cell out of grid");
+    // the steps out of the cell and its neighbours are the ones that change,
+    // diagonal ones included through the corner rule
+    auto update = [&](std::uint32_t x, std::uint32_t y) {
+      auto index = CellIndex(size_, x, y);
+      if (index != GoalIndex()) rhs_[index] = BestSuccessor(passable, index);
+      UpdateVertex(index);
+    };
+    update(cell.x, cell.y);
+    for (const auto& step : kGridSteps) {
+      auto x = static_cast<std::int64_t>(cell.x) + step.dx;
+      auto y = static_cast<std::int64_t>(cell.y) + step.dy;
+      if (InGrid(size_, x, y)) {
+        update(static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(y));
+      }
+    }
+  }
+
+  // Follows the costs of the last Plan from the start, with the path
+  // convention of GridAStar::GetPath.
+  template <typename Passable>
+  bool GetPath(const Passable& passable, std::vector<glm::uvec2>& path) const {
+    path.clear();
+    auto current = CellIndex(size_, start_.x, start_.y);
+    if (g_[current] == kUnreached && current != GoalIndex()) return false;
+    // cost ties could cycle on stale costs, so never walk more than all cells
+    for (auto limit = g_.size(); current != GoalIndex() && limit != 0;
+         --limit) {
+      auto x = current % size_.x;
+      auto y = current / size_.x;
+      auto best = kUnreached;
+      auto next = current;
+      for (const auto& step : kGridSteps) {
+        if (!CanStep(size_, passable, x, y, step.dx, step.dy)) continue;
+        auto neighbour = CellIndex(size_, x + step.dx, y + step.dy);
+        auto cost = step.cost + g_[neighbour];
+        if (cost < best) {
+          best = cost;
+          next = neighbour;
+        }
+      }
+      if (next == current) return false;
+      current = next;
+      path.push_back(glm::uvec2{current % size_.x, current / size_.x});
+    }
+    if (current != GoalIndex()) return false;
+    std::reverse(path.begin(), path.end());
+    return true;
+  }
+
+  // kUnreached if the last Plan found no path.
+  float GetCost() const noexcept {
+    return g_[CellIndex(size_, start_.x, start_.y)];
+  }
+
+  glm::uvec2 GetStart() const noexcept { return start_; }
+
+  glm::uvec2 GetGoal() const noexcept { return goal_; }
+
+  // Of the last Plan.
+  const SearchStats& GetStats() const noexcept { return stats_; }
+
+  std::size_t BufferBytes() const noexcept {
+    return (g_.capacity() + rhs_.capacity()) * sizeof(float) +
+           open_.Capacity() * (sizeof(Key) + 2 * sizeof(std::uint32_t));
+  }
+
+ private:
+  struct Key {
+    float first;
+    float second;
+
+    bool operator<(const Key& other) const noexcept {
+      return first < other.first ||
+             (first == other.first && second < other.second);
+    }
+  };
+
+  // Slightly below the octile distance. Costs summed along a path round
+  // differently from the distance, and a heuristic that overshoots a cost by
+  // a rounding error leaves that cell unsettled behind the start.
+  static float Heuristic(glm::uvec2 a, glm::uvec2 b) noexcept {
+    return OctileDistance(a, b) * 0.999f;
+  }
+
+  std::uint32_t GoalIndex() const noexcept {
+    return CellIndex(size_, goal_.x, goal_.y);
+  }
+
+  Key CalculateKey(std::uint32_t index) const noexcept {
+    auto cost = std::min(g_[index], rhs_[index]);
+    auto pos = glm::uvec2{index % size_.x, index / size_.x};
+    return {cost + Heuristic(start_, pos) + key_modifier_, cost};
+  }
+
+  void UpdateVertex(std::uint32_t index) {
+    auto inconsistent = g_[index] != rhs_[index];
+    if (open_.Contains(index)) {
+      if (inconsistent) {
+        open_.UpdateKey(index, CalculateKey(index));
+      } else {
+        open_.Remove(index);
+      }
+    } else if (inconsistent) {
+      open_.Push(index, CalculateKey(index));
+      ++stats_.pushed;
+    }
+  }
+
+  // The cheapest cost to the goal through a step out of index.
+  template <typename Passable>
+  float BestSuccessor(const Passable& passable, std::uint32_t index) const {
+    auto x = index % size_.x;
+    auto y = index / size_.x;
+    auto best = kUnreached;
+    for (const auto& step : kGridSteps) {
+      if (!CanStep(size_, passable, x, y, step.dx, step.dy)) continue;
+      auto next = CellIndex(size_, x + step.dx, y + step.dy);
+      best = std::min(best, step.cost + g_[next]);
+    }
+    return best;
+  }
+
+  // Calls fn(pred, cost) for every cell with a step into (x, y).
+  template <typename Passable, typename Fn>
+  void ForEachPredecessor(const Passable& passable, std::uint32_t x,
+                          std::uint32_t y, Fn&& fn) const {
+    for (const auto& step : kGridSteps) {
+      auto px = static_cast<std::int64_t>(x) - step.dx;
+      auto py = static_cast<std::int64_t>(y) - step.dy;
+      if (!InGrid(size_, px, py)) continue;
+      auto ux = static_cast<std::uint32_t>(px);
+      auto uy = static_cast<std::uint32_t>(py);
+      if (!CanStep(size_, passable, ux, uy, step.dx, step.dy)) continue;
+      fn(CellIndex(size_, ux, uy), step.cost);
+    }
+  }
+
+  glm::uvec2 size_{};
+  glm::uvec2 start_{};
+  glm::uvec2 goal_{};
+  float key_modifier_ = 0;
+  std::vector<float> g_;
+  std::vector<float> rhs_;
+  IndexedMinHeap<Key> open_;
+  SearchStats stats_;
+};
+
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,576 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "einu-engine/ai/grid_astar.h"
+#include "einu-engine/ai/grid_search.h"
+#include "einu-engine/ai/indexed_heap.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace ai {
+
+// Hierarchical path-finding A* (HPA*) on an 8-connected grid. The grid is
+// cut into square clusters. Where two clusters touch, every run of cells
+// passable on both sides becomes an entrance: one transition in its middle,
+// or one at each end when it is wide. Transitions are the nodes of an
+// abstract graph, linked across the border at cost 1 and to the other
+// transitions of their cluster at the cost of the shortest path inside the
+// cluster.
+//
+// A query links start and goal to the transitions of their clusters, runs A*
+// on the abstract graph and refines each abstract edge with a search inside
+// one cluster, so a long query never touches most of the grid. Paths are
+// close to, but not always, the shortest. The searches inside a cluster use
+// buffers the size of a cluster, whatever the size of the grid.
+//
+// After a cell changes, UpdateCell rebuilds only its cluster and, when the
+// cell is on the edge of the cluster, the entrances on that edge.
+class GridHPA {
+ public:
+  explicit GridHPA(std::uint32_t cluster_size = 32) noexcept
+      : cluster_size_{cluster_size} {
+    assert(cluster_size >= 2 && "cluster too small");
+  }
+
+  template <typename Passable>
+  void Build(glm::uvec2 size, const Passable& passable) {
+    size_ = size;
+    cluster_count_ = (size + glm::uvec2(cluster_size_ - 1)) /
+                     glm::uvec2(cluster_size_);
+    nodes_.clear();
+    free_nodes_.clear();
+    cluster_nodes_.assign(std::size_t{cluster_count_.x} * cluster_count_.y,
+                          {});
+    border_nodes_.assign(VerticalBorderCount() + HorizontalBorderCount(), {});
+    for (std::uint32_t border = 0; border != border_nodes_.size(); ++border) {
+      BuildBorder(passable, border);
+    }
+    for (std::uint32_t cluster = 0; cluster != cluster_nodes_.size();
+         ++cluster) {
+      LinkCluster(passable, cluster);
+    }
+  }
+
+  // Brings the abstract graph up to date after the passability of cell
+  // changed.
+  template <typename Passable>
+  void UpdateCell(const Passable& passable, glm::uvec2 cell) {
+    assert(cell.x < size_.x && cell.y < size_.y && "cell out of grid");
+    auto cluster_pos = cell / glm::uvec2(cluster_size_);
+    auto min = cluster_pos * cluster_size_;
+    auto max = glm::min(min + glm::uvec2(cluster_size_), size_) -
+               glm::uvec2(1);
+
+    std::uint32_t clusters[5];
+    auto cluster_count = 0;
+    clusters[cluster_count++] = ClusterIndex(cluster_pos);
+    auto rebuild = [&](std::uint32_t border, glm::uvec2 other) {
+      ClearBorder(border);
+      BuildBorder(passable, border);
+      clusters[cluster_count++] = ClusterIndex(other);
+    };
+    if (cell.x == min.x && cluster_pos.x != 0) {
+      rebuild(VerticalBorder(cluster_pos - glm::uvec2(1, 0)),
+              cluster_pos - glm::uvec2(1, 0));
+    }
+    if (cell.x == max.x && cluster_pos.x + 1 != cluster_count_.x) {
+      rebuild(VerticalBorder(cluster_pos), cluster_pos + glm::uvec2(1, 0));
+    }
+    if (cell.y == min.y && cluster_pos.y != 0) {
+      rebuild(HorizontalBorder(cluster_pos - glm::uvec2(0, 1)),
+              cluster_pos - glm::uvec2(0, 1));
+    }
+    if (cell.y == max.y && cluster_pos.y + 1 != cluster_count_.y) {
+      rebuild(HorizontalBorder(cluster_pos), cluster_pos + glm::uvec2(0, 1));
+    }
+    for (auto i = 0; i != cluster_count; ++i) {
+      LinkCluster(passable, clusters[i]);
+    }
+  }
+
+  // Same path convention as GridAStar::GetPath. Unlike GridAStar, a blocked
+  // start has no path: entrances only join passable cells.
+  template <typename Passable>
+  bool FindPath(const Passable& passable, glm::uvec2 start, glm::uvec2 goal,
+                std::vector<glm::uvec2>& path) {
+    assert(start.x < size_.x && start.y < size_.y && "start out of grid");
+    assert(goal.x < size_.x && goal.y < size_.y && "goal out of grid");
+    path.clear();
+    stats_ = SearchStats{};
+    if (!passable(start.x, start.y) || !passable(goal.x, goal.y)) return false;
+    if (start == goal) return true;
+
+    auto start_cluster = ClusterIndex(start / glm::uvec2(cluster_size_));
+    auto goal_cluster = ClusterIndex(goal / glm::uvec2(cluster_size_));
+    if (start_cluster == goal_cluster &&
+        SearchInCluster(passable, start_cluster, start, goal, path)) {
+      return true;
+    }
+    if (!SearchAbstract(passable, start, start_cluster, goal, goal_cluster)) {
+      return false;
+    }
+    Refine(passable, start, goal, path);
+    return true;
+  }
+
+  std::size_t NodeCount() const noexcept {
+    return nodes_.size() - free_nodes_.size();
+  }
+
+  std::size_t EdgeCount() const noexcept {
+    auto count = std::size_t{0};
+    for (const auto& node : nodes_) count += node.edges.size();
+    return count;
+  }
+
+  // Of the abstract search of the last query.
+  const SearchStats& GetStats() const noexcept { return stats_; }
+
+ private:
+  using NodeID = std::uint32_t;
+
+  static constexpr NodeID kNone = std::numeric_limits<NodeID>::max();
+
+  // Entrances at least this wide get a transition at each end.
+  static constexpr std::uint32_t kWideEntrance = 6;
+
+  static constexpr float kUnreached = std::numeric_limits<float>::max();
+
+  enum Mark : GenerationStamps::Mark { kOpen = 1, kClosed = 2 };
+
+  struct Edge {
+    NodeID to;
+    float cost;
+  };
+
+  struct Node {
+    glm::uvec2 pos;
+    std::uint32_t cluster;
+    std::uint32_t border;
+    // the first edge crosses the border, the rest stay in the cluster
+    std::vector<Edge> edges;
+  };
+
+  struct Key {
+    float f;
+    float h;
+
+    bool operator<(const Key& other) const noexcept {
+      return f < other.f || (f == other.f && h < other.h);
+    }
+  };
+
+  std::uint32_t ClusterIndex(glm::uvec2 cluster_pos) const noexcept {
+    return cluster_pos.y * cluster_count_.x + cluster_pos.x;
+  }
+
+  glm::uvec2 ClusterMin(std::uint32_t cluster) const noexcept {
+    return glm::uvec2(cluster % cluster_count_.x,
+                      cluster / cluster_count_.x) *
+           cluster_size_;
+  }
+
+  glm::uvec2 ClusterSize(std::uint32_t cluster) const noexcept {
+    auto min = ClusterMin(cluster);
+    return glm::min(min + glm::uvec2(cluster_size_), size_) - min;
+  }
+
+  std::size_t VerticalBorderCount() const noexcept {
+    return std::size_t{cluster_count_.x - 1} * cluster_count_.y;
+  }
+
+  std::size_t HorizontalBorderCount() const noexcept {
+    return std::size_t{cluster_count_.x} * (cluster_count_.y - 1);
+  }
+
+  // The border between the cluster at cluster_pos and the one after it in x.
+  std::uint32_t VerticalBorder(glm::uvec2 cluster_pos) const noexcept {
+    return cluster_pos.y * (cluster_count_.x - 1) + cluster_pos.x;
+  }
+
+  // The border between the cluster at cluster_pos and the one after it in y.
+  std::uint32_t HorizontalBorder(glm::uvec2 cluster_pos) const noexcept {
+    return static_cast<std::uint32_t>(VerticalBorderCount()) +
+           cluster_pos.y * cluster_count_.x + cluster_pos.x;
+  }
+
+  NodeID AddNode(glm::uvec2 pos, std::uint32_t border) {
+    auto cluster = ClusterIndex(pos / glm::uvec2(cluster_size_));
+    auto id = static_cast<NodeID>(nodes_.size());
+    if (free_nodes_.empty()) {
+      nodes_.emplace_back();
+    } else {
+      id = free_nodes_.back();
+      free_nodes_.pop_back();
+    }
+    auto& node = nodes_[id];
+    node.pos = pos;
+    node.cluster = cluster;
+    node.border = border;
+    node.edges.clear();
+    cluster_nodes_[cluster].push_back(id);
+    border_nodes_[border].push_back(id);
+    return id;
+  }
+
+  void AddTransition(glm::uvec2 a, glm::uvec2 b, std::uint32_t border) {
+    auto node_a = AddNode(a, border);
+    auto node_b = AddNode(b, border);
+    nodes_[node_a].edges.push_back({node_b, 1.f});
+    nodes_[node_b].edges.push_back({node_a, 1.f});
+  }
+
+  // Removes the transitions of border. Their clusters must be linked again.
+  void ClearBorder(std::uint32_t border) {
+    for (auto id : border_nodes_[border]) {
+      auto& cluster = cluster_nodes_[nodes_[id].cluster];
+      cluster.erase(std::find(cluster.begin(), cluster.end(), id));
+      nodes_[id].edges.clear();
+      free_nodes_.push_back(id);
+    }
+    border_nodes_[border].clear();
+  }
+
+  template <typename Passable>
+  void BuildBorder(const Passable& passable, std::uint32_t border) {
+    // walk the cells of the first cluster along the border; step is the
+    // direction across it
+    auto vertical = border < VerticalBorderCount();
+    auto index = vertical ? border : border - VerticalBorderCount();
+    auto row_length = vertical ? cluster_count_.x - 1 : cluster_count_.x;
+    auto cluster_pos = glm::uvec2(index % row_length, index / row_length);
+    auto first = ClusterIndex(cluster_pos);
+    auto min = ClusterMin(first);
+    auto extent = ClusterSize(first);
+    auto along = vertical ? glm::uvec2(0, 1) : glm::uvec2(1, 0);
+    auto across = vertical ? glm::uvec2(1, 0) : glm::uvec2(0, 1);
+    auto origin = min + (extent - glm::uvec2(1)) * across;
+    auto length = vertical ? extent.y : extent.x;
+
+    auto open = [&](std::uint32_t i) {
+      auto a = origin + along * i;
+      auto b = a + across;
+      return passable(a.x, a.y) && passable(b.x, b.y);
+    };
+    auto add = [&](std::uint32_t i) {
+      auto a = origin + along * i;
+      AddTransition(a, a + across, border);
+    };
+    for (std::uint32_t i = 0; i != length;) {
+      if (!open(i)) {
+        ++i;
+        continue;
+      }
+      auto begin = i;
+      while (i != length && open(i)) ++i;
+      auto width = i - begin;
+      if (width < kWideEntrance) {
+        add(begin + width / 2);
+      } else {
+        add(begin);
+        add(i - 1);
+      }
+    }
+  }
+
+  // Links every pair of transitions of cluster by their shortest path inside
+  // it.
+  template <typename Passable>
+  void LinkCluster(const Passable& passable, std::uint32_t cluster) {
+    const auto& ids = cluster_nodes_[cluster];
+    for (auto id : ids) nodes_[id].edges.resize(1);
+    if (ids.size() < 2) return;
+    // without obstacles the octile distance is the shortest path
+    auto clear = LoadCluster(passable, cluster);
+    for (std::size_t i = 0; i + 1 < ids.size(); ++i) {
+      if (!clear) {
+        ClusterDistances(nodes_[ids[i]].pos, ids.data() + i + 1,
+                         ids.data() + ids.size());
+      }
+      for (auto j = i + 1; j != ids.size(); ++j) {
+        auto cost =
+            clear ? OctileDistance(nodes_[ids[i]].pos, nodes_[ids[j]].pos)
+                  : LocalDistance(nodes_[ids[j]].pos);
+        if (cost == kUnreached) continue;
+        nodes_[ids[i]].edges.push_back({ids[j], cost});
+        nodes_[ids[j]].edges.push_back({ids[i], cost});
+      }
+    }
+  }
+
+  // Copies the passability of cluster for the searches of ClusterDistances,
+  // which visit every cell several times. Returns whether every cell is
+  // passable.
+  template <typename Passable>
+  bool LoadCluster(const Passable& passable, std::uint32_t cluster) {
+    local_min_ = ClusterMin(cluster);
+    local_extent_ = ClusterSize(cluster);
+    auto cell_count = std::size_t{local_extent_.x} * local_extent_.y;
+    if (local_cells_.size() < cell_count) {
+      local_cells_.resize(cell_count);
+      local_dist_.resize(cell_count);
+      local_targets_.resize(cell_count);
+    }
+    auto clear = true;
+    for (std::uint32_t y = 0; y != local_extent_.y; ++y) {
+      for (std::uint32_t x = 0; x != local_extent_.x; ++x) {
+        auto open = passable(local_min_.x + x, local_min_.y + y);
+        local_cells_[CellIndex(local_extent_, x, y)] = open;
+        clear = clear && open;
+      }
+    }
+    return clear;
+  }
+
+  // Dijkstra from source over the loaded cluster, filling local_dist_. It
+  // stops once the cells of the target nodes are settled.
+  void ClusterDistances(glm::uvec2 source, const NodeID* targets_begin,
+                        const NodeID* targets_end) {
+    auto min = local_min_;
+    auto extent = local_extent_;
+    auto local = [this](std::uint32_t x, std::uint32_t y) {
+      return local_cells_[CellIndex(local_extent_, x, y)] != 0;
+    };
+    auto cell_count = std::size_t{extent.x} * extent.y;
+    local_marks_.Resize(cell_count);
+    local_marks_.NextGeneration();
+    local_open_.Reserve(cell_count);
+    local_open_.Clear();
+
+    auto source_local = source - min;
+    auto source_index = CellIndex(extent, source_local.x, source_local.y);
+    local_dist_[source_index] = 0;
+    local_marks_.Set(source_index, kOpen);
+    local_open_.Push(source_index, 0.f);
+
+    auto target_index = [&](NodeID id) {
+      auto pos = nodes_[id].pos - min;
+      return CellIndex(extent, pos.x, pos.y);
+    };
+    for (auto it = targets_begin; it != targets_end; ++it) {
+      ++local_targets_[target_index(*it)];
+    }
+    auto remaining = targets_end - targets_begin;
+    while (!local_open_.Empty() && remaining != 0) {
+      auto current = local_open_.Pop();
+      local_marks_.Set(current, kClosed);
+      remaining -= local_targets_[current];
+      auto x = current % extent.x;
+      auto y = current / extent.x;
+      for (const auto& step : kGridSteps) {
+        if (!CanStep(extent, local, x, y, step.dx, step.dy)) continue;
+        auto next = CellIndex(extent, x + step.dx, y + step.dy);
+        auto mark = local_marks_.Get(next);
+        if (mark == kClosed) continue;
+        auto dist = local_dist_[current] + step.cost;
+        if (mark == kOpen) {
+          if (dist >= local_dist_[next]) continue;
+          local_dist_[next] = dist;
+          local_open_.DecreaseKey(next, dist);
+        } else {
+          local_dist_[next] = dist;
+          local_marks_.Set(next, kOpen);
+          local_open_.Push(next, dist);
+        }
+      }
+    }
+    for (auto it = targets_begin; it != targets_end; ++it) {
+      local_targets_[target_index(*it)] = 0;
+    }
+  }
+
+  // The distance to pos found by the last ClusterDistances.
+  float LocalDistance(glm::uvec2 pos) const noexcept {
+    auto local = pos - local_min_;
+    auto index = CellIndex(local_extent_, local.x, local.y);
+    return local_marks_.Get(index) == kClosed ? local_dist_[index]
+                                              : kUnreached;
+  }
+
+  // A* between two cells of cluster without leaving it. Appends the path in
+  // the GridAStar convention.
+  template <typename Passable>
+  bool SearchInCluster(const Passable& passable, std::uint32_t cluster,
+                       glm::uvec2 from, glm::uvec2 to,
+                       std::vector<glm::uvec2>& path) {
+    auto min = ClusterMin(cluster);
+    auto local = [&](std::uint32_t x, std::uint32_t y) {
+      return passable(min.x + x, min.y + y);
+    };
+    if (!local_search_.FindPath(ClusterSize(cluster), local, from - min,
+                                to - min, local_path_)) {
+      return false;
+    }
+    for (auto cell : local_path_) path.push_back(cell + min);
+    return true;
+  }
+
+  // Links a cell to the transitions of its cluster.
+  template <typename Passable>
+  void LinkEndpoint(const Passable& passable, glm::uvec2 pos,
+                    std::uint32_t cluster, std::vector<Edge>& links) {
+    links.clear();
+    const auto& ids = cluster_nodes_[cluster];
+    auto clear = LoadCluster(passable, cluster);
+    if (!clear) {
+      ClusterDistances(pos, ids.data(), ids.data() + ids.size());
+    }
+    for (auto id : ids) {
+      auto cost = clear ? OctileDistance(pos, nodes_[id].pos)
+                        : LocalDistance(nodes_[id].pos);
+      if (cost != kUnreached) links.push_back({id, cost});
+    }
+  }
+
+  template <typename Passable>
+  bool SearchAbstract(const Passable& passable, glm::uvec2 start,
+                      std::uint32_t start_cluster, glm::uvec2 goal,
+                      std::uint32_t goal_cluster) {
+    auto start_id = static_cast<NodeID>(nodes_.size());
+    auto goal_id = start_id + 1;
+    auto count = std::size_t{goal_id} + 1;
+    if (g_.size() < count) {
+      g_.resize(count);
+      parents_.resize(count);
+    }
+    marks_.Resize(count);
+    marks_.NextGeneration();
+    open_.Reserve(count);
+    open_.Clear();
+
+    // start and goal are linked to their clusters for this query only
+    LinkEndpoint(passable, goal, goal_cluster, goal_links_);
+    LinkEndpoint(passable, start, start_cluster, start_links_);
+
+    g_[start_id] = 0;
+    parents_[start_id] = start_id;
+    marks_.Set(start_id, kOpen);
+    open_.Push(start_id, {OctileDistance(start, goal), 0});
+    ++stats_.pushed;
+    while (!open_.Empty()) {
+      auto current = open_.Pop();
+      marks_.Set(current, kClosed);
+      ++stats_.expanded;
+      if (current == goal_id) {
+        start_id_ = start_id;
+        goal_id_ = goal_id;
+        return true;
+      }
+      const auto& edges =
+          current == start_id ? start_links_ : nodes_[current].edges;
+      for (const auto& edge : edges) {
+        Relax(current, edge.to, edge.cost, nodes_[edge.to].pos, goal);
+      }
+      if (current != start_id && nodes_[current].cluster == goal_cluster) {
+        for (const auto& link : goal_links_) {
+          if (link.to == current) {
+            Relax(current, goal_id, link.cost, goal, goal);
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  void Relax(NodeID current, NodeID next, float cost, glm::uvec2 next_pos,
+             glm::uvec2 goal) {
+    auto mark = marks_.Get(next);
+    if (mark == kClosed) return;
+    auto next_g = g_[current] + cost;
+    if (mark == kOpen && next_g >= g_[next]) return;
+    g_[next] = next_g;
+    parents_[next] = current;
+    auto h = OctileDistance(next_pos, goal);
+    if (mark == kOpen) {
+      open_.DecreaseKey(next, {next_g + h, h});
+    } else {
+      marks_.Set(next, kOpen);
+      open_.Push(next, {next_g + h, h});
+      ++stats_.pushed;
+    }
+  }
+
+  // Turns the abstract path of the last SearchAbstract into cells.
+  template <typename Passable>
+  void Refine(const Passable& passable, glm::uvec2 start, glm::uvec2 goal,
+              std::vector<glm::uvec2>& path) {
+    auto position = [&](NodeID id) {
+      if (id == start_id_) return start;
+      if (id == goal_id_) return goal;
+      return nodes_[id].pos;
+    };
+    for (auto id = goal_id_; id != start_id_; id = parents_[id]) {
+      auto parent = parents_[id];
+      auto from = position(parent);
+      auto to = position(id);
+      if (from == to) continue;
+      auto from_cluster = ClusterIndex(from / glm::uvec2(cluster_size_));
+      auto to_cluster = ClusterIndex(to / glm::uvec2(cluster_size_));
+      if (from_cluster != to_cluster) {
+        path.push_back(to);
+      } else {
+        auto found = SearchInCluster(passable, to_cluster, from, to, path);
+        assert(found && "abstract edge without a path");
+        static_cast<void>(found);
+      }
+    }
+  }
+
+  std::uint32_t cluster_size_;
+  glm::uvec2 size_{};
+  glm::uvec2 cluster_count_{};
+
+  std::vector<Node> nodes_;
+  std::vector<NodeID> free_nodes_;
+  std::vector<std::vector<NodeID>> cluster_nodes_;
+  std::vector<std::vector<NodeID>> border_nodes_;
+
+  // searches inside one cluster
+  std::vector<std::uint8_t> local_cells_;
+  std::vector<float> local_dist_;
+  std::vector<std::uint32_t> local_targets_;
+  GenerationStamps local_marks_;
+  IndexedMinHeap<float> local_open_;
+  glm::uvec2 local_min_{};
+  glm::uvec2 local_extent_{};
+  GridAStar local_search_;
+  std::vector<glm::uvec2> local_path_;
+
+  // search on the abstract graph
+  std::vector<float> g_;
+  std::vector<NodeID> parents_;
+  GenerationStamps marks_;
+  IndexedMinHeap<Key> open_;
+  std::vector<Edge> start_links_;
+  std::vector<Edge> goal_links_;
+  NodeID start_id_ = kNone;
+  NodeID goal_id_ = kNone;
+  SearchStats stats_;
+};
+
+}  // namespace ai
+}  // namespace einu
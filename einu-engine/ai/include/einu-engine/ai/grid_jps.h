@@ -0,0 +1,339 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "einu-engine/ai/bit_grid.h"
+#include "einu-engine/ai/grid_search.h"
+#include "einu-engine/ai/indexed_heap.h"
+#include "einu-engine/core/util/bit.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace ai {
+
+// Jump Point Search on an 8-connected grid of uniform cost, with the same
+// moves and interface as GridAStar. Instead of pushing every neighbour, a
+// search scans straight and diagonal lines until it meets a cell where the
+// path may have to turn, so open ground costs a scan rather than a heap
+// operation per cell. Paths are as short as those of GridAStar. On a BitGrid,
+// lines are scanned a word of cells at a time.
+class GridJPS {
+ public:
+  static constexpr std::size_t kUnlimited =
+      std::numeric_limits<std::size_t>::max();
+
+  void Start(glm::uvec2 size, glm::uvec2 start, glm::uvec2 goal) {
+    assert(start.x < size.x && start.y < size.y && "start out of grid");
+    assert(goal.x < size.x && goal.y < size.y && "goal out of grid");
+    size_ = size;
+    start_ = CellIndex(size, start.x, start.y);
+    goal_ = CellIndex(size, goal.x, goal.y);
+    goal_pos_ = goal;
+    stats_ = SearchStats{};
+    status_ = SearchStatus::Searching;
+
+    auto cell_count = static_cast<std::size_t>(size.x) * size.y;
+    if (g_.size() < cell_count) {
+      g_.resize(cell_count);
+      parents_.resize(cell_count);
+    }
+    marks_.Resize(cell_count);
+    marks_.NextGeneration();
+    open_.Reserve(cell_count);
+    open_.Clear();
+
+    g_[start_] = 0;
+    parents_[start_] = start_;
+    marks_.Set(start_, kOpen);
+    open_.Push(start_, {OctileDistance(start, goal), 0});
+    ++stats_.pushed;
+  }
+
+  // Expands up to max_expansions jump points of the search started last.
+  template <typename Passable>
+  SearchStatus Step(const Passable& passable,
+                    std::size_t max_expansions = kUnlimited) {
+    if (status_ != SearchStatus::Searching) return status_;
+    if (!passable(goal_pos_.x, goal_pos_.y)) {
+      return status_ = SearchStatus::NoPath;
+    }
+    for (; max_expansions != 0; --max_expansions) {
+      if (open_.Empty()) return status_ = SearchStatus::NoPath;
+      auto current = open_.Pop();
+      marks_.Set(current, kClosed);
+      ++stats_.expanded;
+      if (current == goal_) return status_ = SearchStatus::Found;
+      Expand(passable, current);
+    }
+    return status_;
+  }
+
+  // Same convention as GridAStar::GetPath, with the cells between jump
+  // points filled in.
+  void GetPath(std::vector<glm::uvec2>& path) const {
+    path.clear();
+    if (status_ != SearchStatus::Found) return;
+    for (auto cell = goal_; cell != start_; cell = parents_[cell]) {
+      auto from = ToPos(parents_[cell]);
+      auto pos = glm::ivec2(ToPos(cell));
+      auto dir = Direction(from, ToPos(cell));
+      for (; pos != from; pos -= dir) path.emplace_back(pos);
+    }
+  }
+
+  template <typename Passable>
+  bool FindPath(glm::uvec2 size, const Passable& passable, glm::uvec2 start,
+                glm::uvec2 goal, std::vector<glm::uvec2>& path) {
+    Start(size, start, goal);
+    Step(passable);
+    GetPath(path);
+    return status_ == SearchStatus::Found;
+  }
+
+  SearchStatus GetStatus() const noexcept { return status_; }
+
+  const SearchStats& GetStats() const noexcept { return stats_; }
+
+ private:
+  enum Mark : GenerationStamps::Mark { kOpen = 1, kClosed = 2 };
+
+  static constexpr std::uint32_t kNone =
+      std::numeric_limits<std::uint32_t>::max();
+
+  struct Key {
+    float f;
+    float h;
+
+    bool operator<(const Key& other) const noexcept {
+      return f < other.f || (f == other.f && h < other.h);
+    }
+  };
+
+  glm::ivec2 ToPos(std::uint32_t cell) const noexcept {
+    return glm::ivec2(cell % size_.x, cell / size_.x);
+  }
+
+  static glm::ivec2 Direction(glm::ivec2 from, glm::ivec2 to) noexcept {
+    return glm::ivec2((to.x > from.x) - (to.x < from.x),
+                      (to.y > from.y) - (to.y < from.y));
+  }
+
+  template <typename Passable>
+  bool Open(const Passable& passable, int x, int y) const {
+    return InGrid(size_, x, y) && passable(static_cast<std::uint32_t>(x),
+                                           static_cast<std::uint32_t>(y));
+  }
+
+  template <typename Passable>
+  bool CanMove(const Passable& passable, int x, int y, int dx,
+               int dy) const {
+    return CanStep(size_, passable, static_cast<std::uint32_t>(x),
+                   static_cast<std::uint32_t>(y), dx, dy);
+  }
+
+  // Whether a straight move into (x, y) has a neighbour that only a path
+  // through (x, y) reaches without cutting a corner.
+  template <typename Passable>
+  bool HasForcedNeighbour(const Passable& passable, int x, int y, int dx,
+                          int dy) const {
+    if (dx != 0) {
+      return (Open(passable, x, y - 1) && !Open(passable, x - dx, y - 1)) ||
+             (Open(passable, x, y + 1) && !Open(passable, x - dx, y + 1));
+    }
+    return (Open(passable, x - 1, y) && !Open(passable, x - 1, y - dy)) ||
+           (Open(passable, x + 1, y) && !Open(passable, x + 1, y - dy));
+  }
+
+  // Scans from (x, y) along a straight line. Returns the first jump point, or
+  // kNone when the line runs into a wall.
+  template <typename Passable>
+  std::uint32_t JumpStraight(const Passable& passable, int x, int y, int dx,
+                             int dy) const {
+    if constexpr (std::is_same_v<Passable, BitGrid>) {
+      return ScanStraight(passable, x, y, dx, dy);
+    } else {
+      while (CanMove(passable, x, y, dx, dy)) {
+        x += dx;
+        y += dy;
+        auto cell = CellIndex(size_, x, y);
+        if (cell == goal_ || HasForcedNeighbour(passable, x, y, dx, dy)) {
+          return cell;
+        }
+      }
+      return kNone;
+    }
+  }
+
+  // JumpStraight on a BitGrid, 63 cells a word. Lines are read along words
+  // with read(along, across), as rows or as columns. A cell of the line has a
+  // forced neighbour where the cell beside it is open and the one behind that
+  // is blocked. Returns where along the line the scan stops, or -1.
+  template <typename Read>
+  int ScanLine(const Read& read, int along, int across, int dir,
+               int goal_along, int goal_across) const {
+    using Word = BitGrid::Word;
+    constexpr auto kWordBits = BitGrid::kWordBits;
+    auto goal_distance = std::numeric_limits<int>::max();
+    if (goal_across == across && (goal_along - along) * dir > 0) {
+      goal_distance = (goal_along - along) * dir;
+    }
+    // the cell scanned from is in the window but is no candidate
+    for (auto scanned = 0;; scanned += kWordBits - 1) {
+      auto from = along + dir * scanned;
+      int blocked;
+      int forced;
+      if (dir > 0) {
+        // cell from + k in bit 63 - k
+        auto candidates = ~Word{0} >> 1;
+        auto walls = ~read(from, across) & candidates;
+        auto turns = ((read(from, across - 1) & ~read(from - 1, across - 1)) |
+                      (read(from, across + 1) & ~read(from - 1, across + 1))) &
+                     candidates;
+        blocked = walls ? util::CountLeftZero(walls) : kWordBits;
+        forced = turns ? util::CountLeftZero(turns) : kWordBits;
+      } else {
+        // cell from - k in bit k
+        auto start = from - (kWordBits - 1);
+        auto candidates = ~Word{1};
+        auto walls = ~read(start, across) & candidates;
+        auto turns =
+            ((read(start, across - 1) & ~read(start + 1, across - 1)) |
+             (read(start, across + 1) & ~read(start + 1, across + 1))) &
+            candidates;
+        blocked = walls ? util::CountRightZero(walls) : kWordBits;
+        forced = turns ? util::CountRightZero(turns) : kWordBits;
+      }
+      auto stop = std::min(forced, goal_distance - scanned);
+      if (stop < blocked) return from + dir * stop;
+      if (blocked != kWordBits) return -1;
+    }
+  }
+
+  std::uint32_t ScanStraight(const BitGrid& grid, int x, int y, int dx,
+                             int dy) const {
+    auto goal = glm::ivec2(goal_pos_);
+    if (dy == 0) {
+      auto read = [&grid](int along, int across) {
+        return grid.GetRowBits(along, across);
+      };
+      auto stop = ScanLine(read, x, y, dx, goal.x, goal.y);
+      return stop < 0 ? kNone : CellIndex(size_, stop, y);
+    }
+    auto read = [&grid](int along, int across) {
+      return grid.GetColumnBits(across, along);
+    };
+    auto stop = ScanLine(read, y, x, dy, goal.y, goal.x);
+    return stop < 0 ? kNone : CellIndex(size_, x, stop);
+  }
+
+  // Scans from (x, y) in a straight or diagonal direction. A diagonal scan
+  // stops where one of its straight scans finds a jump point.
+  template <typename Passable>
+  std::uint32_t Jump(const Passable& passable, int x, int y, int dx,
+                     int dy) const {
+    if (dx == 0 || dy == 0) return JumpStraight(passable, x, y, dx, dy);
+    while (CanMove(passable, x, y, dx, dy)) {
+      x += dx;
+      y += dy;
+      auto cell = CellIndex(size_, x, y);
+      if (cell == goal_ || JumpStraight(passable, x, y, dx, 0) != kNone ||
+          JumpStraight(passable, x, y, 0, dy) != kNone) {
+        return cell;
+      }
+    }
+    return kNone;
+  }
+
+  template <typename Passable>
+  void Expand(const Passable& passable, std::uint32_t current) {
+    auto pos = ToPos(current);
+    if (current == start_) {
+      for (const auto& step : kGridSteps) {
+        Relax(current, pos, Jump(passable, pos.x, pos.y, step.dx, step.dy));
+      }
+      return;
+    }
+
+    auto dir = Direction(ToPos(parents_[current]), pos);
+    glm::ivec2 dirs[5];
+    auto count = 0;
+    if (dir.x != 0 && dir.y != 0) {
+      dirs[count++] = {dir.x, 0};
+      dirs[count++] = {0, dir.y};
+      dirs[count++] = dir;
+    } else if (dir.x != 0) {
+      dirs[count++] = dir;
+      dirs[count++] = {dir.x, 1};
+      dirs[count++] = {dir.x, -1};
+      dirs[count++] = {0, 1};
+      dirs[count++] = {0, -1};
+    } else {
+      dirs[count++] = dir;
+      dirs[count++] = {1, dir.y};
+      dirs[count++] = {-1, dir.y};
+      dirs[count++] = {1, 0};
+      dirs[count++] = {-1, 0};
+    }
+    for (auto i = 0; i != count; ++i) {
+      Relax(current, pos, Jump(passable, pos.x, pos.y, dirs[i].x, dirs[i].y));
+    }
+  }
+
+  void Relax(std::uint32_t current, glm::ivec2 pos, std::uint32_t next) {
+    if (next == kNone) return;
+    auto mark = marks_.Get(next);
+    if (mark == kClosed) return;
+    auto next_pos = glm::uvec2(ToPos(next));
+    auto next_g = g_[current] + OctileDistance(glm::uvec2(pos), next_pos);
+    if (mark == kOpen && next_g >= g_[next]) return;
+    g_[next] = next_g;
+    parents_[next] = current;
+    auto h = OctileDistance(next_pos, goal_pos_);
+    if (mark == kOpen) {
+      open_.DecreaseKey(next, {next_g + h, h});
+    } else {
+      marks_.Set(next, kOpen);
+      open_.Push(next, {next_g + h, h});
+      ++stats_.pushed;
+    }
+  }
+
+  glm::uvec2 size_{};
+  std::uint32_t start_ = 0;
+  std::uint32_t goal_ = 0;
+  glm::uvec2 goal_pos_{};
+  SearchStatus status_ = SearchStatus::NoPath;
+  SearchStats stats_;
+
+  std::vector<float> g_;
+  std::vector<std::uint32_t> parents_;
+  GenerationStamps marks_;
+  IndexedMinHeap<Key> open_;
+};
+
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,172 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// Pieces shared by the searches on 8-connected grids. Cells are given by a
+// passability callable, passable(x, y) -> bool for x, y of type std::uint32_t,
+// so a search can run on any grid storage. Straight steps cost 1 and diagonal
+// steps cost sqrt(2); a diagonal step may not cut the corner of a blocked
+// cell.
+
+namespace einu {
+namespace ai {
+
+inline constexpr float kDiagonalCost = 1.41421356f;
+
+struct GridStep {
+  int dx;
+  int dy;
+  float cost;
+};
+
+// Straight steps first, then diagonal steps.
+inline constexpr GridStep kGridSteps[8] = {
+    {1, 0, 1.f},
+    {-1, 0, 1.f},
+    {0, 1, 1.f},
+    {0, -1, 1.f},
+    {1, 1, kDiagonalCost},
+    {1, -1, kDiagonalCost},
+    {-1, 1, kDiagonalCost},
+    {-1, -1, kDiagonalCost},
+};
+
+enum class SearchStatus { Searching, Found, NoPath };
+
+struct SearchStats {
+  std::size_t expanded = 0;
+  std::size_t pushed = 0;
+};
+
+inline std::uint32_t CellIndex(glm::uvec2 size, std::uint32_t x,
+                               std::uint32_t y) noexcept {
+  return y * size.x + x;
+}
+
+inline bool InGrid(glm::uvec2 size, std::int64_t x, std::int64_t y) noexcept {
+  return x >= 0 && y >= 0 && x < size.x && y < size.y;
+}
+
+// The exact cost between two cells of an open grid.
+inline float OctileDistance(glm::uvec2 a, glm::uvec2 b) noexcept {
+  auto dx = a.x > b.x ? a.x - b.x : b.x - a.x;
+  auto dy = a.y > b.y ? a.y - b.y : b.y - a.y;
+  auto diagonal = std::min(dx, dy);
+  auto straight = std::max(dx, dy) - diagonal;
+  return static_cast<float>(straight) +
+         kDiagonalCost * static_cast<float>(diagonal);
+}
+
+// Whether a step from the in-grid cell (x, y) lands on a passable cell without
+// cutting a blocked corner.
+template <typename Passable>
+bool CanStep(glm::uvec2 size, const Passable& passable, std::uint32_t x,
+             std::uint32_t y, int dx, int dy) {
+  auto nx = static_cast<std::int64_t>(x) + dx;
+  auto ny = static_cast<std::int64_t>(y) + dy;
+  if (!InGrid(size, nx, ny)) return false;
+  auto ux = static_cast<std::uint32_t>(nx);
+  auto uy = static_cast<std::uint32_t>(ny);
+  if (!passable(ux, uy)) return false;
+  return dx == 0 || dy == 0 || (passable(ux, y) && passable(x, uy));
+}
+
+namespace internal {
+
+// Drops the diagonal steps of a mask of passable neighbours that would cut a
+// blocked corner.
+constexpr std::uint8_t ClearCorners(std::uint8_t neighbours) noexcept {
+  auto right = neighbours & 1;
+  auto left = neighbours >> 1 & 1;
+  auto down = neighbours >> 2 & 1;
+  auto up = neighbours >> 3 & 1;
+  auto corners = (right & down) << 4 | (right & up) << 5 |
+                 (left & down) << 6 | (left & up) << 7;
+  return static_cast<std::uint8_t>(neighbours & (0x0f | corners));
+}
+
+}  // namespace internal
+
+// The steps CanStep allows from the in-grid cell (x, y), bit i standing for
+// kGridSteps[i]. Asks passable once per neighbour; grids that can answer for
+// all neighbours at once overload it.
+template <typename Passable>
+std::uint8_t GetStepMask(glm::uvec2 size, const Passable& passable,
+                         std::uint32_t x, std::uint32_t y) {
+  auto neighbours = std::uint8_t{0};
+  for (auto i = 0; i != 8; ++i) {
+    auto nx = static_cast<std::int64_t>(x) + kGridSteps[i].dx;
+    auto ny = static_cast<std::int64_t>(y) + kGridSteps[i].dy;
+    if (InGrid(size, nx, ny) && passable(static_cast<std::uint32_t>(nx),
+                                         static_cast<std::uint32_t>(ny))) {
+      neighbours |= 1 << i;
+    }
+  }
+  return internal::ClearCorners(neighbours);
+}
+
+// Per-cell marks that are all cleared at once by starting a new generation,
+// so a search over a big grid does not pay for touching every cell to reset.
+// A mark is a small non-zero number; 0 means unmarked.
+class GenerationStamps {
+ public:
+  using Mark = std::uint32_t;
+
+  static constexpr Mark kMaxMark = 7;
+
+  void Resize(std::size_t count) {
+    if (stamps_.size() < count) stamps_.resize(count, 0);
+  }
+
+  std::size_t Size() const noexcept { return stamps_.size(); }
+
+  void NextGeneration() {
+    if (base_ > std::numeric_limits<std::uint32_t>::max() - 2 * kSpan) {
+      std::fill(stamps_.begin(), stamps_.end(), 0);
+      base_ = 0;
+    }
+    base_ += kSpan;
+  }
+
+  Mark Get(std::size_t index) const noexcept {
+    auto stamp = stamps_[index];
+    return stamp > base_ ? stamp - base_ : 0;
+  }
+
+  void Set(std::size_t index, Mark mark) noexcept {
+    stamps_[index] = base_ + mark;
+  }
+
+ private:
+  static constexpr std::uint32_t kSpan = kMaxMark + 1;
+
+  std::vector<std::uint32_t> stamps_;
+  std::uint32_t base_ = 0;
+};
+
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,55 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <utility>
+
+#include "einu-engine/ai/bit_grid.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace ai {
+
+// A read-only copy of which cells of a grid are passable, so searches on
+// worker threads never read the live grid.
+class GridSnapshot {
+ public:
+  GridSnapshot() = default;
+
+  explicit GridSnapshot(BitGrid cells) : cells_{std::move(cells)} {}
+
+  template <typename Passable>
+  GridSnapshot(glm::uvec2 size, const Passable& passable)
+      : cells_{size, passable} {}
+
+  bool operator()(std::uint32_t x, std::uint32_t y) const noexcept {
+    return cells_(x, y);
+  }
+
+  // For the searches to take the word-wide paths of BitGrid.
+  const BitGrid& GetCells() const noexcept { return cells_; }
+
+  glm::uvec2 GetSize() const noexcept { return cells_.GetSize(); }
+
+ private:
+  BitGrid cells_;
+};
+
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,153 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace einu {
+namespace ai {
+
+// A binary min-heap of ids in [0, capacity) that knows where each id sits,
+// so the key of an id already in the heap can be changed, or the id removed,
+// in O(log n). Keys compare with operator<.
+template <typename Key>
+class IndexedMinHeap {
+ public:
+  using Id = std::uint32_t;
+
+  void Reserve(std::size_t capacity) {
+    if (positions_.size() < capacity) positions_.resize(capacity);
+  }
+
+  void Clear() noexcept { heap_.clear(); }
+
+  bool Empty() const noexcept { return heap_.empty(); }
+
+  std::size_t Size() const noexcept { return heap_.size(); }
+
+  std::size_t Capacity() const noexcept { return positions_.size(); }
+
+  void Push(Id id, const Key& key) {
+    assert(id < positions_.size() && "id out of heap capacity");
+    heap_.push_back({key, id});
+    SiftUp(heap_.size() - 1);
+  }
+
+  // id must be in the heap and key must not be greater than its key.
+  void DecreaseKey(Id id, const Key& key) noexcept {
+    auto pos = positions_[id];
+    assert(pos < heap_.size() && heap_[pos].id == id && "id not in heap");
+    heap_[pos].key = key;
+    SiftUp(pos);
+  }
+
+  bool Contains(Id id) const noexcept {
+    auto pos = positions_[id];
+    return pos < heap_.size() && heap_[pos].id == id;
+  }
+
+  // id must be in the heap. Unlike DecreaseKey, key may be greater.
+  void UpdateKey(Id id, const Key& key) noexcept {
+    auto pos = positions_[id];
+    assert(pos < heap_.size() && heap_[pos].id == id && "id not in heap");
+    auto raise = heap_[pos].key < key;
+    heap_[pos].key = key;
+    if (raise) {
+      SiftDown(pos);
+    } else {
+      SiftUp(pos);
+    }
+  }
+
+  // id must be in the heap.
+  void Remove(Id id) noexcept {
+    auto pos = positions_[id];
+    assert(pos < heap_.size() && heap_[pos].id == id && "id not in heap");
+    auto last = heap_.back();
+    heap_.pop_back();
+    if (pos == heap_.size()) return;
+    auto raise = heap_[pos].key < last.key;
+    Place(pos, last);
+    if (raise) {
+      SiftDown(pos);
+    } else {
+      SiftUp(pos);
+    }
+  }
+
+  Id Top() const noexcept { return heap_.front().id; }
+
+  const Key& TopKey() const noexcept { return heap_.front().key; }
+
+  Id Pop() noexcept {
+    assert(!heap_.empty() && "pop from empty heap");
+    auto top = heap_.front().id;
+    heap_.front() = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) SiftDown(0);
+    return top;
+  }
+
+ private:
+  struct Entry {
+    Key key;
+    Id id;
+  };
+
+  void SiftUp(std::size_t pos) noexcept {
+    auto entry = heap_[pos];
+    while (pos != 0) {
+      auto parent = (pos - 1) / 2;
+      if (!(entry.key < heap_[parent].key)) break;
+      Place(pos, heap_[parent]);
+      pos = parent;
+    }
+    Place(pos, entry);
+  }
+
+  void SiftDown(std::size_t pos) noexcept {
+    auto entry = heap_[pos];
+    auto size = heap_.size();
+    while (true) {
+      auto child = 2 * pos + 1;
+      if (child >= size) break;
+      if (child + 1 < size && heap_[child + 1].key < heap_[child].key) {
+        ++child;
+      }
+      if (!(heap_[child].key < entry.key)) break;
+      Place(pos, heap_[child]);
+      pos = child;
+    }
+    Place(pos, entry);
+  }
+
+  void Place(std::size_t pos, const Entry& entry) noexcept {
+    heap_[pos] = entry;
+    positions_[entry.id] = static_cast<Id>(pos);
+  }
+
+  std::vector<Entry> heap_;
+  std::vector<Id> positions_;
+};
+
+}  // namespace ai
+}  // namespace einu
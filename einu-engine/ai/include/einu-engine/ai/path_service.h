@@ -0,0 +1,256 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "einu-engine/ai/grid_astar.h"
+#include "einu-engine/ai/grid_connectivity.h"
+#include "einu-engine/ai/grid_snapshot.h"
+#include "einu-engine/core/eid.h"
+#include "einu-engine/core/job_system.h"
+#include "einu-engine/core/trace.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace ai {
+
+struct PathRequest {
+  EID agent;
+  glm::uvec2 start;
+  glm::uvec2 goal;
+};
+
+// A finished search handed to one of the agents that asked for it. path
+// follows the GridAStar convention: from the goal back to the first cell
+// after the start.
+struct PathResult {
+  EID agent;
+  glm::uvec2 start;
+  glm::uvec2 goal;
+  bool found;
+  const std::vector<glm::uvec2>& path;
+};
+
+struct PathServiceStats {
+  std::size_t requested = 0;
+  // requests that joined a search already queued or running
+  std::size_t shared = 0;
+  // requests answered without a search, their goal being out of reach
+  std::size_t rejected = 0;
+  std::size_t searched = 0;
+  std::size_t delivered = 0;
+  // results dropped because their agent asked again or cancelled
+  std::size_t dropped = 0;
+};
+
+namespace internal {
+
+struct PathSearch {
+  std::uint64_t key;
+  glm::uvec2 start;
+  glm::uvec2 goal;
+  std::shared_ptr<const GridSnapshot> grid;
+  // written by the job
+  std::vector<glm::uvec2> path;
+  bool found = false;
+  // main thread only
+  std::vector<std::pair<EID, std::uint64_t>> agents;
+};
+
+using PathSearchPtr = std::shared_ptr<PathSearch>;
+
+// Where jobs leave their searches. Shared with the jobs so that it outlives
+// the service.
+struct PathMailbox {
+  std::mutex mutex;
+  std::vector<PathSearchPtr> done;
+};
+
+}  // namespace internal
+
+// Solves path requests on the workers of a job system against a snapshot of
+// the grid. Systems call Request whenever an agent needs a path; once per
+// frame the app calls Schedule to start the searches and Deliver to hand out
+// finished paths, at most a budget of them per frame:
+//
+//   service.SetGrid(std::make_shared<GridSnapshot>(size, passable));
+//   ...
+//   service.Request({eid, start, goal});
+//   ...
+//   service.Schedule();
+//   service.Deliver(64, [&](const PathResult& result) { ... });
+//
+// Everything but the searches runs on the thread calling the service.
+class PathService {
+ public:
+  explicit PathService(JobSystem& jobs)
+      : jobs_{jobs}, mailbox_{std::make_shared<internal::PathMailbox>()} {}
+
+  PathService(const PathService&) = delete;
+  PathService& operator=(const PathService&) = delete;
+
+  // Requests from now on are searched on grid. Searches already queued or
+  // running keep the snapshot they were requested on.
+  void SetGrid(std::shared_ptr<const GridSnapshot> grid) {
+    grid_ = std::move(grid);
+    connectivity_.Build(grid_->GetSize(), grid_->GetCells());
+    searches_.clear();
+  }
+
+  // A newer request of an agent supersedes its older one. Requests with the
+  // same start and goal share one search. A goal out of reach is answered
+  // with no path at once.
+  void Request(const PathRequest& request) {
+    assert(grid_ && "no grid to search");
+    auto size = grid_->GetSize();
+    assert(request.start.x < size.x && request.start.y < size.y &&
+           "start out of grid");
+    assert(request.goal.x < size.x && request.goal.y < size.y &&
+           "goal out of grid");
+    ++stats_.requested;
+    auto ticket = ++last_ticket_;
+    tickets_[request.agent] = ticket;
+
+    // a search for an unreachable goal would visit all it can reach
+    if (!connectivity_.Reachable(request.start, request.goal)) {
+      ++stats_.rejected;
+      auto search = std::make_shared<internal::PathSearch>();
+      search->start = request.start;
+      search->goal = request.goal;
+      ready_.push_back({request.agent, ticket, std::move(search)});
+      return;
+    }
+
+    auto start = CellIndex(size, request.start.x, request.start.y);
+    auto goal = CellIndex(size, request.goal.x, request.goal.y);
+    auto key = std::uint64_t{start} << 32 | goal;
+    auto& search = searches_[key];
+    if (search) {
+      ++stats_.shared;
+    } else {
+      search = std::make_shared<internal::PathSearch>();
+      search->key = key;
+      search->start = request.start;
+      search->goal = request.goal;
+      search->grid = grid_;
+      queued_.push_back(search);
+    }
+    search->agents.emplace_back(request.agent, ticket);
+  }
+
+  // Drops the pending request of agent, if any.
+  void Cancel(EID agent) { tickets_.erase(agent); }
+
+  bool IsPending(EID agent) const { return tickets_.contains(agent); }
+
+  // Starts the searches requested since the last call.
+  void Schedule() {
+    for (auto& search : queued_) {
+      jobs_.Schedule([search, mailbox = mailbox_] {
+        EINU_TRACE_SCOPE("path search");
+        thread_local auto astar = GridAStar{};
+        const auto& grid = search->grid->GetCells();
+        search->found = astar.FindPath(grid.GetSize(), grid, search->start,
+                                       search->goal, search->path);
+        auto lock = std::lock_guard{mailbox->mutex};
+        mailbox->done.push_back(search);
+        return JobResult::Done();
+      });
+      ++stats_.searched;
+    }
+    queued_.clear();
+  }
+
+  // Calls deliver(const PathResult&) for at most max_results finished paths
+  // of pending requests. The rest wait for the next call. Returns the number
+  // of paths delivered.
+  template <typename DeliverFn>
+  std::size_t Deliver(std::size_t max_results, DeliverFn&& deliver) {
+    EINU_TRACE_SCOPE("PathService::Deliver");
+    CollectDone();
+    auto delivered = std::size_t{0};
+    while (delivered != max_results && !ready_.empty()) {
+      auto [agent, ticket, search] = std::move(ready_.front());
+      ready_.pop_front();
+      auto it = tickets_.find(agent);
+      if (it == tickets_.end() || it->second != ticket) {
+        ++stats_.dropped;
+        continue;
+      }
+      tickets_.erase(it);
+      deliver(PathResult{agent, search->start, search->goal, search->found,
+                         search->path});
+      ++delivered;
+    }
+    stats_.delivered += delivered;
+    return delivered;
+  }
+
+  // Finished paths waiting for Deliver, including superseded ones.
+  std::size_t ReadyCount() const noexcept { return ready_.size(); }
+
+  const PathServiceStats& GetStats() const noexcept { return stats_; }
+
+ private:
+  struct Delivery {
+    EID agent;
+    std::uint64_t ticket;
+    std::shared_ptr<const internal::PathSearch> search;
+  };
+
+  void CollectDone() {
+    auto done = std::vector<internal::PathSearchPtr>{};
+    {
+      auto lock = std::lock_guard{mailbox_->mutex};
+      done.swap(mailbox_->done);
+    }
+    for (auto& search : done) {
+      if (auto it = searches_.find(search->key);
+          it != searches_.end() && it->second == search) {
+        searches_.erase(it);
+      }
+      for (auto [agent, ticket] : search->agents) {
+        ready_.push_back({agent, ticket, search});
+      }
+    }
+  }
+
+  JobSystem& jobs_;
+  std::shared_ptr<internal::PathMailbox> mailbox_;
+  std::shared_ptr<const GridSnapshot> grid_;
+  GridConnectivity connectivity_;
+  absl::flat_hash_map<std::uint64_t, internal::PathSearchPtr> searches_;
+  absl::flat_hash_map<EID, std::uint64_t> tickets_;
+  std::uint64_t last_ticket_ = 0;
+  std::vector<internal::PathSearchPtr> queued_;
+  std::deque<Delivery> ready_;
+  PathServiceStats stats_;
+};
+
+}  // namespace ai
+}  // namespace einu
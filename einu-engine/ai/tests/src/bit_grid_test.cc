@@ -0,0 +1,171 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/bit_grid.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "einu-engine/ai/flow_field.h"
+#include "einu-engine/ai/grid_astar.h"
+#include "einu-engine/ai/grid_jps.h"
+#include "gtest/gtest.h"
+#include "src/test_grid.h"
+
+namespace einu {
+namespace ai {
+
+namespace {
+
+bool InGridAndPassable(const test::TestGrid& grid, std::int64_t x,
+                       std::int64_t y) {
+  return InGrid(grid.size, x, y) && grid(static_cast<std::uint32_t>(x),
+                                         static_cast<std::uint32_t>(y));
+}
+
+// Checks every cell, step mask and a sample of the line reads of bits
+// against grid.
+void CheckBits(const BitGrid& bits, const test::TestGrid& grid,
+               std::mt19937& generator) {
+  auto size = grid.size;
+  ASSERT_EQ(bits.GetSize(), size);
+  auto passable_count = std::size_t{0};
+  for (std::uint32_t y = 0; y != size.y; ++y) {
+    for (std::uint32_t x = 0; x != size.x; ++x) {
+      ASSERT_EQ(bits(x, y), grid(x, y));
+      passable_count += grid(x, y);
+      ASSERT_EQ(bits.GetStepMask(x, y), GetStepMask(size, grid, x, y));
+    }
+  }
+  EXPECT_EQ(bits.CountPassable(), passable_count);
+
+  auto column = std::uniform_int_distribution<std::int64_t>{
+      -BitGrid::kWordBits, size.x};
+  auto row = std::uniform_int_distribution<std::int64_t>{-1, size.y};
+  for (int i = 0; i != 200; ++i) {
+    auto x = column(generator);
+    auto y = row(generator);
+    auto row_bits = bits.GetRowBits(x, y);
+    for (int bit = 0; bit != BitGrid::kWordBits; ++bit) {
+      ASSERT_EQ(row_bits >> (BitGrid::kWordBits - 1 - bit) & 1,
+                InGridAndPassable(grid, x + bit, y));
+    }
+  }
+  auto column_x = std::uniform_int_distribution<std::int64_t>{-1, size.x};
+  auto column_y = std::uniform_int_distribution<std::int64_t>{
+      -BitGrid::kWordBits, size.y};
+  for (int i = 0; i != 200; ++i) {
+    auto x = column_x(generator);
+    auto y = column_y(generator);
+    auto column_bits = bits.GetColumnBits(x, y);
+    for (int bit = 0; bit != BitGrid::kWordBits; ++bit) {
+      ASSERT_EQ(column_bits >> (BitGrid::kWordBits - 1 - bit) & 1,
+                InGridAndPassable(grid, x, y + bit));
+    }
+  }
+}
+
+}  // namespace
+
+TEST(BitGrid, matches_the_grid_it_copies) {
+  auto generator = std::mt19937{73};
+  for (auto size : {glm::uvec2{1, 1}, glm::uvec2{64, 3}, glm::uvec2{130, 70},
+                    glm::uvec2{5, 200}}) {
+    for (auto blocked_percent : {0, 30, 100}) {
+      auto grid = test::TestGrid{size, blocked_percent, generator()};
+      CheckBits(BitGrid{size, grid}, grid, generator);
+    }
+  }
+}
+
+TEST(BitGrid, edits_write_rows_and_columns) {
+  auto size = glm::uvec2{150, 90};
+  auto grid = test::TestGrid{size, 100, 1};
+  auto bits = BitGrid{size};
+  auto generator = std::mt19937{79};
+  for (int i = 0; i != 40; ++i) {
+    auto pos = test::RandomCell(size, generator);
+    auto end = test::RandomCell(size, generator);
+    auto count = glm::uvec2{end.x >= pos.x ? end.x - pos.x : 0,
+                            end.y >= pos.y ? end.y - pos.y : 0};
+    auto passable = i % 3 != 0;
+    bits.Fill(pos, count, passable);
+    for (auto y = pos.y; y != pos.y + count.y; ++y) {
+      for (auto x = pos.x; x != pos.x + count.x; ++x) {
+        grid.Set({x, y}, passable);
+      }
+    }
+    auto cell = test::RandomCell(size, generator);
+    bits.Set(cell.x, cell.y, !passable);
+    grid.Set(cell, !passable);
+  }
+  CheckBits(bits, grid, generator);
+}
+
+TEST(BitGrid, filled_at_construction) {
+  auto size = glm::uvec2{70, 3};
+  auto bits = BitGrid{size, true};
+  EXPECT_EQ(bits.CountPassable(), 210);
+  EXPECT_EQ(bits.GetRowBits(-1, 0) >> 63, 0);
+  EXPECT_EQ(bits.GetRowBits(64, 1) >> 58, 0x3f);
+}
+
+TEST(BitGrid, searches_on_it_match_dijkstra) {
+  auto size = glm::uvec2{150, 90};
+  auto grid = test::TestGrid{size, 25, 83};
+  auto bits = BitGrid{size, grid};
+  auto generator = std::mt19937{89};
+  auto astar = GridAStar{};
+  auto jps = GridJPS{};
+  auto field = FlowField{};
+  auto path = std::vector<glm::uvec2>{};
+  for (int i = 0; i != 20; ++i) {
+    auto start = test::RandomCell(size, generator);
+    auto goal = test::RandomCell(size, generator);
+    // a flow field never enters a blocked start
+    for (auto cell : {start, goal}) {
+      grid.Set(cell, true);
+      bits.Set(cell.x, cell.y, true);
+    }
+    auto shortest = test::ShortestCost(size, grid, start, goal);
+    auto reachable = shortest != test::kUnreachable;
+
+    ASSERT_EQ(astar.FindPath(size, bits, start, goal, path), reachable);
+    if (reachable) {
+      auto cost = test::PathCost(size, grid, start, goal, path);
+      ASSERT_TRUE(cost.has_value());
+      EXPECT_NEAR(*cost, shortest, 1e-3f);
+    }
+    // the line scans read a word of cells at a time
+    ASSERT_EQ(jps.FindPath(size, bits, start, goal, path), reachable);
+    if (reachable) {
+      auto cost = test::PathCost(size, grid, start, goal, path);
+      ASSERT_TRUE(cost.has_value());
+      EXPECT_NEAR(*cost, shortest, 1e-3f);
+    }
+    field.Compute(size, bits, goal);
+    EXPECT_EQ(field.Reaches(start), reachable);
+    if (reachable) {
+      EXPECT_NEAR(field.GetCost(start), shortest, 1e-3f);
+    }
+  }
+}
+
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,154 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/flow_field.h"
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/test_grid.h"
+
+namespace einu {
+namespace ai {
+
+namespace {
+
+// Checks every cell of field against the reference search from its goal,
+// and that following the directions from a cell costs what the field says.
+void CheckField(const FlowField& field, const test::TestGrid& grid) {
+  auto size = grid.size;
+  auto goal = field.GetGoal();
+  // moves are symmetric, so the costs from the goal are the costs to it
+  auto costs = test::ShortestCosts(size, grid, goal);
+  for (std::uint32_t y = 0; y != size.y; ++y) {
+    for (std::uint32_t x = 0; x != size.x; ++x) {
+      auto cell = glm::uvec2{x, y};
+      auto shortest = costs[CellIndex(size, x, y)];
+      auto reaches = grid(goal.x, goal.y) && shortest != test::kUnreachable;
+      ASSERT_EQ(field.Reaches(cell), reaches);
+      if (!reaches) {
+        EXPECT_EQ(field.GetDirection(cell), (glm::ivec2{0, 0}));
+        continue;
+      }
+      EXPECT_NEAR(field.GetCost(cell), shortest, 1e-3f);
+
+      auto cost = 0.f;
+      for (auto steps = 0u; cell != goal; ++steps) {
+        ASSERT_LT(steps, size.x * size.y);
+        auto direction = field.GetDirection(cell);
+        ASSERT_TRUE(
+            CanStep(size, grid, cell.x, cell.y, direction.x, direction.y));
+        cost += direction.x == 0 || direction.y == 0 ? 1.f : kDiagonalCost;
+        cell = field.GetNextCell(cell);
+      }
+      EXPECT_NEAR(cost, shortest, 1e-3f);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(FlowField, matches_dijkstra_on_random_grids) {
+  auto generator = std::mt19937{37};
+  auto field = FlowField{};
+  for (auto [size, blocked_percent] :
+       {std::pair{glm::uvec2{30, 20}, 0}, std::pair{glm::uvec2{13, 27}, 25},
+        std::pair{glm::uvec2{32, 32}, 40}}) {
+    auto grid = test::TestGrid{size, blocked_percent, generator()};
+    for (int i = 0; i != 6; ++i) {
+      field.Compute(size, grid, test::RandomCell(size, generator));
+      CheckField(field, grid);
+    }
+  }
+}
+
+TEST(FlowField, blocked_goal_is_reached_from_nowhere) {
+  auto size = glm::uvec2{6, 6};
+  auto grid = test::TestGrid{size, 0, 1};
+  grid.Set({2, 3}, false);
+  auto field = FlowField{};
+  field.Compute(size, grid, {2, 3});
+  EXPECT_FALSE(field.Reaches({2, 3}));
+  EXPECT_FALSE(field.Reaches({2, 2}));
+}
+
+TEST(FlowFieldCache, computes_a_goal_once) {
+  auto size = glm::uvec2{16, 16};
+  auto grid = test::TestGrid{size, 20, 3};
+  auto cache = FlowFieldCache{2};
+  const auto* field = &cache.Get(size, grid, {1, 1});
+  EXPECT_EQ(&cache.Get(size, grid, {1, 1}), field);
+  EXPECT_EQ(cache.Find({1, 1}), field);
+  EXPECT_EQ(cache.Find({2, 2}), nullptr);
+  EXPECT_EQ(cache.GetStats().hits, 1);
+  EXPECT_EQ(cache.GetStats().misses, 1);
+}
+
+TEST(FlowFieldCache, evicts_the_least_recently_used_goal) {
+  auto size = glm::uvec2{16, 16};
+  auto grid = test::TestGrid{size, 0, 1};
+  auto cache = FlowFieldCache{2};
+  cache.Get(size, grid, {1, 1});
+  cache.Get(size, grid, {2, 2});
+  cache.Get(size, grid, {1, 1});
+  cache.Get(size, grid, {3, 3});
+  EXPECT_EQ(cache.Size(), 2);
+  EXPECT_NE(cache.Find({1, 1}), nullptr);
+  EXPECT_EQ(cache.Find({2, 2}), nullptr);
+  EXPECT_NE(cache.Find({3, 3}), nullptr);
+  EXPECT_EQ(cache.GetStats().evicted, 1);
+}
+
+TEST(FlowFieldCache, fields_kept_after_changes_stay_right) {
+  auto size = glm::uvec2{24, 24};
+  auto grid = test::TestGrid{size, 30, 41};
+  auto generator = std::mt19937{43};
+  auto cache = FlowFieldCache{6};
+  auto goals = std::vector<glm::uvec2>{};
+  for (int i = 0; i != 6; ++i) {
+    goals.push_back(test::RandomCell(size, generator));
+  }
+  for (int round = 0; round != 20; ++round) {
+    for (auto goal : goals) cache.Get(size, grid, goal);
+    auto cell = test::RandomCell(size, generator);
+    grid.Set(cell, !grid(cell.x, cell.y));
+    cache.InvalidateCell(cell);
+    for (auto goal : goals) {
+      if (const auto* field = cache.Find(goal)) CheckField(*field, grid);
+    }
+  }
+  // the grid is split into pieces, so some changes leave fields alone
+  EXPECT_GT(cache.GetStats().hits, 0);
+  EXPECT_GT(cache.GetStats().invalidated, 0);
+}
+
+TEST(FlowFieldCache, invalidate_drops_every_field) {
+  auto size = glm::uvec2{8, 8};
+  auto grid = test::TestGrid{size, 0, 1};
+  auto cache = FlowFieldCache{4};
+  cache.Get(size, grid, {1, 1});
+  cache.Get(size, grid, {2, 2});
+  cache.Invalidate();
+  EXPECT_EQ(cache.Size(), 0);
+  EXPECT_EQ(cache.GetStats().invalidated, 2);
+  EXPECT_EQ(cache.Find({1, 1}), nullptr);
+}
+
+}  // namespace ai
+}  // namespace einu
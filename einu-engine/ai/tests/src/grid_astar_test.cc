@@ -0,0 +1,111 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/grid_astar.h"
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/test_grid.h"
+
+namespace einu {
+namespace ai {
+
+TEST(GridAStar, finds_shortest_paths_on_random_grids) {
+  auto astar = GridAStar{};
+  auto generator = std::mt19937{11};
+  auto path = std::vector<glm::uvec2>{};
+  // the grids shrink and grow so the buffers are reused across sizes
+  for (auto [size, blocked_percent] :
+       {std::pair{glm::uvec2{40, 25}, 0}, std::pair{glm::uvec2{17, 31}, 20},
+        std::pair{glm::uvec2{48, 48}, 35}, std::pair{glm::uvec2{9, 5}, 45}}) {
+    auto grid = test::TestGrid{size, blocked_percent, generator()};
+    for (int i = 0; i != 40; ++i) {
+      auto start = test::RandomCell(size, generator);
+      auto goal = test::RandomCell(size, generator);
+      auto shortest = test::ShortestCost(size, grid, start, goal);
+      auto reachable = grid(goal.x, goal.y) && shortest != test::kUnreachable;
+
+      ASSERT_EQ(astar.FindPath(size, grid, start, goal, path), reachable);
+      if (!reachable) {
+        EXPECT_TRUE(path.empty());
+        continue;
+      }
+      auto cost = test::PathCost(size, grid, start, goal, path);
+      ASSERT_TRUE(cost.has_value());
+      EXPECT_NEAR(*cost, shortest, 1e-3f);
+    }
+  }
+}
+
+TEST(GridAStar, stepping_finds_the_path_of_a_full_search) {
+  auto size = glm::uvec2{32, 32};
+  auto grid = test::TestGrid{size, 25, 3};
+  auto generator = std::mt19937{5};
+  auto full = GridAStar{};
+  auto stepped = GridAStar{};
+  auto full_path = std::vector<glm::uvec2>{};
+  auto stepped_path = std::vector<glm::uvec2>{};
+  for (int i = 0; i != 20; ++i) {
+    auto start = test::RandomCell(size, generator);
+    auto goal = test::RandomCell(size, generator);
+    auto found = full.FindPath(size, grid, start, goal, full_path);
+
+    stepped.Start(size, start, goal);
+    auto status = SearchStatus::Searching;
+    while ((status = stepped.Step(grid, 7)) == SearchStatus::Searching) {
+    }
+    EXPECT_EQ(status, found ? SearchStatus::Found : SearchStatus::NoPath);
+    stepped.GetPath(stepped_path);
+    EXPECT_EQ(stepped_path, full_path);
+  }
+}
+
+TEST(GridAStar, start_at_the_goal_gives_an_empty_path) {
+  auto size = glm::uvec2{8, 8};
+  auto grid = test::TestGrid{size, 0, 1};
+  auto astar = GridAStar{};
+  auto path = std::vector<glm::uvec2>{glm::uvec2{1, 1}};
+  EXPECT_TRUE(astar.FindPath(size, grid, {3, 4}, {3, 4}, path));
+  EXPECT_TRUE(path.empty());
+}
+
+TEST(GridAStar, blocked_goal_has_no_path) {
+  auto size = glm::uvec2{8, 8};
+  auto grid = test::TestGrid{size, 0, 1};
+  grid.Set({5, 5}, false);
+  auto astar = GridAStar{};
+  auto path = std::vector<glm::uvec2>{};
+  EXPECT_FALSE(astar.FindPath(size, grid, {0, 0}, {5, 5}, path));
+  EXPECT_EQ(astar.GetStatus(), SearchStatus::NoPath);
+  EXPECT_EQ(astar.GetStats().expanded, 0);
+}
+
+TEST(GridAStar, diagonal_steps_do_not_cut_corners) {
+  auto size = glm::uvec2{3, 3};
+  auto grid = test::TestGrid{size, 0, 1};
+  grid.Set({1, 0}, false);
+  auto astar = GridAStar{};
+  auto path = std::vector<glm::uvec2>{};
+  ASSERT_TRUE(astar.FindPath(size, grid, {0, 0}, {1, 1}, path));
+  EXPECT_EQ(path, (std::vector<glm::uvec2>{{1, 1}, {0, 1}}));
+}
+
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,164 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/grid_connectivity.h"
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/test_grid.h"
+
+namespace einu {
+namespace ai {
+
+namespace {
+
+// Labels the 4-connected components of passable cells by breadth-first
+// search, 0 standing for blocked cells. Returns the number of components.
+std::uint32_t LabelComponents(const test::TestGrid& grid,
+                              std::vector<std::uint32_t>& labels) {
+  auto size = grid.size;
+  labels.assign(std::size_t{size.x} * size.y, 0);
+  auto label = std::uint32_t{0};
+  auto frontier = std::vector<glm::uvec2>{};
+  for (std::uint32_t y = 0; y != size.y; ++y) {
+    for (std::uint32_t x = 0; x != size.x; ++x) {
+      if (!grid(x, y) || labels[CellIndex(size, x, y)] != 0) continue;
+      labels[CellIndex(size, x, y)] = ++label;
+      frontier.assign(1, glm::uvec2{x, y});
+      for (std::size_t i = 0; i != frontier.size(); ++i) {
+        auto cell = frontier[i];
+        for (const auto& step : kGridSteps) {
+          if (step.dx != 0 && step.dy != 0) continue;
+          if (!CanStep(size, grid, cell.x, cell.y, step.dx, step.dy)) continue;
+          auto next = glm::uvec2{cell.x + step.dx, cell.y + step.dy};
+          auto& next_label = labels[CellIndex(size, next.x, next.y)];
+          if (next_label != 0) continue;
+          next_label = label;
+          frontier.push_back(next);
+        }
+      }
+    }
+  }
+  return label;
+}
+
+// Checks that the labels of connectivity name the same components as a
+// breadth-first search of grid.
+void CheckLabels(GridConnectivity& connectivity, const test::TestGrid& grid) {
+  auto expected = std::vector<std::uint32_t>{};
+  auto component_count = LabelComponents(grid, expected);
+  EXPECT_EQ(connectivity.ComponentCount(), component_count);
+  // the labels match one to one
+  auto to_label = std::map<std::uint32_t, std::uint32_t>{};
+  auto from_label = std::map<std::uint32_t, std::uint32_t>{};
+  for (std::uint32_t y = 0; y != grid.size.y; ++y) {
+    for (std::uint32_t x = 0; x != grid.size.x; ++x) {
+      auto want = expected[CellIndex(grid.size, x, y)];
+      auto label = connectivity.GetLabel({x, y});
+      ASSERT_EQ(want == 0, label == GridConnectivity::kNoLabel);
+      if (want == 0) continue;
+      ASSERT_EQ(to_label.emplace(want, label).first->second, label);
+      ASSERT_EQ(from_label.emplace(label, want).first->second, want);
+    }
+  }
+}
+
+// Checks Reachable against the reference search of the moves of GridAStar.
+void CheckReachable(GridConnectivity& connectivity, const test::TestGrid& grid,
+                    std::mt19937& generator) {
+  auto size = grid.size;
+  for (int i = 0; i != 4; ++i) {
+    auto start = test::RandomCell(size, generator);
+    auto costs = test::ShortestCosts(size, grid, start);
+    for (int j = 0; j != 30; ++j) {
+      auto goal = test::RandomCell(size, generator);
+      auto reachable =
+          start == goal ||
+          (grid(goal.x, goal.y) &&
+           costs[CellIndex(size, goal.x, goal.y)] != test::kUnreachable);
+      EXPECT_EQ(connectivity.Reachable(start, goal), reachable);
+      EXPECT_EQ(connectivity.Connected(start, goal),
+                grid(start.x, start.y) && reachable && grid(goal.x, goal.y));
+    }
+  }
+}
+
+}  // namespace
+
+TEST(GridConnectivity, build_matches_breadth_first_search) {
+  auto generator = std::mt19937{61};
+  auto connectivity = GridConnectivity{};
+  for (auto [size, blocked_percent] :
+       {std::pair{glm::uvec2{30, 20}, 0}, std::pair{glm::uvec2{13, 27}, 30},
+        std::pair{glm::uvec2{40, 40}, 45}}) {
+    auto grid = test::TestGrid{size, blocked_percent, generator()};
+    connectivity.Build(size, grid);
+    CheckLabels(connectivity, grid);
+    CheckReachable(connectivity, grid, generator);
+  }
+}
+
+TEST(GridConnectivity, updated_cells_match_breadth_first_search) {
+  auto size = glm::uvec2{32, 24};
+  // near the threshold where the passable cells stop spanning the grid, so
+  // changes often split and merge components
+  auto grid = test::TestGrid{size, 40, 67};
+  auto generator = std::mt19937{71};
+  auto connectivity = GridConnectivity{};
+  connectivity.Build(size, grid);
+  for (int round = 0; round != 60; ++round) {
+    for (int i = 0; i != 10; ++i) {
+      auto cell = test::RandomCell(size, generator);
+      grid.Set(cell, !grid(cell.x, cell.y));
+      connectivity.UpdateCell(grid, cell);
+    }
+    CheckLabels(connectivity, grid);
+    CheckReachable(connectivity, grid, generator);
+  }
+}
+
+TEST(GridConnectivity, blocking_a_bridge_splits_a_component) {
+  auto size = glm::uvec2{9, 5};
+  auto grid = test::TestGrid{size, 0, 1};
+  for (std::uint32_t y = 0; y != size.y; ++y) {
+    if (y != 2) grid.Set({4, y}, false);
+  }
+  auto connectivity = GridConnectivity{};
+  connectivity.Build(size, grid);
+  EXPECT_EQ(connectivity.ComponentCount(), 1);
+  EXPECT_TRUE(connectivity.Connected({0, 0}, {8, 4}));
+
+  grid.Set({4, 2}, false);
+  connectivity.UpdateCell(grid, {4, 2});
+  EXPECT_EQ(connectivity.ComponentCount(), 2);
+  EXPECT_FALSE(connectivity.Connected({0, 0}, {8, 4}));
+  // a blocked start steps out to either side
+  EXPECT_TRUE(connectivity.Reachable({4, 2}, {8, 4}));
+  EXPECT_TRUE(connectivity.Reachable({4, 2}, {0, 0}));
+
+  grid.Set({4, 2}, true);
+  connectivity.UpdateCell(grid, {4, 2});
+  EXPECT_EQ(connectivity.ComponentCount(), 1);
+  EXPECT_TRUE(connectivity.Connected({0, 0}, {8, 4}));
+}
+
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,120 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/grid_dstar_lite.h"
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/test_grid.h"
+
+namespace einu {
+namespace ai {
+
+namespace {
+
+// Checks the last plan of planner against the reference search on grid.
+void CheckPlan(const GridDStarLite& planner, bool reachable,
+               const test::TestGrid& grid) {
+  auto start = planner.GetStart();
+  auto goal = planner.GetGoal();
+  auto shortest = test::ShortestCost(grid.size, grid, start, goal);
+  ASSERT_EQ(reachable, shortest != test::kUnreachable);
+  auto path = std::vector<glm::uvec2>{};
+  ASSERT_EQ(planner.GetPath(grid, path), reachable);
+  if (!reachable) {
+    EXPECT_EQ(planner.GetCost(), GridDStarLite::kUnreached);
+    return;
+  }
+  EXPECT_NEAR(planner.GetCost(), shortest, 1e-3f);
+  auto cost = test::PathCost(grid.size, grid, start, goal, path);
+  ASSERT_TRUE(cost.has_value());
+  EXPECT_NEAR(*cost, shortest, 1e-3f);
+}
+
+}  // namespace
+
+TEST(GridDStarLite, first_plan_matches_dijkstra) {
+  auto generator = std::mt19937{47};
+  auto planner = GridDStarLite{};
+  for (auto [size, blocked_percent] :
+       {std::pair{glm::uvec2{30, 20}, 0}, std::pair{glm::uvec2{13, 27}, 25},
+        std::pair{glm::uvec2{32, 32}, 40}}) {
+    auto grid = test::TestGrid{size, blocked_percent, generator()};
+    for (int i = 0; i != 20; ++i) {
+      auto start = test::RandomCell(size, generator);
+      auto goal = test::RandomCell(size, generator);
+      grid.Set(goal, true);
+      planner.Reset(size, start, goal);
+      CheckPlan(planner, planner.Plan(grid), grid);
+    }
+  }
+}
+
+TEST(GridDStarLite, replans_match_dijkstra_as_the_map_changes) {
+  auto size = glm::uvec2{40, 30};
+  auto grid = test::TestGrid{size, 25, 53};
+  auto generator = std::mt19937{59};
+  auto planner = GridDStarLite{};
+  auto path = std::vector<glm::uvec2>{};
+  for (int agent = 0; agent != 4; ++agent) {
+    auto goal = test::RandomCell(size, generator);
+    grid.Set(goal, true);
+    planner.Reset(size, test::RandomCell(size, generator), goal);
+    CheckPlan(planner, planner.Plan(grid), grid);
+    for (int round = 0; round != 25; ++round) {
+      // the agent walks a few cells along its path
+      if (planner.GetPath(grid, path)) {
+        for (int i = 0; i != 3 && !path.empty(); ++i) {
+          planner.MoveStart(path.back());
+          path.pop_back();
+        }
+      }
+      for (int i = 0; i != 6; ++i) {
+        auto cell = test::RandomCell(size, generator);
+        if (cell == goal) continue;
+        grid.Set(cell, !grid(cell.x, cell.y));
+        planner.UpdateCell(grid, cell);
+      }
+      CheckPlan(planner, planner.Plan(grid), grid);
+    }
+  }
+}
+
+TEST(GridDStarLite, walled_off_goal_is_unreached) {
+  auto size = glm::uvec2{10, 10};
+  auto grid = test::TestGrid{size, 0, 1};
+  auto planner = GridDStarLite{};
+  planner.Reset(size, {0, 0}, {9, 9});
+  ASSERT_TRUE(planner.Plan(grid));
+  for (std::uint32_t i = 0; i != 10; ++i) {
+    grid.Set({i, 5}, false);
+    planner.UpdateCell(grid, {i, 5});
+  }
+  EXPECT_FALSE(planner.Plan(grid));
+  CheckPlan(planner, false, grid);
+
+  grid.Set({4, 5}, true);
+  planner.UpdateCell(grid, {4, 5});
+  EXPECT_TRUE(planner.Plan(grid));
+  CheckPlan(planner, true, grid);
+}
+
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,121 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/grid_hpa.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/test_grid.h"
+
+namespace einu {
+namespace ai {
+
+namespace {
+
+// Checks the paths of hpa between random cells of grid against the
+// reference search. Returns the worst ratio of a path to the shortest.
+float CheckPaths(GridHPA& hpa, const test::TestGrid& grid,
+                 std::mt19937& generator, int query_count) {
+  auto worst = 1.f;
+  auto path = std::vector<glm::uvec2>{};
+  for (int i = 0; i != query_count; ++i) {
+    auto start = test::RandomCell(grid.size, generator);
+    auto goal = test::RandomCell(grid.size, generator);
+    auto shortest = test::ShortestCost(grid.size, grid, start, goal);
+    auto reachable = grid(start.x, start.y) && grid(goal.x, goal.y) &&
+                     shortest != test::kUnreachable;
+
+    EXPECT_EQ(hpa.FindPath(grid, start, goal, path), reachable);
+    if (!reachable || start == goal) {
+      EXPECT_TRUE(path.empty());
+      continue;
+    }
+    auto cost = test::PathCost(grid.size, grid, start, goal, path);
+    EXPECT_TRUE(cost.has_value());
+    if (!cost) continue;
+    EXPECT_GE(*cost, shortest - 1e-3f);
+    worst = std::max(worst, *cost / shortest);
+  }
+  return worst;
+}
+
+}  // namespace
+
+TEST(GridHPA, finds_a_path_exactly_where_dijkstra_does) {
+  auto generator = std::mt19937{23};
+  for (auto [size, blocked_percent] :
+       {std::pair{glm::uvec2{70, 45}, 0}, std::pair{glm::uvec2{64, 64}, 20},
+        std::pair{glm::uvec2{37, 53}, 35}, std::pair{glm::uvec2{5, 3}, 10}}) {
+    auto grid = test::TestGrid{size, blocked_percent, generator()};
+    auto hpa = GridHPA{8};
+    hpa.Build(size, grid);
+    // near-optimal: the detours through the transitions stay small
+    EXPECT_LT(CheckPaths(hpa, grid, generator, 60), 1.3f);
+  }
+}
+
+TEST(GridHPA, updated_cells_match_a_rebuild) {
+  auto size = glm::uvec2{60, 44};
+  auto grid = test::TestGrid{size, 25, 29};
+  auto generator = std::mt19937{31};
+  auto hpa = GridHPA{8};
+  hpa.Build(size, grid);
+  for (int round = 0; round != 10; ++round) {
+    for (int i = 0; i != 15; ++i) {
+      auto cell = test::RandomCell(size, generator);
+      grid.Set(cell, !grid(cell.x, cell.y));
+      hpa.UpdateCell(grid, cell);
+    }
+    auto rebuilt = GridHPA{8};
+    rebuilt.Build(size, grid);
+    EXPECT_EQ(hpa.NodeCount(), rebuilt.NodeCount());
+    EXPECT_EQ(hpa.EdgeCount(), rebuilt.EdgeCount());
+    CheckPaths(hpa, grid, generator, 20);
+  }
+}
+
+TEST(GridHPA, blocked_start_has_no_path) {
+  auto size = glm::uvec2{16, 16};
+  auto grid = test::TestGrid{size, 0, 1};
+  grid.Set({2, 2}, false);
+  auto hpa = GridHPA{4};
+  hpa.Build(size, grid);
+  auto path = std::vector<glm::uvec2>{};
+  EXPECT_FALSE(hpa.FindPath(grid, {2, 2}, {12, 12}, path));
+  EXPECT_FALSE(hpa.FindPath(grid, {12, 12}, {2, 2}, path));
+}
+
+TEST(GridHPA, leaves_a_cluster_to_reach_a_goal_inside_it) {
+  // the wall splits the top left cluster; its halves meet in the one below
+  auto size = glm::uvec2{16, 16};
+  auto grid = test::TestGrid{size, 0, 1};
+  for (std::uint32_t y = 0; y != 8; ++y) grid.Set({4, y}, false);
+  auto hpa = GridHPA{8};
+  hpa.Build(size, grid);
+  auto path = std::vector<glm::uvec2>{};
+  ASSERT_TRUE(hpa.FindPath(grid, {1, 1}, {6, 1}, path));
+  auto cost = test::PathCost(size, grid, {1, 1}, {6, 1}, path);
+  ASSERT_TRUE(cost.has_value());
+  EXPECT_GE(*cost, test::ShortestCost(size, grid, {1, 1}, {6, 1}) - 1e-3f);
+}
+
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,91 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/grid_jps.h"
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/test_grid.h"
+
+namespace einu {
+namespace ai {
+
+TEST(GridJPS, finds_shortest_paths_on_random_grids) {
+  auto jps = GridJPS{};
+  auto generator = std::mt19937{17};
+  auto path = std::vector<glm::uvec2>{};
+  for (auto [size, blocked_percent] :
+       {std::pair{glm::uvec2{40, 25}, 0}, std::pair{glm::uvec2{17, 31}, 10},
+        std::pair{glm::uvec2{48, 48}, 30}, std::pair{glm::uvec2{9, 5}, 45}}) {
+    auto grid = test::TestGrid{size, blocked_percent, generator()};
+    for (int i = 0; i != 40; ++i) {
+      auto start = test::RandomCell(size, generator);
+      auto goal = test::RandomCell(size, generator);
+      auto shortest = test::ShortestCost(size, grid, start, goal);
+      auto reachable = grid(goal.x, goal.y) && shortest != test::kUnreachable;
+
+      ASSERT_EQ(jps.FindPath(size, grid, start, goal, path), reachable);
+      if (!reachable) {
+        EXPECT_TRUE(path.empty());
+        continue;
+      }
+      // the cells between jump points are filled in
+      auto cost = test::PathCost(size, grid, start, goal, path);
+      ASSERT_TRUE(cost.has_value());
+      EXPECT_NEAR(*cost, shortest, 1e-3f);
+    }
+  }
+}
+
+TEST(GridJPS, stepping_finds_the_path_of_a_full_search) {
+  auto size = glm::uvec2{32, 32};
+  auto grid = test::TestGrid{size, 25, 3};
+  auto generator = std::mt19937{5};
+  auto full = GridJPS{};
+  auto stepped = GridJPS{};
+  auto full_path = std::vector<glm::uvec2>{};
+  auto stepped_path = std::vector<glm::uvec2>{};
+  for (int i = 0; i != 20; ++i) {
+    auto start = test::RandomCell(size, generator);
+    auto goal = test::RandomCell(size, generator);
+    auto found = full.FindPath(size, grid, start, goal, full_path);
+
+    stepped.Start(size, start, goal);
+    auto status = SearchStatus::Searching;
+    while ((status = stepped.Step(grid, 3)) == SearchStatus::Searching) {
+    }
+    EXPECT_EQ(status, found ? SearchStatus::Found : SearchStatus::NoPath);
+    stepped.GetPath(stepped_path);
+    EXPECT_EQ(stepped_path, full_path);
+  }
+}
+
+TEST(GridJPS, expands_fewer_cells_than_astar_on_open_ground) {
+  auto size = glm::uvec2{64, 64};
+  auto grid = test::TestGrid{size, 0, 1};
+  auto jps = GridJPS{};
+  auto path = std::vector<glm::uvec2>{};
+  ASSERT_TRUE(jps.FindPath(size, grid, {0, 5}, {63, 40}, path));
+  EXPECT_EQ(path.size(), 63);
+  EXPECT_LT(jps.GetStats().expanded, 8);
+}
+
+}  // namespace ai
+}  // namespace einu
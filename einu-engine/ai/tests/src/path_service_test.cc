@@ -0,0 +1,154 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/ai/path_service.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "einu-engine/core/job_system.h"
+#include "gtest/gtest.h"
+#include "src/test_grid.h"
+
+namespace einu {
+namespace ai {
+
+struct PathServiceTest : public testing::Test {
+  const glm::uvec2 size{36, 28};
+
+  PathServiceTest() { service.SetGrid(snapshot); }
+
+  // Runs the searches requested so far and delivers every result.
+  std::vector<PathRequest> Finish() {
+    service.Schedule();
+    jobs.RunReady();
+    auto delivered = std::vector<PathRequest>{};
+    service.Deliver(GridAStar::kUnlimited, [&](const PathResult& result) {
+      delivered.push_back({result.agent, result.start, result.goal});
+      CheckResult(result);
+    });
+    return delivered;
+  }
+
+  void CheckResult(const PathResult& result) {
+    auto shortest = test::ShortestCost(size, grid, result.start, result.goal);
+    auto reachable =
+        grid(result.goal.x, result.goal.y) && shortest != test::kUnreachable;
+    ASSERT_EQ(result.found, reachable);
+    if (!reachable) return;
+    auto cost =
+        test::PathCost(size, grid, result.start, result.goal, result.path);
+    ASSERT_TRUE(cost.has_value());
+    EXPECT_NEAR(*cost, shortest, 1e-3f);
+  }
+
+  test::TestGrid grid{size, 35, 9};
+  std::shared_ptr<const GridSnapshot> snapshot =
+      std::make_shared<GridSnapshot>(size, grid);
+  JobSystem jobs{0};
+  PathService service{jobs};
+};
+
+TEST_F(PathServiceTest, delivers_shortest_paths_or_none) {
+  auto generator = std::mt19937{13};
+  for (EID agent = 0; agent != 64; ++agent) {
+    service.Request({agent, test::RandomCell(size, generator),
+                     test::RandomCell(size, generator)});
+  }
+  EXPECT_EQ(Finish().size(), 64);
+  EXPECT_EQ(service.ReadyCount(), 0);
+
+  const auto& stats = service.GetStats();
+  EXPECT_EQ(stats.requested, 64);
+  EXPECT_EQ(stats.delivered, 64);
+  // the maze splits into pieces, so some goals are out of reach
+  EXPECT_GT(stats.rejected, 0);
+  EXPECT_EQ(stats.rejected + stats.searched + stats.shared, 64);
+}
+
+TEST_F(PathServiceTest, same_requests_share_a_search) {
+  auto start = glm::uvec2{};
+  auto goal = glm::uvec2{};
+  auto generator = std::mt19937{2};
+  do {
+    start = test::RandomCell(size, generator);
+    goal = test::RandomCell(size, generator);
+  } while (start == goal || !grid(goal.x, goal.y) ||
+           test::ShortestCost(size, grid, start, goal) == test::kUnreachable);
+
+  for (EID agent = 0; agent != 3; ++agent) {
+    service.Request({agent, start, goal});
+  }
+  EXPECT_EQ(Finish().size(), 3);
+  EXPECT_EQ(service.GetStats().searched, 1);
+  EXPECT_EQ(service.GetStats().shared, 2);
+}
+
+TEST_F(PathServiceTest, newer_request_supersedes_the_older) {
+  service.Request({7, {0, 0}, {1, 0}});
+  service.Request({7, {0, 0}, {0, 1}});
+  auto delivered = Finish();
+  ASSERT_EQ(delivered.size(), 1);
+  EXPECT_EQ(delivered[0].goal, (glm::uvec2{0, 1}));
+  EXPECT_EQ(service.GetStats().dropped, 1);
+  EXPECT_FALSE(service.IsPending(7));
+}
+
+TEST_F(PathServiceTest, cancelled_request_is_not_delivered) {
+  service.Request({3, {0, 0}, {5, 5}});
+  EXPECT_TRUE(service.IsPending(3));
+  service.Cancel(3);
+  EXPECT_FALSE(service.IsPending(3));
+  EXPECT_TRUE(Finish().empty());
+}
+
+TEST_F(PathServiceTest, delivers_within_the_budget) {
+  for (EID agent = 0; agent != 5; ++agent) {
+    service.Request({agent, {agent, 0}, {0, agent}});
+  }
+  service.Schedule();
+  jobs.RunReady();
+  auto delivered = 0;
+  EXPECT_EQ(service.Deliver(2, [&](const PathResult&) { ++delivered; }), 2);
+  EXPECT_EQ(delivered, 2);
+  EXPECT_EQ(service.ReadyCount(), 3);
+  EXPECT_EQ(Finish().size(), 3);
+}
+
+TEST_F(PathServiceTest, searches_keep_the_grid_they_were_requested_on) {
+  auto open = test::TestGrid{size, 0, 1};
+  auto corner = glm::uvec2{size.x - 1, size.y - 1};
+  service.SetGrid(std::make_shared<GridSnapshot>(size, open));
+  service.Request({1, {0, 0}, corner});
+  service.Schedule();
+  service.SetGrid(snapshot);
+
+  jobs.RunReady();
+  auto path = std::vector<glm::uvec2>{};
+  service.Deliver(1, [&](const PathResult& result) {
+    EXPECT_TRUE(result.found);
+    path = result.path;
+  });
+  auto cost = test::PathCost(size, open, {0, 0}, corner, path);
+  ASSERT_TRUE(cost.has_value());
+  EXPECT_NEAR(*cost, OctileDistance({0, 0}, corner), 1e-3f);
+}
+
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,133 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "einu-engine/ai/grid_search.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace ai {
+namespace test {
+
+inline constexpr float kUnreachable = std::numeric_limits<float>::infinity();
+
+// A grid with a share of its cells blocked at random.
+struct TestGrid {
+  TestGrid(glm::uvec2 size, int blocked_percent,
+           std::mt19937::result_type seed)
+      : size{size}, blocked(std::size_t{size.x} * size.y) {
+    auto generator = std::mt19937{seed};
+    auto distribution = std::uniform_int_distribution<int>{0, 99};
+    for (auto& cell : blocked) {
+      cell = distribution(generator) < blocked_percent;
+    }
+  }
+
+  bool operator()(std::uint32_t x, std::uint32_t y) const noexcept {
+    return !blocked[std::size_t{y} * size.x + x];
+  }
+
+  void Set(glm::uvec2 cell, bool passable) {
+    blocked[std::size_t{cell.y} * size.x + cell.x] = !passable;
+  }
+
+  glm::uvec2 size;
+  std::vector<std::uint8_t> blocked;
+};
+
+inline glm::uvec2 RandomCell(glm::uvec2 size, std::mt19937& generator) {
+  auto x = std::uniform_int_distribution<std::uint32_t>{0, size.x - 1};
+  auto y = std::uniform_int_distribution<std::uint32_t>{0, size.y - 1};
+  // braced initializers run in order, so the cells are the same everywhere
+  return glm::uvec2{x(generator), y(generator)};
+}
+
+// The cost of a shortest path from start to every cell, by a plain Dijkstra
+// search over the moves of CanStep; kUnreachable where there is none.
+template <typename Passable>
+std::vector<float> ShortestCosts(glm::uvec2 size, const Passable& passable,
+                                 glm::uvec2 start) {
+  auto costs = std::vector<float>(std::size_t{size.x} * size.y, kUnreachable);
+  using Entry = std::pair<float, std::uint32_t>;
+  auto open =
+      std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>{};
+  costs[CellIndex(size, start.x, start.y)] = 0;
+  open.push({0.f, CellIndex(size, start.x, start.y)});
+  while (!open.empty()) {
+    auto [cost, current] = open.top();
+    open.pop();
+    if (cost != costs[current]) continue;
+    auto x = current % size.x;
+    auto y = current / size.x;
+    for (const auto& step : kGridSteps) {
+      if (!CanStep(size, passable, x, y, step.dx, step.dy)) continue;
+      auto next = CellIndex(size, x + step.dx, y + step.dy);
+      if (cost + step.cost < costs[next]) {
+        costs[next] = cost + step.cost;
+        open.push({costs[next], next});
+      }
+    }
+  }
+  return costs;
+}
+
+template <typename Passable>
+float ShortestCost(glm::uvec2 size, const Passable& passable, glm::uvec2 start,
+                   glm::uvec2 goal) {
+  return ShortestCosts(size, passable, start)[CellIndex(size, goal.x, goal.y)];
+}
+
+// The cost of a path from start given as the searches return it, from the
+// goal back to the first cell after start; nullopt unless every step is one
+// CanStep allows and the path ends on goal.
+template <typename Passable>
+std::optional<float> PathCost(glm::uvec2 size, const Passable& passable,
+                              glm::uvec2 start, glm::uvec2 goal,
+                              const std::vector<glm::uvec2>& path) {
+  auto cost = 0.f;
+  auto current = start;
+  for (auto it = path.rbegin(); it != path.rend(); ++it) {
+    auto dx = static_cast<int>(it->x) - static_cast<int>(current.x);
+    auto dy = static_cast<int>(it->y) - static_cast<int>(current.y);
+    if (dx < -1 || dx > 1 || dy < -1 || dy > 1 || (dx == 0 && dy == 0)) {
+      return std::nullopt;
+    }
+    if (!CanStep(size, passable, current.x, current.y, dx, dy)) {
+      return std::nullopt;
+    }
+    cost += dx == 0 || dy == 0 ? 1.f : kDiagonalCost;
+    current = *it;
+  }
+  if (current != goal) return std::nullopt;
+  return cost;
+}
+
+}  // namespace test
+}  // namespace ai
+}  // namespace einu
@@ -0,0 +1,169 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/common/cell_pyramid.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "einu-engine/common/point_query.h"
+#include "einu-engine/common/spatial_index.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace bench {
+
+// The loop-of-life world and grid: cells of 8 x 8.
+const glm::uvec2 kPyramidGridSize = {160, 90};
+constexpr float kPyramidCellSize = 8.f;
+
+// Grass and sheep 5 : 1, as loop-of-life starts out, and its 5 wolves however
+// much the rest grow.
+constexpr std::uint32_t kGrass = 1u << 0;
+constexpr std::uint32_t kSheep = 1u << 1;
+constexpr std::uint32_t kWolf = 1u << 2;
+
+struct PyramidAgent {
+  std::uint32_t type;
+  glm::vec2 pos;
+};
+
+// The agents in an index, their types counted in a pyramid, and their columns
+// in the order of the index.
+struct PyramidWorld {
+  explicit PyramidWorld(std::size_t count)
+      : index{kPyramidGridSize}, pyramid{kPyramidGridSize} {
+    auto generator = std::mt19937{7};
+    auto x_dist = std::uniform_real_distribution<float>{
+        0.f, kPyramidGridSize.x * kPyramidCellSize};
+    auto y_dist = std::uniform_real_distribution<float>{
+        0.f, kPyramidGridSize.y * kPyramidCellSize};
+    auto entries = std::vector<SpatialIndex<PyramidAgent>::Entry>{};
+    for (std::uint32_t i = 0; i != count; ++i) {
+      auto type = i < 5 ? kWolf : generator() % 6 == 0 ? kSheep : kGrass;
+      auto pos = glm::vec2{x_dist(generator), y_dist(generator)};
+      auto cell = GetCell(pos);
+      entries.push_back({i, cell, {type, pos}});
+      pyramid.Add(cell, type);
+    }
+    index.Assign(entries);
+    for (const auto& agent : index.GetItems()) {
+      xs.push_back(agent.pos.x);
+      ys.push_back(agent.pos.y);
+      types.push_back(agent.type);
+    }
+  }
+
+  static glm::uvec2 GetCell(glm::vec2 pos) {
+    auto cell = glm::uvec2(pos / kPyramidCellSize);
+    return glm::min(cell, kPyramidGridSize - glm::uvec2{1, 1});
+  }
+
+  SpatialIndex<PyramidAgent> index;
+  CellPyramid<> pyramid;
+  std::vector<float> xs;
+  std::vector<float> ys;
+  std::vector<std::uint32_t> types;
+};
+
+// range(1) picks a sense: 0 is a herder looking for wolves over the whole
+// world, 1 is a wolf looking for sheep within 200.
+struct PyramidSense {
+  explicit PyramidSense(std::int64_t sense)
+      : radius{sense == 0 ? 1000.f : 200.f},
+        types{sense == 0 ? kWolf : kSheep} {}
+
+  glm::vec2 center = {640.f, 360.f};
+  float radius;
+  std::uint32_t types;
+
+  glm::uvec2 GetMin() const {
+    return PyramidWorld::GetCell(
+        glm::max(center - glm::vec2{radius, radius}, glm::vec2{0.f, 0.f}));
+  }
+  glm::uvec2 GetMax() const {
+    return PyramidWorld::GetCell(center + glm::vec2{radius, radius});
+  }
+};
+
+void PyramidArgs(benchmark::internal::Benchmark* b) {
+  b->ArgsProduct({{600, 6000, 60000}, {0, 1}});
+}
+
+// Senses every row of the box, as loop-of-life did.
+void BM_SenseByRows(benchmark::State& state) {
+  auto world = PyramidWorld{static_cast<std::size_t>(state.range(0))};
+  auto sense = PyramidSense{state.range(1)};
+  auto found = std::vector<std::uint32_t>(world.xs.size());
+  const auto* first_agent = world.index.GetItems().begin();
+  for (auto _ : state) {
+    auto count = std::size_t{0};
+    world.index.ForEachRow(sense.GetMin(), sense.GetMax(), [&](auto row) {
+      auto first = static_cast<std::size_t>(row.begin() - first_agent);
+      count += FindInRadius(world.xs.data() + first, world.ys.data() + first,
+                            world.types.data() + first, row.size(),
+                            sense.center, sense.radius, sense.types,
+                            found.data());
+    });
+    benchmark::DoNotOptimize(count);
+  }
+}
+BENCHMARK(BM_SenseByRows)->Apply(PyramidArgs);
+
+// Senses only the runs of cells the pyramid hands out.
+void BM_SenseByPyramid(benchmark::State& state) {
+  auto world = PyramidWorld{static_cast<std::size_t>(state.range(0))};
+  auto sense = PyramidSense{state.range(1)};
+  auto found = std::vector<std::uint32_t>(world.xs.size());
+  const auto* first_agent = world.index.GetItems().begin();
+  for (auto _ : state) {
+    auto count = std::size_t{0};
+    world.pyramid.ForEachRow(
+        sense.GetMin(), sense.GetMax(), sense.types,
+        [&](std::uint32_t y, std::uint32_t x_begin, std::uint32_t x_end) {
+          auto row = world.index.GetRow(y, x_begin, x_end);
+          auto first = static_cast<std::size_t>(row.begin() - first_agent);
+          count += FindInRadius(
+              world.xs.data() + first, world.ys.data() + first,
+              world.types.data() + first, row.size(), sense.center,
+              sense.radius, sense.types, found.data());
+        });
+    benchmark::DoNotOptimize(count);
+  }
+}
+BENCHMARK(BM_SenseByPyramid)->Apply(PyramidArgs);
+
+// What keeping the pyramid up to date costs an agent stepping into the next
+// cell.
+void BM_CellPyramidMove(benchmark::State& state) {
+  auto pyramid = CellPyramid<>{kPyramidGridSize};
+  auto cell = glm::uvec2{0, 45};
+  pyramid.Add(cell, kSheep);
+  for (auto _ : state) {
+    auto next = glm::uvec2{(cell.x + 1) % kPyramidGridSize.x, cell.y};
+    pyramid.Move(cell, next, kSheep);
+    cell = next;
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_CellPyramidMove);
+
+}  // namespace bench
+}  // namespace einu
@@ -0,0 +1,158 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/common/grid.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace bench {
+
+// About the size of a cell that holds a few agents' worth of data.
+struct BenchCell {
+  float value[4];
+};
+
+template <typename Layout>
+Grid<BenchCell, Layout> MakeGrid(std::uint32_t side) {
+  auto grid = Grid<BenchCell, Layout>{{side, side}};
+  float value = 0;
+  for (auto& cell : grid) {
+    cell.value[0] = value++;
+  }
+  return grid;
+}
+
+// Corners of random boxes that fit in the grid.
+std::vector<glm::uvec2> BoxCorners(std::uint32_t side, std::uint32_t box_side) {
+  auto generator = std::mt19937{7};
+  auto distribution =
+      std::uniform_int_distribution<std::uint32_t>{0, side - box_side};
+  auto corners = std::vector<glm::uvec2>(4096);
+  for (auto& corner : corners) {
+    corner = {distribution(generator), distribution(generator)};
+  }
+  return corners;
+}
+
+void BoxArgs(benchmark::internal::Benchmark* b) {
+  for (int side : {1024, 4096}) {
+    // 3 is the neighbourhood of a cell
+    for (int box_side : {3, 16}) {
+      b->Args({side, box_side});
+    }
+  }
+}
+
+template <typename Layout>
+void BM_GridBoxQuery(benchmark::State& state) {
+  auto side = static_cast<std::uint32_t>(state.range(0));
+  auto box_side = static_cast<std::uint32_t>(state.range(1));
+  auto grid = MakeGrid<Layout>(side);
+  auto corners = BoxCorners(side, box_side);
+  for (auto _ : state) {
+    float sum = 0;
+    for (auto corner : corners) {
+      for (std::uint32_t y = 0; y != box_side; ++y) {
+        for (std::uint32_t x = 0; x != box_side; ++x) {
+          sum += grid.At(corner.x + x, corner.y + y).value[0];
+        }
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * corners.size());
+}
+BENCHMARK_TEMPLATE(BM_GridBoxQuery, RowMajorLayout)->Apply(BoxArgs);
+BENCHMARK_TEMPLATE(BM_GridBoxQuery, TiledLayout<>)->Apply(BoxArgs);
+BENCHMARK_TEMPLATE(BM_GridBoxQuery, MortonLayout<>)->Apply(BoxArgs);
+
+template <typename Layout>
+void BM_GridGetCells(benchmark::State& state) {
+  auto side = static_cast<std::uint32_t>(state.range(0));
+  auto box_side = static_cast<std::uint32_t>(state.range(1));
+  auto grid = MakeGrid<Layout>(side);
+  auto corners = BoxCorners(side, box_side);
+  auto cells = std::vector<const BenchCell*>(box_side * box_side);
+  for (auto _ : state) {
+    float sum = 0;
+    for (auto corner : corners) {
+      grid.GetCells(corner.x, corner.y, box_side, box_side, cells.data());
+      for (auto cell : cells) {
+        sum += cell->value[0];
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * corners.size());
+}
+BENCHMARK_TEMPLATE(BM_GridGetCells, RowMajorLayout)->Apply(BoxArgs);
+BENCHMARK_TEMPLATE(BM_GridGetCells, TiledLayout<>)->Apply(BoxArgs);
+BENCHMARK_TEMPLATE(BM_GridGetCells, MortonLayout<>)->Apply(BoxArgs);
+
+// Reads the neighbours of every cell along a random walk, the way a search
+// expanding a frontier does.
+template <typename Layout>
+void BM_GridNeighbourWalk(benchmark::State& state) {
+  auto side = static_cast<std::uint32_t>(state.range(0));
+  auto grid = MakeGrid<Layout>(side);
+  auto generator = std::mt19937{7};
+  auto step = std::uniform_int_distribution<int>{0, 3};
+  auto walk = std::vector<glm::uvec2>(1 << 16);
+  auto pos = glm::uvec2{side / 2, side / 2};
+  for (auto& cell : walk) {
+    switch (step(generator)) {
+      case 0:
+        pos.x = pos.x + 1 < side - 1 ? pos.x + 1 : pos.x;
+        break;
+      case 1:
+        pos.x = pos.x > 1 ? pos.x - 1 : pos.x;
+        break;
+      case 2:
+        pos.y = pos.y + 1 < side - 1 ? pos.y + 1 : pos.y;
+        break;
+      default:
+        pos.y = pos.y > 1 ? pos.y - 1 : pos.y;
+        break;
+    }
+    cell = pos;
+  }
+  for (auto _ : state) {
+    float sum = 0;
+    for (auto cell : walk) {
+      for (std::uint32_t y = cell.y - 1; y != cell.y + 2; ++y) {
+        for (std::uint32_t x = cell.x - 1; x != cell.x + 2; ++x) {
+          sum += grid.At(x, y).value[0];
+        }
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * walk.size());
+}
+BENCHMARK_TEMPLATE(BM_GridNeighbourWalk, RowMajorLayout)->Arg(1024)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_GridNeighbourWalk, TiledLayout<>)->Arg(1024)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_GridNeighbourWalk, MortonLayout<>)->Arg(1024)->Arg(4096);
+
+}  // namespace bench
+}  // namespace einu
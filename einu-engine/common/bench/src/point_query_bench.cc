@@ -0,0 +1,142 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/common/point_query.h"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace bench {
+
+// A loop-of-life agent as the world state kept it before the columns.
+struct QueryAgent {
+  std::uint32_t type;
+  glm::vec2 pos;
+  std::uint32_t eid;
+};
+
+// Agents of four types scattered over a 1280 x 720 world, in both layouts.
+struct QueryAgents {
+  explicit QueryAgents(std::size_t count) {
+    auto generator = std::mt19937{7};
+    auto x_dist = std::uniform_real_distribution<float>{0.f, 1280.f};
+    auto y_dist = std::uniform_real_distribution<float>{0.f, 720.f};
+    for (std::uint32_t i = 0; i != count; ++i) {
+      auto pos = glm::vec2{x_dist(generator), y_dist(generator)};
+      auto agent = QueryAgent{1u << (i % 4), pos, i};
+      agents.push_back(agent);
+      xs.push_back(agent.pos.x);
+      ys.push_back(agent.pos.y);
+      types.push_back(agent.type);
+    }
+  }
+
+  std::vector<QueryAgent> agents;
+  std::vector<float> xs;
+  std::vector<float> ys;
+  std::vector<std::uint32_t> types;
+};
+
+// Sensing two of the four types within 200 of the middle of the world.
+const glm::vec2 kQueryCenter = {640.f, 360.f};
+constexpr float kQueryRadius = 200.f;
+constexpr std::uint32_t kQueryTypes = 0b0110;
+
+void QueryArgs(benchmark::internal::Benchmark* b) {
+  b->Arg(64)->Arg(1024)->Arg(16384);
+}
+
+// The old sense loop: one agent at a time, straight from the agents.
+void BM_RadiusPerAgent(benchmark::State& state) {
+  auto agents = QueryAgents{static_cast<std::size_t>(state.range(0))};
+  auto found = std::vector<QueryAgent>{};
+  for (auto _ : state) {
+    found.clear();
+    for (const auto& agent : agents.agents) {
+      if ((agent.type & kQueryTypes) == agent.type &&
+          glm::dot(agent.pos - kQueryCenter, agent.pos - kQueryCenter) <
+              kQueryRadius * kQueryRadius) {
+        found.push_back(agent);
+      }
+    }
+    benchmark::DoNotOptimize(found.data());
+  }
+  state.SetItemsProcessed(state.iterations() * agents.agents.size());
+}
+BENCHMARK(BM_RadiusPerAgent)->Apply(QueryArgs);
+
+void BM_FindInRadius(benchmark::State& state) {
+  auto agents = QueryAgents{static_cast<std::size_t>(state.range(0))};
+  auto found = std::vector<std::uint32_t>(agents.xs.size());
+  for (auto _ : state) {
+    auto count = FindInRadius(agents.xs.data(), agents.ys.data(),
+                              agents.types.data(), agents.xs.size(),
+                              kQueryCenter, kQueryRadius, kQueryTypes,
+                              found.data());
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * agents.xs.size());
+}
+BENCHMARK(BM_FindInRadius)->Apply(QueryArgs);
+
+// The old closest prey: one agent at a time, keeping the closest.
+void BM_NearestPerAgent(benchmark::State& state) {
+  auto agents = QueryAgents{static_cast<std::size_t>(state.range(0))};
+  for (auto _ : state) {
+    auto closest = QueryAgent{};
+    auto closest_distance2 = std::numeric_limits<float>::max();
+    for (const auto& agent : agents.agents) {
+      if ((agent.type & kQueryTypes) == agent.type) {
+        auto distance2 =
+            glm::dot(agent.pos - kQueryCenter, agent.pos - kQueryCenter);
+        if (distance2 < closest_distance2) {
+          closest = agent;
+          closest_distance2 = distance2;
+        }
+      }
+    }
+    benchmark::DoNotOptimize(closest);
+  }
+  state.SetItemsProcessed(state.iterations() * agents.agents.size());
+}
+BENCHMARK(BM_NearestPerAgent)->Apply(QueryArgs);
+
+void BM_FindNearest(benchmark::State& state) {
+  auto agents = QueryAgents{static_cast<std::size_t>(state.range(0))};
+  auto k = static_cast<std::size_t>(state.range(1));
+  auto found = std::vector<std::uint32_t>(k);
+  for (auto _ : state) {
+    auto count = FindNearest(agents.xs.data(), agents.ys.data(),
+                             agents.types.data(), agents.xs.size(),
+                             kQueryCenter,
+                             std::numeric_limits<float>::infinity(),
+                             kQueryTypes, k, found.data());
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * agents.xs.size());
+}
+BENCHMARK(BM_FindNearest)->ArgsProduct({{64, 1024, 16384}, {1, 8}});
+
+}  // namespace bench
+}  // namespace einu
@@ -0,0 +1,150 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/common/spatial_hash.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "einu-engine/common/grid.h"
+#include "einu-engine/core/job_system.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace bench {
+
+// What loop-of-life keeps of an agent.
+struct BenchAgent {
+  std::uint32_t type;
+  glm::vec2 pos;
+  std::uint32_t eid;
+};
+
+// The loop-of-life grid, with the agents scattered over it.
+const glm::uvec2 kHashSize = {160, 90};
+
+std::vector<glm::uvec2> AgentCells(std::size_t count) {
+  auto generator = std::mt19937{7};
+  auto cells = std::vector<glm::uvec2>(count);
+  for (auto& cell : cells) {
+    cell = {generator() % kHashSize.x, generator() % kHashSize.y};
+  }
+  return cells;
+}
+
+void AgentArgs(benchmark::internal::Benchmark* b) {
+  b->Arg(10000)->Arg(100000)->Arg(1000000);
+}
+
+// The old world state: a vector per cell, cleared and refilled.
+void BM_GridOfVectorsRebuild(benchmark::State& state) {
+  auto cells = AgentCells(static_cast<std::size_t>(state.range(0)));
+  auto grid = Grid<std::vector<BenchAgent>>{kHashSize};
+  for (auto _ : state) {
+    for (auto& cell : grid) cell.clear();
+    for (std::uint32_t i = 0; i != cells.size(); ++i) {
+      grid[cells[i].y][cells[i].x].push_back({1, glm::vec2(cells[i]), i});
+    }
+    benchmark::DoNotOptimize(grid.begin());
+  }
+  state.SetItemsProcessed(state.iterations() * cells.size());
+}
+BENCHMARK(BM_GridOfVectorsRebuild)->Apply(AgentArgs);
+
+void BM_SpatialHashRebuild(benchmark::State& state) {
+  auto cells = AgentCells(static_cast<std::size_t>(state.range(0)));
+  auto hash = SpatialHash<BenchAgent>{kHashSize};
+  for (auto _ : state) {
+    for (std::uint32_t i = 0; i != cells.size(); ++i) {
+      hash.Insert(cells[i], {1, glm::vec2(cells[i]), i});
+    }
+    hash.Build();
+    benchmark::DoNotOptimize(hash.GetItems().begin());
+  }
+  state.SetItemsProcessed(state.iterations() * cells.size());
+}
+BENCHMARK(BM_SpatialHashRebuild)->Apply(AgentArgs);
+
+void BM_SpatialHashRebuildJobs(benchmark::State& state) {
+  auto cells = AgentCells(static_cast<std::size_t>(state.range(0)));
+  auto hash = SpatialHash<BenchAgent>{kHashSize};
+  auto jobs = JobSystem{};
+  auto chunk_count = jobs.WorkerCount() + 1;
+  for (auto _ : state) {
+    for (std::uint32_t i = 0; i != cells.size(); ++i) {
+      hash.Insert(cells[i], {1, glm::vec2(cells[i]), i});
+    }
+    hash.Build(jobs, chunk_count);
+    benchmark::DoNotOptimize(hash.GetItems().begin());
+  }
+  state.SetItemsProcessed(state.iterations() * cells.size());
+}
+BENCHMARK(BM_SpatialHashRebuildJobs)->Apply(AgentArgs)->UseRealTime();
+
+// Every agent reads the agents of the 5 x 5 cells around it, as sensing does.
+void BM_GridOfVectorsBoxQuery(benchmark::State& state) {
+  auto cells = AgentCells(static_cast<std::size_t>(state.range(0)));
+  auto grid = Grid<std::vector<BenchAgent>>{kHashSize};
+  for (std::uint32_t i = 0; i != cells.size(); ++i) {
+    grid[cells[i].y][cells[i].x].push_back({1, glm::vec2(cells[i]), i});
+  }
+  for (auto _ : state) {
+    auto sum = 0u;
+    for (auto cell : cells) {
+      auto min = glm::max(cell, glm::uvec2{2, 2}) - glm::uvec2{2, 2};
+      auto max =
+          glm::min(cell + glm::uvec2{2, 2}, kHashSize - glm::uvec2{1, 1});
+      for (auto y = min.y; y <= max.y; ++y) {
+        for (auto x = min.x; x <= max.x; ++x) {
+          for (const auto& agent : grid[y][x]) sum += agent.type;
+        }
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * cells.size());
+}
+BENCHMARK(BM_GridOfVectorsBoxQuery)->Arg(10000)->Arg(100000);
+
+void BM_SpatialHashBoxQuery(benchmark::State& state) {
+  auto cells = AgentCells(static_cast<std::size_t>(state.range(0)));
+  auto hash = SpatialHash<BenchAgent>{kHashSize};
+  for (std::uint32_t i = 0; i != cells.size(); ++i) {
+    hash.Insert(cells[i], {1, glm::vec2(cells[i]), i});
+  }
+  hash.Build();
+  for (auto _ : state) {
+    auto sum = 0u;
+    for (auto cell : cells) {
+      auto min = glm::max(cell, glm::uvec2{2, 2}) - glm::uvec2{2, 2};
+      auto max =
+          glm::min(cell + glm::uvec2{2, 2}, kHashSize - glm::uvec2{1, 1});
+      hash.ForEachRow(min, max, [&sum](auto agents) {
+        for (const auto& agent : agents) sum += agent.type;
+      });
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * cells.size());
+}
+BENCHMARK(BM_SpatialHashBoxQuery)->Arg(10000)->Arg(100000);
+
+}  // namespace bench
+}  // namespace einu
@@ -0,0 +1,178 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/common/spatial_index.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "einu-engine/common/spatial_hash.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+namespace bench {
+
+struct IndexAgent {
+  std::uint32_t type;
+  glm::vec2 pos;
+  std::uint32_t eid;
+};
+
+// The loop-of-life grid, with positions in cells.
+const glm::uvec2 kIndexSize = {160, 90};
+
+// Agents scattered over the grid, of which the first mover_count walk
+// diagonally a twentieth of a cell a frame, like sheep among grass.
+class Population {
+ public:
+  Population(std::size_t count, std::size_t mover_count)
+      : positions_(count), mover_count_{mover_count} {
+    auto generator = std::mt19937{7};
+    auto dist = std::uniform_real_distribution<float>{0.f, 1.f};
+    for (auto& pos : positions_) {
+      pos = glm::vec2{dist(generator) * kIndexSize.x,
+                      dist(generator) * kIndexSize.y};
+    }
+  }
+
+  void Step() noexcept {
+    for (std::size_t i = 0; i != mover_count_; ++i) {
+      auto& pos = positions_[i];
+      pos += glm::vec2{0.04f, 0.03f};
+      if (pos.x >= kIndexSize.x) pos.x -= kIndexSize.x;
+      if (pos.y >= kIndexSize.y) pos.y -= kIndexSize.y;
+    }
+  }
+
+  glm::uvec2 GetCell(std::size_t i) const noexcept {
+    return glm::uvec2(positions_[i]);
+  }
+
+  IndexAgent GetAgent(std::size_t i) const noexcept {
+    return {1, positions_[i], static_cast<std::uint32_t>(i)};
+  }
+
+  SpatialIndex<IndexAgent> MakeIndex() const {
+    auto entries = std::vector<SpatialIndex<IndexAgent>::Entry>{};
+    entries.reserve(positions_.size());
+    for (std::size_t i = 0; i != positions_.size(); ++i) {
+      entries.push_back({static_cast<EID>(i), GetCell(i), GetAgent(i)});
+    }
+    auto index = SpatialIndex<IndexAgent>{kIndexSize};
+    index.Assign(entries);
+    return index;
+  }
+
+  std::size_t Size() const noexcept { return positions_.size(); }
+  std::size_t MoverCount() const noexcept { return mover_count_; }
+
+ private:
+  std::vector<glm::vec2> positions_;
+  std::size_t mover_count_;
+};
+
+// Agents and the percentage of them that move.
+void PopulationArgs(benchmark::internal::Benchmark* b) {
+  b->Args({10000, 10})->Args({100000, 1})->Args({100000, 10});
+}
+
+Population MakePopulation(const benchmark::State& state) {
+  auto count = static_cast<std::size_t>(state.range(0));
+  return Population{count, count * state.range(1) / 100};
+}
+
+// A frame of the rebuilt world state: every agent is inserted again.
+void BM_SpatialHashFrame(benchmark::State& state) {
+  auto population = MakePopulation(state);
+  auto hash = SpatialHash<IndexAgent>{kIndexSize};
+  for (auto _ : state) {
+    population.Step();
+    for (std::size_t i = 0; i != population.Size(); ++i) {
+      hash.Insert(population.GetCell(i), population.GetAgent(i));
+    }
+    hash.Build();
+    benchmark::DoNotOptimize(hash.GetItems().begin());
+  }
+  state.SetItemsProcessed(state.iterations() * population.Size());
+}
+BENCHMARK(BM_SpatialHashFrame)->Apply(PopulationArgs);
+
+// A frame of the incremental world state: only the movers are updated.
+void BM_SpatialIndexFrame(benchmark::State& state) {
+  auto population = MakePopulation(state);
+  auto index = population.MakeIndex();
+  for (auto _ : state) {
+    population.Step();
+    for (std::size_t i = 0; i != population.MoverCount(); ++i) {
+      index.Update(static_cast<EID>(i), population.GetCell(i),
+                   population.GetAgent(i));
+    }
+    benchmark::DoNotOptimize(index.GetItems().begin());
+  }
+  state.SetItemsProcessed(state.iterations() * population.Size());
+}
+BENCHMARK(BM_SpatialIndexFrame)->Apply(PopulationArgs);
+
+// A frame in which as many agents are born, each at a random cell, as the
+// oldest ones die.
+void BM_SpatialIndexInsertErase(benchmark::State& state) {
+  auto population = Population{static_cast<std::size_t>(state.range(0)), 0};
+  auto birth_count = static_cast<std::size_t>(state.range(1));
+  auto index = population.MakeIndex();
+  auto oldest = EID{0};
+  auto eid = static_cast<EID>(population.Size());
+  for (auto _ : state) {
+    for (std::size_t j = 0; j != birth_count; ++j, ++eid, ++oldest) {
+      auto i = eid % population.Size();
+      index.Insert(eid, population.GetCell(i), population.GetAgent(i));
+      index.Erase(oldest);
+    }
+    index.Flush();
+  }
+  state.SetItemsProcessed(state.iterations() * birth_count * 2);
+}
+BENCHMARK(BM_SpatialIndexInsertErase)
+    ->Args({10000, 10})
+    ->Args({10000, 100})
+    ->Args({100000, 100});
+
+// Every agent reads the agents of the 5 x 5 cells around it, as sensing does.
+void BM_SpatialIndexBoxQuery(benchmark::State& state) {
+  auto population = Population{static_cast<std::size_t>(state.range(0)), 0};
+  auto index = population.MakeIndex();
+  for (auto _ : state) {
+    auto sum = 0u;
+    for (std::size_t i = 0; i != population.Size(); ++i) {
+      auto cell = population.GetCell(i);
+      auto min = glm::max(cell, glm::uvec2{2, 2}) - glm::uvec2{2, 2};
+      auto max =
+          glm::min(cell + glm::uvec2{2, 2}, kIndexSize - glm::uvec2{1, 1});
+      index.ForEachRow(min, max, [&sum](auto agents) {
+        for (const auto& agent : agents) sum += agent.type;
+      });
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * population.Size());
+}
+BENCHMARK(BM_SpatialIndexBoxQuery)->Arg(10000)->Arg(100000);
+
+}  // namespace bench
+}  // namespace einu
@@ -0,0 +1,290 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "einu-engine/core/util/bit.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+
+// Counts of the items of each type in the cells of a grid, summed up a
+// pyramid of ever coarser grids: a node of level l covers 2^l x 2^l cells,
+// up to one node over the whole grid. Types are single bits of a mask, up to
+// kTypeCount of them. Keep it beside a SpatialHash or SpatialIndex, adding,
+// moving and removing as items do there; a change walks up the levels.
+//
+// ForEachRow finds where the items of some types are in a box without
+// looking at every cell of it: nodes with none of them are skipped whole, and
+// nodes where they are common enough are handed out whole, so a wide box
+// costs about as much as the items asked for rather than its area.
+template <std::size_t kTypeCount = 8>
+class CellPyramid {
+ public:
+  CellPyramid() = default;
+  explicit CellPyramid(glm::uvec2 size);
+
+  void Clear() noexcept;
+  void Add(glm::uvec2 cell, std::uint32_t type);
+  void Remove(glm::uvec2 cell, std::uint32_t type);
+  void Move(glm::uvec2 from, glm::uvec2 to, std::uint32_t type);
+
+  // The number of items of the types in mask in cell.
+  std::uint32_t GetCount(glm::uvec2 cell, std::uint32_t mask) const noexcept;
+  // Calls fn(y, x_begin, x_end) for runs of cells x_begin to x_end,
+  // exclusive, of row y, within the box from min to max, inclusive. The runs
+  // do not overlap and cover every cell of the box with items of the types in
+  // mask, though they may cover others too. They come in no particular order.
+  template <typename Fn>
+  void ForEachRow(glm::uvec2 min, glm::uvec2 max, std::uint32_t mask,
+                  Fn&& fn) const;
+
+  glm::uvec2 GetSize() const noexcept;
+  std::size_t GetLevelCount() const noexcept;
+  std::size_t BufferBytes() const noexcept;
+
+ private:
+  // Nodes where at least one in kScanRatio items is of the types asked for
+  // are handed out whole: scanning a few items more costs less than looking
+  // deeper for them.
+  static constexpr std::uint32_t kScanRatio = 8;
+
+  struct Level {
+    glm::uvec2 size;
+    // the items of each type in each node, type after type
+    std::vector<std::uint32_t> counts;
+    // the items of any type in each node
+    std::vector<std::uint32_t> totals;
+  };
+
+  static std::size_t GetTypeIndex(std::uint32_t type) noexcept;
+  std::uint32_t GetCount(const Level& level, std::size_t node,
+                         std::uint32_t mask) const noexcept;
+  // Hands out node of level l, which is in the box and holds count items of
+  // the types in mask, or visits its children.
+  template <typename Fn>
+  void Visit(std::size_t l, glm::uvec2 node, std::uint32_t count,
+             glm::uvec2 min, glm::uvec2 max, std::uint32_t mask,
+             Fn& fn) const;
+
+  std::vector<Level> levels_;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+template <std::size_t kTypeCount>
+inline CellPyramid<kTypeCount>::CellPyramid(glm::uvec2 size) {
+  assert(size.x != 0 && size.y != 0 && "empty grid");
+  while (true) {
+    auto node_count = static_cast<std::size_t>(size.x) * size.y;
+    levels_.push_back(Level{size, std::vector<std::uint32_t>(
+                                      node_count * kTypeCount, 0),
+                            std::vector<std::uint32_t>(node_count, 0)});
+    if (size.x == 1 && size.y == 1) break;
+    size = glm::uvec2{(size.x + 1) / 2, (size.y + 1) / 2};
+  }
+}
+
+template <std::size_t kTypeCount>
+inline void CellPyramid<kTypeCount>::Clear() noexcept {
+  for (auto& level : levels_) {
+    std::fill(level.counts.begin(), level.counts.end(), 0);
+    std::fill(level.totals.begin(), level.totals.end(), 0);
+  }
+}
+
+template <std::size_t kTypeCount>
+inline void CellPyramid<kTypeCount>::Add(glm::uvec2 cell, std::uint32_t type) {
+  assert(cell.x < GetSize().x && cell.y < GetSize().y && "cell out of grid");
+  auto t = GetTypeIndex(type);
+  for (std::size_t l = 0; l != levels_.size(); ++l) {
+    auto& level = levels_[l];
+    auto node = (cell.y >> l) * level.size.x + (cell.x >> l);
+    ++level.counts[node * kTypeCount + t];
+    ++level.totals[node];
+  }
+}
+
+template <std::size_t kTypeCount>
+inline void CellPyramid<kTypeCount>::Remove(glm::uvec2 cell,
+                                            std::uint32_t type) {
+  assert(cell.x < GetSize().x && cell.y < GetSize().y && "cell out of grid");
+  auto t = GetTypeIndex(type);
+  for (std::size_t l = 0; l != levels_.size(); ++l) {
+    auto& level = levels_[l];
+    auto node = (cell.y >> l) * level.size.x + (cell.x >> l);
+    assert(level.counts[node * kTypeCount + t] != 0 && "no such item");
+    --level.counts[node * kTypeCount + t];
+    --level.totals[node];
+  }
+}
+
+template <std::size_t kTypeCount>
+inline void CellPyramid<kTypeCount>::Move(glm::uvec2 from, glm::uvec2 to,
+                                          std::uint32_t type) {
+  assert(from.x < GetSize().x && from.y < GetSize().y && "cell out of grid");
+  assert(to.x < GetSize().x && to.y < GetSize().y && "cell out of grid");
+  auto t = GetTypeIndex(type);
+  // once both are in the same node, so are they in every node above
+  for (std::size_t l = 0; l != levels_.size(); ++l) {
+    auto& level = levels_[l];
+    auto from_node = (from.y >> l) * level.size.x + (from.x >> l);
+    auto to_node = (to.y >> l) * level.size.x + (to.x >> l);
+    if (from_node == to_node) break;
+    assert(level.counts[from_node * kTypeCount + t] != 0 && "no such item");
+    --level.counts[from_node * kTypeCount + t];
+    --level.totals[from_node];
+    ++level.counts[to_node * kTypeCount + t];
+    ++level.totals[to_node];
+  }
+}
+
+template <std::size_t kTypeCount>
+inline std::uint32_t CellPyramid<kTypeCount>::GetCount(
+    glm::uvec2 cell, std::uint32_t mask) const noexcept {
+  assert(cell.x < GetSize().x && cell.y < GetSize().y && "cell out of grid");
+  return GetCount(levels_[0], std::size_t{cell.y} * GetSize().x + cell.x,
+                  mask);
+}
+
+template <std::size_t kTypeCount>
+template <typename Fn>
+inline void CellPyramid<kTypeCount>::ForEachRow(glm::uvec2 min,
+                                                glm::uvec2 max,
+                                                std::uint32_t mask,
+                                                Fn&& fn) const {
+  assert(min.x <= max.x && min.y <= max.y && max.x < GetSize().x &&
+         max.y < GetSize().y && "box out of grid");
+  // start from the finest level whose nodes are at least as wide as the box,
+  // which then overlaps at most 2 x 2 of them
+  auto extent = std::max(max.x - min.x, max.y - min.y) + 1;
+  auto l = std::size_t{0};
+  while ((std::uint32_t{1} << l) < extent && l + 1 != levels_.size()) ++l;
+  const auto& level = levels_[l];
+  auto count = std::uint32_t{0};
+  auto total = std::uint32_t{0};
+  for (auto y = min.y >> l; y <= max.y >> l; ++y) {
+    for (auto x = min.x >> l; x <= max.x >> l; ++x) {
+      auto index = std::size_t{y} * level.size.x + x;
+      count += GetCount(level, index, mask);
+      total += level.totals[index];
+    }
+  }
+  if (count == 0) return;
+  if (count * kScanRatio >= total) {
+    for (auto y = min.y; y <= max.y; ++y) fn(y, min.x, max.x + 1);
+    return;
+  }
+  for (auto y = min.y >> l; y <= max.y >> l; ++y) {
+    for (auto x = min.x >> l; x <= max.x >> l; ++x) {
+      auto node_count =
+          GetCount(level, std::size_t{y} * level.size.x + x, mask);
+      if (node_count != 0) {
+        Visit(l, glm::uvec2{x, y}, node_count, min, max, mask, fn);
+      }
+    }
+  }
+}
+
+template <std::size_t kTypeCount>
+inline glm::uvec2 CellPyramid<kTypeCount>::GetSize() const noexcept {
+  return levels_.empty() ? glm::uvec2{} : levels_[0].size;
+}
+
+template <std::size_t kTypeCount>
+inline std::size_t CellPyramid<kTypeCount>::GetLevelCount() const noexcept {
+  return levels_.size();
+}
+
+template <std::size_t kTypeCount>
+inline std::size_t CellPyramid<kTypeCount>::BufferBytes() const noexcept {
+  auto bytes = levels_.capacity() * sizeof(Level);
+  for (const auto& level : levels_) {
+    bytes += (level.counts.capacity() + level.totals.capacity()) *
+             sizeof(std::uint32_t);
+  }
+  return bytes;
+}
+
+template <std::size_t kTypeCount>
+inline std::size_t CellPyramid<kTypeCount>::GetTypeIndex(
+    std::uint32_t type) noexcept {
+  assert(type != 0 && (type & (type - 1)) == 0 && "type is not a single bit");
+  auto t = static_cast<std::size_t>(util::CountRightZero(type));
+  assert(t < kTypeCount && "type out of range");
+  return t;
+}
+
+template <std::size_t kTypeCount>
+inline std::uint32_t CellPyramid<kTypeCount>::GetCount(
+    const Level& level, std::size_t node, std::uint32_t mask) const noexcept {
+  const auto* counts = level.counts.data() + node * kTypeCount;
+  static_assert(kTypeCount <= 32, "types are bits of a std::uint32_t");
+  auto count = std::uint32_t{0};
+  mask &= static_cast<std::uint32_t>((std::uint64_t{1} << kTypeCount) - 1);
+  for (; mask; mask &= mask - 1) {
+    count += counts[util::CountRightZero(mask)];
+  }
+  return count;
+}
+
+template <std::size_t kTypeCount>
+template <typename Fn>
+inline void CellPyramid<kTypeCount>::Visit(std::size_t l, glm::uvec2 node,
+                                           std::uint32_t count,
+                                           glm::uvec2 min, glm::uvec2 max,
+                                           std::uint32_t mask, Fn& fn) const {
+  const auto& level = levels_[l];
+  auto index = std::size_t{node.y} * level.size.x + node.x;
+  if (l == 0 || count * kScanRatio >= level.totals[index]) {
+    auto node_min = glm::uvec2{node.x << l, node.y << l};
+    auto x_begin = std::max(node_min.x, min.x);
+    auto x_end = std::min(node_min.x + (1u << l) - 1, max.x) + 1;
+    auto y_last = std::min(node_min.y + (1u << l) - 1, max.y);
+    for (auto y = std::max(node_min.y, min.y); y <= y_last; ++y) {
+      fn(y, x_begin, x_end);
+    }
+    return;
+  }
+  // the children are tested here so that only those worth a look are visited
+  const auto& child_level = levels_[l - 1];
+  auto child_width = 1u << (l - 1);
+  for (auto y = node.y * 2; y != node.y * 2 + 2; ++y) {
+    if (y >= child_level.size.y) break;
+    auto y_min = y << (l - 1);
+    if (y_min > max.y || y_min + child_width - 1 < min.y) continue;
+    for (auto x = node.x * 2; x != node.x * 2 + 2; ++x) {
+      if (x >= child_level.size.x) break;
+      auto x_min = x << (l - 1);
+      if (x_min > max.x || x_min + child_width - 1 < min.x) continue;
+      auto child_count = GetCount(
+          child_level, std::size_t{y} * child_level.size.x + x, mask);
+      if (child_count != 0) {
+        Visit(l - 1, glm::uvec2{x, y}, child_count, min, max, mask, fn);
+      }
+    }
+  }
+}
+
+}  // namespace einu
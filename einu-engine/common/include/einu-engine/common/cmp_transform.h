@@ -31,5 +31,14 @@ class Transform : public Xnent, public ::einu::Transform {
       : ::einu::Transform{transform} {}
 };
 
+// The transform at the previous simulation tick, kept for rendering between
+// fixed steps.
+class PreviousTransform : public Xnent, public ::einu::Transform {
+ public:
+  PreviousTransform() = default;
+  explicit PreviousTransform(const ::einu::Transform& transform)
+      : ::einu::Transform{transform} {}
+};
+
 }  // namespace cmp
 }  // namespace einu
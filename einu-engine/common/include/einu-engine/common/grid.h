@@ -18,93 +18,236 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include "glm/glm.hpp"
 
 namespace einu {
 
-template <typename T>
+// Layout policies map a cell coordinate to its place in the grid's storage.
+// Every layout is dense: the cells of a grid of size x * y fill exactly x * y
+// slots, so iterating the storage visits each cell once, in memory order.
+
+// Cell (x, y) sits at y * width + x. Rows are contiguous.
+class RowMajorLayout {
+ public:
+  static constexpr bool kRowContiguous = true;
+
+  RowMajorLayout() = default;
+  explicit RowMajorLayout(glm::uvec2 size) noexcept : width_{size.x} {}
+
+  std::size_t Index(std::uint32_t x, std::uint32_t y) const noexcept {
+    return std::size_t{y} * width_ + x;
+  }
+
+ private:
+  std::uint32_t width_ = 0;
+};
+
+namespace internal {
+
+// Spreads the low 16 bits of v apart so that they occupy the even bits.
+constexpr std::uint32_t SpreadBits(std::uint32_t v) noexcept {
+  v &= 0x0000ffff;
+  v = (v | (v << 8)) & 0x00ff00ff;
+  v = (v | (v << 4)) & 0x0f0f0f0f;
+  v = (v | (v << 2)) & 0x33333333;
+  v = (v | (v << 1)) & 0x55555555;
+  return v;
+}
+
+constexpr std::uint32_t MortonCode(std::uint32_t x, std::uint32_t y) noexcept {
+  return SpreadBits(x) | (SpreadBits(y) << 1);
+}
+
+}  // namespace internal
+
+// The grid is cut into square tiles of kTileSide cells, stored one after
+// another in row-major order of tiles, so a small box of cells spans a few
+// tiles instead of as many rows. Within a full tile the cells are in
+// row-major order, or in Z-order (Morton order) when kMorton is set. The
+// tiles on the right and bottom edges are cut short to keep the layout dense
+// and are always row-major inside.
+template <std::uint32_t kTileSide = 8, bool kMorton = false>
+class TiledLayout {
+ public:
+  static_assert(kTileSide > 0 && (kTileSide & (kTileSide - 1)) == 0,
+                "the tile side must be a power of two");
+  static_assert(!kMorton || kTileSide <= 0x10000,
+                "Morton codes of a tile must fit 32 bits");
+
+  static constexpr bool kRowContiguous = false;
+
+  TiledLayout() = default;
+  explicit TiledLayout(glm::uvec2 size) noexcept
+      : size_{size},
+        full_tiles_{size.x / kTileSide, size.y / kTileSide},
+        tile_row_cells_{std::size_t{kTileSide} * size.x} {}
+
+  std::size_t Index(std::uint32_t x, std::uint32_t y) const noexcept {
+    auto tile_x = x / kTileSide;
+    auto tile_y = y / kTileSide;
+    auto local_x = x % kTileSide;
+    auto local_y = y % kTileSide;
+    auto tile_row_start = tile_y * tile_row_cells_;
+    if (tile_x < full_tiles_.x && tile_y < full_tiles_.y) {
+      auto tile_start = tile_row_start + std::size_t{tile_x} * kTileCells;
+      return tile_start + (kMorton ? internal::MortonCode(local_x, local_y)
+                                   : local_y * kTileSide + local_x);
+    }
+    // every tile before this one in its row of tiles is a full kTileSide wide
+    auto tile_width = std::min(kTileSide, size_.x - tile_x * kTileSide);
+    auto tile_height = std::min(kTileSide, size_.y - tile_y * kTileSide);
+    return tile_row_start + std::size_t{tile_x} * kTileSide * tile_height +
+           std::size_t{local_y} * tile_width + local_x;
+  }
+
+ private:
+  static constexpr std::uint32_t kTileCells = kTileSide * kTileSide;
+
+  glm::uvec2 size_{0, 0};
+  glm::uvec2 full_tiles_{0, 0};
+  std::size_t tile_row_cells_ = 0;
+};
+
+template <std::uint32_t kTileSide = 32>
+using MortonLayout = TiledLayout<kTileSide, true>;
+
+// A 2D grid of cells, stored as laid out by Layout. operator[] hands out whole
+// rows and is only offered by layouts with contiguous rows; At, GetCells and
+// the iterators work with any layout.
+template <typename T, typename Layout = RowMajorLayout>
 class Grid {
  public:
+  using LayoutType = Layout;
+
   Grid() = default;
   explicit Grid(glm::uvec2 size);
 
   const T* operator[](std::size_t y) const noexcept;
   T* operator[](std::size_t y) noexcept;
+  const T& At(std::uint32_t x, std::uint32_t y) const noexcept;
+  T& At(std::uint32_t x, std::uint32_t y) noexcept;
+  const T& At(glm::uvec2 pos) const noexcept;
+  T& At(glm::uvec2 pos) noexcept;
+  // Iterate every cell once, in memory order, which is row-major order only
+  // for RowMajorLayout.
   const T* begin() const noexcept;
   T* begin() noexcept;
   const T* end() const noexcept;
   T* end() noexcept;
+  // Writes the cells of the box to dest in row-major order of the box,
+  // whatever the layout.
   void GetCells(std::size_t x, std::size_t y, std::size_t x_count,
                 std::size_t y_count, const T** dest) const;
 
   glm::uvec2 GetSize() const noexcept;
   std::size_t GetTotalCellCount() const noexcept;
+  const Layout& GetLayout() const noexcept;
 
  private:
   glm::uvec2 size_;
+  Layout layout_;
   std::vector<T> grid_;
 };
 
 //////////////////////////////////////////////////////////////////////////
 
-template <typename T>
-inline Grid<T>::Grid(glm::uvec2 size) {
+template <typename T, typename Layout>
+inline Grid<T, Layout>::Grid(glm::uvec2 size) : layout_{size} {
   size_ = size;
   grid_.resize(GetTotalCellCount());
 }
 
-template <typename T>
-inline const T* Grid<T>::operator[](std::size_t y) const noexcept {
+template <typename T, typename Layout>
+inline const T* Grid<T, Layout>::operator[](std::size_t y) const noexcept {
+  static_assert(Layout::kRowContiguous,
+                "rows of this layout are not contiguous; use At");
   return grid_.data() + y * size_.x;
 }
 
-template <typename T>
-inline T* Grid<T>::operator[](std::size_t y) noexcept {
+template <typename T, typename Layout>
+inline T* Grid<T, Layout>::operator[](std::size_t y) noexcept {
   return const_cast<T*>(static_cast<const Grid&>(*this)[y]);
 }
 
-template <typename T>
-inline const T* Grid<T>::begin() const noexcept {
+template <typename T, typename Layout>
+inline const T& Grid<T, Layout>::At(std::uint32_t x,
+                                    std::uint32_t y) const noexcept {
+  return grid_[layout_.Index(x, y)];
+}
+
+template <typename T, typename Layout>
+inline T& Grid<T, Layout>::At(std::uint32_t x, std::uint32_t y) noexcept {
+  return const_cast<T&>(static_cast<const Grid&>(*this).At(x, y));
+}
+
+template <typename T, typename Layout>
+inline const T& Grid<T, Layout>::At(glm::uvec2 pos) const noexcept {
+  return At(pos.x, pos.y);
+}
+
+template <typename T, typename Layout>
+inline T& Grid<T, Layout>::At(glm::uvec2 pos) noexcept {
+  return At(pos.x, pos.y);
+}
+
+template <typename T, typename Layout>
+inline const T* Grid<T, Layout>::begin() const noexcept {
   return grid_.data();
 }
 
-template <typename T>
-inline T* Grid<T>::begin() noexcept {
+template <typename T, typename Layout>
+inline T* Grid<T, Layout>::begin() noexcept {
   return const_cast<T*>(static_cast<const Grid&>(*this).begin());
 }
 
-template <typename T>
-inline const T* Grid<T>::end() const noexcept {
+template <typename T, typename Layout>
+inline const T* Grid<T, Layout>::end() const noexcept {
   return grid_.data() + GetTotalCellCount();
 }
 
-template <typename T>
-inline T* Grid<T>::end() noexcept {
+template <typename T, typename Layout>
+inline T* Grid<T, Layout>::end() noexcept {
   return const_cast<T*>(static_cast<const Grid&>(*this).end());
 }
 
-template <typename T>
-inline void Grid<T>::GetCells(std::size_t pos_x, std::size_t pos_y,
-                              std::size_t count_x, std::size_t count_y,
-                              const T** dest) const {
+template <typename T, typename Layout>
+inline void Grid<T, Layout>::GetCells(std::size_t pos_x, std::size_t pos_y,
+                                      std::size_t count_x, std::size_t count_y,
+                                      const T** dest) const {
   for (std::size_t y_index = 0; y_index != count_y; ++y_index) {
-    for (std::size_t x_index = 0; x_index != count_x; ++x_index) {
-      dest[x_index + y_index * count_x] =
-          &(*this)[pos_y + y_index][pos_x + x_index];
+    auto y = static_cast<std::uint32_t>(pos_y + y_index);
+    if constexpr (Layout::kRowContiguous) {
+      const auto* row = (*this)[y] + pos_x;
+      for (std::size_t x_index = 0; x_index != count_x; ++x_index) {
+        dest[x_index + y_index * count_x] = row + x_index;
+      }
+    } else {
+      for (std::size_t x_index = 0; x_index != count_x; ++x_index) {
+        dest[x_index + y_index * count_x] =
+            &At(static_cast<std::uint32_t>(pos_x + x_index), y);
+      }
     }
   }
 }
 
-template <typename T>
-inline glm::uvec2 Grid<T>::GetSize() const noexcept {
+template <typename T, typename Layout>
+inline glm::uvec2 Grid<T, Layout>::GetSize() const noexcept {
   return size_;
 }
 
-template <typename T>
-inline std::size_t Grid<T>::GetTotalCellCount() const noexcept {
+template <typename T, typename Layout>
+inline std::size_t Grid<T, Layout>::GetTotalCellCount() const noexcept {
   return static_cast<std::size_t>(size_.x) * size_.y;
 }
 
+template <typename T, typename Layout>
+inline const Layout& Grid<T, Layout>::GetLayout() const noexcept {
+  return layout_;
+}
+
 }  // namespace einu
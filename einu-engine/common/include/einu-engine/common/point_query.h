@@ -0,0 +1,173 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "einu-engine/core/util/bit.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+
+// Batched queries over points stored as columns: the x and y coordinates and
+// a bit mask of each point in arrays of their own. A point matches a query if
+// it is strictly within radius of center and all of its mask bits are in the
+// query's mask. The results are indices into the columns.
+//
+// With AVX2 enabled (EINU_ENGINE_AVX2), eight points are tested at a time;
+// otherwise one at a time, with the same results.
+
+namespace internal {
+
+inline float Distance2(const float* xs, const float* ys, std::size_t i,
+                       glm::vec2 center) noexcept {
+  auto dx = xs[i] - center.x;
+  auto dy = ys[i] - center.y;
+  return dx * dx + dy * dy;
+}
+
+inline bool MatchOne(const float* xs, const float* ys,
+                     const std::uint32_t* masks, std::size_t i,
+                     glm::vec2 center, float radius2,
+                     std::uint32_t mask) noexcept {
+  return (masks[i] & ~mask) == 0 && Distance2(xs, ys, i, center) < radius2;
+}
+
+#if defined(__AVX2__)
+
+// Bit j is set if point first + j matches.
+inline std::uint32_t MatchEight(const float* xs, const float* ys,
+                                const std::uint32_t* masks, std::size_t first,
+                                glm::vec2 center, float radius2,
+                                std::uint32_t mask) noexcept {
+  auto dx = _mm256_sub_ps(_mm256_loadu_ps(xs + first),
+                          _mm256_set1_ps(center.x));
+  auto dy = _mm256_sub_ps(_mm256_loadu_ps(ys + first),
+                          _mm256_set1_ps(center.y));
+  auto d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+  auto near = _mm256_cmp_ps(d2, _mm256_set1_ps(radius2), _CMP_LT_OQ);
+  auto others = _mm256_andnot_si256(
+      _mm256_set1_epi32(static_cast<int>(mask)),
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + first)));
+  auto fits = _mm256_cmpeq_epi32(others, _mm256_setzero_si256());
+  return static_cast<std::uint32_t>(
+      _mm256_movemask_ps(_mm256_and_ps(near, _mm256_castsi256_ps(fits))));
+}
+
+#endif
+
+// Calls fn(i) for each matching point i, in order. radius2 is read again
+// after every call, so fn may narrow the query as it goes.
+template <typename Fn>
+inline void ForEachMatch(const float* xs, const float* ys,
+                         const std::uint32_t* masks, std::size_t count,
+                         glm::vec2 center, const float& radius2,
+                         std::uint32_t mask, Fn&& fn) {
+  auto i = std::size_t{0};
+#if defined(__AVX2__)
+  for (; i + 8 <= count; i += 8) {
+    auto bits = MatchEight(xs, ys, masks, i, center, radius2, mask);
+    while (bits) {
+      auto j = i + util::CountRightZero(bits);
+      bits &= bits - 1;
+      // the lanes were tested against the radius before fn narrowed it
+      if (Distance2(xs, ys, j, center) < radius2) fn(j);
+    }
+  }
+#endif
+  for (; i != count; ++i) {
+    if (MatchOne(xs, ys, masks, i, center, radius2, mask)) fn(i);
+  }
+}
+
+}  // namespace internal
+
+// Writes the indices of the matching points, in order, to out, which must
+// have room for count indices. Returns how many it wrote.
+inline std::size_t FindInRadius(const float* xs, const float* ys,
+                                const std::uint32_t* masks, std::size_t count,
+                                glm::vec2 center, float radius,
+                                std::uint32_t mask,
+                                std::uint32_t* out) noexcept {
+  auto radius2 = radius * radius;
+  auto found = std::size_t{0};
+  auto i = std::size_t{0};
+#if defined(__AVX2__)
+  for (; i + 8 <= count; i += 8) {
+    auto bits = internal::MatchEight(xs, ys, masks, i, center, radius2, mask);
+    while (bits) {
+      out[found++] = static_cast<std::uint32_t>(i + util::CountRightZero(bits));
+      bits &= bits - 1;
+    }
+  }
+#endif
+  for (; i != count; ++i) {
+    // written either way, kept only on a match
+    out[found] = static_cast<std::uint32_t>(i);
+    found += internal::MatchOne(xs, ys, masks, i, center, radius2, mask);
+  }
+  return found;
+}
+
+// Writes the indices of the up to k matching points nearest to center to out,
+// nearest first, breaking ties by index. Returns how many it wrote.
+inline std::size_t FindNearest(const float* xs, const float* ys,
+                               const std::uint32_t* masks, std::size_t count,
+                               glm::vec2 center, float radius,
+                               std::uint32_t mask, std::size_t k,
+                               std::uint32_t* out) noexcept {
+  if (k == 0) return 0;
+  // a max-heap of the nearest found so far, farthest on top
+  auto nearer = [&](std::uint32_t a, std::uint32_t b) {
+    auto da = internal::Distance2(xs, ys, a, center);
+    auto db = internal::Distance2(xs, ys, b, center);
+    return da < db || (da == db && a < b);
+  };
+  auto size = std::size_t{0};
+  auto radius2 = radius * radius;
+  internal::ForEachMatch(
+      xs, ys, masks, count, center, radius2, mask, [&](std::size_t i) {
+        auto index = static_cast<std::uint32_t>(i);
+        if (size != k) {
+          out[size++] = index;
+          std::push_heap(out, out + size, nearer);
+        } else if (nearer(index, out[0])) {
+          std::pop_heap(out, out + size, nearer);
+          out[size - 1] = index;
+          std::push_heap(out, out + size, nearer);
+        } else {
+          return;
+        }
+        // once full, only points nearer than the farthest kept can get in
+        if (size == k) {
+          radius2 = std::min(radius2,
+                             internal::Distance2(xs, ys, out[0], center));
+        }
+      });
+  std::sort_heap(out, out + size, nearer);
+  return size;
+}
+
+}  // namespace einu
@@ -0,0 +1,45 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <ostream>
+
+#include "einu-engine/core/latency_histogram.h"
+#include "einu-engine/core/xnent.h"
+
+namespace einu {
+namespace sgl {
+
+// Rolling latency histograms of the last frames, cheap enough to record
+// every frame and printed only when asked for.
+struct FrameStats : public Xnent {
+  RollingLatencyHistogram frame;
+  RollingLatencyHistogram simulation;
+  RollingLatencyHistogram render;
+};
+
+inline void WriteFrameStats(std::ostream& os, const FrameStats& stats) {
+  WriteLatencyHeader(os);
+  WriteLatencySummary(os, "frame", Summarize(stats.frame.Collect()));
+  WriteLatencySummary(os, "simulation", Summarize(stats.simulation.Collect()));
+  WriteLatencySummary(os, "render", Summarize(stats.render.Collect()));
+}
+
+}  // namespace sgl
+}  // namespace einu
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 
 #include "einu-engine/core/xnent.h"
 
@@ -26,7 +27,7 @@ namespace einu {
 namespace sgl {
 
 struct Time : public Xnent {
-  using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
+  using TimePoint = std::chrono::time_point<std::chrono::steady_clock>;
   TimePoint pre;
   TimePoint now;
 };
@@ -36,5 +37,24 @@ constexpr float DeltaSeconds(const Time& time) noexcept {
   return dt.count();
 }
 
+// Runs the simulation in ticks of a fixed step, independent of the frame
+// rate. Each frame adds its real time to the accumulator and the simulation
+// catches up by up to max_steps ticks. alpha is how far the leftover time is
+// into the next tick, for interpolating between the last two ticks when
+// rendering.
+struct FixedStep : public Xnent {
+  using Duration = Time::TimePoint::duration;
+  Duration step = std::chrono::milliseconds{50};
+  std::size_t max_steps = 5;
+  Duration accumulator = Duration::zero();
+  std::size_t steps = 0;
+  float alpha = 0;
+};
+
+constexpr float StepSeconds(const FixedStep& fixed_step) noexcept {
+  std::chrono::duration<float> dt = fixed_step.step;
+  return dt.count();
+}
+
 }  // namespace sgl
 }  // namespace einu
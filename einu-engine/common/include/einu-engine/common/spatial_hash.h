@@ -0,0 +1,243 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "einu-engine/common/span.h"
+#include "einu-engine/core/job_system.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+
+// Items bucketed by the cell of a grid they are in, rebuilt from scratch each
+// time they move. Inserts append to a staging list and count the items of
+// their cell; Build then sums the counts into offsets and scatters the items
+// into one flat array sorted by cell, with no allocation once the buffers
+// have grown:
+//
+//   for (...) hash.Insert(cell, item);
+//   hash.Build();
+//   for (const auto& item : hash.GetCell(cell)) ...
+//
+// Cells are in row-major order, so the cells of a row of a box are one
+// contiguous span. Build(jobs) splits the items into chunks that are counted
+// and scattered on a job system, and gives the same order as Build.
+template <typename T>
+class SpatialHash {
+ public:
+  using Span = einu::Span<T>;
+
+  SpatialHash() = default;
+  explicit SpatialHash(glm::uvec2 size);
+
+  // Drops the items inserted since the last build. Built items stay until the
+  // next build.
+  void Clear() noexcept;
+  void Insert(glm::uvec2 cell, const T& item);
+  // Replaces the built items with those inserted since the last build, in the
+  // order they were inserted within each cell.
+  void Build();
+  // Build with the count and scatter passes split into up to chunk_count
+  // jobs. Waits for them, running jobs on the calling thread as well.
+  void Build(JobSystem& jobs, std::size_t chunk_count);
+
+  Span GetCell(glm::uvec2 cell) const noexcept;
+  // The items of cells x_begin to x_end, exclusive, of row y.
+  Span GetRow(std::uint32_t y, std::uint32_t x_begin,
+              std::uint32_t x_end) const noexcept;
+  // Calls fn(Span) for each row of the box from min to max, inclusive.
+  template <typename Fn>
+  void ForEachRow(glm::uvec2 min, glm::uvec2 max, Fn&& fn) const;
+  Span GetItems() const noexcept;
+
+  glm::uvec2 GetSize() const noexcept;
+  std::size_t GetTotalCellCount() const noexcept;
+  std::size_t BufferBytes() const noexcept;
+
+ private:
+  // Counts the staged items from first to last into counts.
+  void CountChunk(std::uint32_t* counts, std::size_t first,
+                  std::size_t last) const noexcept;
+  // Turns the counts of chunk_count chunks, chunk after chunk, into where
+  // each chunk writes the items of each cell.
+  void SumCounts(std::uint32_t* counts, std::size_t chunk_count);
+  void ScatterChunk(std::uint32_t* next, std::size_t first, std::size_t last);
+
+  glm::uvec2 size_{};
+  std::vector<T> staged_;
+  std::vector<std::uint32_t> staged_cells_;
+  // the items staged in each cell
+  std::vector<std::uint32_t> counts_;
+  std::vector<std::uint32_t> chunk_counts_;
+  std::vector<T> items_;
+  // the items of cell i are items_[offsets_[i]] to items_[offsets_[i + 1]]
+  std::vector<std::uint32_t> offsets_;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+inline SpatialHash<T>::SpatialHash(glm::uvec2 size)
+    : size_{size},
+      counts_(GetTotalCellCount(), 0),
+      offsets_(GetTotalCellCount() + 1, 0) {}
+
+template <typename T>
+inline void SpatialHash<T>::Clear() noexcept {
+  staged_.clear();
+  staged_cells_.clear();
+  std::fill(counts_.begin(), counts_.end(), 0);
+}
+
+template <typename T>
+inline void SpatialHash<T>::Insert(glm::uvec2 cell, const T& item) {
+  assert(cell.x < size_.x && cell.y < size_.y && "cell out of grid");
+  auto index = cell.y * size_.x + cell.x;
+  staged_.push_back(item);
+  staged_cells_.push_back(index);
+  ++counts_[index];
+}
+
+template <typename T>
+inline void SpatialHash<T>::Build() {
+  SumCounts(counts_.data(), 1);
+  ScatterChunk(counts_.data(), 0, staged_.size());
+  Clear();
+}
+
+template <typename T>
+inline void SpatialHash<T>::Build(JobSystem& jobs, std::size_t chunk_count) {
+  auto item_count = staged_.size();
+  chunk_count = std::clamp<std::size_t>(chunk_count, 1, item_count + 1);
+  auto chunk_size = (item_count + chunk_count - 1) / chunk_count;
+  auto cell_count = GetTotalCellCount();
+  chunk_counts_.assign(cell_count * chunk_count, 0);
+  auto run = [&](auto pass) {
+    auto handles = std::vector<JobHandle>{};
+    handles.reserve(chunk_count);
+    for (std::size_t chunk = 0; chunk != chunk_count; ++chunk) {
+      auto* counts = chunk_counts_.data() + chunk * cell_count;
+      auto first = std::min(chunk * chunk_size, item_count);
+      auto last = std::min(first + chunk_size, item_count);
+      handles.push_back(jobs.Schedule([this, pass, counts, first, last] {
+        (this->*pass)(counts, first, last);
+        return JobResult::Done();
+      }));
+    }
+    for (const auto& handle : handles) jobs.Wait(handle);
+  };
+  run(&SpatialHash::CountChunk);
+  SumCounts(chunk_counts_.data(), chunk_count);
+  run(&SpatialHash::ScatterChunk);
+  Clear();
+}
+
+template <typename T>
+inline void SpatialHash<T>::CountChunk(std::uint32_t* counts,
+                                       std::size_t first,
+                                       std::size_t last) const noexcept {
+  for (auto i = first; i != last; ++i) ++counts[staged_cells_[i]];
+}
+
+template <typename T>
+inline void SpatialHash<T>::SumCounts(std::uint32_t* counts,
+                                      std::size_t chunk_count) {
+  auto cell_count = GetTotalCellCount();
+  offsets_.resize(cell_count + 1);
+  auto offset = std::uint32_t{0};
+  for (std::size_t cell = 0; cell != cell_count; ++cell) {
+    offsets_[cell] = offset;
+    // within a cell, earlier chunks write first
+    for (std::size_t chunk = 0; chunk != chunk_count; ++chunk) {
+      auto& count = counts[chunk * cell_count + cell];
+      auto chunk_start = offset;
+      offset += count;
+      count = chunk_start;
+    }
+  }
+  offsets_[cell_count] = offset;
+  items_.resize(offset);
+}
+
+template <typename T>
+inline void SpatialHash<T>::ScatterChunk(std::uint32_t* next,
+                                         std::size_t first,
+                                         std::size_t last) {
+  auto* items = items_.data();
+  const auto* staged = staged_.data();
+  const auto* cells = staged_cells_.data();
+  for (auto i = first; i != last; ++i) items[next[cells[i]]++] = staged[i];
+}
+
+template <typename T>
+inline typename SpatialHash<T>::Span SpatialHash<T>::GetCell(
+    glm::uvec2 cell) const noexcept {
+  return GetRow(cell.y, cell.x, cell.x + 1);
+}
+
+template <typename T>
+inline typename SpatialHash<T>::Span SpatialHash<T>::GetRow(
+    std::uint32_t y, std::uint32_t x_begin,
+    std::uint32_t x_end) const noexcept {
+  assert(y < size_.y && x_begin <= x_end && x_end <= size_.x &&
+         "row out of grid");
+  auto row = std::size_t{y} * size_.x;
+  return Span{items_.data() + offsets_[row + x_begin],
+              items_.data() + offsets_[row + x_end]};
+}
+
+template <typename T>
+template <typename Fn>
+inline void SpatialHash<T>::ForEachRow(glm::uvec2 min, glm::uvec2 max,
+                                       Fn&& fn) const {
+  for (auto y = min.y; y <= max.y; ++y) {
+    fn(GetRow(y, min.x, max.x + 1));
+  }
+}
+
+template <typename T>
+inline typename SpatialHash<T>::Span SpatialHash<T>::GetItems()
+    const noexcept {
+  return Span{items_.data(), items_.data() + items_.size()};
+}
+
+template <typename T>
+inline glm::uvec2 SpatialHash<T>::GetSize() const noexcept {
+  return size_;
+}
+
+template <typename T>
+inline std::size_t SpatialHash<T>::GetTotalCellCount() const noexcept {
+  return static_cast<std::size_t>(size_.x) * size_.y;
+}
+
+template <typename T>
+inline std::size_t SpatialHash<T>::BufferBytes() const noexcept {
+  return (staged_.capacity() + items_.capacity()) * sizeof(T) +
+         (staged_cells_.capacity() + counts_.capacity() +
+          chunk_counts_.capacity() + offsets_.capacity()) *
+             sizeof(std::uint32_t);
+}
+
+}  // namespace einu
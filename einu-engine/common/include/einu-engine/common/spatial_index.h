@@ -0,0 +1,398 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "einu-engine/common/span.h"
+#include "einu-engine/core/eid.h"
+#include "glm/glm.hpp"
+
+namespace einu {
+
+// Items bucketed by the cell of a grid they are in, like SpatialHash, but
+// kept up to date one entity at a time instead of being rebuilt. Each entity
+// has at most one item:
+//
+//   index.Insert(eid, cell, item);  // on create
+//   index.Update(eid, cell, item);  // on move
+//   index.Erase(eid);               // on destroy
+//   index.Flush();                  // once a frame
+//
+// The items stay in one flat array sorted by cell in row-major order, so
+// queries are the same as SpatialHash's. The index remembers the cell of each
+// entity and finds its item by scanning that cell. An item that stays in its
+// cell is overwritten in place; one that changes cells is carried across the
+// cell boundaries in between, one item move per occupied cell, so a step to
+// the next column is O(1) and a step to the next row costs a row of cells.
+// Insert and Erase only queue the change; Flush applies all of them in one
+// pass over the grid, so the entities that come and go in a frame cost one
+// O(items + cells) pass between them. Until then, queries, Update and Find
+// see the index as of the last Flush. Assign fills the whole index at once.
+// The order of the items within a cell is unspecified.
+template <typename T>
+class SpatialIndex {
+ public:
+  using Span = einu::Span<T>;
+
+  struct Entry {
+    EID eid;
+    glm::uvec2 cell;
+    T item;
+  };
+
+  SpatialIndex() = default;
+  explicit SpatialIndex(glm::uvec2 size);
+
+  void Clear() noexcept;
+  // Replaces the items with those of the entries, whose EIDs must be unique.
+  void Assign(const std::vector<Entry>& entries);
+  // Queues the entity to be inserted on Flush. It must not be in the index
+  // then.
+  void Insert(EID eid, glm::uvec2 cell, const T& item);
+  // Sets the item of an entity in the index and moves it to cell. Returns
+  // whether it changed cells.
+  bool Update(EID eid, glm::uvec2 cell, const T& item);
+  // Queues the entity to be erased on Flush, or drops its queued insert and
+  // returns it. Does nothing if the entity is in neither.
+  std::optional<Entry> Erase(EID eid);
+  // Applies the queued erases, then the queued inserts.
+  void Flush();
+  bool Contains(EID eid) const;
+  // The item of an entity, or nullptr if it is not in the index.
+  const T* Find(EID eid) const;
+
+  Span GetCell(glm::uvec2 cell) const noexcept;
+  // The items of cells x_begin to x_end, exclusive, of row y.
+  Span GetRow(std::uint32_t y, std::uint32_t x_begin,
+              std::uint32_t x_end) const noexcept;
+  // Calls fn(Span) for each row of the box from min to max, inclusive.
+  template <typename Fn>
+  void ForEachRow(glm::uvec2 min, glm::uvec2 max, Fn&& fn) const;
+  Span GetItems() const noexcept;
+
+  glm::uvec2 GetSize() const noexcept;
+  std::size_t GetTotalCellCount() const noexcept;
+  std::size_t BufferBytes() const noexcept;
+
+ private:
+  std::uint32_t GetCellIndex(glm::uvec2 cell) const noexcept;
+  // The slot of the item of an entity in cell.
+  std::uint32_t FindSlot(std::uint32_t cell, EID eid) const noexcept;
+  // Carries the item at slot from its cell to another, setting it to item on
+  // the way.
+  void Move(std::uint32_t slot, std::uint32_t from, std::uint32_t to, T item);
+
+  glm::uvec2 size_{};
+  std::vector<T> items_;
+  // the entity of each item
+  std::vector<EID> eids_;
+  // the items of cell i are items_[offsets_[i]] to items_[offsets_[i + 1]]
+  std::vector<std::uint32_t> offsets_;
+  // the cell of each entity
+  absl::flat_hash_map<EID, std::uint32_t> cells_;
+  // changes queued for Flush
+  std::vector<Entry> inserts_;
+  std::vector<EID> erases_;
+  // scratch space of Flush, kept to avoid reallocating every frame
+  std::vector<std::uint32_t> erased_slots_;
+  std::vector<T> flushed_items_;
+  std::vector<EID> flushed_eids_;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+inline SpatialIndex<T>::SpatialIndex(glm::uvec2 size)
+    : size_{size}, offsets_(GetTotalCellCount() + 1, 0) {}
+
+template <typename T>
+inline void SpatialIndex<T>::Clear() noexcept {
+  items_.clear();
+  eids_.clear();
+  std::fill(offsets_.begin(), offsets_.end(), 0);
+  cells_.clear();
+  inserts_.clear();
+  erases_.clear();
+}
+
+template <typename T>
+inline void SpatialIndex<T>::Assign(const std::vector<Entry>& entries) {
+  Clear();
+  // count into the next cell's offset, so the sum leaves each cell's start
+  for (const auto& entry : entries) ++offsets_[GetCellIndex(entry.cell) + 1];
+  for (std::size_t i = 1; i != offsets_.size(); ++i) {
+    offsets_[i] += offsets_[i - 1];
+  }
+  items_.resize(entries.size());
+  eids_.resize(entries.size());
+  cells_.reserve(entries.size());
+  for (const auto& entry : entries) {
+    auto cell = GetCellIndex(entry.cell);
+    auto slot = offsets_[cell]++;
+    items_[slot] = entry.item;
+    eids_[slot] = entry.eid;
+    [[maybe_unused]] auto inserted = cells_.try_emplace(entry.eid, cell).second;
+    assert(inserted && "entity already in the index");
+  }
+  // each cell's offset now is the start of the next
+  for (auto i = offsets_.size() - 1; i != 0; --i) offsets_[i] = offsets_[i - 1];
+  offsets_[0] = 0;
+}
+
+template <typename T>
+inline void SpatialIndex<T>::Insert(EID eid, glm::uvec2 cell, const T& item) {
+  assert(cell.x < size_.x && cell.y < size_.y && "cell out of grid");
+  inserts_.push_back(Entry{eid, cell, item});
+}
+
+template <typename T>
+inline bool SpatialIndex<T>::Update(EID eid, glm::uvec2 cell, const T& item) {
+  auto it = cells_.find(eid);
+  assert(it != cells_.end() && "entity not in the index");
+  auto from = it->second;
+  auto slot = FindSlot(from, eid);
+  auto to = GetCellIndex(cell);
+  if (from == to) {
+    items_[slot] = item;
+    return false;
+  }
+  it->second = to;
+  Move(slot, from, to, item);
+  return true;
+}
+
+template <typename T>
+inline std::optional<typename SpatialIndex<T>::Entry> SpatialIndex<T>::Erase(
+    EID eid) {
+  auto insert_it =
+      std::find_if(inserts_.begin(), inserts_.end(),
+                   [eid](const auto& entry) { return entry.eid == eid; });
+  if (insert_it != inserts_.end()) {
+    auto dropped = std::move(*insert_it);
+    *insert_it = std::move(inserts_.back());
+    inserts_.pop_back();
+    return dropped;
+  }
+  if (cells_.contains(eid)) erases_.push_back(eid);
+  return std::nullopt;
+}
+
+template <typename T>
+inline void SpatialIndex<T>::Flush() {
+  if (inserts_.empty() && erases_.empty()) return;
+
+  erased_slots_.clear();
+  for (auto eid : erases_) {
+    auto it = cells_.find(eid);
+    if (it == cells_.end()) continue;
+    erased_slots_.push_back(FindSlot(it->second, eid));
+    cells_.erase(it);
+  }
+  std::sort(erased_slots_.begin(), erased_slots_.end());
+  std::sort(inserts_.begin(), inserts_.end(),
+            [this](const auto& lhs, const auto& rhs) {
+              return GetCellIndex(lhs.cell) < GetCellIndex(rhs.cell);
+            });
+
+  // The items that stay are copied in blocks between the erased slots and
+  // the ends of the cells that get inserts, which go last in their cell.
+  constexpr auto kNone = ~std::uint32_t{0};
+  auto size = items_.size() - erased_slots_.size() + inserts_.size();
+  flushed_items_.clear();
+  flushed_eids_.clear();
+  flushed_items_.reserve(size);
+  flushed_eids_.reserve(size);
+  auto copied = std::uint32_t{0};
+  auto copy_until = [this, &copied](std::uint32_t slot) {
+    flushed_items_.insert(flushed_items_.end(),
+                          std::make_move_iterator(items_.begin() + copied),
+                          std::make_move_iterator(items_.begin() + slot));
+    flushed_eids_.insert(flushed_eids_.end(), eids_.begin() + copied,
+                         eids_.begin() + slot);
+    copied = slot;
+  };
+  auto erased_it = erased_slots_.begin();
+  auto insert_it = inserts_.begin();
+  for (;;) {
+    auto erase_at = erased_it != erased_slots_.end() ? *erased_it : kNone;
+    auto insert_cell = insert_it != inserts_.end()
+                           ? GetCellIndex(insert_it->cell)
+                           : kNone;
+    auto insert_at = insert_cell != kNone ? offsets_[insert_cell + 1] : kNone;
+    if (erase_at == kNone && insert_at == kNone) break;
+    if (insert_at <= erase_at) {
+      copy_until(insert_at);
+      [[maybe_unused]] auto inserted =
+          cells_.try_emplace(insert_it->eid, insert_cell).second;
+      assert(inserted && "entity already in the index");
+      flushed_items_.push_back(std::move(insert_it->item));
+      flushed_eids_.push_back(insert_it->eid);
+      ++insert_it;
+    } else {
+      copy_until(erase_at);
+      ++copied;
+      ++erased_it;
+    }
+  }
+  copy_until(static_cast<std::uint32_t>(items_.size()));
+
+  // a cell starts as many slots later as items were inserted into the cells
+  // before it, less the erased slots before it
+  erased_it = erased_slots_.begin();
+  insert_it = inserts_.begin();
+  auto erased_count = std::uint32_t{0};
+  auto inserted_count = std::uint32_t{0};
+  for (std::size_t cell = 0; cell != offsets_.size(); ++cell) {
+    auto offset = offsets_[cell];
+    for (; erased_it != erased_slots_.end() && *erased_it < offset;
+         ++erased_it) {
+      ++erased_count;
+    }
+    for (; insert_it != inserts_.end() && GetCellIndex(insert_it->cell) < cell;
+         ++insert_it) {
+      ++inserted_count;
+    }
+    offsets_[cell] = offset - erased_count + inserted_count;
+  }
+
+  std::swap(items_, flushed_items_);
+  std::swap(eids_, flushed_eids_);
+  inserts_.clear();
+  erases_.clear();
+}
+
+template <typename T>
+inline bool SpatialIndex<T>::Contains(EID eid) const {
+  return cells_.contains(eid);
+}
+
+template <typename T>
+inline const T* SpatialIndex<T>::Find(EID eid) const {
+  auto it = cells_.find(eid);
+  if (it == cells_.end()) return nullptr;
+  return &items_[FindSlot(it->second, eid)];
+}
+
+template <typename T>
+inline typename SpatialIndex<T>::Span SpatialIndex<T>::GetCell(
+    glm::uvec2 cell) const noexcept {
+  return GetRow(cell.y, cell.x, cell.x + 1);
+}
+
+template <typename T>
+inline typename SpatialIndex<T>::Span SpatialIndex<T>::GetRow(
+    std::uint32_t y, std::uint32_t x_begin,
+    std::uint32_t x_end) const noexcept {
+  assert(y < size_.y && x_begin <= x_end && x_end <= size_.x &&
+         "row out of grid");
+  auto row = std::size_t{y} * size_.x;
+  return Span{items_.data() + offsets_[row + x_begin],
+              items_.data() + offsets_[row + x_end]};
+}
+
+template <typename T>
+template <typename Fn>
+inline void SpatialIndex<T>::ForEachRow(glm::uvec2 min, glm::uvec2 max,
+                                        Fn&& fn) const {
+  for (auto y = min.y; y <= max.y; ++y) {
+    fn(GetRow(y, min.x, max.x + 1));
+  }
+}
+
+template <typename T>
+inline typename SpatialIndex<T>::Span SpatialIndex<T>::GetItems()
+    const noexcept {
+  return Span{items_.data(), items_.data() + items_.size()};
+}
+
+template <typename T>
+inline glm::uvec2 SpatialIndex<T>::GetSize() const noexcept {
+  return size_;
+}
+
+template <typename T>
+inline std::size_t SpatialIndex<T>::GetTotalCellCount() const noexcept {
+  return static_cast<std::size_t>(size_.x) * size_.y;
+}
+
+template <typename T>
+inline std::size_t SpatialIndex<T>::BufferBytes() const noexcept {
+  return (items_.capacity() + flushed_items_.capacity()) * sizeof(T) +
+         (eids_.capacity() + flushed_eids_.capacity()) * sizeof(EID) +
+         offsets_.capacity() * sizeof(std::uint32_t) +
+         cells_.capacity() * sizeof(std::pair<EID, std::uint32_t>) +
+         inserts_.capacity() * sizeof(Entry) +
+         erases_.capacity() * sizeof(EID) +
+         erased_slots_.capacity() * sizeof(std::uint32_t);
+}
+
+template <typename T>
+inline std::uint32_t SpatialIndex<T>::GetCellIndex(
+    glm::uvec2 cell) const noexcept {
+  assert(cell.x < size_.x && cell.y < size_.y && "cell out of grid");
+  return cell.y * size_.x + cell.x;
+}
+
+template <typename T>
+inline std::uint32_t SpatialIndex<T>::FindSlot(std::uint32_t cell,
+                                               EID eid) const noexcept {
+  auto slot = offsets_[cell];
+  while (eids_[slot] != eid) ++slot;
+  assert(slot < offsets_[cell + 1] && "entity not in its cell");
+  return slot;
+}
+
+template <typename T>
+inline void SpatialIndex<T>::Move(std::uint32_t slot, std::uint32_t from,
+                                  std::uint32_t to, T item) {
+  auto eid = eids_[slot];
+  // the slot becomes the last of each cell on the way, which then hands it
+  // over to the next, and the item that was there takes the old slot
+  auto hand_over = [this, &slot](std::uint32_t next) {
+    if (next != slot) {
+      items_[slot] = std::move(items_[next]);
+      eids_[slot] = eids_[next];
+      slot = next;
+    }
+  };
+  if (from < to) {
+    for (auto c = from; c != to; ++c) {
+      hand_over(offsets_[c + 1] - 1);
+      --offsets_[c + 1];
+    }
+  } else {
+    for (auto c = from; c != to; --c) {
+      hand_over(offsets_[c]);
+      ++offsets_[c];
+    }
+  }
+  items_[slot] = std::move(item);
+  eids_[slot] = eid;
+}
+
+}  // namespace einu
@@ -18,7 +18,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cassert>
 #include <chrono>
+#include <cstddef>
 #include <utility>
 
 #include "einu-engine/common/sgl_time.h"
@@ -27,12 +30,41 @@ namespace einu {
 namespace sys {
 
 inline void InitTime(sgl::Time& time) noexcept {
-  time.now = std::chrono::system_clock::now();
+  time.now = std::chrono::steady_clock::now();
 }
 
 inline void UpdateTime(sgl::Time& time) noexcept {
   std::swap(time.now, time.pre);
-  time.now = std::chrono::system_clock::now();
+  time.now = std::chrono::steady_clock::now();
+}
+
+// Adds the last frame of frame_time to the accumulator and works out how many
+// ticks the simulation runs this frame. Time beyond max_steps ticks is dropped,
+// so a load spike slows the simulation down instead of making the next frames
+// even longer.
+inline std::size_t AdvanceFixedStep(sgl::FixedStep& fixed_step,
+                                    const sgl::Time& frame_time) noexcept {
+  assert(fixed_step.step.count() > 0 && "fixed step must be positive");
+  fixed_step.accumulator += frame_time.now - frame_time.pre;
+  auto due = static_cast<std::size_t>(fixed_step.accumulator / fixed_step.step);
+  fixed_step.steps = std::min(due, fixed_step.max_steps);
+  fixed_step.accumulator -=
+      static_cast<sgl::FixedStep::Duration::rep>(fixed_step.steps) *
+      fixed_step.step;
+  if (due > fixed_step.max_steps) {
+    fixed_step.accumulator %= fixed_step.step;
+  }
+  fixed_step.alpha = std::chrono::duration<float>(fixed_step.accumulator) /
+                     std::chrono::duration<float>(fixed_step.step);
+  return fixed_step.steps;
+}
+
+// Moves time forward by exactly one tick, so that systems integrating with
+// DeltaSeconds see the fixed step.
+inline void StepTime(sgl::Time& time,
+                     const sgl::FixedStep& fixed_step) noexcept {
+  time.pre = time.now;
+  time.now += fixed_step.step;
 }
 
 }  // namespace sys
@@ -49,4 +49,14 @@ class Transform {
   glm::vec3 position_{0, 0, 0};
 };
 
+// Blends two transforms, from a at alpha 0 to b at alpha 1.
+inline Transform Interpolate(const Transform& a, const Transform& b,
+                             float alpha) noexcept {
+  auto transform = Transform{};
+  transform.SetPosition(glm::mix(a.GetPosition(), b.GetPosition(), alpha));
+  transform.SetRotation(glm::slerp(a.GetRotation(), b.GetRotation(), alpha));
+  transform.SetScale(glm::mix(a.GetScale(), b.GetScale(), alpha));
+  return transform;
+}
+
 }  // namespace einu
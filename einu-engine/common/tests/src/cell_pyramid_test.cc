@@ -0,0 +1,188 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/common/cell_pyramid.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace einu {
+
+namespace {
+
+struct Item {
+  glm::uvec2 cell;
+  std::uint32_t type;
+};
+
+// The items of each type in each cell, counted one by one.
+class CellCounts {
+ public:
+  explicit CellCounts(glm::uvec2 size)
+      : size_{size}, counts_(std::size_t{size.x} * size.y) {}
+
+  void Add(glm::uvec2 cell, std::uint32_t type, int delta) {
+    auto& counts = counts_[std::size_t{cell.y} * size_.x + cell.x];
+    for (std::size_t t = 0; t != counts.size(); ++t) {
+      if (type >> t & 1) counts[t] += delta;
+    }
+  }
+
+  std::uint32_t Get(glm::uvec2 cell, std::uint32_t mask) const {
+    const auto& counts = counts_[std::size_t{cell.y} * size_.x + cell.x];
+    auto count = 0;
+    for (std::size_t t = 0; t != counts.size(); ++t) {
+      if (mask >> t & 1) count += counts[t];
+    }
+    return static_cast<std::uint32_t>(count);
+  }
+
+ private:
+  glm::uvec2 size_;
+  std::vector<std::array<int, 8>> counts_;
+};
+
+// Checks that the runs of pyramid over the box from min to max stay in it,
+// do not overlap and cover every cell with items of the types in mask.
+// Returns the number of cells covered.
+std::size_t CheckRuns(const CellPyramid<>& pyramid, const CellCounts& counts,
+                      glm::uvec2 min, glm::uvec2 max, std::uint32_t mask) {
+  auto size = pyramid.GetSize();
+  auto covered = std::vector<int>(std::size_t{size.x} * size.y, 0);
+  auto covered_count = std::size_t{0};
+  pyramid.ForEachRow(
+      min, max, mask,
+      [&](std::uint32_t y, std::uint32_t x_begin, std::uint32_t x_end) {
+        EXPECT_LT(x_begin, x_end);
+        EXPECT_TRUE(y >= min.y && y <= max.y);
+        EXPECT_TRUE(x_begin >= min.x && x_end <= max.x + 1);
+        for (auto x = x_begin; x < x_end; ++x) {
+          ++covered[std::size_t{y} * size.x + x];
+          ++covered_count;
+        }
+      });
+  for (auto y = min.y; y <= max.y; ++y) {
+    for (auto x = min.x; x <= max.x; ++x) {
+      auto times = covered[std::size_t{y} * size.x + x];
+      EXPECT_LE(times, 1);
+      if (counts.Get({x, y}, mask) != 0) {
+        EXPECT_EQ(times, 1);
+      }
+    }
+  }
+  return covered_count;
+}
+
+}  // namespace
+
+TEST(CellPyramid, counts_and_runs_match_a_scan) {
+  auto generator = std::mt19937{29};
+  auto side = std::uniform_int_distribution<std::uint32_t>{1, 70};
+  auto operation = std::uniform_int_distribution<int>{0, 2};
+  auto common_type = std::uniform_int_distribution<int>{0, 1};
+  auto any_type = std::uniform_int_distribution<int>{0, 7};
+  auto mask = std::uniform_int_distribution<std::uint32_t>{0, 255};
+  for (int trial = 0; trial != 30; ++trial) {
+    auto size = glm::uvec2{side(generator), side(generator)};
+    auto pyramid = CellPyramid<>{size};
+    auto counts = CellCounts{size};
+    auto column = std::uniform_int_distribution<std::uint32_t>{0, size.x - 1};
+    auto row = std::uniform_int_distribution<std::uint32_t>{0, size.y - 1};
+    auto random_cell = [&] {
+      return glm::uvec2{column(generator), row(generator)};
+    };
+
+    // two common types and six rare ones
+    auto items = std::vector<Item>{};
+    for (int i = 0; i != 1000; ++i) {
+      auto op = operation(generator);
+      if (op == 0 || items.empty()) {
+        auto t = generator() % 4 == 0 ? any_type(generator)
+                                      : common_type(generator);
+        auto item = Item{random_cell(), std::uint32_t{1} << t};
+        items.push_back(item);
+        pyramid.Add(item.cell, item.type);
+        counts.Add(item.cell, item.type, 1);
+      } else if (op == 1) {
+        auto& item = items[generator() % items.size()];
+        auto to = random_cell();
+        pyramid.Move(item.cell, to, item.type);
+        counts.Add(item.cell, item.type, -1);
+        counts.Add(to, item.type, 1);
+        item.cell = to;
+      } else {
+        auto it = items.begin() + generator() % items.size();
+        pyramid.Remove(it->cell, it->type);
+        counts.Add(it->cell, it->type, -1);
+        items.erase(it);
+      }
+    }
+
+    for (int query = 0; query != 40; ++query) {
+      auto a = random_cell();
+      auto b = random_cell();
+      auto min = glm::uvec2{std::min(a.x, b.x), std::min(a.y, b.y)};
+      auto max = glm::uvec2{std::max(a.x, b.x), std::max(a.y, b.y)};
+      auto m = mask(generator);
+      CheckRuns(pyramid, counts, min, max, m);
+      auto cell = random_cell();
+      EXPECT_EQ(pyramid.GetCount(cell, m), counts.Get(cell, m));
+    }
+  }
+}
+
+TEST(CellPyramid, rare_items_are_found_without_covering_the_box) {
+  auto size = glm::uvec2{128, 128};
+  auto pyramid = CellPyramid<>{size};
+  auto counts = CellCounts{size};
+  // type 2 everywhere, type 1 in two cells
+  for (std::uint32_t y = 0; y != size.y; y += 2) {
+    for (std::uint32_t x = 0; x != size.x; x += 2) {
+      pyramid.Add({x, y}, 2);
+      counts.Add({x, y}, 2, 1);
+    }
+  }
+  for (auto cell : {glm::uvec2{5, 90}, glm::uvec2{100, 7}}) {
+    pyramid.Add(cell, 1);
+    counts.Add(cell, 1, 1);
+  }
+  auto corner = glm::uvec2{size.x - 1, size.y - 1};
+  EXPECT_LT(CheckRuns(pyramid, counts, {0, 0}, corner, 1),
+            size.x * size.y / 64);
+  EXPECT_EQ(CheckRuns(pyramid, counts, {0, 0}, corner, 4), 0);
+}
+
+TEST(CellPyramid, clear_drops_every_item) {
+  auto pyramid = CellPyramid<>{{9, 5}};
+  pyramid.Add({3, 3}, 1);
+  pyramid.Add({8, 4}, 2);
+  pyramid.Clear();
+  EXPECT_EQ(pyramid.GetCount({3, 3}, 0xff), 0);
+  auto runs = 0;
+  pyramid.ForEachRow(
+      {0, 0}, {8, 4}, 0xff,
+      [&](std::uint32_t, std::uint32_t, std::uint32_t) { ++runs; });
+  EXPECT_EQ(runs, 0);
+}
+
+}  // namespace einu
@@ -0,0 +1,162 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/common/grid.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace einu {
+
+namespace {
+
+// Sizes that are multiples of the tile sides and sizes that leave partial
+// tiles on the right, the bottom or both.
+const glm::uvec2 kSizes[] = {{1, 1},   {8, 8},   {13, 5}, {32, 32},
+                             {37, 70}, {64, 33}, {1, 40}, {100, 3}};
+
+// The id of a cell, unique within a grid.
+std::uint32_t CellId(glm::uvec2 size, std::uint32_t x, std::uint32_t y) {
+  return y * size.x + x;
+}
+
+}  // namespace
+
+template <typename Layout>
+struct GridLayoutTest : public testing::Test {};
+
+using Layouts =
+    testing::Types<RowMajorLayout, TiledLayout<8>, TiledLayout<4>,
+                   TiledLayout<16, true>, MortonLayout<8>, MortonLayout<32>>;
+TYPED_TEST_SUITE(GridLayoutTest, Layouts);
+
+TYPED_TEST(GridLayoutTest, index_is_a_bijection_onto_the_storage) {
+  for (auto size : kSizes) {
+    auto layout = TypeParam{size};
+    auto cell_count = std::size_t{size.x} * size.y;
+    auto hits = std::vector<int>(cell_count, 0);
+    for (std::uint32_t y = 0; y != size.y; ++y) {
+      for (std::uint32_t x = 0; x != size.x; ++x) {
+        auto index = layout.Index(x, y);
+        ASSERT_LT(index, cell_count);
+        ++hits[index];
+      }
+    }
+    for (auto hit : hits) ASSERT_EQ(hit, 1);
+  }
+}
+
+TYPED_TEST(GridLayoutTest, iteration_visits_every_cell_once) {
+  for (auto size : kSizes) {
+    auto grid = Grid<std::uint32_t, TypeParam>{size};
+    for (std::uint32_t y = 0; y != size.y; ++y) {
+      for (std::uint32_t x = 0; x != size.x; ++x) {
+        grid.At(x, y) = CellId(size, x, y);
+      }
+    }
+    auto seen = std::vector<int>(grid.GetTotalCellCount(), 0);
+    for (auto id : grid) ++seen[id];
+    for (auto count : seen) ASSERT_EQ(count, 1);
+    for (std::uint32_t y = 0; y != size.y; ++y) {
+      for (std::uint32_t x = 0; x != size.x; ++x) {
+        ASSERT_EQ(grid.At(glm::uvec2{x, y}), CellId(size, x, y));
+      }
+    }
+  }
+}
+
+TYPED_TEST(GridLayoutTest, boxes_match_a_row_major_grid) {
+  auto generator = std::mt19937{7};
+  for (auto size : kSizes) {
+    auto grid = Grid<std::uint32_t, TypeParam>{size};
+    auto row_major = Grid<std::uint32_t>{size};
+    for (std::uint32_t y = 0; y != size.y; ++y) {
+      for (std::uint32_t x = 0; x != size.x; ++x) {
+        grid.At(x, y) = row_major[y][x] = CellId(size, x, y);
+      }
+    }
+    auto column = std::uniform_int_distribution<std::uint32_t>{0, size.x - 1};
+    auto row = std::uniform_int_distribution<std::uint32_t>{0, size.y - 1};
+    for (int i = 0; i != 20; ++i) {
+      auto x = column(generator);
+      auto y = row(generator);
+      auto count_x = std::uniform_int_distribution<std::uint32_t>{
+          1, size.x - x}(generator);
+      auto count_y = std::uniform_int_distribution<std::uint32_t>{
+          1, size.y - y}(generator);
+      auto cells = std::vector<const std::uint32_t*>(count_x * count_y);
+      auto expected = std::vector<const std::uint32_t*>(count_x * count_y);
+      grid.GetCells(x, y, count_x, count_y, cells.data());
+      row_major.GetCells(x, y, count_x, count_y, expected.data());
+      for (std::size_t j = 0; j != cells.size(); ++j) {
+        ASSERT_EQ(*cells[j], *expected[j]);
+      }
+    }
+  }
+}
+
+TEST(GridLayout, row_major_rows_are_contiguous) {
+  auto size = glm::uvec2{7, 4};
+  auto grid = Grid<std::uint32_t>{size};
+  for (std::uint32_t y = 0; y != size.y; ++y) {
+    for (std::uint32_t x = 0; x != size.x; ++x) {
+      grid[y][x] = CellId(size, x, y);
+    }
+  }
+  for (std::uint32_t y = 0; y != size.y; ++y) {
+    for (std::uint32_t x = 0; x != size.x; ++x) {
+      EXPECT_EQ(grid.At(x, y), CellId(size, x, y));
+      EXPECT_EQ(&grid[y][x], &grid.At(x, y));
+    }
+  }
+}
+
+TEST(GridLayout, tiles_cut_short_at_the_edges_stay_dense) {
+  // a full 4 x 4 tile, then one 2 wide, then a row of tiles 2 high
+  auto layout = TiledLayout<4>{{6, 6}};
+  EXPECT_EQ(layout.Index(3, 3), 15);
+  EXPECT_EQ(layout.Index(4, 0), 16);
+  EXPECT_EQ(layout.Index(5, 1), 19);
+  EXPECT_EQ(layout.Index(5, 3), 23);
+  EXPECT_EQ(layout.Index(0, 4), 24);
+  EXPECT_EQ(layout.Index(3, 5), 31);
+  EXPECT_EQ(layout.Index(4, 4), 32);
+  EXPECT_EQ(layout.Index(5, 5), 35);
+}
+
+TEST(GridLayout, full_morton_tiles_are_in_z_order) {
+  auto layout = MortonLayout<4>{{8, 6}};
+  EXPECT_EQ(layout.Index(0, 0), 0);
+  EXPECT_EQ(layout.Index(1, 0), 1);
+  EXPECT_EQ(layout.Index(0, 1), 2);
+  EXPECT_EQ(layout.Index(1, 1), 3);
+  EXPECT_EQ(layout.Index(2, 0), 4);
+  EXPECT_EQ(layout.Index(0, 2), 8);
+  EXPECT_EQ(layout.Index(3, 3), 15);
+  EXPECT_EQ(layout.Index(4, 0), 16);
+  // the bottom tiles are cut short and row-major
+  EXPECT_EQ(layout.Index(0, 4), 32);
+  EXPECT_EQ(layout.Index(1, 4), 33);
+  EXPECT_EQ(layout.Index(0, 5), 36);
+  EXPECT_EQ(layout.Index(4, 4), 40);
+}
+
+}  // namespace einu
@@ -0,0 +1,143 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/common/point_query.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace einu {
+
+namespace {
+
+// Points on a small lattice, so that many lie at the same distance, with one
+// or no mask bit each.
+struct Points {
+  Points(std::size_t count, std::mt19937& generator)
+      : xs(count), ys(count), masks(count) {
+    auto coordinate = std::uniform_int_distribution<int>{0, 49};
+    auto bit = std::uniform_int_distribution<int>{-1, 3};
+    for (std::size_t i = 0; i != count; ++i) {
+      xs[i] = static_cast<float>(coordinate(generator));
+      ys[i] = static_cast<float>(coordinate(generator));
+      auto b = bit(generator);
+      masks[i] = b < 0 ? 0 : std::uint32_t{1} << b;
+    }
+  }
+
+  float Distance2(std::uint32_t i, glm::vec2 center) const {
+    auto dx = xs[i] - center.x;
+    auto dy = ys[i] - center.y;
+    return dx * dx + dy * dy;
+  }
+
+  // The matching points in order, by a plain scan.
+  std::vector<std::uint32_t> Scan(glm::vec2 center, float radius,
+                                  std::uint32_t mask) const {
+    auto found = std::vector<std::uint32_t>{};
+    for (std::uint32_t i = 0; i != xs.size(); ++i) {
+      if ((masks[i] & ~mask) == 0 && Distance2(i, center) < radius * radius) {
+        found.push_back(i);
+      }
+    }
+    return found;
+  }
+
+  std::vector<float> xs;
+  std::vector<float> ys;
+  std::vector<std::uint32_t> masks;
+};
+
+}  // namespace
+
+TEST(PointQuery, find_in_radius_matches_a_scan) {
+  auto generator = std::mt19937{19};
+  auto count = std::uniform_int_distribution<std::size_t>{0, 70};
+  auto coordinate = std::uniform_int_distribution<int>{0, 49};
+  auto radius = std::uniform_int_distribution<int>{0, 79};
+  auto mask = std::uniform_int_distribution<std::uint32_t>{0, 15};
+  for (int i = 0; i != 2000; ++i) {
+    auto points = Points{count(generator), generator};
+    auto center = glm::vec2{static_cast<float>(coordinate(generator)),
+                            static_cast<float>(coordinate(generator))};
+    // half of the radii fall on the lattice, so points lie on the circle
+    auto r = static_cast<float>(radius(generator)) / 2;
+    auto m = mask(generator);
+    auto out = std::vector<std::uint32_t>(points.xs.size() + 1);
+    auto found = FindInRadius(points.xs.data(), points.ys.data(),
+                              points.masks.data(), points.xs.size(), center, r,
+                              m, out.data());
+    out.resize(found);
+    ASSERT_EQ(out, points.Scan(center, r, m));
+  }
+}
+
+TEST(PointQuery, find_nearest_matches_a_sorted_scan) {
+  auto generator = std::mt19937{23};
+  auto count = std::uniform_int_distribution<std::size_t>{0, 70};
+  auto coordinate = std::uniform_int_distribution<int>{0, 49};
+  auto radius = std::uniform_int_distribution<int>{0, 79};
+  auto mask = std::uniform_int_distribution<std::uint32_t>{0, 15};
+  auto nearest = std::uniform_int_distribution<std::size_t>{0, 9};
+  for (int i = 0; i != 2000; ++i) {
+    auto points = Points{count(generator), generator};
+    auto center = glm::vec2{static_cast<float>(coordinate(generator)),
+                            static_cast<float>(coordinate(generator))};
+    auto r = static_cast<float>(radius(generator)) / 2;
+    auto m = mask(generator);
+    auto k = nearest(generator);
+
+    auto expected = points.Scan(center, r, m);
+    std::sort(expected.begin(), expected.end(), [&](auto a, auto b) {
+      return std::tuple{points.Distance2(a, center), a} <
+             std::tuple{points.Distance2(b, center), b};
+    });
+    expected.resize(std::min(k, expected.size()));
+
+    auto out = std::vector<std::uint32_t>(k);
+    auto found = FindNearest(points.xs.data(), points.ys.data(),
+                             points.masks.data(), points.xs.size(), center, r,
+                             m, k, out.data());
+    out.resize(found);
+    ASSERT_EQ(out, expected);
+  }
+}
+
+TEST(PointQuery, points_on_the_circle_are_outside) {
+  auto xs = std::vector<float>{3, 0, 2};
+  auto ys = std::vector<float>{0, 4, 0};
+  auto masks = std::vector<std::uint32_t>{0, 0, 1};
+  auto out = std::vector<std::uint32_t>(3);
+  EXPECT_EQ(FindInRadius(xs.data(), ys.data(), masks.data(), 3, {0, 0}, 3, 1,
+                         out.data()),
+            1);
+  EXPECT_EQ(out[0], 2);
+  // the mask bit of point 2 is not in the query's mask
+  EXPECT_EQ(FindInRadius(xs.data(), ys.data(), masks.data(), 3, {0, 0}, 5, 0,
+                         out.data()),
+            2);
+  EXPECT_EQ(out[0], 0);
+  EXPECT_EQ(out[1], 1);
+}
+
+}  // namespace einu
@@ -0,0 +1,148 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/common/spatial_hash.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "einu-engine/core/job_system.h"
+#include "gtest/gtest.h"
+
+namespace einu {
+
+namespace {
+
+struct Item {
+  std::uint32_t id;
+  glm::uvec2 cell;
+};
+
+// Hashes count items at random cells of a grid of size, built one way or the
+// other, and keeps the ids of each cell in insertion order for comparison.
+struct Items {
+  Items(glm::uvec2 size, std::uint32_t count, std::mt19937& generator)
+      : hash{size}, ids(std::size_t{size.x} * size.y) {
+    auto x = std::uniform_int_distribution<std::uint32_t>{0, size.x - 1};
+    auto y = std::uniform_int_distribution<std::uint32_t>{0, size.y - 1};
+    for (std::uint32_t id = 0; id != count; ++id) {
+      auto cell = glm::uvec2{x(generator), y(generator)};
+      hash.Insert(cell, {id, cell});
+      ids[std::size_t{cell.y} * size.x + cell.x].push_back(id);
+    }
+  }
+
+  // Compares every cell of the hash with a scan of the items inserted.
+  void Check() const {
+    auto size = hash.GetSize();
+    auto total = std::size_t{0};
+    for (std::uint32_t y = 0; y != size.y; ++y) {
+      for (std::uint32_t x = 0; x != size.x; ++x) {
+        auto got = std::vector<std::uint32_t>{};
+        for (const auto& item : hash.GetCell({x, y})) {
+          EXPECT_EQ(item.cell, (glm::uvec2{x, y}));
+          got.push_back(item.id);
+        }
+        EXPECT_EQ(got, ids[std::size_t{y} * size.x + x]);
+        total += got.size();
+      }
+    }
+    EXPECT_EQ(hash.GetItems().size(), total);
+  }
+
+  SpatialHash<Item> hash;
+  std::vector<std::vector<std::uint32_t>> ids;
+};
+
+}  // namespace
+
+TEST(SpatialHash, cells_hold_their_items_in_insertion_order) {
+  auto generator = std::mt19937{3};
+  auto side = std::uniform_int_distribution<std::uint32_t>{1, 50};
+  auto count = std::uniform_int_distribution<std::uint32_t>{0, 3000};
+  for (int i = 0; i != 20; ++i) {
+    auto size = glm::uvec2{side(generator), side(generator)};
+    auto items = Items{size, count(generator), generator};
+    items.hash.Build();
+    items.Check();
+  }
+}
+
+TEST(SpatialHash, jobs_build_the_same_order) {
+  auto generator = std::mt19937{5};
+  auto jobs = JobSystem{3};
+  auto side = std::uniform_int_distribution<std::uint32_t>{1, 50};
+  auto count = std::uniform_int_distribution<std::uint32_t>{0, 3000};
+  for (int i = 0; i != 20; ++i) {
+    auto size = glm::uvec2{side(generator), side(generator)};
+    auto items = Items{size, count(generator), generator};
+    items.hash.Build(jobs, 1 + generator() % 9);
+    items.Check();
+  }
+}
+
+TEST(SpatialHash, rows_of_a_box_hold_the_items_inside_it) {
+  auto generator = std::mt19937{7};
+  auto size = glm::uvec2{37, 23};
+  auto items = Items{size, 2000, generator};
+  items.hash.Build();
+  auto column = std::uniform_int_distribution<std::uint32_t>{0, size.x - 1};
+  auto row = std::uniform_int_distribution<std::uint32_t>{0, size.y - 1};
+  for (int i = 0; i != 50; ++i) {
+    auto a = glm::uvec2{column(generator), row(generator)};
+    auto b = glm::uvec2{column(generator), row(generator)};
+    auto min = glm::uvec2{std::min(a.x, b.x), std::min(a.y, b.y)};
+    auto max = glm::uvec2{std::max(a.x, b.x), std::max(a.y, b.y)};
+    auto found = std::size_t{0};
+    items.hash.ForEachRow(min, max, [&](const auto& items_of_row) {
+      for (const auto& item : items_of_row) {
+        EXPECT_TRUE(item.cell.x >= min.x && item.cell.x <= max.x &&
+                    item.cell.y >= min.y && item.cell.y <= max.y);
+        ++found;
+      }
+    });
+    auto expected = std::size_t{0};
+    for (auto y = min.y; y <= max.y; ++y) {
+      for (auto x = min.x; x <= max.x; ++x) {
+        expected += items.ids[std::size_t{y} * size.x + x].size();
+      }
+    }
+    EXPECT_EQ(found, expected);
+  }
+}
+
+TEST(SpatialHash, build_replaces_the_items) {
+  auto generator = std::mt19937{11};
+  auto size = glm::uvec2{8, 8};
+  auto items = Items{size, 100, generator};
+  items.hash.Build();
+  items.hash.Insert({2, 3}, {7, {2, 3}});
+  EXPECT_EQ(items.hash.GetItems().size(), 100);
+  items.hash.Build();
+  ASSERT_EQ(items.hash.GetItems().size(), 1);
+  EXPECT_EQ(items.hash.GetCell({2, 3})[0].id, 7);
+
+  items.hash.Insert({4, 4}, {8, {4, 4}});
+  items.hash.Clear();
+  items.hash.Build();
+  EXPECT_TRUE(items.hash.GetItems().empty());
+}
+
+}  // namespace einu
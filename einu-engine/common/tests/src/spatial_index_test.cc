@@ -0,0 +1,171 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/common/spatial_index.h"
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace einu {
+
+namespace {
+
+struct Item {
+  EID eid;
+  int value;
+};
+
+// What an index should hold: the cell and value of each entity.
+using Expected = std::map<EID, std::pair<glm::uvec2, int>>;
+
+// Compares every cell, row and lookup of index with expected.
+void CheckIndex(const SpatialIndex<Item>& index, const Expected& expected) {
+  auto size = index.GetSize();
+  auto count = std::size_t{0};
+  for (std::uint32_t y = 0; y != size.y; ++y) {
+    auto row_count = std::size_t{0};
+    for (std::uint32_t x = 0; x != size.x; ++x) {
+      for (const auto& item : index.GetCell({x, y})) {
+        auto it = expected.find(item.eid);
+        ASSERT_NE(it, expected.end());
+        EXPECT_EQ(it->second.first, (glm::uvec2{x, y}));
+        EXPECT_EQ(it->second.second, item.value);
+        ++row_count;
+      }
+    }
+    EXPECT_EQ(index.GetRow(y, 0, size.x).size(), row_count);
+    count += row_count;
+  }
+  EXPECT_EQ(count, expected.size());
+  EXPECT_EQ(index.GetItems().size(), expected.size());
+  for (const auto& [eid, cell_value] : expected) {
+    ASSERT_TRUE(index.Contains(eid));
+    EXPECT_EQ(index.Find(eid)->value, cell_value.second);
+  }
+}
+
+}  // namespace
+
+TEST(SpatialIndex, random_changes_match_a_map) {
+  auto size = glm::uvec2{13, 7};
+  auto index = SpatialIndex<Item>{size};
+  // as of the last flush, and with the queued changes applied
+  auto flushed = Expected{};
+  auto queued = Expected{};
+  auto generator = std::mt19937{13};
+  auto eids = std::uniform_int_distribution<EID>{0, 299};
+  auto column = std::uniform_int_distribution<std::uint32_t>{0, size.x - 1};
+  auto row = std::uniform_int_distribution<std::uint32_t>{0, size.y - 1};
+  auto operation = std::uniform_int_distribution<int>{0, 9};
+  for (int step = 0; step != 30000; ++step) {
+    auto eid = eids(generator);
+    auto cell = glm::uvec2{column(generator), row(generator)};
+    auto value = static_cast<int>(generator() % 1000);
+    auto op = operation(generator);
+    auto in_queued = queued.count(eid) != 0;
+    auto in_flushed = flushed.count(eid) != 0;
+    if (op < 2) {
+      if (in_queued) continue;
+      index.Insert(eid, cell, {eid, value});
+      queued[eid] = {cell, value};
+    } else if (op < 4) {
+      index.Erase(eid);
+      queued.erase(eid);
+      // queries still see the entity until the flush
+      EXPECT_EQ(index.Contains(eid), in_flushed);
+    } else if (op == 4) {
+      index.Flush();
+      flushed = queued;
+      CheckIndex(index, flushed);
+    } else if (in_queued && in_flushed && queued[eid] == flushed[eid]) {
+      auto moved = index.Update(eid, cell, {eid, value});
+      EXPECT_EQ(moved, flushed[eid].first != cell);
+      queued[eid] = flushed[eid] = {cell, value};
+    }
+  }
+  index.Flush();
+  CheckIndex(index, queued);
+}
+
+TEST(SpatialIndex, changes_wait_for_the_flush) {
+  auto index = SpatialIndex<Item>{{4, 4}};
+  index.Insert(1, {2, 2}, {1, 10});
+  EXPECT_FALSE(index.Contains(1));
+  EXPECT_TRUE(index.GetCell({2, 2}).empty());
+  index.Flush();
+  EXPECT_TRUE(index.Contains(1));
+  EXPECT_EQ(index.GetCell({2, 2}).size(), 1);
+
+  EXPECT_FALSE(index.Erase(1).has_value());
+  EXPECT_TRUE(index.Contains(1));
+  index.Flush();
+  EXPECT_FALSE(index.Contains(1));
+  EXPECT_TRUE(index.GetItems().empty());
+}
+
+TEST(SpatialIndex, erase_drops_a_queued_insert) {
+  auto index = SpatialIndex<Item>{{4, 4}};
+  index.Insert(1, {0, 3}, {1, 10});
+  index.Insert(2, {3, 0}, {2, 20});
+  auto dropped = index.Erase(1);
+  ASSERT_TRUE(dropped.has_value());
+  EXPECT_EQ(dropped->eid, 1);
+  EXPECT_EQ(dropped->cell, (glm::uvec2{0, 3}));
+  EXPECT_EQ(dropped->item.value, 10);
+  index.Flush();
+  CheckIndex(index, {{2, {{3, 0}, 20}}});
+}
+
+TEST(SpatialIndex, erase_then_insert_moves_an_entity_on_flush) {
+  auto index = SpatialIndex<Item>{{4, 4}};
+  index.Insert(1, {0, 0}, {1, 10});
+  index.Flush();
+  index.Erase(1);
+  index.Insert(1, {3, 3}, {1, 11});
+  index.Flush();
+  CheckIndex(index, {{1, {{3, 3}, 11}}});
+}
+
+TEST(SpatialIndex, assign_replaces_everything) {
+  auto size = glm::uvec2{9, 6};
+  auto index = SpatialIndex<Item>{size};
+  index.Insert(100, {1, 1}, {100, 0});
+  index.Flush();
+
+  auto generator = std::mt19937{17};
+  auto column = std::uniform_int_distribution<std::uint32_t>{0, size.x - 1};
+  auto row = std::uniform_int_distribution<std::uint32_t>{0, size.y - 1};
+  auto entries = std::vector<SpatialIndex<Item>::Entry>{};
+  auto expected = Expected{};
+  for (EID eid = 0; eid != 80; ++eid) {
+    auto cell = glm::uvec2{column(generator), row(generator)};
+    auto value = static_cast<int>(eid) * 3;
+    entries.push_back({eid, cell, {eid, value}});
+    expected[eid] = {cell, value};
+  }
+  index.Assign(entries);
+  CheckIndex(index, expected);
+  EXPECT_FALSE(index.Contains(100));
+}
+
+}  // namespace einu
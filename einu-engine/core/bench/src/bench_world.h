@@ -0,0 +1,75 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+#include "einu-engine/core/internal/eid_pool.h"
+#include "einu-engine/core/internal/entity_manager.h"
+#include "einu-engine/core/internal/xnent_pool.h"
+#include "einu-engine/core/internal/xnent_type_id_register.h"
+#include "einu-engine/core/xnent.h"
+#include "einu-engine/core/xnent_list.h"
+
+namespace einu {
+namespace bench {
+
+template <std::size_t index>
+struct B : public Xnent {
+  float value = 0;
+};
+
+namespace internal {
+
+template <std::size_t... Is>
+XnentList<B<Is>...> MakeBList(std::index_sequence<Is...>);
+
+}  // namespace internal
+
+// XnentList<B<0>, ..., B<count - 1>>
+template <std::size_t count>
+using BList = decltype(internal::MakeBList(std::make_index_sequence<count>{}));
+
+inline constexpr std::size_t kMaxBCount = 8;
+
+struct World {
+  using ComponentList = BList<kMaxBCount>;
+  using EntityManager = einu::internal::EntityManager<16, 16>;
+
+  World() {
+    ett_mgr.SetComponentPool(comp_pool);
+    ett_mgr.SetEIDPool(eid_pool);
+  }
+
+  einu::internal::XnentTypeIDRegister<ComponentList> reg;
+  einu::internal::XnentPool<ComponentList> comp_pool;
+  einu::internal::EIDPool eid_pool;
+  EntityManager ett_mgr;
+};
+
+// 1e3 through 1e7
+inline void EntityCounts(benchmark::internal::Benchmark* bench) {
+  bench->RangeMultiplier(10)->Range(1'000, 10'000'000);
+  bench->Unit(benchmark::kMicrosecond);
+}
+
+}  // namespace bench
+}  // namespace einu
@@ -0,0 +1,39 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "benchmark/benchmark.h"
+#include "einu-engine/core/util/bit.h"
+#include "src/bench_world.h"
+
+namespace einu {
+namespace bench {
+
+// Worst case: only the last bit is set.
+void BM_BitVectorCountlZero(benchmark::State& state) {
+  auto count = static_cast<std::size_t>(state.range(0));
+  auto vec = util::BitVector(count, false);
+  vec.set(count - 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(vec.countl_zero());
+  }
+  state.SetBytesProcessed(state.iterations() * count / 8);
+}
+BENCHMARK(BM_BitVectorCountlZero)->Apply(EntityCounts);
+
+}  // namespace bench
+}  // namespace einu
@@ -0,0 +1,150 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/bench_world.h"
+
+namespace einu {
+namespace bench {
+
+void BM_CreateEntity(benchmark::State& state) {
+  auto count = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    {
+      auto world = World{};
+      state.ResumeTiming();
+      for (std::size_t i = 0; i != count; ++i) {
+        benchmark::DoNotOptimize(world.ett_mgr.CreateEntity());
+      }
+      state.PauseTiming();
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_CreateEntity)->Apply(EntityCounts);
+
+void BM_DestroyEntity(benchmark::State& state) {
+  auto count = static_cast<std::size_t>(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    {
+      auto world = World{};
+      for (std::size_t i = 0; i != count; ++i) {
+        world.ett_mgr.AddComponent<B<0>>(world.ett_mgr.CreateEntity());
+      }
+      state.ResumeTiming();
+      for (EID eid = 0; eid != count; ++eid) {
+        world.ett_mgr.DestroyEntity(eid);
+      }
+      state.PauseTiming();
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DestroyEntity)->Apply(EntityCounts);
+
+void BM_DestroyEntities(benchmark::State& state) {
+  auto count = static_cast<std::size_t>(state.range(0));
+  // a long-lived world, as in a game where waves of entities die off
+  auto world = World{};
+  auto eids = std::vector<EID>{};
+  for (auto _ : state) {
+    state.PauseTiming();
+    eids.clear();
+    for (std::size_t i = 0; i != count; ++i) {
+      eids.push_back(world.ett_mgr.CreateEntity());
+      world.ett_mgr.AddComponent<B<0>>(eids.back());
+    }
+    state.ResumeTiming();
+    world.ett_mgr.DestroyEntities(eids.data(), eids.size());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_DestroyEntities)->Apply(EntityCounts);
+
+void BM_AddRemoveComponent(benchmark::State& state) {
+  auto count = static_cast<std::size_t>(state.range(0));
+  auto world = World{};
+  for (std::size_t i = 0; i != count; ++i) {
+    world.ett_mgr.CreateEntity();
+  }
+  for (auto _ : state) {
+    for (EID eid = 0; eid != count; ++eid) {
+      world.ett_mgr.AddComponent<B<0>>(eid);
+    }
+    for (EID eid = 0; eid != count; ++eid) {
+      world.ett_mgr.RemoveComponent<B<0>>(eid);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count * 2);
+}
+BENCHMARK(BM_AddRemoveComponent)->Apply(EntityCounts);
+
+void BM_GetComponentRandom(benchmark::State& state) {
+  auto count = static_cast<std::size_t>(state.range(0));
+  auto world = World{};
+  auto eids = std::vector<EID>{};
+  for (std::size_t i = 0; i != count; ++i) {
+    auto eid = world.ett_mgr.CreateEntity();
+    world.ett_mgr.AddComponent<B<0>>(eid).value = static_cast<float>(i);
+    eids.push_back(eid);
+  }
+  std::shuffle(eids.begin(), eids.end(), std::mt19937{42});
+  for (auto _ : state) {
+    auto sum = 0.f;
+    for (auto eid : eids) {
+      sum += world.ett_mgr.GetComponent<B<0>>(eid).value;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_GetComponentRandom)->Apply(EntityCounts);
+
+void BM_GetComponentsRandom(benchmark::State& state) {
+  auto count = static_cast<std::size_t>(state.range(0));
+  auto world = World{};
+  auto eids = std::vector<EID>{};
+  for (std::size_t i = 0; i != count; ++i) {
+    auto eid = world.ett_mgr.CreateEntity();
+    world.ett_mgr.AddComponent<B<0>>(eid).value = static_cast<float>(i);
+    eids.push_back(eid);
+  }
+  std::shuffle(eids.begin(), eids.end(), std::mt19937{42});
+  auto comps = std::vector<B<0>*>(count);
+  for (auto _ : state) {
+    world.ett_mgr.GetComponents(eids.data(), count, comps.data());
+    auto sum = 0.f;
+    for (auto comp : comps) {
+      sum += comp->value;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_GetComponentsRandom)->Apply(EntityCounts);
+
+}  // namespace bench
+}  // namespace einu
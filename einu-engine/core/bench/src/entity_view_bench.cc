@@ -0,0 +1,61 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <tuple>
+
+#include "benchmark/benchmark.h"
+#include "einu-engine/core/entity_view.h"
+#include "einu-engine/core/tmp/static_algo.h"
+#include "src/bench_world.h"
+
+namespace einu {
+namespace bench {
+
+// Every entity has all kMaxBCount components; the view asks for the first
+// comp_count of them.
+template <std::size_t comp_count>
+void BM_ViewIterate(benchmark::State& state) {
+  auto count = static_cast<std::size_t>(state.range(0));
+  auto world = World{};
+  for (std::size_t i = 0; i != count; ++i) {
+    auto eid = world.ett_mgr.CreateEntity();
+    tmp::static_for<0, kMaxBCount>(
+        [&](auto j) { world.ett_mgr.AddComponent<B<j>>(eid); });
+  }
+  auto view = EntityView<BList<comp_count>>{};
+  for (auto _ : state) {
+    view.View(world.ett_mgr);
+    auto sum = 0.f;
+    for (auto&& comps : view.Components()) {
+      sum += std::get<0>(comps).value;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_TEMPLATE(BM_ViewIterate, 1)->Apply(EntityCounts);
+BENCHMARK_TEMPLATE(BM_ViewIterate, 2)->Apply(EntityCounts);
+BENCHMARK_TEMPLATE(BM_ViewIterate, 3)->Apply(EntityCounts);
+BENCHMARK_TEMPLATE(BM_ViewIterate, 4)->Apply(EntityCounts);
+BENCHMARK_TEMPLATE(BM_ViewIterate, 5)->Apply(EntityCounts);
+BENCHMARK_TEMPLATE(BM_ViewIterate, 6)->Apply(EntityCounts);
+BENCHMARK_TEMPLATE(BM_ViewIterate, 7)->Apply(EntityCounts);
+BENCHMARK_TEMPLATE(BM_ViewIterate, 8)->Apply(EntityCounts);
+
+}  // namespace bench
+}  // namespace einu
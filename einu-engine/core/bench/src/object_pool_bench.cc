@@ -0,0 +1,59 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "einu-engine/core/internal/pool_policy.h"
+#include "einu-engine/core/util/object_pool.h"
+#include "src/bench_world.h"
+
+namespace einu {
+namespace bench {
+
+// Releases and reacquires up to 1024 random objects of a full pool that grew
+// from empty with the default growth.
+void BM_DynamicPoolChurn(benchmark::State& state) {
+  auto count = static_cast<std::size_t>(state.range(0));
+  auto churn_count = std::min(count, std::size_t{1024});
+  auto pool = util::DynamicPool<B<0>>{
+      0, nullptr, einu::internal::DefaultGrowFunc};
+  auto objs = std::vector<B<0>*>{};
+  for (std::size_t i = 0; i != count; ++i) {
+    objs.push_back(&pool.Acquire());
+  }
+  auto generator = std::mt19937{42};
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::shuffle(objs.begin(), objs.end(), generator);
+    state.ResumeTiming();
+    for (std::size_t i = 0; i != churn_count; ++i) {
+      pool.Release(*objs[i]);
+    }
+    for (std::size_t i = 0; i != churn_count; ++i) {
+      objs[i] = &pool.Acquire();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * churn_count * 2);
+}
+BENCHMARK(BM_DynamicPoolChurn)->Apply(EntityCounts);
+
+}  // namespace bench
+}  // namespace einu
@@ -0,0 +1,86 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cstddef>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "einu-engine/core/snapshot.h"
+#include "src/bench_world.h"
+
+namespace einu {
+namespace bench {
+
+using BenchSnapshot = WorldSnapshot<BList<4>, XnentList<>>;
+
+// Every entity has B<0>; the other components are spread over some of them.
+std::vector<char> SaveWorld(std::size_t count) {
+  auto world = World{};
+  for (std::size_t i = 0; i != count; ++i) {
+    auto eid = world.ett_mgr.CreateEntity();
+    world.ett_mgr.AddComponent<B<0>>(eid).value = static_cast<float>(i);
+    if (i % 2) world.ett_mgr.AddComponent<B<1>>(eid);
+    if (i % 3) world.ett_mgr.AddComponent<B<2>>(eid);
+    if (i % 4 == 0) world.ett_mgr.AddComponent<B<3>>(eid);
+  }
+  auto buffer = std::vector<char>{};
+  BenchSnapshot::Save(world.ett_mgr, buffer);
+  return buffer;
+}
+
+// 1e4 through 1e6
+void SnapshotEntityCounts(benchmark::internal::Benchmark* bench) {
+  bench->RangeMultiplier(10)->Range(10'000, 1'000'000);
+  bench->Unit(benchmark::kMillisecond);
+}
+
+void BM_SnapshotSave(benchmark::State& state) {
+  auto count = static_cast<std::size_t>(state.range(0));
+  auto snapshot = SaveWorld(count);
+  auto world = World{};
+  BenchSnapshot::Load(world.ett_mgr, snapshot.data(), snapshot.size());
+  auto buffer = std::vector<char>{};
+  for (auto _ : state) {
+    BenchSnapshot::Save(world.ett_mgr, buffer);
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  state.SetBytesProcessed(state.iterations() * snapshot.size());
+}
+BENCHMARK(BM_SnapshotSave)->Apply(SnapshotEntityCounts);
+
+void BM_SnapshotLoad(benchmark::State& state) {
+  auto count = static_cast<std::size_t>(state.range(0));
+  auto snapshot = SaveWorld(count);
+  for (auto _ : state) {
+    state.PauseTiming();
+    {
+      auto world = World{};
+      state.ResumeTiming();
+      BenchSnapshot::Load(world.ett_mgr, snapshot.data(), snapshot.size());
+      state.PauseTiming();
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  state.SetBytesProcessed(state.iterations() * snapshot.size());
+}
+BENCHMARK(BM_SnapshotLoad)->Apply(SnapshotEntityCounts);
+
+}  // namespace bench
+}  // namespace einu
@@ -18,10 +18,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <tuple>
 #include <vector>
 
 #include "einu-engine/core/i_entity_manager.h"
+#include "einu-engine/core/trace.h"
 #include "einu-engine/core/xnent_list.h"
 
 namespace einu {
@@ -29,15 +31,19 @@ namespace einu {
 template <typename ComponentList>
 class ComponentIterator;
 
+// Walks the component pointers of a view, one entity at a time. Tags have no
+// pointers in the buffer, so they are left out of the stride.
 template <typename... Comps>
 class ComponentIterator<XnentList<Comps...>> {
  public:
   using Itr = std::vector<Xnent*>::const_iterator;
 
-  constexpr explicit ComponentIterator(Itr itr) noexcept : itr_(itr) {}
+  constexpr explicit ComponentIterator(Itr itr, std::size_t index = 0) noexcept
+      : itr_(itr), index_(index) {}
 
   constexpr ComponentIterator& operator++() noexcept {
-    std::advance(itr_, sizeof...(Comps));
+    std::advance(itr_, kStride);
+    ++index_;
     return *this;
   }
 
@@ -48,7 +54,7 @@ class ComponentIterator<XnentList<Comps...>> {
   }
 
   constexpr bool operator==(ComponentIterator other) const noexcept {
-    return itr_ == other.itr_;
+    return index_ == other.index_;
   }
 
   constexpr bool operator!=(ComponentIterator other) const noexcept {
@@ -60,32 +66,52 @@ class ComponentIterator<XnentList<Comps...>> {
   }
 
  private:
+  using TypeList = tmp::TypeList<Comps...>;
+
+  static constexpr std::size_t kStride =
+      (std::size_t{0} + ... + !IsTag<Comps>::value);
+
+  template <typename T>
+  static constexpr std::size_t PointerIndexOf() noexcept {
+    constexpr bool has_pointer[] = {!IsTag<Comps>::value...};
+    auto index = std::size_t{0};
+    for (std::size_t i = 0; i != tmp::IndexOf<TypeList, T>::value; ++i) {
+      index += has_pointer[i];
+    }
+    return index;
+  }
+
   template <typename T>
   T& DeRef() const noexcept {
-    using TypeList = tmp::TypeList<Comps...>;
-    return static_cast<T&>(**std::next(itr_, tmp::IndexOf<TypeList, T>::value));
+    if constexpr (IsTag<T>::value) {
+      return GetTagInstance<T>();
+    } else {
+      return static_cast<T&>(**std::next(itr_, PointerIndexOf<T>()));
+    }
   }
 
   Itr itr_;
+  std::size_t index_;
 };
 
 template <typename ComponentList>
 class ComponentBufferView {
  public:
-  constexpr explicit ComponentBufferView(
-      const std::vector<Xnent*>& comps) noexcept
-      : comps_(comps) {}
+  constexpr ComponentBufferView(const std::vector<Xnent*>& comps,
+                                std::size_t size) noexcept
+      : comps_(comps), size_(size) {}
 
   auto begin() const noexcept {
     return ComponentIterator<ComponentList>{comps_.begin()};
   }
 
   auto end() const noexcept {
-    return ComponentIterator<ComponentList>{comps_.end()};
+    return ComponentIterator<ComponentList>{comps_.end(), size_};
   }
 
  private:
   const std::vector<Xnent*>& comps_;
+  std::size_t size_;
 };
 
 class EIDBufferView {
@@ -107,12 +133,13 @@ class EntityView {
   using ComponentsView = ComponentBufferView<ComponentList>;
 
   void View(IEntityManager& ett_mgr) {
+    EINU_TRACE_SCOPE("EntityView::View");
     Clear(ett_buffer_);
     ett_mgr.GetEntitiesWithComponents(ett_buffer_, ComponentList{});
   }
 
   ComponentsView Components() const noexcept {
-    return ComponentsView{ett_buffer_.comps};
+    return ComponentsView{ett_buffer_.comps, ett_buffer_.eids.size()};
   }
 
   EIDBufferView EIDs() const noexcept {
@@ -121,8 +148,32 @@ class EntityView {
 
   auto Size() const noexcept { return ett_buffer_.eids.size(); }
 
+  std::size_t BufferBytes() const noexcept {
+    return ett_buffer_.comps.capacity() * sizeof(Xnent*) +
+           ett_buffer_.eids.capacity() * sizeof(EID);
+  }
+
  private:
   EntityBuffer ett_buffer_;
 };
 
+// Destroys the entities of a viewed EntityView whose components satisfy
+// pred, a callable taking the components of the view in order. doomed is
+// scratch space for their EIDs, kept by the caller so that die-offs frame
+// after frame do not allocate.
+template <typename ComponentList, typename Pred>
+void DestroyIf(IEntityManager& ett_mgr, const EntityView<ComponentList>& view,
+               Pred pred, std::vector<EID>& doomed) {
+  EINU_TRACE_SCOPE("DestroyIf");
+  doomed.clear();
+  auto eid_it = view.EIDs().begin();
+  for (auto&& comps : view.Components()) {
+    if (std::apply(pred, comps)) {
+      doomed.push_back(*eid_it);
+    }
+    ++eid_it;
+  }
+  ett_mgr.DestroyEntities(doomed.data(), doomed.size());
+}
+
 }  // namespace einu
@@ -30,9 +30,13 @@ class IEIDPool {
 
   void Release(EID eid) noexcept { ReleaseImpl(eid); }
 
+  // Marks `eid` as in use so that later calls to Acquire never return it.
+  void Reserve(EID eid) noexcept { ReserveImpl(eid); }
+
  private:
   virtual EID AcquireImpl() noexcept = 0;
   virtual void ReleaseImpl(EID eid) noexcept = 0;
+  virtual void ReserveImpl(EID eid) noexcept = 0;
 };
 
 }  // namespace einu
@@ -18,18 +18,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <type_traits>
 #include <vector>
 
 #include "einu-engine/core/i_eid_pool.h"
 #include "einu-engine/core/i_xnent_pool.h"
 #include "einu-engine/core/internal/pool_policy.h"
 #include "einu-engine/core/internal/xnent_mask.h"
+#include "einu-engine/core/memory_stats.h"
 #include "einu-engine/core/xnent_list.h"
 
-#ifdef EINU_CORE_PROFILE
-#include "easy/profiler.h"
-#endif
-
 namespace einu {
 
 struct EntityBuffer {
@@ -60,153 +59,176 @@ class IEntityManager {
 
   void SetPolicy(Policy policy) noexcept { SetPolicyImpl(policy); }
 
-  EID CreateEntity() {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
-    return CreateEntityImpl();
-  }
+  EID CreateEntity() { return CreateEntityImpl(); }
 
-  void DestroyEntity(EID eid) {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
-    DestroyEntityImpl(eid);
+  // Creates an entity with a known EID, e.g. when restoring a snapshot. The
+  // EID must not belong to a living entity.
+  void CreateEntity(EID eid) { CreateEntityImpl(eid); }
+
+  // Same as calling CreateEntity on each of the count eids, but acquires the
+  // entity data in one go.
+  void CreateEntities(const EID* eids, std::size_t count) {
+    CreateEntitiesImpl(eids, count);
   }
 
-  bool ContainsEntity(EID eid) const {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
-    return ContainsEntityImpl(eid);
+  void DestroyEntity(EID eid) { DestroyEntityImpl(eid); }
+
+  // Same as calling DestroyEntity on each of the count eids, but releases
+  // the components type by type. The eids must be unique.
+  void DestroyEntities(const EID* eids, std::size_t count) {
+    DestroyEntitiesImpl(eids, count);
   }
 
+  bool ContainsEntity(EID eid) const { return ContainsEntityImpl(eid); }
+
   template <typename T>
   T& AddComponent(EID eid) {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     return static_cast<T&>(AddComponentImpl(eid, GetXnentTypeID<T>()));
   }
 
   Xnent& AddComponent(EID eid, XnentTypeID tid) {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     return AddComponentImpl(eid, tid);
   }
 
+  // Adds component T to count entities: out[i] is the new component of
+  // eids[i]. The components are acquired from the pool in one go.
+  template <typename T>
+  void AddComponents(const EID* eids, std::size_t count, T** out) {
+    constexpr std::size_t kChunkSize = 64;
+    Xnent* comps[kChunkSize];
+    for (std::size_t begin = 0; begin < count; begin += kChunkSize) {
+      auto size = std::min(kChunkSize, count - begin);
+      AddComponentsImpl(eids + begin, size, GetXnentTypeID<T>(), comps);
+      for (std::size_t i = 0; i != size; ++i) {
+        out[begin + i] = static_cast<T*>(comps[i]);
+      }
+    }
+  }
+
+  void AddComponents(const EID* eids, std::size_t count, XnentTypeID tid,
+                     Xnent** out) {
+    AddComponentsImpl(eids, count, tid, out);
+  }
+
   template <typename T>
   void RemoveComponent(EID eid) {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     RemoveComponentImpl(eid, GetXnentTypeID<T>());
   }
 
   void RemoveComponent(EID eid, XnentTypeID tid) {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     RemoveComponentImpl(eid, tid);
   }
 
+  template <typename T>
+  bool HasComponent(EID eid) const {
+    return HasComponentImpl(eid, GetXnentTypeID<T>());
+  }
+
+  bool HasComponent(EID eid, XnentTypeID tid) const {
+    return HasComponentImpl(eid, tid);
+  }
+
   template <typename T>
   T& GetComponent(EID eid) {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     return static_cast<T&>(GetComponentImpl(eid, GetXnentTypeID<T>()));
   }
 
   Xnent& GetComponent(EID eid, XnentTypeID tid) {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     return GetComponentImpl(eid, tid);
   }
 
   template <typename T>
   const T& GetComponent(EID eid) const {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     return static_cast<const T&>(GetComponentImpl(eid, GetXnentTypeID<T>()));
   }
 
   const Xnent& GetComponent(EID eid, XnentTypeID tid) const {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     return GetComponentImpl(eid, tid);
   }
 
+  // Looks up component T of count entities: out[i] is the component of
+  // eids[i]. Faster than calling GetComponent in a loop for scattered
+  // entities.
+  template <typename T>
+  void GetComponents(const EID* eids, std::size_t count, T** out) {
+    constexpr std::size_t kChunkSize = 64;
+    Xnent* comps[kChunkSize];
+    for (std::size_t begin = 0; begin < count; begin += kChunkSize) {
+      auto size = std::min(kChunkSize, count - begin);
+      GetComponentsImpl(eids + begin, size,
+                        GetXnentTypeID<std::remove_const_t<T>>(), comps);
+      for (std::size_t i = 0; i != size; ++i) {
+        out[begin + i] = static_cast<T*>(comps[i]);
+      }
+    }
+  }
+
+  void GetComponents(const EID* eids, std::size_t count, XnentTypeID tid,
+                     Xnent** out) {
+    GetComponentsImpl(eids, count, tid, out);
+  }
+
+  template <typename T>
+  void GetComponents(const EID* eids, std::size_t count,
+                     const T** out) const {
+    constexpr std::size_t kChunkSize = 64;
+    const Xnent* comps[kChunkSize];
+    for (std::size_t begin = 0; begin < count; begin += kChunkSize) {
+      auto size = std::min(kChunkSize, count - begin);
+      GetComponentsImpl(eids + begin, size, GetXnentTypeID<T>(), comps);
+      for (std::size_t i = 0; i != size; ++i) {
+        out[begin + i] = static_cast<const T*>(comps[i]);
+      }
+    }
+  }
+
+  void GetComponents(const EID* eids, std::size_t count, XnentTypeID tid,
+                     const Xnent** out) const {
+    GetComponentsImpl(eids, count, tid, out);
+  }
+
   template <typename T>
   T& AddSinglenent() {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     return static_cast<T&>(AddSinglenentImpl(GetXnentTypeID<T>()));
   }
 
-  Xnent& AddSinglenent(XnentTypeID tid) {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
-    return AddSinglenentImpl(tid);
-  }
+  Xnent& AddSinglenent(XnentTypeID tid) { return AddSinglenentImpl(tid); }
 
   template <typename T>
-  void RemoveSinglenent() {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
-    RemoveSinglenentImpl(GetXnentTypeID<T>());
+  void RemoveSinglenent() { RemoveSinglenentImpl(GetXnentTypeID<T>()); }
+
+  void RemoveSinglenent(XnentTypeID tid) { RemoveSinglenentImpl(tid); }
+
+  template <typename T>
+  bool HasSinglenent() const noexcept {
+    return HasSinglenentImpl(GetXnentTypeID<T>());
   }
 
-  void RemoveSinglenent(XnentTypeID tid) {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
-    RemoveSinglenentImpl(tid);
+  bool HasSinglenent(XnentTypeID tid) const noexcept {
+    return HasSinglenentImpl(tid);
   }
 
   template <typename T>
   T& GetSinglenent() noexcept {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     return static_cast<T&>(GetSinglenentImpl(GetXnentTypeID<T>()));
   }
 
   Xnent& GetSinglenent(XnentTypeID tid) noexcept {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     return GetSinglenentImpl(tid);
   }
 
   template <typename T>
   const T& GetSinglenent() const noexcept {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     return static_cast<const T&>(GetSinglenentImpl(GetXnentTypeID<T>()));
   }
 
   const Xnent& GetSinglenent(XnentTypeID tid) const noexcept {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     return GetSinglenentImpl(tid);
   }
 
   template <typename ComponentList>
   void GetEntitiesWithComponents(EntityBuffer& buffer,
                                  ComponentList comp_list) {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     GetEntitiesWithComponentsImpl(buffer, internal::GetXnentMask(comp_list),
                                   internal::GetXnentTypeIDArray(comp_list));
   }
@@ -214,12 +236,11 @@ class IEntityManager {
   void GetEntitiesWithComponents(EntityBuffer& buffer,
                                  const internal::DynamicXnentMask& mask,
                                  const internal::XnentTypeIDArray& xtid_arr) {
-#ifdef EINU_CORE_PROFILE
-    EASY_FUNCTION();
-#endif
     GetEntitiesWithComponentsImpl(buffer, mask, xtid_arr);
   }
 
+  EntityStats GetEntityStats() const noexcept { return GetEntityStatsImpl(); }
+
   void Reset() noexcept { ResetImpl(); }
 
  private:
@@ -229,16 +250,28 @@ class IEntityManager {
   virtual void SetPolicyImpl(Policy policy) noexcept = 0;
 
   virtual EID CreateEntityImpl() = 0;
+  virtual void CreateEntityImpl(EID eid) = 0;
+  virtual void CreateEntitiesImpl(const EID* eids, std::size_t count) = 0;
   virtual void DestroyEntityImpl(EID eid) = 0;
+  virtual void DestroyEntitiesImpl(const EID* eids, std::size_t count) = 0;
   virtual bool ContainsEntityImpl(EID eid) const = 0;
 
   virtual Xnent& AddComponentImpl(EID eid, XnentTypeID tid) = 0;
+  virtual void AddComponentsImpl(const EID* eids, std::size_t count,
+                                 XnentTypeID tid, Xnent** out) = 0;
   virtual void RemoveComponentImpl(EID eid, XnentTypeID tid) = 0;
+  virtual bool HasComponentImpl(EID eid, XnentTypeID tid) const = 0;
   virtual Xnent& GetComponentImpl(EID eid, XnentTypeID tid) = 0;
   virtual const Xnent& GetComponentImpl(EID eid, XnentTypeID tid) const = 0;
+  virtual void GetComponentsImpl(const EID* eids, std::size_t count,
+                                 XnentTypeID tid, Xnent** out) = 0;
+  virtual void GetComponentsImpl(const EID* eids, std::size_t count,
+                                 XnentTypeID tid,
+                                 const Xnent** out) const = 0;
 
   virtual Xnent& AddSinglenentImpl(XnentTypeID tid) = 0;
   virtual void RemoveSinglenentImpl(XnentTypeID tid) = 0;
+  virtual bool HasSinglenentImpl(XnentTypeID tid) const noexcept = 0;
   virtual Xnent& GetSinglenentImpl(XnentTypeID tid) noexcept = 0;
   virtual const Xnent& GetSinglenentImpl(XnentTypeID tid) const noexcept = 0;
 
@@ -246,6 +279,8 @@ class IEntityManager {
       EntityBuffer& buffer, const internal::DynamicXnentMask& mask,
       const internal::XnentTypeIDArray& xtid_arr) = 0;
 
+  virtual EntityStats GetEntityStatsImpl() const noexcept = 0;
+
   virtual void ResetImpl() noexcept = 0;
 };
 
@@ -19,9 +19,11 @@
 #pragma once
 
 #include <memory>
+#include <string_view>
 #include <utility>
 
 #include "einu-engine/core/internal/pool_policy.h"
+#include "einu-engine/core/memory_stats.h"
 #include "einu-engine/core/xnent.h"
 #include "einu-engine/core/xnent_type_id.h"
 
@@ -48,6 +50,12 @@ class IXnentPool {
 
   Xnent& Acquire(XnentTypeID tid) { return AcquireImpl(tid); }
 
+  // Acquires count xnents of type tid into out. The pool grows at most once
+  // for all of them.
+  void Acquire(XnentTypeID tid, Xnent** out, size_type count) {
+    AcquireImpl(tid, out, count);
+  }
+
   template <typename T>
   void Release(T& comp) noexcept {
     ReleaseImpl(GetXnentTypeID<T>(), comp);
@@ -57,6 +65,12 @@ class IXnentPool {
     ReleaseImpl(tid, comp);
   }
 
+  // Releases count xnents of type tid. Sorting comps by address first lets
+  // the pool release neighbouring xnents without searching for their chunk.
+  void Release(XnentTypeID tid, Xnent* const* comps, size_type count) noexcept {
+    ReleaseImpl(tid, comps, count);
+  }
+
   template <typename T>
   size_type OnePoolSize() const noexcept {
     return OnePoolSizeImpl(GetXnentTypeID<T>());
@@ -66,13 +80,39 @@ class IXnentPool {
     return OnePoolSizeImpl(tid);
   }
 
+  template <typename T>
+  PoolStats OnePoolStats() const noexcept {
+    return OnePoolStatsImpl(GetXnentTypeID<T>());
+  }
+
+  PoolStats OnePoolStats(XnentTypeID tid) const noexcept {
+    return OnePoolStatsImpl(tid);
+  }
+
+  // Tags take no storage; acquiring one returns the shared tag instance.
+  bool IsTag(XnentTypeID tid) const noexcept { return IsTagImpl(tid); }
+
+  // The pool serves xnents with type ids 0 to XnentCount() - 1.
+  size_type XnentCount() const noexcept { return XnentCountImpl(); }
+
+  std::string_view XnentName(XnentTypeID tid) const noexcept {
+    return XnentNameImpl(tid);
+  }
+
  protected:
   virtual void AddPolicyImpl(size_type init_size, std::unique_ptr<Xnent> value,
                              internal::GrowthFunc growth_func,
                              XnentTypeID id) = 0;
   virtual Xnent& AcquireImpl(XnentTypeID id) = 0;
+  virtual void AcquireImpl(XnentTypeID id, Xnent** out, size_type count) = 0;
   virtual void ReleaseImpl(XnentTypeID id, Xnent& comp) noexcept = 0;
+  virtual void ReleaseImpl(XnentTypeID id, Xnent* const* comps,
+                           size_type count) noexcept = 0;
   virtual size_type OnePoolSizeImpl(XnentTypeID id) const noexcept = 0;
+  virtual PoolStats OnePoolStatsImpl(XnentTypeID id) const noexcept = 0;
+  virtual bool IsTagImpl(XnentTypeID id) const noexcept = 0;
+  virtual size_type XnentCountImpl() const noexcept = 0;
+  virtual std::string_view XnentNameImpl(XnentTypeID id) const noexcept = 0;
 };
 
 }  // namespace einu
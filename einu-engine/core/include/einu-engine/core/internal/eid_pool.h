@@ -31,6 +31,13 @@ class EIDPool final : public IEIDPool {
 
   void ReleaseImpl(EID eid) noexcept override {}
 
+  void ReserveImpl(EID eid) noexcept override {
+    auto available = available_.load();
+    while (available <= eid &&
+           !available_.compare_exchange_weak(available, eid + 1)) {
+    }
+  }
+
   std::atomic_uint32_t available_{0};
 };
 
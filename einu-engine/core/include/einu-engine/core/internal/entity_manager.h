@@ -19,16 +19,18 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <cassert>
-#include <map>
+#include <memory>
+#include <vector>
 
 #include "einu-engine/core/i_entity_manager.h"
 #include "einu-engine/core/util/object_pool.h"
+#include "einu-engine/core/util/prefetch.h"
 
 namespace einu {
 namespace internal {
 
-// TODO(Xiaoyue Chen): use hash table + sorted array for entity storage/caching
 template <std::size_t max_comp, std::size_t max_single>
 class EntityManager final : public IEntityManager {
  public:
@@ -43,7 +45,18 @@ class EntityManager final : public IEntityManager {
     XnentTable* comp_table;
   };
 
-  using EntityTable = std::map<EID, EntityData>;
+  // Entity data is indexed by EID through fixed-size pages, so finding an
+  // entity takes two dependent loads. A page is allocated when its first
+  // entity is created and freed when its last one is destroyed; since EIDs
+  // are not recycled, long-running worlds only keep the recent pages.
+  static constexpr std::size_t kPageSize = 4096;
+
+  struct Page {
+    std::array<EntityData, kPageSize> data{};
+    std::size_t live_count = 0;
+  };
+
+  using EntityTable = std::vector<std::unique_ptr<Page>>;
   using EntityDataPool = util::DynamicPool<ComponentMask, XnentTable>;
   using SinglenentTable = std::array<Xnent, max_single>;
 
@@ -55,6 +68,14 @@ class EntityManager final : public IEntityManager {
   void SetComponentPoolImpl(IXnentPool& comp_pool) noexcept override {
     assert(!comp_pool_ && "component pool is already set");
     comp_pool_ = &comp_pool;
+    data_mask_.set();
+    for (auto i = std::size_t{0}; i != comp_pool.XnentCount(); ++i) {
+      auto tid = XnentTypeID{i};
+      if (comp_pool.IsTag(tid)) {
+        data_mask_.reset(tid);
+        tag_table_[tid] = &comp_pool.Acquire(tid);
+      }
+    }
   }
 
   void SetSinglenentPoolImpl(IXnentPool& single_pool) noexcept override {
@@ -67,19 +88,87 @@ class EntityManager final : public IEntityManager {
     ett_data_pool_.GrowExtra(policy.init_size);
   }
 
+  const EntityData* Find(EID eid) const noexcept {
+    auto page_index = eid / kPageSize;
+    if (page_index >= ett_table_.size() || !ett_table_[page_index]) {
+      return nullptr;
+    }
+    const auto& data = ett_table_[page_index]->data[eid % kPageSize];
+    return data.mask ? &data : nullptr;
+  }
+
+  const EntityData& At(EID eid) const noexcept {
+    auto data = Find(eid);
+    assert(data && "entity does not exist");
+    return *data;
+  }
+
+  void Insert(EID eid) { Insert(eid, ett_data_pool_.Acquire()); }
+
+  void Insert(EID eid, typename EntityDataPool::reference tup) {
+    auto page_index = eid / kPageSize;
+    if (page_index >= ett_table_.size()) {
+      ett_table_.resize(page_index + 1);
+    }
+    auto& page = ett_table_[page_index];
+    if (!page) {
+      page = std::make_unique<Page>();
+    }
+    page->data[eid % kPageSize] =
+        EntityData{&std::get<ComponentMask&>(tup), &std::get<XnentTable&>(tup)};
+    ++page->live_count;
+    ++entity_count_;
+  }
+
+  void Erase(EID eid) noexcept {
+    auto& page = ett_table_[eid / kPageSize];
+    page->data[eid % kPageSize] = EntityData{};
+    if (--page->live_count == 0) {
+      page.reset();
+    }
+    --entity_count_;
+  }
+
+  template <typename Fn>
+  void ForEachEntity(Fn&& fn) const {
+    for (std::size_t i = 0; i != ett_table_.size(); ++i) {
+      if (!ett_table_[i]) continue;
+      const auto& data = ett_table_[i]->data;
+      for (std::size_t j = 0; j != kPageSize; ++j) {
+        if (data[j].mask) {
+          fn(static_cast<EID>(i * kPageSize + j), data[j]);
+        }
+      }
+    }
+  }
+
   EID CreateEntityImpl() override {
     auto eid = eid_pool_->Acquire();
-    auto tup = ett_data_pool_.Acquire();
-    ett_table_[eid] =
-        EntityData{&std::get<ComponentMask&>(tup), &std::get<XnentTable&>(tup)};
+    Insert(eid);
     return eid;
   }
 
-  void ReleaseEntity(typename EntityTable::iterator it) {
-    auto eid = it->first;
-    auto [mask, table] = it->second;
-    for (auto i = std::size_t{0}; i != mask->size(); ++i) {
-      if (mask->test(i)) {
+  void CreateEntityImpl(EID eid) override {
+    assert(!ContainsEntityImpl(eid) && "entity already exists");
+    eid_pool_->Reserve(eid);
+    Insert(eid);
+  }
+
+  void CreateEntitiesImpl(const EID* eids, std::size_t count) override {
+    for (std::size_t i = 0; i != count; ++i) {
+      assert(!ContainsEntityImpl(eids[i]) && "entity already exists");
+      eid_pool_->Reserve(eids[i]);
+    }
+    ett_data_pool_.Acquire(count, [this, &eids](auto&& tup) {
+      Insert(*eids++, tup);
+    });
+  }
+
+  void ReleaseEntity(EID eid, const EntityData& data) {
+    auto [mask, table] = data;
+    auto data_mask = *mask & data_mask_;
+    for (auto i = std::size_t{0}; i != data_mask.size(); ++i) {
+      if (data_mask.test(i)) {
         comp_pool_->Release(XnentTypeID{i}, *(*table)[i]);
       }
     }
@@ -89,40 +178,147 @@ class EntityManager final : public IEntityManager {
   }
 
   void DestroyEntityImpl(EID eid) override {
-    auto it = ett_table_.find(eid);
-    assert(it != ett_table_.end() && "entity does not exist");
-    ReleaseEntity(it);
-    ett_table_.erase(it);
+    ReleaseEntity(eid, At(eid));
+    Erase(eid);
+  }
+
+  // Only called in asserts, since it sorts a copy of the batch.
+  static bool AreUnique(const EID* eids, std::size_t count) {
+    auto sorted = std::vector<EID>(eids, eids + count);
+    std::sort(sorted.begin(), sorted.end());
+    return std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+  }
+
+  void DestroyEntitiesImpl(const EID* eids, std::size_t count) override {
+    assert(AreUnique(eids, count) && "eids are not unique");
+    auto& datas = destroy_buffer_.datas;
+    auto& comps = destroy_buffer_.comps;
+    for (std::size_t i = 0; i != count; ++i) {
+      const auto& data = At(eids[i]);
+      auto [mask, table] = data;
+      auto data_mask = *mask & data_mask_;
+      for (auto tid = std::size_t{0}; tid != data_mask.size(); ++tid) {
+        if (data_mask.test(tid)) {
+          comps[tid].push_back((*table)[tid]);
+        }
+      }
+      mask->reset();
+      datas.push_back(data);
+    }
+
+    for (auto tid = std::size_t{0}; tid != comps.size(); ++tid) {
+      auto& tid_comps = comps[tid];
+      if (tid_comps.empty()) continue;
+      if (!std::is_sorted(tid_comps.begin(), tid_comps.end())) {
+        std::sort(tid_comps.begin(), tid_comps.end());
+      }
+      comp_pool_->Release(XnentTypeID{tid}, tid_comps.data(), tid_comps.size());
+      tid_comps.clear();
+    }
+
+    ett_data_pool_.Release(datas.begin(), datas.end(),
+                           [](const EntityData& data) {
+                             return std::forward_as_tuple(*data.mask,
+                                                          *data.comp_table);
+                           });
+    datas.clear();
+
+    for (std::size_t i = 0; i != count; ++i) {
+      eid_pool_->Release(eids[i]);
+      Erase(eids[i]);
+    }
   }
 
   bool ContainsEntityImpl(EID eid) const override {
-    return ett_table_.find(eid) != ett_table_.end();
+    return Find(eid) != nullptr;
   }
 
   Xnent& AddComponentImpl(EID eid, XnentTypeID tid) override {
-    auto&& [mask, table] = ett_table_.at(eid);
-    auto& comp = comp_pool_->Acquire(tid);
+    auto&& [mask, table] = At(eid);
     mask->set(tid);
+    if (!data_mask_.test(tid)) {
+      return *tag_table_[tid];
+    }
+    auto& comp = comp_pool_->Acquire(tid);
     (*table)[tid] = &comp;
     return comp;
   }
 
+  void AddComponentsImpl(const EID* eids, std::size_t count, XnentTypeID tid,
+                         Xnent** out) override {
+    comp_pool_->Acquire(tid, out, count);
+    for (std::size_t i = 0; i != count; ++i) {
+      auto&& [mask, table] = At(eids[i]);
+      mask->set(tid);
+      if (data_mask_.test(tid)) {
+        (*table)[tid] = out[i];
+      }
+    }
+  }
+
   void RemoveComponentImpl(EID eid, XnentTypeID tid) override {
-    auto&& [mask, table] = ett_table_.at(eid);
-    auto& comp = *(*table)[tid];
-    comp_pool_->Release(tid, comp);
+    auto&& [mask, table] = At(eid);
+    if (data_mask_.test(tid)) {
+      comp_pool_->Release(tid, *(*table)[tid]);
+    }
     mask->reset(tid);
   }
 
+  bool HasComponentImpl(EID eid, XnentTypeID tid) const override {
+    auto data = Find(eid);
+    return data && data->mask->test(tid);
+  }
+
   Xnent& GetComponentImpl(EID eid, XnentTypeID tid) override {
     return const_cast<Xnent&>(
         static_cast<const EntityManager&>(*this).GetComponentImpl(eid, tid));
   }
 
   const Xnent& GetComponentImpl(EID eid, XnentTypeID tid) const override {
-    auto&& [mask, table] = ett_table_.at(eid);
+    auto&& [mask, table] = At(eid);
     assert(mask->test(tid) && "entity does not have the component");
-    return *(*table)[tid];
+    return data_mask_.test(tid) ? *(*table)[tid] : *tag_table_[tid];
+  }
+
+  void GetComponentsImpl(const EID* eids, std::size_t count, XnentTypeID tid,
+                         Xnent** out) override {
+    LookUpComponents(eids, count, tid, out);
+  }
+
+  void GetComponentsImpl(const EID* eids, std::size_t count, XnentTypeID tid,
+                         const Xnent** out) const override {
+    LookUpComponents(eids, count, tid, out);
+  }
+
+  // Writes the components through XnentPtr, which is Xnent* or const Xnent*,
+  // so both GetComponentsImpl share one walk.
+  template <typename XnentPtr>
+  void LookUpComponents(const EID* eids, std::size_t count, XnentTypeID tid,
+                        XnentPtr* out) const {
+    if (!data_mask_.test(tid)) {
+      std::fill(out, out + count, tag_table_[tid]);
+      return;
+    }
+    // Each lookup is a chain of dependent loads (entity data, then pointer
+    // table). Walking a batch one link at a time, prefetching the next link
+    // of every entity, lets the cache misses of the batch overlap.
+    constexpr std::size_t kBatchSize = 16;
+    auto datas = std::array<const EntityData*, kBatchSize>{};
+    for (std::size_t begin = 0; begin < count; begin += kBatchSize) {
+      auto size = std::min(kBatchSize, count - begin);
+      for (std::size_t i = 0; i != size; ++i) {
+        datas[i] = &At(eids[begin + i]);
+        util::Prefetch(datas[i]);
+      }
+      for (std::size_t i = 0; i != size; ++i) {
+        assert(datas[i]->mask->test(tid) &&
+               "entity does not have the component");
+        util::Prefetch(&(*datas[i]->comp_table)[tid]);
+      }
+      for (std::size_t i = 0; i != size; ++i) {
+        out[begin + i] = (*datas[i]->comp_table)[tid];
+      }
+    }
   }
 
   Xnent& AddSinglenentImpl(XnentTypeID tid) override {
@@ -146,28 +342,46 @@ class EntityManager final : public IEntityManager {
     singlenent_table_[tid] = nullptr;
   }
 
+  bool HasSinglenentImpl(XnentTypeID tid) const noexcept override {
+    return singlenent_table_[tid] != nullptr;
+  }
+
   void GetEntitiesWithComponentsImpl(
       EntityBuffer& buffer, const internal::DynamicXnentMask& mask,
       const internal::XnentTypeIDArray& xtid_arr) override {
     auto smask = ToStatic<max_comp>(mask);
-    for (auto it = ett_table_.begin(); it != ett_table_.end(); ++it) {
-      auto [emask, table] = it->second;
+    ForEachEntity([&](EID eid, const EntityData& data) {
+      auto [emask, table] = data;
       if ((*emask & smask) == smask) {
-        auto eid = it->first;
         buffer.eids.push_back(eid);
         std::transform(xtid_arr.begin(), xtid_arr.end(),
                        std::back_inserter(buffer.comps),
                        [&table](auto xtid) { return (*table)[xtid]; });
       }
-    }
+    });
+  }
+
+  EntityStats GetEntityStatsImpl() const noexcept override {
+    auto page_count = std::count_if(ett_table_.begin(), ett_table_.end(),
+                                    [](const auto& page) { return !!page; });
+    auto index_bytes = ett_table_.capacity() * sizeof(std::unique_ptr<Page>) +
+                       page_count * sizeof(Page);
+    auto stats = EntityStats{};
+    stats.entity_count = entity_count_;
+    stats.mask_bytes = sizeof(ComponentMask);
+    stats.table_bytes = sizeof(XnentTable);
+    stats.index_bytes = index_bytes / std::max(entity_count_, std::size_t{1});
+    stats.singlenent_table_bytes = sizeof(singlenent_table_);
+    stats.data_pool = ett_data_pool_.GetStats();
+    return stats;
   }
 
   void ResetImpl() noexcept override {
-    for (auto it = ett_table_.begin(); it != ett_table_.end(); ++it) {
-      ReleaseEntity(it);
-    }
+    ForEachEntity(
+        [this](EID eid, const EntityData& data) { ReleaseEntity(eid, data); });
 
     ett_table_.clear();
+    entity_count_ = 0;
 
     for (auto i = std::size_t{0}; i != singlenent_table_.size(); ++i) {
       if (singlenent_table_[i]) {
@@ -180,13 +394,26 @@ class EntityManager final : public IEntityManager {
     singlenent_pool_ = nullptr;
     ett_data_pool_.Clear();
     singlenent_table_.fill(nullptr);
+    data_mask_.reset();
+    tag_table_.fill(nullptr);
   }
 
   IEIDPool* eid_pool_ = nullptr;
   IXnentPool* comp_pool_ = nullptr;
   IXnentPool* singlenent_pool_ = nullptr;
   EntityDataPool ett_data_pool_{};
+  // Scratch space of DestroyEntities, kept to avoid reallocating per call.
+  struct DestroyBuffer {
+    std::vector<EntityData> datas;
+    std::array<std::vector<Xnent*>, max_comp> comps;
+  };
+
   EntityTable ett_table_{};
+  std::size_t entity_count_ = 0;
+  // Components with storage; the rest are tags, which only set mask bits.
+  ComponentMask data_mask_{};
+  XnentTable tag_table_{};
+  DestroyBuffer destroy_buffer_{};
   XnentTable singlenent_table_{};
 };
 
@@ -0,0 +1,193 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "einu-engine/core/internal/snapshot_format.h"
+
+namespace einu {
+namespace internal {
+namespace snapshot {
+
+// A delta turns one snapshot into another. It is the byte-wise XOR of the
+// two snapshots, taken section by section so that a section growing or
+// shrinking does not shift the sections after it, and run-length encoded
+// as (equal bytes, literal bytes, literals...) pairs of varints. XOR is
+// symmetric, so the same delta also turns the second snapshot back into
+// the first one.
+//
+// Layout:
+//   varint   size of the source snapshot
+//   runs     header and section directory
+//   runs     data of section 0, 1, ...
+
+inline constexpr std::size_t kMinEqualRun = 8;
+
+inline void WriteVarint(std::vector<char>& out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+inline std::uint64_t ReadVarint(const char*& cur) noexcept {
+  auto value = std::uint64_t{0};
+  for (auto shift = 0u;; shift += 7) {
+    auto byte = static_cast<unsigned char>(*cur++);
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return value;
+  }
+}
+
+inline char ByteAt(const char* data, std::size_t size,
+                   std::size_t i) noexcept {
+  return i < size ? data[i] : 0;
+}
+
+// Appends the runs of [a, a + a_size) XOR [b, b + b_size). The shorter range
+// is padded with zeros.
+inline void EncodeXor(const char* a, std::size_t a_size, const char* b,
+                      std::size_t b_size, std::vector<char>& out) {
+  auto size = std::max(a_size, b_size);
+  auto common = std::min(a_size, b_size);
+  auto i = std::size_t{0};
+  while (i != size) {
+    auto equal_begin = i;
+    while (i + sizeof(std::uint64_t) <= common) {
+      std::uint64_t wa, wb;
+      std::memcpy(&wa, a + i, sizeof(wa));
+      std::memcpy(&wb, b + i, sizeof(wb));
+      if (wa != wb) break;
+      i += sizeof(std::uint64_t);
+    }
+    while (i != size && ByteAt(a, a_size, i) == ByteAt(b, b_size, i)) {
+      ++i;
+    }
+
+    auto literal_begin = i;
+    auto equal_run = std::size_t{0};
+    while (i != size && equal_run != kMinEqualRun) {
+      equal_run = ByteAt(a, a_size, i) == ByteAt(b, b_size, i)
+                      ? equal_run + 1
+                      : 0;
+      ++i;
+    }
+    i -= equal_run;
+
+    WriteVarint(out, literal_begin - equal_begin);
+    WriteVarint(out, i - literal_begin);
+    for (auto j = literal_begin; j != i; ++j) {
+      out.push_back(ByteAt(a, a_size, j) ^ ByteAt(b, b_size, j));
+    }
+  }
+}
+
+// Like EncodeXor, but a section that did not change is written as one equal
+// run after a memcmp instead of being compared word by word.
+inline void EncodeSection(const char* a, std::size_t a_size, const char* b,
+                          std::size_t b_size, std::vector<char>& out) {
+  if (a_size != b_size || std::memcmp(a, b, a_size) != 0) {
+    EncodeXor(a, a_size, b, b_size, out);
+  } else if (a_size != 0) {
+    WriteVarint(out, a_size);
+    WriteVarint(out, 0);
+  }
+}
+
+// Reads runs written by EncodeXor and writes [src, src + src_size) XOR the
+// runs into [dst, dst + dst_size). dst must be zero-filled.
+inline void DecodeXor(const char*& runs, const char* src,
+                      std::size_t src_size, char* dst,
+                      std::size_t dst_size) noexcept {
+  auto size = std::max(src_size, dst_size);
+  auto common = std::min(src_size, dst_size);
+  auto i = std::size_t{0};
+  while (i != size) {
+    auto equal_end = i + ReadVarint(runs);
+    if (i < common) {
+      std::memcpy(dst + i, src + i, std::min(equal_end, common) - i);
+    }
+    i = equal_end;
+
+    auto literal_end = i + ReadVarint(runs);
+    for (; i != literal_end; ++i, ++runs) {
+      if (i < dst_size) dst[i] = ByteAt(src, src_size, i) ^ *runs;
+    }
+  }
+}
+
+inline std::size_t DirectorySize(const std::vector<char>& snapshot) noexcept {
+  auto header = Header{};
+  std::memcpy(&header, snapshot.data(), sizeof(header));
+  return sizeof(Header) + header.section_count * sizeof(Section);
+}
+
+inline Section SectionAt(const char* snapshot, std::size_t i) noexcept {
+  auto section = Section{};
+  std::memcpy(&section, snapshot + sizeof(Header) + i * sizeof(Section),
+              sizeof(section));
+  return section;
+}
+
+// Writes the delta that turns from into to.
+inline void EncodeDelta(const std::vector<char>& from,
+                        const std::vector<char>& to,
+                        std::vector<char>& delta) {
+  auto dir_size = DirectorySize(from);
+  assert(dir_size == DirectorySize(to) && "snapshots have different layouts");
+
+  delta.clear();
+  WriteVarint(delta, from.size());
+  EncodeXor(from.data(), dir_size, to.data(), dir_size, delta);
+  auto section_count = (dir_size - sizeof(Header)) / sizeof(Section);
+  for (std::size_t i = 0; i != section_count; ++i) {
+    auto from_section = SectionAt(from.data(), i);
+    auto to_section = SectionAt(to.data(), i);
+    EncodeSection(from.data() + from_section.offset, from_section.size,
+                  to.data() + to_section.offset, to_section.size, delta);
+  }
+}
+
+// Applies a delta written by EncodeDelta(from, to, delta) to to and writes
+// from.
+inline void DecodeDelta(const std::vector<char>& to,
+                        const std::vector<char>& delta,
+                        std::vector<char>& from) {
+  const auto* runs = delta.data();
+  from.assign(ReadVarint(runs), 0);
+  auto dir_size = DirectorySize(to);
+  DecodeXor(runs, to.data(), dir_size, from.data(), dir_size);
+  auto section_count = (dir_size - sizeof(Header)) / sizeof(Section);
+  for (std::size_t i = 0; i != section_count; ++i) {
+    auto from_section = SectionAt(from.data(), i);
+    auto to_section = SectionAt(to.data(), i);
+    DecodeXor(runs, to.data() + to_section.offset, to_section.size,
+              from.data() + from_section.offset, from_section.size);
+  }
+}
+
+}  // namespace snapshot
+}  // namespace internal
+}  // namespace einu
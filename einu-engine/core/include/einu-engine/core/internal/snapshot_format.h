@@ -0,0 +1,99 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace einu {
+namespace internal {
+namespace snapshot {
+
+// A snapshot file is a Header, followed by Header::section_count Sections,
+// followed by the data of every section. Section data starts at a multiple of
+// kAlignment so that raw blocks can be read in place from a mapped file.
+//
+// Sections are always written in the same order:
+//   EIDs        - one EID per entity
+//   Masks       - one component bit mask per entity, in the same order
+//   Component i - one per component type, values of the entities that have
+//                 bit i set in their mask, in entity order
+//   Singlenent i - one per singlenent type, empty if the singlenent is absent
+
+inline constexpr char kMagic[8] = {'E', 'I', 'N', 'U', 'S', 'N', 'A', 'P'};
+inline constexpr std::uint32_t kVersion = 2;
+inline constexpr std::size_t kAlignment = 64;
+
+enum class SectionKind : std::uint32_t {
+  EIDs,
+  Masks,
+  Component,
+  Singlenent,
+};
+
+enum class Encoding : std::uint32_t {
+  // count elements of elem_size bytes copied verbatim
+  Raw,
+  // count elements written one after another by SnapshotCodec
+  Codec,
+  // no data, the mask bits are all there is to a tag
+  Tag,
+};
+
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t section_count;
+  std::uint64_t entity_count;
+  std::uint32_t component_count;
+  std::uint32_t singlenent_count;
+};
+
+struct Section {
+  SectionKind kind;
+  std::uint32_t index;
+  Encoding encoding;
+  std::uint32_t elem_size;
+  std::uint64_t count;
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+static_assert(std::is_trivially_copyable<Header>::value &&
+              sizeof(Header) == 32);
+static_assert(std::is_trivially_copyable<Section>::value &&
+              sizeof(Section) == 40);
+
+constexpr std::size_t AlignUp(std::size_t size) noexcept {
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+constexpr std::size_t MaskSizeInBytes(std::size_t component_count) noexcept {
+  return (component_count + 7) / 8;
+}
+
+constexpr std::size_t SectionCount(std::size_t component_count,
+                                   std::size_t singlenent_count) noexcept {
+  return 2 + component_count + singlenent_count;
+}
+
+}  // namespace snapshot
+}  // namespace internal
+}  // namespace einu
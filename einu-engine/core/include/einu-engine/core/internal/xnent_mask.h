@@ -67,7 +67,11 @@ const DynamicXnentMask& GetXnentMaskImpl(XnentList<Ts...>) {
 
 template <typename... Ts>
 const XnentTypeIDArray& GetXnentTypeIDArrayImpl(XnentList<Ts...>) {
-  static auto& r = *new XnentTypeIDArray{GetXnentTypeID<Ts>()...};
+  static auto& r = *[] {
+    auto arr = new XnentTypeIDArray{};
+    ((IsTag<Ts>::value ? void() : arr->push_back(GetXnentTypeID<Ts>())), ...);
+    return arr;
+  }();
   return r;
 }
 
@@ -78,6 +82,8 @@ const DynamicXnentMask& GetXnentMask(XnentList l) {
   return detail::GetXnentMaskImpl(l);
 }
 
+// Type ids of the xnents in the list, leaving out tags as they have no
+// storage to point to.
 template <typename XnentList>
 const XnentTypeIDArray& GetXnentTypeIDArray(XnentList l) {
   return detail::GetXnentTypeIDArrayImpl(l);
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <memory>
@@ -25,13 +26,14 @@
 #include <variant>
 
 #include "einu-engine/core/i_xnent_pool.h"
+#include "einu-engine/core/rtti/type_name.h"
 #include "einu-engine/core/util/object_pool.h"
 #include "einu-engine/core/xnent_list.h"
 
 namespace einu {
 namespace internal {
 
-template <typename Comp>
+template <typename Comp, bool is_tag = IsTag<Comp>::value>
 class OneXnentPool {
  public:
   using size_type = std::size_t;
@@ -49,7 +51,29 @@ class OneXnentPool {
 
   Xnent& Acquire() { return pool_.Acquire(); }
 
-  void Release(Xnent& obj) noexcept {
+  void Acquire(Xnent** out, size_type count) {
+    pool_.Acquire(count, [&out](Comp& comp) { *out++ = &comp; });
+  }
+
+  void Release(Xnent& obj) noexcept { pool_.Release(Reset(obj)); }
+
+  void Release(Xnent* const* objs, size_type count) noexcept {
+    pool_.Release(objs, objs + count,
+                  [this](Xnent* obj) -> const Comp& { return Reset(*obj); });
+  }
+
+  size_type Size() const noexcept { return pool_.Size(); }
+
+  PoolStats GetStats() const noexcept { return pool_.GetStats(); }
+
+  std::string_view Name() const noexcept { return rtti::GetTypeName<Comp>(); }
+
+  constexpr bool IsTag() const noexcept { return false; }
+
+ private:
+  using Pool = util::DynamicPool<Comp>;
+
+  Comp& Reset(Xnent& obj) noexcept {
     auto& comp = reinterpret_cast<Comp&>(obj);
     auto val = pool_.GetValue();
     if (val) {
@@ -57,16 +81,43 @@ class OneXnentPool {
     } else {
       comp = Comp{};
     }
-    pool_.Release(comp);
+    return comp;
   }
 
-  size_type Size() const noexcept { return pool_.Size(); }
-
- private:
-  using Pool = util::DynamicPool<Comp>;
   Pool pool_;
 };
 
+template <typename Comp>
+class OneXnentPool<Comp, true> {
+ public:
+  using size_type = std::size_t;
+  using GrowthFunc = std::function<size_type(size_type)>;
+
+  void SetValue(std::unique_ptr<Xnent> /*value*/) noexcept {}
+
+  void SetGrowth(GrowthFunc /*growth*/) noexcept {}
+
+  void GrowExtra(size_type /*delta_size*/) {}
+
+  Xnent& Acquire() noexcept { return GetTagInstance<Comp>(); }
+
+  void Acquire(Xnent** out, size_type count) noexcept {
+    std::fill(out, out + count, &GetTagInstance<Comp>());
+  }
+
+  void Release(Xnent& /*obj*/) noexcept {}
+
+  void Release(Xnent* const* /*objs*/, size_type /*count*/) noexcept {}
+
+  size_type Size() const noexcept { return 0; }
+
+  PoolStats GetStats() const noexcept { return PoolStats{}; }
+
+  std::string_view Name() const noexcept { return rtti::GetTypeName<Comp>(); }
+
+  constexpr bool IsTag() const noexcept { return true; }
+};
+
 template <typename ComponentList>
 class XnentPool;
 
@@ -96,14 +147,41 @@ class XnentPool<XnentList<Xnents...>> final : public IXnentPool {
         [](auto&& arg) -> auto& { return arg.Acquire(); }, pool_table_[id]);
   }
 
+  void AcquireImpl(XnentTypeID id, Xnent** out, size_type count) override {
+    std::visit([&](auto&& arg) { arg.Acquire(out, count); }, pool_table_[id]);
+  }
+
   void ReleaseImpl(XnentTypeID id, Xnent& comp) noexcept override {
     std::visit([&comp](auto&& arg) { arg.Release(comp); }, pool_table_[id]);
   }
 
+  void ReleaseImpl(XnentTypeID id, Xnent* const* comps,
+                   size_type count) noexcept override {
+    std::visit([&](auto&& arg) { arg.Release(comps, count); },
+               pool_table_[id]);
+  }
+
   size_type OnePoolSizeImpl(XnentTypeID id) const noexcept override {
     return std::visit([](auto&& arg) { return arg.Size(); }, pool_table_[id]);
   }
 
+  PoolStats OnePoolStatsImpl(XnentTypeID id) const noexcept override {
+    return std::visit([](auto&& arg) { return arg.GetStats(); },
+                      pool_table_[id]);
+  }
+
+  bool IsTagImpl(XnentTypeID id) const noexcept override {
+    return std::visit([](auto&& arg) { return arg.IsTag(); }, pool_table_[id]);
+  }
+
+  size_type XnentCountImpl() const noexcept override {
+    return pool_table_.size();
+  }
+
+  std::string_view XnentNameImpl(XnentTypeID id) const noexcept override {
+    return std::visit([](auto&& arg) { return arg.Name(); }, pool_table_[id]);
+  }
+
   PoolTable pool_table_;
 };
 
@@ -0,0 +1,276 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "einu-engine/core/trace.h"
+
+// Jobs for work that spans frames, such as long searches or resource loading.
+// A job is a callable run one step at a time on a worker thread. At the end of
+// each step it says when it wants to run again, so a job keeps its progress in
+// its own captures instead of in a per-entity state machine:
+//
+//   auto search = std::make_shared<Search>(start, goal);
+//   auto handle = jobs.Schedule([search] {
+//     search->Expand(1000);
+//     return search->Done() ? JobResult::Done() : JobResult::NextFrame();
+//   });
+//   ...
+//   jobs.NextFrame();  // once per frame
+//   if (jobs.IsDone(handle)) UsePath(search->Path());
+//
+// Jobs run concurrently with the frame, so they must not touch the entity
+// manager; they work on their own data and hand results back through it.
+// Jobs must not throw.
+
+namespace einu {
+
+namespace internal {
+
+struct JobState;
+
+}  // namespace internal
+
+// Refers to a scheduled job. Copies refer to the same job.
+class JobHandle {
+ public:
+  JobHandle() = default;
+
+  bool Valid() const noexcept { return state_ != nullptr; }
+
+ private:
+  explicit JobHandle(std::shared_ptr<internal::JobState> state) noexcept
+      : state_{std::move(state)} {}
+
+  std::shared_ptr<internal::JobState> state_;
+
+  friend class JobSystem;
+};
+
+// When a job runs its next step.
+class JobResult {
+ public:
+  // The job is finished and its jobs waiting on it become ready.
+  static JobResult Done() noexcept { return JobResult{Kind::Done}; }
+
+  // As soon as possible, after the other ready jobs.
+  static JobResult Yield() noexcept { return JobResult{Kind::Yield}; }
+
+  // After the next call to JobSystem::NextFrame.
+  static JobResult NextFrame() noexcept { return JobResult{Kind::NextFrame}; }
+
+  // Once job is done.
+  static JobResult After(JobHandle job) noexcept {
+    auto result = JobResult{Kind::After};
+    result.after_ = std::move(job);
+    return result;
+  }
+
+ private:
+  enum class Kind { Done, Yield, NextFrame, After };
+
+  explicit JobResult(Kind kind) noexcept : kind_{kind} {}
+
+  Kind kind_;
+  JobHandle after_;
+
+  friend class JobSystem;
+};
+
+using Job = std::function<JobResult()>;
+
+namespace internal {
+
+struct JobState {
+  explicit JobState(Job job) : job{std::move(job)} {}
+
+  Job job;
+  bool done = false;
+  std::vector<std::shared_ptr<JobState>> waiters;
+};
+
+}  // namespace internal
+
+class JobSystem {
+ public:
+  // With no workers, jobs only run in RunReady and Wait on the calling thread.
+  explicit JobSystem(std::size_t worker_count = DefaultWorkerCount()) {
+    workers_.reserve(worker_count);
+    for (std::size_t i = 0; i != worker_count; ++i) {
+      workers_.emplace_back([this, i] { WorkerLoop(i); });
+    }
+  }
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  // Workers finish the step they are running. Unfinished jobs are dropped.
+  ~JobSystem() {
+    {
+      auto lock = std::lock_guard{mutex_};
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) worker.join();
+  }
+
+  static std::size_t DefaultWorkerCount() noexcept {
+    auto hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 1;
+  }
+
+  JobHandle Schedule(Job job) {
+    auto state = std::make_shared<internal::JobState>(std::move(job));
+    {
+      auto lock = std::lock_guard{mutex_};
+      ++pending_count_;
+      ready_.push_back(state);
+    }
+    cv_.notify_one();
+    return JobHandle{std::move(state)};
+  }
+
+  // Makes the jobs waiting for the next frame ready.
+  void NextFrame() {
+    {
+      auto lock = std::lock_guard{mutex_};
+      for (auto& state : next_frame_) ready_.push_back(std::move(state));
+      next_frame_.clear();
+    }
+    cv_.notify_all();
+  }
+
+  bool IsDone(const JobHandle& handle) const {
+    assert(handle.Valid() && "invalid job handle");
+    auto lock = std::lock_guard{mutex_};
+    return handle.state_->done;
+  }
+
+  // Runs steps of ready jobs on the calling thread until none is ready.
+  // Returns the number of steps run.
+  std::size_t RunReady() {
+    auto steps = std::size_t{0};
+    for (auto lock = std::unique_lock{mutex_}; !ready_.empty(); ++steps) {
+      RunStep(lock);
+    }
+    return steps;
+  }
+
+  // Blocks until the job is done, running ready jobs in the meantime. Never
+  // returns if the job waits for a frame that the caller would start.
+  void Wait(const JobHandle& handle) {
+    assert(handle.Valid() && "invalid job handle");
+    auto lock = std::unique_lock{mutex_};
+    while (!handle.state_->done) {
+      if (!ready_.empty()) {
+        RunStep(lock);
+      } else {
+        cv_.wait(lock);
+      }
+    }
+  }
+
+  // Jobs scheduled and not done yet.
+  std::size_t PendingCount() const {
+    auto lock = std::lock_guard{mutex_};
+    return pending_count_;
+  }
+
+  std::size_t WorkerCount() const noexcept { return workers_.size(); }
+
+ private:
+  using StatePtr = std::shared_ptr<internal::JobState>;
+
+  void WorkerLoop(std::size_t index) {
+#ifdef EINU_CORE_PROFILE
+    trace::SetThreadName("job worker " + std::to_string(index));
+#else
+    static_cast<void>(index);
+#endif
+    auto lock = std::unique_lock{mutex_};
+    while (true) {
+      cv_.wait(lock, [this] { return stop_ || !ready_.empty(); });
+      if (stop_) return;
+      RunStep(lock);
+    }
+  }
+
+  // Pops a ready job and runs one step of it without holding the lock.
+  void RunStep(std::unique_lock<std::mutex>& lock) {
+    auto state = std::move(ready_.front());
+    ready_.pop_front();
+    lock.unlock();
+    auto result = JobResult::Done();
+    {
+      EINU_TRACE_SCOPE("job step");
+      result = state->job();
+    }
+    if (result.kind_ == JobResult::Kind::Done) state->job = nullptr;
+    lock.lock();
+    switch (result.kind_) {
+      case JobResult::Kind::Done:
+        Finish(*state);
+        cv_.notify_all();
+        return;
+      case JobResult::Kind::Yield:
+        ready_.push_back(std::move(state));
+        break;
+      case JobResult::Kind::NextFrame:
+        next_frame_.push_back(std::move(state));
+        return;
+      case JobResult::Kind::After:
+        assert(result.after_.Valid() && "invalid job handle");
+        if (auto& after = *result.after_.state_; !after.done) {
+          after.waiters.push_back(std::move(state));
+          return;
+        }
+        ready_.push_back(std::move(state));
+        break;
+    }
+    cv_.notify_one();
+  }
+
+  void Finish(internal::JobState& state) {
+    state.done = true;
+    --pending_count_;
+    for (auto& waiter : state.waiters) ready_.push_back(std::move(waiter));
+    state.waiters.clear();
+  }
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<StatePtr> ready_;
+  std::vector<StatePtr> next_frame_;
+  std::size_t pending_count_ = 0;
+  bool stop_ = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace einu
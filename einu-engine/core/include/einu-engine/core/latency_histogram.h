@@ -0,0 +1,200 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <utility>
+
+#include "einu-engine/core/util/bit.h"
+
+namespace einu {
+
+// Counts durations in log-linear buckets, HDR histogram style. Every power of
+// two range of nanoseconds is split into kSubBucketCount / 2 linear buckets,
+// so a percentile is reported within 1 / 16 of the recorded value while the
+// whole range of uint64 nanoseconds fits in under a thousand counters.
+class LatencyHistogram {
+ public:
+  using Duration = std::chrono::nanoseconds;
+
+  static constexpr int kSubBucketBits = 5;
+  static constexpr std::size_t kSubBucketCount = std::size_t{1}
+                                                 << kSubBucketBits;
+  static constexpr std::size_t kBucketCount =
+      (64 - kSubBucketBits + 2) * (kSubBucketCount / 2);
+
+  void Record(Duration duration) noexcept {
+    auto ns = static_cast<std::uint64_t>(
+        std::max(duration.count(), Duration::rep{0}));
+    ++counts_[BucketIndex(ns)];
+    ++count_;
+    max_ = std::max(max_, ns);
+  }
+
+  void Merge(const LatencyHistogram& other) noexcept {
+    for (std::size_t i = 0; i != kBucketCount; ++i) {
+      counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    max_ = std::max(max_, other.max_);
+  }
+
+  void Clear() noexcept {
+    counts_.fill(0);
+    count_ = 0;
+    max_ = 0;
+  }
+
+  std::size_t Count() const noexcept { return count_; }
+
+  Duration Max() const noexcept { return Duration(max_); }
+
+  // The smallest recorded duration that percentile percent of the records do
+  // not exceed, rounded up to the top of its bucket.
+  Duration Percentile(double percentile) const noexcept {
+    if (count_ == 0) return Duration::zero();
+    auto rank = static_cast<std::uint64_t>(
+        std::ceil(std::clamp(percentile, 0.0, 100.0) / 100 * count_));
+    rank = std::clamp<std::uint64_t>(rank, 1, count_);
+    auto seen = std::uint64_t{0};
+    for (std::size_t i = 0; i != kBucketCount; ++i) {
+      seen += counts_[i];
+      if (seen >= rank) {
+        return Duration(std::min(BucketUpperBound(i), max_));
+      }
+    }
+    return Max();
+  }
+
+  static std::size_t BucketIndex(std::uint64_t ns) noexcept {
+    if (ns < kSubBucketCount) return static_cast<std::size_t>(ns);
+    auto magnitude = static_cast<std::size_t>(
+        63 - util::CountLeftZero(ns) - (kSubBucketBits - 1));
+    return magnitude * (kSubBucketCount / 2) +
+           static_cast<std::size_t>(ns >> magnitude);
+  }
+
+  static constexpr std::uint64_t BucketUpperBound(std::size_t index) noexcept {
+    if (index < kSubBucketCount) return index;
+    auto magnitude = index / (kSubBucketCount / 2) - 1;
+    auto sub_bucket = index - magnitude * (kSubBucketCount / 2);
+    return ((static_cast<std::uint64_t>(sub_bucket) + 1) << magnitude) - 1;
+  }
+
+ private:
+  std::array<std::uint32_t, kBucketCount> counts_{};
+  std::size_t count_ = 0;
+  std::uint64_t max_ = 0;
+};
+
+// Keeps the most recent records only: records go into the newer of two
+// histograms, and once it holds window / 2 records the older one is dropped.
+// Queries see between window / 2 and window of the latest records.
+class RollingLatencyHistogram {
+ public:
+  using Duration = LatencyHistogram::Duration;
+
+  explicit RollingLatencyHistogram(std::size_t window = 600) noexcept
+      : half_window_{std::max<std::size_t>(window / 2, 1)} {}
+
+  void Record(Duration duration) noexcept {
+    if (generations_[current_].Count() == half_window_) {
+      current_ ^= 1;
+      generations_[current_].Clear();
+    }
+    generations_[current_].Record(duration);
+  }
+
+  void Clear() noexcept {
+    for (auto& generation : generations_) generation.Clear();
+  }
+
+  LatencyHistogram Collect() const noexcept {
+    auto histogram = generations_[0];
+    histogram.Merge(generations_[1]);
+    return histogram;
+  }
+
+ private:
+  std::size_t half_window_;
+  std::array<LatencyHistogram, 2> generations_;
+  std::size_t current_ = 0;
+};
+
+struct LatencySummary {
+  std::size_t count = 0;
+  LatencyHistogram::Duration p50{};
+  LatencyHistogram::Duration p95{};
+  LatencyHistogram::Duration p99{};
+  LatencyHistogram::Duration max{};
+};
+
+inline LatencySummary Summarize(const LatencyHistogram& histogram) noexcept {
+  return {histogram.Count(), histogram.Percentile(50),
+          histogram.Percentile(95), histogram.Percentile(99),
+          histogram.Max()};
+}
+
+inline void WriteLatencyHeader(std::ostream& os) {
+  os << std::setw(24) << std::left << "  latency (ms)" << std::right
+     << std::setw(8) << "count" << std::setw(10) << "p50" << std::setw(10)
+     << "p95" << std::setw(10) << "p99" << std::setw(10) << "max" << '\n';
+}
+
+inline void WriteLatencySummary(std::ostream& os, const char* name,
+                                const LatencySummary& summary) {
+  auto flags = os.flags();
+  auto ms = [](LatencyHistogram::Duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  };
+  os << "  " << std::setw(22) << std::left << name << std::right
+     << std::setw(8) << summary.count << std::fixed << std::setprecision(3)
+     << std::setw(10) << ms(summary.p50) << std::setw(10) << ms(summary.p95)
+     << std::setw(10) << ms(summary.p99) << std::setw(10) << ms(summary.max)
+     << '\n';
+  os.flags(flags);
+}
+
+// Records the time from its construction to its destruction.
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(RollingLatencyHistogram& histogram) noexcept
+      : histogram_{histogram}, start_{std::chrono::steady_clock::now()} {}
+
+  ScopedLatency(const ScopedLatency&) = delete;
+  ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+  ~ScopedLatency() {
+    histogram_.Record(std::chrono::steady_clock::now() - start_);
+  }
+
+ private:
+  RollingLatencyHistogram& histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace einu
@@ -0,0 +1,151 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "einu-engine/core/entity_view.h"
+#include "einu-engine/core/i_entity_manager.h"
+#include "einu-engine/core/i_xnent_pool.h"
+#include "einu-engine/core/memory_stats.h"
+
+namespace einu {
+
+struct MemoryReport {
+  struct Pool {
+    std::string_view name;
+    PoolStats stats;
+  };
+
+  struct View {
+    std::string name;
+    std::size_t size;
+    std::size_t bytes;
+  };
+
+  std::vector<Pool> components;
+  std::vector<Pool> singlenents;
+  EntityStats entities;
+  std::vector<View> views;
+};
+
+inline std::vector<MemoryReport::Pool> CollectPoolStats(
+    const IXnentPool& pool) {
+  auto stats = std::vector<MemoryReport::Pool>{};
+  for (XnentTypeID tid = 0; tid != pool.XnentCount(); ++tid) {
+    stats.push_back({pool.XnentName(tid), pool.OnePoolStats(tid)});
+  }
+  return stats;
+}
+
+inline void WriteMemoryReport(std::ostream& os, const MemoryReport& report) {
+  auto flags = os.flags();
+  auto write_pools = [&os](const char* title, const auto& pools) {
+    os << title << '\n'
+       << std::setw(40) << std::left << "  type" << std::right
+       << std::setw(10) << "capacity" << std::setw(10) << "live"
+       << std::setw(12) << "bytes" << std::setw(8) << "chunks"
+       << std::setw(8) << "growth" << std::setw(8) << "frag" << '\n';
+    auto total = std::size_t{0};
+    for (const auto& [name, stats] : pools) {
+      os << "  " << std::setw(38) << std::left << name << std::right
+         << std::setw(10) << stats.capacity << std::setw(10) << stats.live
+         << std::setw(12) << stats.bytes << std::setw(8) << stats.chunk_count
+         << std::setw(8) << stats.growth_count << std::setw(8)
+         << std::fixed << std::setprecision(2) << FragmentationRatio(stats)
+         << '\n';
+      total += stats.bytes;
+    }
+    os << "  total bytes: " << total << '\n';
+  };
+
+  write_pools("components", report.components);
+  write_pools("singlenents", report.singlenents);
+
+  const auto& entities = report.entities;
+  os << "entities\n"
+     << "  count: " << entities.entity_count << '\n'
+     << "  bytes per entity: " << BytesPerEntity(entities)
+     << " (mask " << entities.mask_bytes << ", table "
+     << entities.table_bytes << ", index " << entities.index_bytes << ")\n"
+     << "  data pool capacity: " << entities.data_pool.capacity
+     << ", growth: " << entities.data_pool.growth_count << '\n'
+     << "  total bytes: " << TotalBytes(entities) << '\n';
+
+  os << "views\n";
+  for (const auto& view : report.views) {
+    os << "  " << std::setw(38) << std::left << view.name << std::right
+       << std::setw(10) << view.size << std::setw(12) << view.bytes << '\n';
+  }
+  os.flags(flags);
+}
+
+// Collects a MemoryReport on demand, or every interval frames when Update is
+// called once per frame. An interval of 0 never reports.
+class MemoryReporter {
+ public:
+  MemoryReporter(const IXnentPool& comp_pool, const IXnentPool& single_pool,
+                 const IEntityManager& ett_mgr) noexcept
+      : comp_pool_{comp_pool}, single_pool_{single_pool}, ett_mgr_{ett_mgr} {}
+
+  template <typename ComponentList>
+  void AddView(std::string name, const EntityView<ComponentList>& view) {
+    views_.emplace_back(std::move(name), [&view] {
+      return std::pair{view.Size(), view.BufferBytes()};
+    });
+  }
+
+  MemoryReport Collect() const {
+    auto report = MemoryReport{};
+    report.components = CollectPoolStats(comp_pool_);
+    report.singlenents = CollectPoolStats(single_pool_);
+    report.entities = ett_mgr_.GetEntityStats();
+    for (const auto& [name, get_stats] : views_) {
+      auto [size, bytes] = get_stats();
+      report.views.push_back({name, size, bytes});
+    }
+    return report;
+  }
+
+  void Write(std::ostream& os) const { WriteMemoryReport(os, Collect()); }
+
+  void Update(std::ostream& os, std::size_t interval) {
+    if (interval != 0 && ++frame_ % interval == 0) {
+      Write(os);
+    }
+  }
+
+ private:
+  using ViewStats = std::function<std::pair<std::size_t, std::size_t>()>;
+
+  const IXnentPool& comp_pool_;
+  const IXnentPool& single_pool_;
+  const IEntityManager& ett_mgr_;
+  std::vector<std::pair<std::string, ViewStats>> views_;
+  std::size_t frame_ = 0;
+};
+
+}  // namespace einu
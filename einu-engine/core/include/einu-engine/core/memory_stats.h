@@ -0,0 +1,74 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+
+namespace einu {
+
+struct PoolStats {
+  // number of object slots
+  std::size_t capacity = 0;
+  // number of acquired slots
+  std::size_t live = 0;
+  // free slots in chunks that also hold live objects
+  std::size_t scattered_free = 0;
+  std::size_t chunk_count = 0;
+  // times the pool grew because it was full
+  std::size_t growth_count = 0;
+  std::size_t bytes = 0;
+};
+
+// Share of the free slots that are scattered between live objects rather
+// than sitting in chunks that are entirely free.
+inline double FragmentationRatio(const PoolStats& stats) noexcept {
+  auto free = stats.capacity - stats.live;
+  return free == 0 ? 0.0 : static_cast<double>(stats.scattered_free) / free;
+}
+
+inline double Occupancy(const PoolStats& stats) noexcept {
+  return stats.capacity == 0
+             ? 0.0
+             : static_cast<double>(stats.live) / stats.capacity;
+}
+
+struct EntityStats {
+  std::size_t entity_count = 0;
+  // component mask of one entity
+  std::size_t mask_bytes = 0;
+  // component pointer table of one entity
+  std::size_t table_bytes = 0;
+  // entity table bookkeeping for one entity
+  std::size_t index_bytes = 0;
+  // singlenent pointer table
+  std::size_t singlenent_table_bytes = 0;
+  // pool of masks and component pointer tables
+  PoolStats data_pool{};
+};
+
+inline std::size_t BytesPerEntity(const EntityStats& stats) noexcept {
+  return stats.mask_bytes + stats.table_bytes + stats.index_bytes;
+}
+
+inline std::size_t TotalBytes(const EntityStats& stats) noexcept {
+  return stats.data_pool.bytes + stats.entity_count * stats.index_bytes +
+         stats.singlenent_table_bytes;
+}
+
+}  // namespace einu
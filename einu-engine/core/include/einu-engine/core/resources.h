@@ -0,0 +1,106 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "einu-engine/core/i_entity_manager.h"
+#include "einu-engine/core/tmp/type_list.h"
+#include "einu-engine/core/xnent_type_id.h"
+
+namespace einu {
+
+template <typename... Singlenents>
+struct Reads {};
+
+template <typename... Singlenents>
+struct Writes {};
+
+// The singlenents a system reads and the ones it writes, by type id.
+struct ResourceAccess {
+  std::vector<XnentTypeID> reads;
+  std::vector<XnentTypeID> writes;
+};
+
+namespace internal {
+
+inline bool Intersects(const std::vector<XnentTypeID>& lhs,
+                       const std::vector<XnentTypeID>& rhs) noexcept {
+  return std::any_of(lhs.begin(), lhs.end(), [&rhs](auto tid) {
+    return std::find(rhs.begin(), rhs.end(), tid) != rhs.end();
+  });
+}
+
+}  // namespace internal
+
+// Two systems conflict, and must not run at the same time, if one of them
+// writes a singlenent the other one reads or writes.
+inline bool Conflicts(const ResourceAccess& lhs,
+                      const ResourceAccess& rhs) noexcept {
+  using internal::Intersects;
+  return Intersects(lhs.writes, rhs.writes) ||
+         Intersects(lhs.writes, rhs.reads) || Intersects(lhs.reads, rhs.writes);
+}
+
+template <typename ReadList, typename WriteList>
+class Resources;
+
+// References to the singlenents a system declares it reads and writes,
+// looked up once instead of on every GetSinglenent call. Read singlenents are
+// only handed out as const. The references stay valid until a singlenent is
+// removed; call Resolve again after replacing one.
+template <typename... Rs, typename... Ws>
+class Resources<Reads<Rs...>, Writes<Ws...>> {
+ public:
+  explicit Resources(IEntityManager& ett_mgr) { Resolve(ett_mgr); }
+
+  void Resolve(IEntityManager& ett_mgr) {
+    reads_ = std::make_tuple(&ett_mgr.GetSinglenent<const Rs>()...);
+    writes_ = std::make_tuple(&ett_mgr.GetSinglenent<Ws>()...);
+  }
+
+  template <typename T>
+  decltype(auto) Get() const noexcept {
+    constexpr auto read_count = tmp::CountType<ReadList, T>::value;
+    constexpr auto write_count = tmp::CountType<WriteList, T>::value;
+    static_assert(read_count + write_count == 1,
+                  "<T> must be declared exactly once in Reads or Writes");
+    if constexpr (write_count == 1) {
+      return static_cast<T&>(*std::get<T*>(writes_));
+    } else {
+      return static_cast<const T&>(*std::get<const T*>(reads_));
+    }
+  }
+
+  static ResourceAccess Access() {
+    return ResourceAccess{{GetXnentTypeID<Rs>()...}, {GetXnentTypeID<Ws>()...}};
+  }
+
+ private:
+  using ReadList = tmp::TypeList<Rs...>;
+  using WriteList = tmp::TypeList<Ws...>;
+
+  std::tuple<const Rs*...> reads_;
+  std::tuple<Ws*...> writes_;
+};
+
+}  // namespace einu
@@ -0,0 +1,50 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string_view>
+
+namespace einu {
+namespace rtti {
+
+// Human readable name of T, e.g. "einu::cmp::Transform". Meant for reports
+// and debugging only; the exact spelling depends on the compiler.
+template <typename T>
+std::string_view GetTypeName() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+  auto name = std::string_view{__FUNCSIG__};
+  auto begin = name.find("GetTypeName<") + 12;
+  auto end = name.rfind(">(");
+  name = name.substr(begin, end - begin);
+  for (auto prefix : {"struct ", "class ", "enum "}) {
+    if (name.substr(0, std::string_view{prefix}.size()) == prefix) {
+      name.remove_prefix(std::string_view{prefix}.size());
+    }
+  }
+  return name;
+#else
+  auto name = std::string_view{__PRETTY_FUNCTION__};
+  auto begin = name.find("T = ") + 4;
+  auto end = name.find_first_of(";]", begin);
+  return name.substr(begin, end - begin);
+#endif
+}
+
+}  // namespace rtti
+}  // namespace einu
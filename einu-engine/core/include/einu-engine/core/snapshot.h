@@ -0,0 +1,567 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "einu-engine/core/i_entity_manager.h"
+#include "einu-engine/core/internal/mapped_file.h"
+#include "einu-engine/core/internal/snapshot_format.h"
+#include "einu-engine/core/tmp/static_algo.h"
+#include "einu-engine/core/tmp/type_list.h"
+#include "einu-engine/core/xnent_list.h"
+
+namespace einu {
+
+class SnapshotError final : public std::exception {
+ public:
+  SnapshotError() = default;
+
+  explicit SnapshotError(const char* message) : message_{message} {}
+  explicit SnapshotError(std::string&& message)
+      : message_{std::move(message)} {}
+
+  ~SnapshotError() = default;
+
+  const char* what() const noexcept override { return message_.c_str(); }
+
+ private:
+  std::string message_{};
+};
+
+class SnapshotWriter {
+ public:
+  explicit SnapshotWriter(std::vector<char>& buffer) noexcept
+      : buffer_{buffer} {}
+
+  void Write(const void* data, std::size_t size) {
+    auto bytes = static_cast<const char*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+  }
+
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value &&
+                  "<T> must be trivially copyable");
+    Write(&value, sizeof(T));
+  }
+
+  template <typename T>
+  void Write(const std::vector<T>& vec) {
+    Write(static_cast<std::uint64_t>(vec.size()));
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      Write(vec.data(), vec.size() * sizeof(T));
+    } else {
+      for (const auto& value : vec) {
+        Write(value);
+      }
+    }
+  }
+
+  void Write(const std::string& str) {
+    Write(static_cast<std::uint64_t>(str.size()));
+    Write(str.data(), str.size());
+  }
+
+ private:
+  std::vector<char>& buffer_;
+};
+
+class SnapshotReader {
+ public:
+  SnapshotReader(const char* begin, const char* end) noexcept
+      : cur_{begin}, end_{end} {}
+
+  void Read(void* data, std::size_t size) {
+    if (Remaining() < size) {
+      throw SnapshotError{"unexpected end of snapshot data"};
+    }
+    std::memcpy(data, cur_, size);
+    cur_ += size;
+  }
+
+  template <typename T>
+  void Read(T& value) {
+    static_assert(std::is_trivially_copyable<T>::value &&
+                  "<T> must be trivially copyable");
+    Read(&value, sizeof(T));
+  }
+
+  template <typename T>
+  void Read(std::vector<T>& vec) {
+    auto size = std::uint64_t{};
+    Read(size);
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      if (Remaining() / sizeof(T) < size) {
+        throw SnapshotError{"unexpected end of snapshot data"};
+      }
+      vec.resize(size);
+      Read(vec.data(), size * sizeof(T));
+    } else {
+      vec.resize(size);
+      for (auto& value : vec) {
+        Read(value);
+      }
+    }
+  }
+
+  void Read(std::string& str) {
+    auto size = std::uint64_t{};
+    Read(size);
+    if (Remaining() < size) {
+      throw SnapshotError{"unexpected end of snapshot data"};
+    }
+    str.assign(cur_, size);
+    cur_ += size;
+  }
+
+  std::size_t Remaining() const noexcept { return end_ - cur_; }
+
+ private:
+  const char* cur_;
+  const char* end_;
+};
+
+// Specialize for xnents that are not trivially copyable (or that should not
+// be copied byte by byte):
+//
+//   template <>
+//   struct SnapshotCodec<cmp::Memory> {
+//     static void Encode(SnapshotWriter& writer, const cmp::Memory& memory);
+//     static void Decode(SnapshotReader& reader, cmp::Memory& memory);
+//   };
+template <typename T>
+struct SnapshotCodec;
+
+namespace internal {
+namespace snapshot {
+
+template <typename T, typename = void>
+struct HasCodec : std::false_type {};
+
+template <typename T>
+struct HasCodec<T, std::void_t<decltype(SnapshotCodec<T>::Encode(
+                       std::declval<SnapshotWriter&>(),
+                       std::declval<const T&>()))>> : std::true_type {};
+
+template <typename T>
+constexpr Encoding GetEncoding() noexcept {
+  static_assert(HasCodec<T>::value || std::is_trivially_copyable<T>::value,
+                "<T> needs a SnapshotCodec specialization");
+  if (IsTag<T>::value) return Encoding::Tag;
+  return HasCodec<T>::value ? Encoding::Codec : Encoding::Raw;
+}
+
+}  // namespace snapshot
+}  // namespace internal
+
+// Saves and restores the listed components and singlenents of a world.
+//
+// Trivially copyable xnents are written as raw blocks, one block per type,
+// and are copied straight out of the (memory mapped) snapshot when loading.
+// Other xnents go through their SnapshotCodec. Tags are stored in the entity
+// masks only.
+template <typename ComponentList, typename SinglenentList>
+class WorldSnapshot;
+
+template <typename... Components, typename... Singlenents>
+class WorldSnapshot<XnentList<Components...>, XnentList<Singlenents...>> {
+ public:
+  static void Save(IEntityManager& ett_mgr, std::vector<char>& buffer) {
+    using namespace internal::snapshot;  // NOLINT
+
+    buffer.clear();
+    auto sections = Sections{};
+    buffer.resize(AlignUp(sizeof(Header) + sizeof(sections)));
+
+    auto all = EntityBuffer{};
+    ett_mgr.GetEntitiesWithComponents(all, XnentList<>{});
+    const auto& eids = all.eids;
+    auto entity_count = eids.size();
+
+    sections[0] = Section{SectionKind::EIDs, 0, Encoding::Raw, sizeof(EID),
+                          entity_count, 0, 0};
+    AppendSection(buffer, sections[0], [&] {
+      SnapshotWriter{buffer}.Write(eids.data(), entity_count * sizeof(EID));
+    });
+
+    sections[1] = Section{SectionKind::Masks, 0, Encoding::Raw, kMaskSize,
+                          entity_count, 0, 0};
+    AppendSection(buffer, sections[1], [&] {
+      buffer.resize(buffer.size() + entity_count * kMaskSize);
+    });
+
+    auto index_table = absl::flat_hash_map<EID, std::uint32_t>{};
+    index_table.reserve(entity_count);
+    for (std::size_t i = 0; i != entity_count; ++i) {
+      index_table[eids[i]] = static_cast<std::uint32_t>(i);
+    }
+
+    auto ett_buffer = EntityBuffer{};
+    auto column = std::vector<std::pair<std::uint32_t, const Xnent*>>{};
+    tmp::static_for<0, kComponentCount>([&](auto i) {
+      using Component = typename tmp::TypeAt<ComponentTypeList, i>::Type;
+      constexpr auto kEncoding = GetEncoding<Component>();
+
+      Clear(ett_buffer);
+      ett_mgr.GetEntitiesWithComponents(ett_buffer, XnentList<Component>{});
+      column.clear();
+      for (std::size_t j = 0; j != ett_buffer.eids.size(); ++j) {
+        column.emplace_back(index_table.at(ett_buffer.eids[j]),
+                            kEncoding == Encoding::Tag ? nullptr
+                                                       : ett_buffer.comps[j]);
+      }
+      auto by_index = [](auto&& lhs, auto&& rhs) {
+        return lhs.first < rhs.first;
+      };
+      if (!std::is_sorted(column.begin(), column.end(), by_index)) {
+        std::sort(column.begin(), column.end(), by_index);
+      }
+      for (auto&& [index, comp] : column) {
+        auto& byte = buffer[sections[1].offset + index * kMaskSize + i / 8];
+        byte = static_cast<char>(byte | (1 << (i % 8)));
+      }
+
+      auto& section = sections[2 + i];
+      section = Section{SectionKind::Component, i, kEncoding,
+                        ElemSize<Component>(), column.size(), 0, 0};
+      AppendSection(buffer, section, [&] {
+        if constexpr (kEncoding != Encoding::Tag) {
+          for (auto&& [index, comp] : column) {
+            Encode(buffer, static_cast<const Component&>(*comp));
+          }
+        }
+      });
+    });
+
+    tmp::static_for<0, kSinglenentCount>([&](auto i) {
+      using Singlenent = typename tmp::TypeAt<SinglenentTypeList, i>::Type;
+      constexpr auto kEncoding = GetEncoding<Singlenent>();
+      auto has_singlenent = ett_mgr.HasSinglenent<Singlenent>();
+
+      auto& section = sections[2 + kComponentCount + i];
+      section = Section{SectionKind::Singlenent, i, kEncoding,
+                        ElemSize<Singlenent>(), has_singlenent ? 1u : 0u, 0,
+                        0};
+      AppendSection(buffer, section, [&] {
+        if (has_singlenent) {
+          Encode(buffer, ett_mgr.GetSinglenent<Singlenent>());
+        }
+      });
+    });
+
+    auto header = Header{};
+    std::copy(std::begin(kMagic), std::end(kMagic), header.magic);
+    header.version = kVersion;
+    header.section_count = kSectionCount;
+    header.entity_count = entity_count;
+    header.component_count = kComponentCount;
+    header.singlenent_count = kSinglenentCount;
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    std::memcpy(buffer.data() + sizeof(header), sections.data(),
+                sizeof(sections));
+  }
+
+  static void SaveFile(IEntityManager& ett_mgr, const std::string& path) {
+    auto buffer = std::vector<char>{};
+    Save(ett_mgr, buffer);
+    auto file = std::ofstream{path, std::ios::binary | std::ios::trunc};
+    if (!file) {
+      throw SnapshotError{"failed to open " + path};
+    }
+    file.write(buffer.data(), buffer.size());
+    if (!file) {
+      throw SnapshotError{"failed to write " + path};
+    }
+  }
+
+  // Restores a snapshot into a world that has none of the saved entities.
+  // Singlenents in the snapshot replace the ones already in the world.
+  // The snapshot layout is validated before the world is touched; only a
+  // failing SnapshotCodec can leave the world partially loaded.
+  static void Load(IEntityManager& ett_mgr, const char* data,
+                   std::size_t size) {
+    auto sections = ReadSections(data, size);
+    auto eids = ReadEIDs(data, sections);
+    ett_mgr.CreateEntities(eids.data(), eids.size());
+    LoadXnents(ett_mgr, data, sections, eids);
+  }
+
+  // Rewinds a world to a snapshot taken from it earlier. Entities created
+  // after the snapshot are destroyed, destroyed ones are recreated and the
+  // listed xnents are replaced. Xnents that are not listed are left alone on
+  // the entities that survive.
+  static void Restore(IEntityManager& ett_mgr, const char* data,
+                      std::size_t size) {
+    auto sections = ReadSections(data, size);
+    auto eids = ReadEIDs(data, sections);
+
+    auto saved = absl::flat_hash_map<EID, bool>{};
+    saved.reserve(eids.size());
+    for (auto eid : eids) {
+      saved[eid] = false;
+    }
+
+    auto all = EntityBuffer{};
+    ett_mgr.GetEntitiesWithComponents(all, XnentList<>{});
+    for (auto eid : all.eids) {
+      auto it = saved.find(eid);
+      if (it == saved.end()) {
+        ett_mgr.DestroyEntity(eid);
+        continue;
+      }
+      it->second = true;
+      tmp::static_for<0, kComponentCount>([&](auto i) {
+        using Component = typename tmp::TypeAt<ComponentTypeList, i>::Type;
+        if (ett_mgr.HasComponent<Component>(eid)) {
+          ett_mgr.RemoveComponent<Component>(eid);
+        }
+      });
+    }
+    for (auto eid : eids) {
+      if (!saved[eid]) {
+        ett_mgr.CreateEntity(eid);
+      }
+    }
+
+    tmp::static_for<0, kSinglenentCount>([&](auto i) {
+      using Singlenent = typename tmp::TypeAt<SinglenentTypeList, i>::Type;
+      if (sections[2 + kComponentCount + i].count == 0 &&
+          ett_mgr.HasSinglenent<Singlenent>()) {
+        ett_mgr.RemoveSinglenent<Singlenent>();
+      }
+    });
+
+    LoadXnents(ett_mgr, data, sections, eids);
+  }
+
+  static void LoadFile(IEntityManager& ett_mgr, const std::string& path) {
+    try {
+      auto file = internal::MappedFile{path};
+      Load(ett_mgr, file.Data(), file.Size());
+    } catch (const std::runtime_error& error) {
+      throw SnapshotError{error.what()};
+    }
+  }
+
+ private:
+  using ComponentTypeList = tmp::TypeList<Components...>;
+  using SinglenentTypeList = tmp::TypeList<Singlenents...>;
+  static constexpr std::size_t kComponentCount = sizeof...(Components);
+  static constexpr std::size_t kSinglenentCount = sizeof...(Singlenents);
+  static constexpr std::size_t kSectionCount =
+      internal::snapshot::SectionCount(kComponentCount, kSinglenentCount);
+  static constexpr std::size_t kMaskSize =
+      internal::snapshot::MaskSizeInBytes(kComponentCount);
+  using Sections = std::array<internal::snapshot::Section, kSectionCount>;
+
+  template <typename T>
+  static constexpr std::uint32_t ElemSize() noexcept {
+    using internal::snapshot::Encoding;
+    return internal::snapshot::GetEncoding<T>() == Encoding::Raw ? sizeof(T)
+                                                                 : 0;
+  }
+
+  template <typename Fn>
+  static void AppendSection(std::vector<char>& buffer,
+                            internal::snapshot::Section& section, Fn&& write) {
+    section.offset = buffer.size();
+    write();
+    section.size = buffer.size() - section.offset;
+    buffer.resize(internal::snapshot::AlignUp(buffer.size()));
+  }
+
+  template <typename T>
+  static void Encode(std::vector<char>& buffer, const T& xnent) {
+    using internal::snapshot::Encoding;
+    auto writer = SnapshotWriter{buffer};
+    if constexpr (internal::snapshot::GetEncoding<T>() == Encoding::Tag) {
+      return;
+    } else if constexpr (internal::snapshot::GetEncoding<T>() ==
+                         Encoding::Raw) {
+      writer.Write(&xnent, sizeof(T));
+    } else {
+      SnapshotCodec<T>::Encode(writer, xnent);
+    }
+  }
+
+  template <typename T>
+  static void Decode(SnapshotReader& reader, T& xnent) {
+    using internal::snapshot::Encoding;
+    if constexpr (internal::snapshot::GetEncoding<T>() == Encoding::Tag) {
+      return;
+    } else if constexpr (internal::snapshot::GetEncoding<T>() ==
+                         Encoding::Raw) {
+      reader.Read(&xnent, sizeof(T));
+    } else {
+      SnapshotCodec<T>::Decode(reader, xnent);
+    }
+  }
+
+  static std::vector<EID> ReadEIDs(const char* data,
+                                   const Sections& sections) {
+    auto eids = std::vector<EID>(sections[0].count);
+    std::memcpy(eids.data(), data + sections[0].offset,
+                eids.size() * sizeof(EID));
+    return eids;
+  }
+
+  static void LoadXnents(IEntityManager& ett_mgr, const char* data,
+                         const Sections& sections,
+                         const std::vector<EID>& eids) {
+    const auto* masks = data + sections[1].offset;
+
+    // the components of a type are added to all their entities at once
+    auto owners = std::vector<EID>{};
+    auto comps = std::vector<Xnent*>{};
+    tmp::static_for<0, kComponentCount>([&](auto i) {
+      using Component = typename tmp::TypeAt<ComponentTypeList, i>::Type;
+      const auto& section = sections[2 + i];
+      owners.clear();
+      for (std::size_t j = 0; j != eids.size(); ++j) {
+        if (TestMask(masks, j, i)) owners.push_back(eids[j]);
+      }
+      comps.resize(owners.size());
+      ett_mgr.AddComponents(owners.data(), owners.size(),
+                            GetXnentTypeID<Component>(), comps.data());
+
+      auto reader = SnapshotReader{data + section.offset,
+                                   data + section.offset + section.size};
+      for (auto* comp : comps) {
+        Decode(reader, static_cast<Component&>(*comp));
+      }
+    });
+
+    tmp::static_for<0, kSinglenentCount>([&](auto i) {
+      using Singlenent = typename tmp::TypeAt<SinglenentTypeList, i>::Type;
+      const auto& section = sections[2 + kComponentCount + i];
+      if (section.count == 0) return;
+      auto reader = SnapshotReader{data + section.offset,
+                                   data + section.offset + section.size};
+      auto& singlenent = ett_mgr.HasSinglenent<Singlenent>()
+                             ? ett_mgr.GetSinglenent<Singlenent>()
+                             : ett_mgr.AddSinglenent<Singlenent>();
+      Decode(reader, singlenent);
+    });
+  }
+
+  static bool TestMask(const char* masks, std::size_t entity_index,
+                       std::size_t comp_index) noexcept {
+    auto byte = masks[entity_index * kMaskSize + comp_index / 8];
+    return (byte >> (comp_index % 8)) & 1;
+  }
+
+  static Sections ReadSections(const char* data, std::size_t size) {
+    using namespace internal::snapshot;  // NOLINT
+
+    auto header = Header{};
+    auto sections = Sections{};
+    if (size < sizeof(header) + sizeof(sections)) {
+      throw SnapshotError{"snapshot is too small"};
+    }
+    std::memcpy(&header, data, sizeof(header));
+    std::memcpy(sections.data(), data + sizeof(header), sizeof(sections));
+
+    if (!std::equal(std::begin(kMagic), std::end(kMagic), header.magic)) {
+      throw SnapshotError{"not a snapshot"};
+    }
+    if (header.version != kVersion) {
+      throw SnapshotError{"unsupported snapshot version " +
+                          std::to_string(header.version)};
+    }
+    if (header.section_count != kSectionCount ||
+        header.component_count != kComponentCount ||
+        header.singlenent_count != kSinglenentCount) {
+      throw SnapshotError{"snapshot does not match the xnent lists"};
+    }
+
+    auto expected = Sections{};
+    expected[0] = {SectionKind::EIDs, 0, Encoding::Raw, sizeof(EID),
+                   header.entity_count, 0, 0};
+    expected[1] = {SectionKind::Masks, 0, Encoding::Raw, kMaskSize,
+                   header.entity_count, 0, 0};
+    tmp::static_for<0, kComponentCount>([&](auto i) {
+      using Component = typename tmp::TypeAt<ComponentTypeList, i>::Type;
+      expected[2 + i] = {SectionKind::Component, i, GetEncoding<Component>(),
+                         ElemSize<Component>(), 0, 0, 0};
+    });
+    tmp::static_for<0, kSinglenentCount>([&](auto i) {
+      using Singlenent = typename tmp::TypeAt<SinglenentTypeList, i>::Type;
+      expected[2 + kComponentCount + i] = {SectionKind::Singlenent, i,
+                                           GetEncoding<Singlenent>(),
+                                           ElemSize<Singlenent>(), 0, 0, 0};
+    });
+
+    for (std::size_t i = 0; i != kSectionCount; ++i) {
+      const auto& section = sections[i];
+      const auto& expect = expected[i];
+      if (section.kind != expect.kind || section.index != expect.index ||
+          section.encoding != expect.encoding ||
+          section.elem_size != expect.elem_size) {
+        throw SnapshotError{"snapshot section " + std::to_string(i) +
+                            " does not match the xnent lists"};
+      }
+      if (section.offset > size || section.size > size - section.offset) {
+        throw SnapshotError{"snapshot section " + std::to_string(i) +
+                            " is out of bounds"};
+      }
+      if ((section.encoding == Encoding::Raw ||
+           section.encoding == Encoding::Tag) &&
+          section.size != section.count * section.elem_size) {
+        throw SnapshotError{"snapshot section " + std::to_string(i) +
+                            " has a wrong size"};
+      }
+    }
+    if (sections[0].count != header.entity_count ||
+        sections[1].count != header.entity_count) {
+      throw SnapshotError{"snapshot entity count mismatch"};
+    }
+
+    const auto* masks = data + sections[1].offset;
+    for (std::size_t i = 0; i != kComponentCount; ++i) {
+      auto count = std::uint64_t{0};
+      for (std::size_t j = 0; j != header.entity_count; ++j) {
+        count += TestMask(masks, j, i);
+      }
+      if (count != sections[2 + i].count) {
+        throw SnapshotError{"snapshot mask does not match component count"};
+      }
+    }
+    for (std::size_t i = 0; i != kSinglenentCount; ++i) {
+      if (sections[2 + kComponentCount + i].count > 1) {
+        throw SnapshotError{"snapshot has more than one singlenent"};
+      }
+    }
+
+    return sections;
+  }
+};
+
+}  // namespace einu
@@ -0,0 +1,123 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "einu-engine/core/i_entity_manager.h"
+#include "einu-engine/core/internal/snapshot_delta.h"
+#include "einu-engine/core/snapshot.h"
+
+namespace einu {
+
+// Keeps the last max_frames recorded frames of a world for rollback and
+// replay. Only the latest frame is stored in full; every older frame is
+// stored as the delta that turns its successor back into it. Buffers are
+// kept and reused from frame to frame, so once the history is full,
+// recording a frame allocates only when a delta outgrows its buffer.
+template <typename ComponentList, typename SinglenentList>
+class SnapshotHistory {
+ public:
+  using Snapshot = WorldSnapshot<ComponentList, SinglenentList>;
+
+  explicit SnapshotHistory(std::size_t max_frames) noexcept
+      : max_frames_{max_frames} {
+    assert(max_frames_ != 0 && "history must hold at least one frame");
+  }
+
+  void Record(IEntityManager& ett_mgr) {
+    Snapshot::Save(ett_mgr, scratch_);
+    // a history of one frame keeps only the latest
+    if (!latest_.empty() && max_frames_ != 1) {
+      auto delta = std::vector<char>{};
+      if (!deltas_.empty() && deltas_.size() + 1 >= max_frames_) {
+        delta = std::move(deltas_.front());
+        deltas_.pop_front();
+      } else if (!spare_deltas_.empty()) {
+        delta = std::move(spare_deltas_.back());
+        spare_deltas_.pop_back();
+      }
+      internal::snapshot::EncodeDelta(latest_, scratch_, delta);
+      deltas_.push_back(std::move(delta));
+    }
+    std::swap(latest_, scratch_);
+  }
+
+  // Rewinds the world to the frame recorded frame_count frames before the
+  // latest one and forgets the frames after it. Rolling back 0 frames
+  // restores the latest frame.
+  void Rollback(IEntityManager& ett_mgr, std::size_t frame_count) {
+    assert(frame_count < FrameCount() && "not enough frames recorded");
+    for (std::size_t i = 0; i != frame_count; ++i) {
+      internal::snapshot::DecodeDelta(latest_, deltas_.back(), scratch_);
+      std::swap(latest_, scratch_);
+      spare_deltas_.push_back(std::move(deltas_.back()));
+      deltas_.pop_back();
+    }
+    Snapshot::Restore(ett_mgr, latest_.data(), latest_.size());
+  }
+
+  // The full snapshot of the frame frame_count frames before the latest one.
+  std::vector<char> GetFrame(std::size_t frame_count) const {
+    assert(frame_count < FrameCount() && "not enough frames recorded");
+    auto frame = latest_;
+    auto prev = std::vector<char>{};
+    for (auto it = deltas_.rbegin(); it != deltas_.rbegin() + frame_count;
+         ++it) {
+      internal::snapshot::DecodeDelta(frame, *it, prev);
+      std::swap(frame, prev);
+    }
+    return frame;
+  }
+
+  std::size_t FrameCount() const noexcept {
+    return latest_.empty() ? 0 : deltas_.size() + 1;
+  }
+
+  std::size_t MemoryUsage() const noexcept {
+    auto size = latest_.capacity() + scratch_.capacity();
+    for (const auto& delta : deltas_) {
+      size += delta.capacity();
+    }
+    for (const auto& delta : spare_deltas_) {
+      size += delta.capacity();
+    }
+    return size;
+  }
+
+  void Clear() noexcept {
+    latest_.clear();
+    deltas_.clear();
+    spare_deltas_.clear();
+  }
+
+ private:
+  std::size_t max_frames_;
+  std::vector<char> latest_{};
+  std::vector<char> scratch_{};
+  std::deque<std::vector<char>> deltas_{};
+  // buffers of rolled back deltas, reused by the next frames
+  std::vector<std::vector<char>> spare_deltas_{};
+};
+
+}  // namespace einu
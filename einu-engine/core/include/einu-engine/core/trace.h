@@ -0,0 +1,298 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Scoped trace zones, compiled in only when EINU_CORE_PROFILE is defined and
+// recorded only while tracing is enabled at runtime:
+//
+//   void Update(...) {
+//     EINU_TRACE_SCOPE("update");
+//     ...
+//   }
+//
+//   einu::trace::SetEnabled(true);
+//   ...
+//   einu::trace::WriteChromeTrace("trace.json");
+//
+// Every thread records into its own ring buffer, so recording takes no lock.
+// A buffer grows as zones are recorded, up to EINU_CORE_TRACE_BUFFER_CAPACITY
+// zones unless SetBufferCapacity says otherwise; once full, the oldest zones
+// are overwritten. Export and Clear must not run while traced threads are
+// recording.
+
+#ifndef EINU_CORE_TRACE_BUFFER_CAPACITY
+#define EINU_CORE_TRACE_BUFFER_CAPACITY 65536
+#endif
+
+#define EINU_TRACE_CONCAT_IMPL(a, b) a##b
+#define EINU_TRACE_CONCAT(a, b) EINU_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef EINU_CORE_PROFILE
+#define EINU_TRACE_SCOPE(name) \
+  ::einu::trace::Scope EINU_TRACE_CONCAT(einu_trace_scope_, __LINE__) { name }
+#define EINU_TRACE_FUNCTION() EINU_TRACE_SCOPE(__func__)
+#else
+#define EINU_TRACE_SCOPE(name) static_cast<void>(0)
+#define EINU_TRACE_FUNCTION() static_cast<void>(0)
+#endif
+
+namespace einu {
+namespace trace {
+
+struct Zone {
+  // must outlive the export, e.g. a string literal
+  const char* name;
+  std::int64_t begin_ns;
+  std::int64_t end_ns;
+};
+
+namespace internal {
+
+inline constexpr std::size_t kDefaultBufferCapacity =
+    EINU_CORE_TRACE_BUFFER_CAPACITY;
+
+class ThreadBuffer {
+ public:
+  ThreadBuffer(std::uint32_t tid, std::size_t capacity)
+      : tid_{tid}, capacity_{std::max<std::size_t>(capacity, 1)} {}
+
+  void Push(const Zone& zone) {
+    auto count = count_.load(std::memory_order_relaxed);
+    auto pos = static_cast<std::size_t>(count % capacity_);
+    if (pos == zones_.size()) {
+      // grow in steps that stop at the capacity
+      if (zones_.size() == zones_.capacity()) {
+        zones_.reserve(std::min(capacity_, std::max<std::size_t>(
+                                               zones_.size() * 2, 64)));
+      }
+      zones_.push_back(zone);
+    } else {
+      zones_[pos] = zone;
+    }
+    count_.store(count + 1, std::memory_order_release);
+  }
+
+  template <typename Fn>
+  void ForEach(Fn&& fn) const {
+    auto count = count_.load(std::memory_order_acquire);
+    auto size = std::min<std::uint64_t>(count, capacity_);
+    for (auto i = count - size; i != count; ++i) {
+      fn(zones_[i % capacity_]);
+    }
+  }
+
+  void Clear() noexcept { count_.store(0, std::memory_order_relaxed); }
+
+  std::uint32_t GetTID() const noexcept { return tid_; }
+
+  std::size_t BufferBytes() const noexcept {
+    return zones_.capacity() * sizeof(Zone);
+  }
+
+  const std::string& GetName() const noexcept { return name_; }
+  void SetName(std::string name) { name_ = std::move(name); }
+
+ private:
+  std::uint32_t tid_;
+  std::size_t capacity_;
+  std::string name_;
+  std::vector<Zone> zones_;
+  std::atomic<std::uint64_t> count_{0};
+};
+
+class Registry {
+ public:
+  static Registry& Get() {
+    static auto registry = Registry{};
+    return registry;
+  }
+
+  ThreadBuffer& GetThreadBuffer() {
+    thread_local auto buffer = [this] {
+      auto lock = std::lock_guard{mutex_};
+      auto tid = static_cast<std::uint32_t>(buffers_.size());
+      buffers_.push_back(std::make_shared<ThreadBuffer>(tid, capacity_));
+      return buffers_.back();
+    }();
+    return *buffer;
+  }
+
+  std::int64_t Now() const noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - start_)
+        .count();
+  }
+
+  bool IsEnabled() const noexcept {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  void SetEnabled(bool enabled) noexcept {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  void SetBufferCapacity(std::size_t capacity) noexcept {
+    auto lock = std::lock_guard{mutex_};
+    capacity_ = capacity;
+  }
+
+  template <typename Fn>
+  void ForEachBuffer(Fn&& fn) const {
+    auto lock = std::lock_guard{mutex_};
+    for (const auto& buffer : buffers_) {
+      fn(*buffer);
+    }
+  }
+
+ private:
+  Registry() = default;
+
+  std::chrono::steady_clock::time_point start_ =
+      std::chrono::steady_clock::now();
+  std::atomic<bool> enabled_{false};
+  mutable std::mutex mutex_;
+  std::size_t capacity_ = kDefaultBufferCapacity;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+};
+
+inline void WriteJSONString(std::ostream& os, const char* str) {
+  os << '"';
+  for (; *str; ++str) {
+    switch (*str) {
+      case '"':
+        os << "\\\"";
+        break;
+      case '\\':
+        os << "\\\\";
+        break;
+      case '\n':
+        os << "\\n";
+        break;
+      default:
+        os << *str;
+    }
+  }
+  os << '"';
+}
+
+}  // namespace internal
+
+inline bool IsEnabled() noexcept {
+  return internal::Registry::Get().IsEnabled();
+}
+
+inline void SetEnabled(bool enabled) noexcept {
+  internal::Registry::Get().SetEnabled(enabled);
+}
+
+// Applies to threads that have not recorded anything yet.
+inline void SetBufferCapacity(std::size_t zone_count) noexcept {
+  internal::Registry::Get().SetBufferCapacity(zone_count);
+}
+
+inline void SetThreadName(std::string name) {
+  internal::Registry::Get().GetThreadBuffer().SetName(std::move(name));
+}
+
+inline void Record(const Zone& zone) {
+  internal::Registry::Get().GetThreadBuffer().Push(zone);
+}
+
+class Scope {
+ public:
+  explicit Scope(const char* name) noexcept : name_{name} {
+    if (IsEnabled()) {
+      begin_ns_ = internal::Registry::Get().Now();
+    }
+  }
+
+  ~Scope() {
+    if (begin_ns_ >= 0) {
+      auto& registry = internal::Registry::Get();
+      registry.GetThreadBuffer().Push(Zone{name_, begin_ns_, registry.Now()});
+    }
+  }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  const char* name_;
+  std::int64_t begin_ns_ = -1;
+};
+
+inline void Clear() {
+  internal::Registry::Get().ForEachBuffer(
+      [](internal::ThreadBuffer& buffer) { buffer.Clear(); });
+}
+
+// Writes the recorded zones in the Trace Event Format understood by
+// chrome://tracing and Perfetto.
+inline void WriteChromeTrace(std::ostream& os) {
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  auto first = true;
+  auto separate = [&] {
+    if (!first) os << ',';
+    first = false;
+  };
+  internal::Registry::Get().ForEachBuffer([&](const auto& buffer) {
+    if (!buffer.GetName().empty()) {
+      separate();
+      os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":"
+         << buffer.GetTID() << ",\"args\":{\"name\":";
+      internal::WriteJSONString(os, buffer.GetName().c_str());
+      os << "}}";
+    }
+    buffer.ForEach([&](const Zone& zone) {
+      separate();
+      os << "{\"name\":";
+      internal::WriteJSONString(os, zone.name);
+      os << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer.GetTID()
+         << ",\"ts\":" << zone.begin_ns / 1000 << '.'
+         << zone.begin_ns % 1000 / 100
+         << ",\"dur\":" << (zone.end_ns - zone.begin_ns) / 1000 << '.'
+         << (zone.end_ns - zone.begin_ns) % 1000 / 100 << '}';
+    });
+  });
+  os << "]}\n";
+}
+
+inline void WriteChromeTrace(const std::string& path) {
+  auto file = std::ofstream{path};
+  if (!file) {
+    throw std::runtime_error("failed to open trace file " + path);
+  }
+  WriteChromeTrace(file);
+}
+
+}  // namespace trace
+}  // namespace einu
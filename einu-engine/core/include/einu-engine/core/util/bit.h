@@ -28,8 +28,10 @@
 #ifdef _MSC_VER
 #include <intrin.h>
 #pragma intrinsic(_BitScanReverse)
+#pragma intrinsic(_BitScanForward)
 #if _WIN64
 #pragma intrinsic(_BitScanReverse64)
+#pragma intrinsic(_BitScanForward64)
 #endif
 #endif
 
@@ -44,6 +46,10 @@ int CountLeftZero(std::uint64_t x) noexcept;
 std::optional<std::size_t> CountLeftZero(const std::uint64_t* begin,
                                          const std::uint64_t* end) noexcept;
 
+int CountRightZero(std::uint32_t x) noexcept;
+
+int CountRightZero(std::uint64_t x) noexcept;
+
 namespace internal {
 
 template <typename Mask>
@@ -74,6 +80,16 @@ inline std::optional<std::size_t> CountLeftZero(
   return internal::CountLeftZero(begin, end);
 }
 
+inline int CountRightZero(std::uint32_t x) noexcept {
+#ifdef _MSC_VER
+  unsigned long index;  // NOLINT
+  _BitScanForward(&index, x);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(x);
+#endif
+}
+
 #if _WIN64 || __x86_64__ || __ppc64__
 
 inline int CountLeftZero(std::uint64_t x) noexcept {
@@ -91,6 +107,16 @@ inline std::optional<std::size_t> CountLeftZero(
   return internal::CountLeftZero(begin, end);
 }
 
+inline int CountRightZero(std::uint64_t x) noexcept {
+#ifdef _MSC_VER
+  unsigned long index;  // NOLINT
+  _BitScanForward64(&index, x);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(x);
+#endif
+}
+
 #endif
 
 class BitVector {
@@ -138,6 +164,24 @@ class BitVector {
     return std::nullopt;
   }
 
+  // Like countl_zero(), but ignores the bits before pos: the position of the
+  // first set bit at or after pos.
+  std::optional<size_type> countl_zero(size_type pos) const noexcept {
+    if (pos >= size_) return std::nullopt;
+    auto word = pos / kWordBits;
+    auto bits = mask_[word] & (~size_type(0) >> (pos % kWordBits));
+    if (!bits) {
+      auto clz = CountLeftZero(mask_.data() + ++word,
+                               mask_.data() + mask_.size());
+      if (!clz.has_value()) return std::nullopt;
+      word += *clz / kWordBits;
+      bits = mask_[word];
+    }
+    auto found = word * kWordBits + CountLeftZero(bits);
+    if (found < size_) return found;
+    return std::nullopt;
+  }
+
   bool test(size_type pos) const noexcept {
     auto bit_mask = GetBitMask(pos);
     return (mask_[pos / kWordBits] & bit_mask) == bit_mask;
@@ -28,6 +28,7 @@
 #include <utility>
 #include <vector>
 
+#include "einu-engine/core/memory_stats.h"
 #include "einu-engine/core/util/bit.h"
 
 namespace einu {
@@ -44,11 +45,14 @@ class FixedPoolImpl {
   using const_reference = std::tuple<const Ts&...>;
 
   explicit FixedPoolImpl(size_type count)
-      : object_arr_tuple_{ObjectArray<Ts>(count)...}, bit_arr_(count, true) {}
+      : object_arr_tuple_{ObjectArray<Ts>(count)...},
+        bit_arr_(count, true),
+        free_count_{count} {}
 
   FixedPoolImpl(size_type count, const value_type& value)
       : object_arr_tuple_{ObjectArray<Ts>(count, std::get<Ts>(value))...},
-        bit_arr_(count, true) {}
+        bit_arr_(count, true),
+        free_count_{count} {}
 
   FixedPoolImpl(const FixedPoolImpl&) = delete;
   FixedPoolImpl& operator=(const FixedPoolImpl&) = delete;
@@ -56,13 +60,18 @@ class FixedPoolImpl {
   FixedPoolImpl& operator=(FixedPoolImpl&&) = default;
 
   size_type Size() const noexcept { return bit_arr_.size(); }
+  size_type FreeCount() const noexcept { return free_count_; }
   std::optional<size_type> FreePos() const noexcept {
     return bit_arr_.countl_zero();
   }
 
+  // Compares addresses rather than taking their difference, which is only
+  // defined within one chunk and, narrowed, made far away chunks match.
   bool Has(const_reference obj) const noexcept {
-    auto idx = &std::get<0>(obj) - std::get<0>(object_arr_tuple_).data();
-    return 0 <= idx && (unsigned)idx < Size();
+    const auto* first = std::get<0>(object_arr_tuple_).data();
+    const auto* ptr = &std::get<0>(obj);
+    auto less = std::less<>{};
+    return !less(ptr, first) && less(ptr, first + Size());
   }
 
   [[nodiscard]] reference Acquire() noexcept {
@@ -74,14 +83,29 @@ class FixedPoolImpl {
   [[nodiscard]] reference Acquire(size_type pos_hint) noexcept {
     assert(bit_arr_[pos_hint] && "object at pos is not available");
     bit_arr_[pos_hint] = false;
+    --free_count_;
     return std::forward_as_tuple(
         std::get<ObjectArray<Ts>>(object_arr_tuple_)[pos_hint]...);
   }
 
+  // Acquires up to count free objects in address order, calls fn(obj) for
+  // each of them and returns how many were acquired.
+  template <typename Fn>
+  size_type Acquire(size_type count, Fn&& fn) {
+    count = std::min(count, free_count_);
+    auto pos = size_type{0};
+    for (size_type i = 0; i != count; ++i) {
+      pos = *bit_arr_.countl_zero(pos);
+      fn(Acquire(pos++));
+    }
+    return count;
+  }
+
   void Release(const_reference obj) noexcept {
     auto idx = &std::get<0>(obj) - std::get<0>(object_arr_tuple_).data();
     assert(!bit_arr_[idx] && "object is already released");
     bit_arr_[idx] = true;
+    ++free_count_;
   }
 
  private:
@@ -90,6 +114,14 @@ class FixedPoolImpl {
 
   std::tuple<ObjectArray<Ts>...> object_arr_tuple_;
   util::BitVector bit_arr_;
+  size_type free_count_;
+};
+
+struct Identity {
+  template <typename T>
+  constexpr T&& operator()(T&& t) const noexcept {
+    return std::forward<T>(t);
+  }
 };
 
 }  // namespace internal
@@ -116,6 +148,7 @@ class FixedPool<T> {
       : pool_{count, std::forward_as_tuple(value)} {}
 
   size_type Size() const noexcept { return pool_.Size(); }
+  size_type FreeCount() const noexcept { return pool_.FreeCount(); }
   std::optional<size_type> FreePos() const noexcept { return pool_.FreePos(); }
   bool Has(const_reference obj) const noexcept { return pool_.Has(obj); }
   [[nodiscard]] reference Acquire() noexcept {
@@ -124,6 +157,10 @@ class FixedPool<T> {
   [[nodiscard]] reference Acquire(size_type pos_hint) noexcept {
     return std::get<0>(pool_.Acquire(pos_hint));
   }
+  template <typename Fn>
+  size_type Acquire(size_type count, Fn&& fn) {
+    return pool_.Acquire(count, [&fn](auto&& obj) { fn(std::get<0>(obj)); });
+  }
   void Release(const_reference obj) noexcept {
     pool_.Release(std::forward_as_tuple(obj));
   }
@@ -180,6 +217,7 @@ class DynamicPool {
   [[nodiscard]] reference Acquire() {
     if (PoolsAllAcquired()) {
       GrowExtra(growth_(Size()));
+      ++growth_count_;
     }
 
     auto free_pos = pools_bit_array_.countl_zero();
@@ -188,16 +226,55 @@ class DynamicPool {
     auto& pool = pools_[*free_pos];
     auto&& obj = pool.Acquire();
     pools_bit_array_[*free_pos] = pool.FreePos().has_value();
+    ++live_count_;
     return obj;
   }
 
+  // Acquires count objects and calls fn(obj) for each of them. The pool
+  // grows at most once, by enough for all of them, and the objects are
+  // taken chunk by chunk in address order.
+  template <typename Fn>
+  void Acquire(size_type count, Fn&& fn) {
+    auto free_count = Size() - live_count_;
+    if (free_count < count) {
+      GrowExtra(std::max(growth_(Size()), count - free_count));
+      ++growth_count_;
+    }
+
+    auto free_pos = pools_bit_array_.countl_zero();
+    while (count != 0) {
+      assert(free_pos.has_value() && "no pool is free");
+      auto& pool = pools_[*free_pos];
+      auto acquired = pool.Acquire(count, fn);
+      pools_bit_array_[*free_pos] = pool.FreePos().has_value();
+      live_count_ += acquired;
+      count -= acquired;
+      free_pos = pools_bit_array_.countl_zero(*free_pos + 1);
+    }
+  }
+
   void Release(const_reference obj) noexcept {
-    auto pool_it =
-        std::find_if(pools_.begin(), pools_.end(),
-                     [&obj](const auto& pool) { return pool.Has(obj); });
-    assert(pool_it != pools_.end() && "object does not belong to this pool");
+    auto pool_it = FindPool(obj);
     pool_it->Release(obj);
     pools_bit_array_.set(pool_it - pools_.begin());
+    --live_count_;
+  }
+
+  // Releases proj(*it) for every it in [first, last). The chunk of the
+  // previous object is tried first, so objects sorted by address are
+  // released without searching the chunks again.
+  template <typename InputIt, typename Proj = internal::Identity>
+  void Release(InputIt first, InputIt last, Proj proj = {}) noexcept {
+    auto pool_it = pools_.end();
+    for (; first != last; ++first) {
+      const_reference obj = proj(*first);
+      if (pool_it == pools_.end() || !pool_it->Has(obj)) {
+        pool_it = FindPool(obj);
+        pools_bit_array_.set(pool_it - pools_.begin());
+      }
+      pool_it->Release(obj);
+      --live_count_;
+    }
   }
 
   size_type Size() const noexcept {
@@ -206,16 +283,43 @@ class DynamicPool {
         [](auto acc, const auto& pool) { return acc + pool.Size(); });
   }
 
+  PoolStats GetStats() const noexcept {
+    auto stats = PoolStats{};
+    stats.capacity = Size();
+    stats.live = live_count_;
+    stats.chunk_count = pools_.size();
+    stats.growth_count = growth_count_;
+    for (const auto& pool : pools_) {
+      if (pool.FreeCount() != pool.Size()) {
+        stats.scattered_free += pool.FreeCount();
+      }
+    }
+    stats.bytes = stats.capacity * (sizeof(Ts) + ...) + stats.capacity / 8 +
+                  pools_.capacity() * sizeof(OnePool) +
+                  pools_bit_array_.capacity() / 8;
+    return stats;
+  }
+
   void Clear() noexcept {
     value_.reset();
     growth_ = DefaultGrowth;
     pools_.clear();
     pools_bit_array_.clear();
+    live_count_ = 0;
+    growth_count_ = 0;
   }
 
  private:
   using PoolList = std::vector<OnePool>;
 
+  typename PoolList::iterator FindPool(const_reference obj) noexcept {
+    auto pool_it =
+        std::find_if(pools_.begin(), pools_.end(),
+                     [&obj](const auto& pool) { return pool.Has(obj); });
+    assert(pool_it != pools_.end() && "object does not belong to this pool");
+    return pool_it;
+  }
+
   bool PoolsAllAcquired() const noexcept {
     for (const auto& pool : pools_) {
       if (!AllAcquired(pool)) return false;
@@ -227,6 +331,8 @@ class DynamicPool {
   GrowthFunc growth_;
   PoolList pools_;
   BitVector pools_bit_array_;
+  size_type live_count_ = 0;
+  size_type growth_count_ = 0;
 };
 
 }  // namespace util
@@ -0,0 +1,38 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#ifdef _MSC_VER
+#include <xmmintrin.h>
+#endif
+
+namespace einu {
+namespace util {
+
+// Hints the CPU to pull the cache line holding addr into all cache levels.
+inline void Prefetch(const void* addr) noexcept {
+#ifdef _MSC_VER
+  _mm_prefetch(static_cast<const char*>(addr), _MM_HINT_T0);
+#else
+  __builtin_prefetch(addr);
+#endif
+}
+
+}  // namespace util
+}  // namespace einu
@@ -0,0 +1,234 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "einu-engine/core/entity_view.h"
+#include "einu-engine/core/i_entity_manager.h"
+#include "einu-engine/core/resources.h"
+#include "einu-engine/core/trace.h"
+#include "einu-engine/core/xnent_list.h"
+
+namespace einu {
+
+// Stages run in this order every frame; systems of a stage run in the order
+// they were added.
+enum class Stage {
+  PreUpdate,
+  Update,
+  PostUpdate,
+  RenderPrep,
+};
+
+inline constexpr std::size_t kStageCount = 4;
+
+inline const char* GetStageName(Stage stage) noexcept {
+  constexpr const char* kNames[kStageCount] = {"pre-update", "update",
+                                               "post-update", "render-prep"};
+  return kNames[static_cast<std::size_t>(stage)];
+}
+
+struct SystemStats {
+  std::string name;
+  Stage stage = Stage::Update;
+  // entities in the view of the system at its last run
+  std::size_t entity_count = 0;
+  std::size_t run_count = 0;
+  std::chrono::nanoseconds last_time{};
+  std::chrono::nanoseconds total_time{};
+};
+
+// The systems of a world and the order they run in. A system registered with
+// a component list gets its own EntityView, refreshed right before the
+// system runs, so it sees the entities created and destroyed by the systems
+// before it:
+//
+//   world.AddSystem(Stage::Update, "move",
+//                   [&](Transform& transform, const Movement& movement) {
+//                     Move(time, transform, movement);
+//                   },
+//                   XnentList<Transform, const Movement>{});
+//   ...
+//   world.Run();
+//
+// Every run of a system is timed and recorded as a trace zone.
+//
+// A system may declare the singlenents it reads and writes, usually by the
+// Access() of its Resources. Systems of a stage are meant not to depend on
+// each other, so adding one whose access conflicts with a system already in
+// the stage throws; put it in a later stage instead.
+class World {
+ public:
+  explicit World(IEntityManager& ett_mgr) noexcept : ett_mgr_{ett_mgr} {}
+
+  World(const World&) = delete;
+  World& operator=(const World&) = delete;
+
+  // Adds a system that runs fn() once per frame.
+  template <typename Fn>
+  void AddSystem(Stage stage, std::string name, Fn fn,
+                 ResourceAccess access = {}) {
+    Add(stage, std::move(name), std::move(access),
+        [fn = std::move(fn)]() mutable {
+          fn();
+          return std::size_t{0};
+        });
+  }
+
+  // Adds a system that runs fn(comps...) or fn(eid, comps...) for every
+  // entity with the listed components.
+  template <typename... Comps, typename Fn>
+  const EntityView<XnentList<Comps...>>& AddSystem(
+      Stage stage, std::string name, Fn fn, XnentList<Comps...>,
+      ResourceAccess access = {}) {
+    using View = EntityView<XnentList<Comps...>>;
+    return AddViewSystem(
+        stage, std::move(name),
+        [fn = std::move(fn)](const View& view) mutable {
+          auto eid_it = view.EIDs().begin();
+          for (auto&& comps : view.Components()) {
+            if constexpr (std::is_invocable_v<Fn&, EID, Comps&...>) {
+              std::apply([&](auto&... comp) { fn(*eid_it, comp...); }, comps);
+            } else {
+              std::apply(fn, comps);
+            }
+            ++eid_it;
+          }
+        },
+        XnentList<Comps...>{}, std::move(access));
+  }
+
+  // Adds a system that runs fn(view) once per frame with the refreshed view
+  // of the listed components, for systems that work on all entities at once.
+  template <typename... Comps, typename Fn>
+  const EntityView<XnentList<Comps...>>& AddViewSystem(
+      Stage stage, std::string name, Fn fn, XnentList<Comps...>,
+      ResourceAccess access = {}) {
+    auto view = std::make_shared<EntityView<XnentList<Comps...>>>();
+    Add(stage, std::move(name), std::move(access),
+        [&ett_mgr = ett_mgr_, view, fn = std::move(fn)]() mutable {
+          view->View(ett_mgr);
+          fn(static_cast<const EntityView<XnentList<Comps...>>&>(*view));
+          return view->Size();
+        });
+    return *view;
+  }
+
+  void RunStage(Stage stage) {
+    EINU_TRACE_SCOPE(GetStageName(stage));
+    for (auto& system : stages_[static_cast<std::size_t>(stage)]) {
+      EINU_TRACE_SCOPE(system->stats.name.c_str());
+      auto begin = std::chrono::steady_clock::now();
+      auto entity_count = system->run();
+      auto time = std::chrono::steady_clock::now() - begin;
+
+      auto& stats = system->stats;
+      stats.entity_count = entity_count;
+      ++stats.run_count;
+      stats.last_time = time;
+      stats.total_time += time;
+    }
+  }
+
+  void Run() {
+    for (std::size_t i = 0; i != kStageCount; ++i) {
+      RunStage(static_cast<Stage>(i));
+    }
+  }
+
+  // Stats of every system, in run order.
+  std::vector<SystemStats> GetSystemStats() const {
+    auto stats = std::vector<SystemStats>{};
+    for (const auto& stage : stages_) {
+      for (const auto& system : stage) {
+        stats.push_back(system->stats);
+      }
+    }
+    return stats;
+  }
+
+  IEntityManager& GetEntityManager() noexcept { return ett_mgr_; }
+
+ private:
+  struct System {
+    SystemStats stats;
+    ResourceAccess access;
+    // returns the number of entities the system ran on
+    std::function<std::size_t()> run;
+  };
+
+  template <typename Run>
+  void Add(Stage stage, std::string name, ResourceAccess access, Run&& run) {
+    auto& systems = stages_[static_cast<std::size_t>(stage)];
+    for (const auto& other : systems) {
+      if (Conflicts(access, other->access)) {
+        throw std::logic_error{"system " + name + " conflicts with " +
+                               other->stats.name + " in stage " +
+                               GetStageName(stage)};
+      }
+    }
+    auto system = std::make_unique<System>();
+    system->stats.name = std::move(name);
+    system->stats.stage = stage;
+    system->access = std::move(access);
+    system->run = std::forward<Run>(run);
+    systems.push_back(std::move(system));
+  }
+
+  IEntityManager& ett_mgr_;
+  // systems are boxed so that their names can back trace zones
+  std::array<std::vector<std::unique_ptr<System>>, kStageCount> stages_;
+};
+
+inline void WriteSystemStats(std::ostream& os,
+                             const std::vector<SystemStats>& stats) {
+  using Micro = std::chrono::duration<double, std::micro>;
+  auto flags = os.flags();
+  auto precision = os.precision();
+  os << std::left << std::setw(16) << "stage" << std::setw(24) << "system"
+     << std::right << std::setw(10) << "entities" << std::setw(12)
+     << "last (us)" << std::setw(12) << "avg (us)" << '\n';
+  for (const auto& system : stats) {
+    auto avg = system.run_count
+                   ? Micro{system.total_time}.count() / system.run_count
+                   : 0.0;
+    os << std::left << std::setw(16) << GetStageName(system.stage)
+       << std::setw(24) << system.name << std::right << std::setw(10)
+       << system.entity_count << std::setw(12) << std::fixed
+       << std::setprecision(1) << Micro{system.last_time}.count()
+       << std::setw(12) << avg << '\n';
+  }
+  os.flags(flags);
+  os.precision(precision);
+}
+
+}  // namespace einu
@@ -18,8 +18,24 @@
 
 #pragma once
 
+#include <type_traits>
+
 namespace einu {
 
 class Xnent {};
 
+// An xnent without data is a tag. Tags are kept as mask bits only: they
+// take no pool storage and no pointer table entry.
+template <typename T>
+struct IsTag : std::is_empty<T> {};
+
+// All tags of a type share this instance, which stands in wherever a
+// reference to the tag is needed.
+template <typename T>
+T& GetTagInstance() noexcept {
+  static_assert(IsTag<T>::value, "<T> must be a tag");
+  static std::remove_const_t<T> instance;
+  return instance;
+}
+
 }  // namespace einu
@@ -68,6 +68,29 @@ TEST_P(CountLeftZero32Test, Test) {
 INSTANTIATE_TEST_SUITE_P(CountLeftZeroTest, CountLeftZero32Test,
                          testing::ValuesIn(k32MaskExpects));
 
+struct CountRightZeroExpect {
+  std::uint64_t mask;
+  int ctz;
+};
+
+static constexpr CountRightZeroExpect kCountRightZeroExpects[] = {
+    {~0llu, 0},
+    {0b1llu << 62, 62},
+    {0b001011llu << 58, 58},
+    {0b1llu << 63, 63},
+};
+
+struct CountRightZero64Test
+    : public testing::TestWithParam<CountRightZeroExpect> {};
+
+TEST_P(CountRightZero64Test, Test) {
+  auto& mask_data = GetParam();
+  EXPECT_EQ(mask_data.ctz, CountRightZero(mask_data.mask));
+}
+
+INSTANTIATE_TEST_SUITE_P(CountRightZeroTest, CountRightZero64Test,
+                         testing::ValuesIn(kCountRightZeroExpects));
+
 template <typename Mask>
 struct RangeMaskExpect {
   std::vector<Mask> masks;
@@ -199,5 +222,22 @@ TEST(BitVectorTest, ResizeUp) {
   EXPECT_EQ(vec.countl_zero(), 119);
 }
 
+TEST(BitVectorTest, CountLeftZeroFrom) {
+  auto vec = BitVector(300, false);
+  vec.set(3);
+  vec.set(64);
+  vec.set(250);
+  EXPECT_EQ(vec.countl_zero(0), 3);
+  EXPECT_EQ(vec.countl_zero(3), 3);
+  EXPECT_EQ(vec.countl_zero(4), 64);
+  EXPECT_EQ(vec.countl_zero(65), 250);
+  EXPECT_EQ(vec.countl_zero(251), std::nullopt);
+  EXPECT_EQ(vec.countl_zero(300), std::nullopt);
+
+  // bits past the end are ignored
+  vec.resize(250);
+  EXPECT_EQ(vec.countl_zero(65), std::nullopt);
+}
+
 }  // namespace util
 }  // namespace einu
@@ -65,8 +65,9 @@ TEST_F(ComponentPoolTest, add_policy_will_grow_pool_size) {
     pool.AddPolicy(std::move(std::get<i>(policy_tuple)), XnentTypeID{i});
     using Comp =
         typename tmp::TypeAt<typename ToTypeList<ComponentList>::Type, i>::Type;
+    // tags take no storage
     EXPECT_EQ(pool.OnePoolSize(XnentTypeID{i}),
-              std::get<i>(policy_tuple).init_size);
+              IsTag<Comp>::value ? 0 : std::get<i>(policy_tuple).init_size);
   });
 }
 
@@ -78,14 +79,15 @@ TEST_F(ComponentPoolTest,
     auto&& policy = std::get<ComponentPoolPolicy<Comp>>(policy_tuple);
     pool.AddPolicy(std::move(policy), XnentTypeID{i});
 
-    auto init_size = policy.init_size;
+    auto init_size = IsTag<Comp>::value ? 0 : policy.init_size;
     for (auto time = std::size_t{0}; time != init_size; ++time) {
       pool.Acquire(XnentTypeID{i});
     }
     EXPECT_EQ(pool.OnePoolSize(XnentTypeID{i}), init_size);
     pool.Acquire(XnentTypeID{i});
     EXPECT_EQ(pool.OnePoolSize(XnentTypeID{i}),
-              init_size + policy.growth_func(init_size));
+              IsTag<Comp>::value ? 0
+                                 : init_size + policy.growth_func(init_size));
   });
 }
 
@@ -97,7 +99,7 @@ TEST_F(ComponentPoolTest, acquire_release_aquire_would_not_make_pool_grow) {
     pool.AddPolicy(std::move(policy), XnentTypeID{i});
 
     auto acquired = std::vector<Xnent*>{};
-    auto init_size = policy.init_size;
+    auto init_size = IsTag<Comp>::value ? 0 : policy.init_size;
     for (auto time = std::size_t{0}; time != init_size; ++time) {
       acquired.push_back(&pool.Acquire(XnentTypeID{i}));
     }
@@ -109,5 +111,14 @@ TEST_F(ComponentPoolTest, acquire_release_aquire_would_not_make_pool_grow) {
   });
 }
 
+TEST_F(ComponentPoolTest, tags_share_one_instance_and_take_no_storage) {
+  auto c2_id = XnentTypeID{2};
+  auto& c2 = pool.Acquire(c2_id);
+  EXPECT_EQ(&pool.Acquire(c2_id), &c2);
+  EXPECT_TRUE(pool.IsTag(c2_id));
+  EXPECT_FALSE(pool.IsTag(XnentTypeID{0}));
+  EXPECT_EQ(pool.OnePoolStats(c2_id).bytes, 0);
+}
+
 }  // namespace internal
 }  // namespace einu
@@ -18,6 +18,9 @@
 
 #include "einu-engine/core/internal/entity_manager.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "einu-engine/core/entity_view.h"
 #include "einu-engine/core/internal/eid_pool.h"
 #include "einu-engine/core/internal/xnent_pool.h"
@@ -59,5 +62,159 @@ TEST_F(
   EXPECT_EQ(ett_view.Size(), 2);
 }
 
+TEST_F(EntityManagerTest, destroyed_entity_is_no_longer_contained) {
+  auto eid = ett_mgr.CreateEntity();
+  ett_mgr.AddComponent<C0>(eid);
+  ett_mgr.DestroyEntity(eid);
+  EXPECT_FALSE(ett_mgr.ContainsEntity(eid));
+  EXPECT_FALSE(ett_mgr.HasComponent<C0>(eid));
+  auto ett_view = EntityView<XnentList<>>{};
+  ett_view.View(ett_mgr);
+  EXPECT_EQ(ett_view.Size(), 2);
+}
+
+TEST_F(EntityManagerTest, entities_are_viewed_in_eid_order_across_pages) {
+  auto eids = std::vector<EID>{};
+  for (int i = 0; i != 10000; ++i) {
+    auto eid = ett_mgr.CreateEntity();
+    ett_mgr.AddComponent<C0>(eid).value = i;
+    eids.push_back(eid);
+  }
+  // empty a whole page in the middle
+  for (int i = 3000; i != 8000; ++i) {
+    ett_mgr.DestroyEntity(eids[i]);
+  }
+  auto ett_view = EntityView<XnentList<C0>>{};
+  ett_view.View(ett_mgr);
+  EXPECT_EQ(ett_view.Size(), 1 + 5000);
+  auto eid_view = ett_view.EIDs();
+  auto viewed = std::vector<EID>(eid_view.begin(), eid_view.end());
+  EXPECT_TRUE(std::is_sorted(viewed.begin(), viewed.end()));
+  EXPECT_EQ(ett_mgr.GetComponent<C0>(eids[9999]).value, 9999);
+}
+
+TEST_F(EntityManagerTest, destroy_entities_releases_their_components) {
+  auto eids = std::vector<EID>{};
+  for (int i = 0; i != 100; ++i) {
+    auto eid = ett_mgr.CreateEntity();
+    ett_mgr.AddComponent<C0>(eid);
+    if (i % 2) ett_mgr.AddComponent<C1>(eid);
+    eids.push_back(eid);
+  }
+  auto c0_live = comp_pool.OnePoolStats<C0>().live;
+  auto c1_live = comp_pool.OnePoolStats<C1>().live;
+  ett_mgr.DestroyEntities(eids.data(), eids.size());
+  EXPECT_EQ(comp_pool.OnePoolStats<C0>().live, c0_live - 100);
+  EXPECT_EQ(comp_pool.OnePoolStats<C1>().live, c1_live - 50);
+  EXPECT_EQ(ett_mgr.GetEntityStats().entity_count, 2);
+  for (auto eid : eids) {
+    EXPECT_FALSE(ett_mgr.ContainsEntity(eid));
+  }
+}
+
+#ifndef NDEBUG
+using EntityManagerDeathTest = EntityManagerTest;
+
+TEST_F(EntityManagerDeathTest, destroy_entities_rejects_duplicate_eids) {
+  auto eid = ett_mgr.CreateEntity();
+  ett_mgr.AddComponent<C0>(eid);
+  auto eids = std::vector<EID>{eid, eid};
+  EXPECT_DEATH(ett_mgr.DestroyEntities(eids.data(), eids.size()),
+               "eids are not unique");
+}
+#endif
+
+TEST_F(EntityManagerTest, destroy_if_destroys_matching_entities) {
+  for (int i = 0; i != 10; ++i) {
+    ett_mgr.AddComponent<C0>(ett_mgr.CreateEntity()).value = i;
+  }
+  auto ett_view = EntityView<XnentList<C0>>{};
+  ett_view.View(ett_mgr);
+  auto doomed = std::vector<EID>{};
+  DestroyIf(
+      ett_mgr, ett_view, [](const C0& c0) { return c0.value >= 5; }, doomed);
+  EXPECT_EQ(doomed.size(), 5);
+
+  ett_view.View(ett_mgr);
+  EXPECT_EQ(ett_view.Size(), 1 + 5);
+  for (auto&& [c0] : ett_view.Components()) {
+    EXPECT_LT(c0.value, 5);
+  }
+}
+
+TEST_F(EntityManagerTest, tags_are_mask_bits_only) {
+  auto eid = ett_mgr.CreateEntity();
+  ett_mgr.AddComponent<C0>(eid).value = 7;
+  ett_mgr.AddComponent<C2>(eid);
+  EXPECT_TRUE(ett_mgr.HasComponent<C2>(eid));
+  EXPECT_EQ(comp_pool.OnePoolStats<C2>().live, 0);
+
+  auto tag_view = EntityView<XnentList<C2>>{};
+  tag_view.View(ett_mgr);
+  EXPECT_EQ(tag_view.Size(), 1);
+  auto tag_count = 0;
+  for ([[maybe_unused]] auto&& [c2] : tag_view.Components()) {
+    ++tag_count;
+  }
+  EXPECT_EQ(tag_count, 1);
+
+  auto view = EntityView<XnentList<C2, C0>>{};
+  view.View(ett_mgr);
+  for (auto&& [c2, c0] : view.Components()) {
+    EXPECT_EQ(c0.value, 7);
+  }
+
+  ett_mgr.RemoveComponent<C2>(eid);
+  tag_view.View(ett_mgr);
+  EXPECT_EQ(tag_view.Size(), 0);
+}
+
+TEST_F(EntityManagerTest, get_components_matches_get_component) {
+  auto eids = std::vector<EID>{};
+  for (int i = 0; i != 100; ++i) {
+    auto eid = ett_mgr.CreateEntity();
+    ett_mgr.AddComponent<C0>(eid).value = i;
+    eids.push_back(eid);
+  }
+  std::reverse(eids.begin(), eids.end());
+  auto comps = std::vector<C0*>(eids.size());
+  ett_mgr.GetComponents(eids.data(), eids.size(), comps.data());
+  for (std::size_t i = 0; i != eids.size(); ++i) {
+    EXPECT_EQ(comps[i], &ett_mgr.GetComponent<C0>(eids[i]));
+  }
+
+  const auto& const_ett_mgr = ett_mgr;
+  auto const_comps = std::vector<const C0*>(eids.size());
+  const_ett_mgr.GetComponents(eids.data(), eids.size(), const_comps.data());
+  for (std::size_t i = 0; i != eids.size(); ++i) {
+    EXPECT_EQ(const_comps[i], comps[i]);
+  }
+}
+
+TEST_F(EntityManagerTest, bulk_create_and_add_matches_one_by_one) {
+  // spread over several pages, out of order
+  auto eids = std::vector<EID>{9000, 3, 4100, 7, 5000};
+  ett_mgr.CreateEntities(eids.data(), eids.size());
+  for (auto eid : eids) {
+    EXPECT_TRUE(ett_mgr.ContainsEntity(eid));
+  }
+  // next to the two entities of the fixture
+  EXPECT_EQ(ett_mgr.GetEntityStats().entity_count, eids.size() + 2);
+  EXPECT_GT(ett_mgr.CreateEntity(), 9000);
+
+  auto comps = std::vector<C0*>(eids.size());
+  ett_mgr.AddComponents(eids.data(), eids.size(), comps.data());
+  auto tags = std::vector<C2*>(2);
+  ett_mgr.AddComponents(eids.data(), tags.size(), tags.data());
+  for (std::size_t i = 0; i != eids.size(); ++i) {
+    comps[i]->value = static_cast<int>(i);
+    EXPECT_EQ(&ett_mgr.GetComponent<C0>(eids[i]), comps[i]);
+    EXPECT_EQ(ett_mgr.HasComponent<C2>(eids[i]), i < tags.size());
+  }
+
+  ett_mgr.DestroyEntities(eids.data(), eids.size());
+  EXPECT_EQ(comp_pool.OnePoolStats<C0>().live, 1);
+}
+
 }  // namespace internal
 }  // namespace einu
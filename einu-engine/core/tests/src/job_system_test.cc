@@ -0,0 +1,126 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/core/job_system.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace einu {
+
+TEST(JobSystem, job_runs_until_done) {
+  auto jobs = JobSystem{0};
+  auto steps = 0;
+  auto handle = jobs.Schedule([&steps] {
+    return ++steps == 3 ? JobResult::Done() : JobResult::Yield();
+  });
+  EXPECT_EQ(jobs.PendingCount(), 1);
+  EXPECT_EQ(jobs.RunReady(), 3);
+  EXPECT_TRUE(jobs.IsDone(handle));
+  EXPECT_EQ(jobs.PendingCount(), 0);
+}
+
+TEST(JobSystem, next_frame_parks_the_job) {
+  auto jobs = JobSystem{0};
+  auto steps = 0;
+  auto handle = jobs.Schedule([&steps] {
+    return ++steps == 3 ? JobResult::Done() : JobResult::NextFrame();
+  });
+  for (int frame = 1; frame != 3; ++frame) {
+    EXPECT_EQ(jobs.RunReady(), 1);
+    EXPECT_EQ(jobs.RunReady(), 0);
+    EXPECT_EQ(steps, frame);
+    jobs.NextFrame();
+  }
+  jobs.RunReady();
+  EXPECT_TRUE(jobs.IsDone(handle));
+}
+
+TEST(JobSystem, after_resumes_when_the_other_job_is_done) {
+  auto jobs = JobSystem{0};
+  auto order = std::vector<int>{};
+  auto loader_steps = 0;
+  auto loader = jobs.Schedule([&] {
+    if (++loader_steps != 2) return JobResult::NextFrame();
+    order.push_back(1);
+    return JobResult::Done();
+  });
+  auto waited = false;
+  auto user = jobs.Schedule([&, loader]() mutable {
+    if (!waited) {
+      waited = true;
+      return JobResult::After(loader);
+    }
+    order.push_back(2);
+    return JobResult::Done();
+  });
+  jobs.RunReady();
+  EXPECT_FALSE(jobs.IsDone(user));
+  jobs.NextFrame();
+  jobs.RunReady();
+  EXPECT_TRUE(jobs.IsDone(user));
+  EXPECT_EQ(order, (std::vector<int>{1, 2}));
+}
+
+TEST(JobSystem, after_a_finished_job_resumes_at_once) {
+  auto jobs = JobSystem{0};
+  auto first = jobs.Schedule([] { return JobResult::Done(); });
+  jobs.RunReady();
+  auto waited = false;
+  auto second = jobs.Schedule([&waited, first] {
+    if (waited) return JobResult::Done();
+    waited = true;
+    return JobResult::After(first);
+  });
+  EXPECT_EQ(jobs.RunReady(), 2);
+  EXPECT_TRUE(jobs.IsDone(second));
+}
+
+TEST(JobSystem, workers_run_jobs) {
+  auto jobs = JobSystem{4};
+  auto sum = std::make_shared<std::atomic<int>>(0);
+  auto handles = std::vector<JobHandle>{};
+  for (int i = 0; i != 100; ++i) {
+    handles.push_back(jobs.Schedule([sum, steps = 0]() mutable {
+      ++*sum;
+      return ++steps == 10 ? JobResult::Done() : JobResult::Yield();
+    }));
+  }
+  for (const auto& handle : handles) jobs.Wait(handle);
+  EXPECT_EQ(*sum, 1000);
+  EXPECT_EQ(jobs.PendingCount(), 0);
+}
+
+TEST(JobSystem, wait_spans_frames_on_workers) {
+  auto jobs = JobSystem{2};
+  auto frames = std::make_shared<std::atomic<int>>(0);
+  auto handle = jobs.Schedule([frames] {
+    return ++*frames == 5 ? JobResult::Done() : JobResult::NextFrame();
+  });
+  while (!jobs.IsDone(handle)) {
+    jobs.NextFrame();
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(*frames, 5);
+}
+
+}  // namespace einu
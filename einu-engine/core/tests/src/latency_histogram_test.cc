@@ -0,0 +1,103 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/core/latency_histogram.h"
+
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+namespace einu {
+
+using std::chrono::microseconds;
+using std::chrono::nanoseconds;
+
+TEST(LatencyHistogram, small_values_are_exact) {
+  auto histogram = LatencyHistogram{};
+  for (int i = 1; i <= 20; ++i) histogram.Record(nanoseconds(i));
+  EXPECT_EQ(histogram.Count(), 20);
+  EXPECT_EQ(histogram.Percentile(50), nanoseconds(10));
+  EXPECT_EQ(histogram.Percentile(95), nanoseconds(19));
+  EXPECT_EQ(histogram.Percentile(100), nanoseconds(20));
+  EXPECT_EQ(histogram.Max(), nanoseconds(20));
+}
+
+TEST(LatencyHistogram, buckets_cover_every_value) {
+  auto last_index = std::size_t{0};
+  for (std::uint64_t ns = 1; ns < std::uint64_t{1} << 40; ns = ns * 3 / 2 + 1) {
+    auto index = LatencyHistogram::BucketIndex(ns);
+    EXPECT_GE(index, last_index);
+    EXPECT_LT(index, LatencyHistogram::kBucketCount);
+    EXPECT_GE(LatencyHistogram::BucketUpperBound(index), ns);
+    last_index = index;
+  }
+  EXPECT_EQ(LatencyHistogram::BucketIndex(~std::uint64_t{0}),
+            LatencyHistogram::kBucketCount - 1);
+}
+
+TEST(LatencyHistogram, percentiles_are_within_bucket_precision) {
+  auto histogram = LatencyHistogram{};
+  for (int i = 1; i <= 1000; ++i) histogram.Record(microseconds(i));
+  for (double percentile : {50.0, 95.0, 99.0}) {
+    auto expected = static_cast<double>(
+        nanoseconds(microseconds(static_cast<int>(percentile * 10))).count());
+    auto actual = static_cast<double>(histogram.Percentile(percentile).count());
+    EXPECT_GE(actual, expected);
+    EXPECT_LE(actual, expected * (1 + 1.0 / 16));
+  }
+  EXPECT_EQ(histogram.Max(), microseconds(1000));
+}
+
+TEST(LatencyHistogram, merge_and_clear) {
+  auto a = LatencyHistogram{};
+  auto b = LatencyHistogram{};
+  a.Record(nanoseconds(5));
+  b.Record(nanoseconds(7));
+  a.Merge(b);
+  EXPECT_EQ(a.Count(), 2);
+  EXPECT_EQ(a.Max(), nanoseconds(7));
+  a.Clear();
+  EXPECT_EQ(a.Count(), 0);
+  EXPECT_EQ(a.Percentile(99), nanoseconds(0));
+}
+
+TEST(RollingLatencyHistogram, forgets_old_records) {
+  auto histogram = RollingLatencyHistogram{4};
+  for (int i = 0; i != 4; ++i) histogram.Record(microseconds(100));
+  for (int i = 0; i != 2; ++i) histogram.Record(nanoseconds(1));
+  auto collected = histogram.Collect();
+  EXPECT_EQ(collected.Count(), 4);
+  EXPECT_EQ(collected.Max(), microseconds(100));
+  for (int i = 0; i != 2; ++i) histogram.Record(nanoseconds(1));
+  collected = histogram.Collect();
+  EXPECT_EQ(collected.Count(), 4);
+  EXPECT_EQ(collected.Max(), nanoseconds(1));
+}
+
+TEST(LatencyHistogram, write_summary) {
+  auto histogram = LatencyHistogram{};
+  histogram.Record(std::chrono::milliseconds(2));
+  auto os = std::ostringstream{};
+  WriteLatencySummary(os, "frame", Summarize(histogram));
+  EXPECT_NE(os.str().find("frame"), std::string::npos);
+  EXPECT_NE(os.str().find("2.000"), std::string::npos);
+}
+
+}  // namespace einu
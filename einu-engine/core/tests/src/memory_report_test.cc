@@ -0,0 +1,104 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/core/memory_report.h"
+
+#include <sstream>
+
+#include "einu-engine/core/internal/eid_pool.h"
+#include "einu-engine/core/internal/entity_manager.h"
+#include "einu-engine/core/internal/xnent_pool.h"
+#include "einu-engine/core/internal/xnent_type_id_register.h"
+#include "gtest/gtest.h"
+#include "src/xnents.h"
+
+namespace einu {
+namespace internal {
+
+struct MemoryReportTest : public testing::Test {
+  using TestCompList = XnentList<C0, C1>;
+  using TestSingleList = XnentList<C2>;
+  using EttMgr = EntityManager<8, 8>;
+
+  MemoryReportTest() {
+    ett_mgr.SetComponentPool(comp_pool);
+    ett_mgr.SetSinglenentPool(single_pool);
+    ett_mgr.SetEIDPool(eid_pool);
+    for (int i = 0; i != 10; ++i) {
+      auto eid = ett_mgr.CreateEntity();
+      ett_mgr.AddComponent<C0>(eid);
+      if (i % 2 == 0) ett_mgr.AddComponent<C1>(eid);
+    }
+  }
+
+  XnentTypeIDRegister<TestCompList> comp_reg;
+  XnentTypeIDRegister<TestSingleList> single_reg;
+  XnentPool<TestCompList> comp_pool;
+  XnentPool<TestSingleList> single_pool;
+  EIDPool eid_pool;
+  EttMgr ett_mgr;
+};
+
+TEST_F(MemoryReportTest, xnent_pool_reports_every_type) {
+  EXPECT_EQ(comp_pool.XnentCount(), 2);
+  EXPECT_EQ(comp_pool.XnentName(0), "einu::C0");
+  EXPECT_EQ(comp_pool.XnentName(1), "einu::C1");
+  EXPECT_EQ(comp_pool.OnePoolStats<C0>().live, 10);
+  EXPECT_EQ(comp_pool.OnePoolStats<C1>().live, 5);
+}
+
+TEST_F(MemoryReportTest, entity_stats_count_entities) {
+  auto stats = ett_mgr.GetEntityStats();
+  EXPECT_EQ(stats.entity_count, 10);
+  EXPECT_EQ(stats.data_pool.live, 10);
+  EXPECT_EQ(stats.table_bytes, 8 * sizeof(Xnent*));
+  EXPECT_GE(TotalBytes(stats), 10 * BytesPerEntity(stats));
+}
+
+TEST_F(MemoryReportTest, reporter_writes_pools_entities_and_views) {
+  auto view = EntityView<XnentList<C0, C1>>{};
+  view.View(ett_mgr);
+  auto reporter = MemoryReporter{comp_pool, single_pool, ett_mgr};
+  reporter.AddView("c0 c1", view);
+
+  auto report = reporter.Collect();
+  ASSERT_EQ(report.views.size(), 1);
+  EXPECT_EQ(report.views[0].size, 5);
+  EXPECT_GE(report.views[0].bytes, 5 * (2 * sizeof(Xnent*) + sizeof(EID)));
+
+  auto os = std::ostringstream{};
+  for (int i = 0; i != 3; ++i) {
+    reporter.Update(os, 2);
+  }
+  auto text = os.str();
+  EXPECT_NE(text.find("einu::C1"), std::string::npos);
+  EXPECT_NE(text.find("c0 c1"), std::string::npos);
+  EXPECT_EQ(text.find("components"), text.rfind("components"));
+}
+
+TEST_F(MemoryReportTest, reporter_with_zero_interval_never_writes) {
+  auto reporter = MemoryReporter{comp_pool, single_pool, ett_mgr};
+  auto os = std::ostringstream{};
+  for (int i = 0; i != 3; ++i) {
+    reporter.Update(os, 0);
+  }
+  EXPECT_TRUE(os.str().empty());
+}
+
+}  // namespace internal
+}  // namespace einu
@@ -18,6 +18,10 @@
 
 #include "einu-engine/core/util/object_pool.h"
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 namespace einu {
@@ -61,6 +65,17 @@ TEST_F(FixedPoolTest, free_pos_move_right_after_acquire) {
   EXPECT_TRUE(AllAcquired(pool));
 }
 
+TEST_F(FixedPoolTest, has_only_its_own_objects) {
+  // a large chunk is mapped far away from the small one
+  auto far_pool = FixedPool<int>{std::size_t{1} << 22};
+  auto& obj = pool.Acquire();
+  auto& far_obj = far_pool.Acquire();
+  EXPECT_TRUE(pool.Has(obj));
+  EXPECT_TRUE(far_pool.Has(far_obj));
+  EXPECT_FALSE(pool.Has(far_obj));
+  EXPECT_FALSE(far_pool.Has(obj));
+}
+
 struct DynamicPoolTest : public testing::Test {
   static constexpr std::size_t kSize = 100;
   DynamicPool<int> pool{kSize};
@@ -114,5 +129,86 @@ TEST_F(DynamicPoolTest, release_would_not_change_size) {
   EXPECT_EQ(pool.Size(), new_size);
 }
 
+TEST_F(DynamicPoolTest, stats_track_live_objects_and_growth) {
+  auto acquired = std::vector<decltype(pool)::value_type*>{kSize + 1};
+  std::for_each(acquired.begin(), acquired.end(),
+                [&](auto&& v) { v = &pool.Acquire(); });
+  pool.Release(*acquired[0]);
+
+  auto stats = pool.GetStats();
+  EXPECT_EQ(stats.capacity, 2 * kSize);
+  EXPECT_EQ(stats.live, kSize);
+  EXPECT_EQ(stats.chunk_count, 2);
+  EXPECT_EQ(stats.growth_count, 1);
+  EXPECT_EQ(stats.scattered_free, kSize);
+  EXPECT_GE(stats.bytes, stats.capacity * sizeof(int));
+  EXPECT_DOUBLE_EQ(FragmentationRatio(stats), 1.0);
+}
+
+TEST_F(DynamicPoolTest, bulk_release_frees_objects_across_chunks) {
+  auto acquired = std::vector<decltype(pool)::value_type*>{2 * kSize};
+  std::for_each(acquired.begin(), acquired.end(),
+                [&](auto&& v) { v = &pool.Acquire(); });
+  pool.Release(acquired.begin(), acquired.end(),
+               [](auto* obj) -> const auto& { return *obj; });
+
+  auto stats = pool.GetStats();
+  EXPECT_EQ(stats.live, 0);
+  EXPECT_EQ(stats.scattered_free, 0);
+  for (std::size_t i = 0; i != 2 * kSize; ++i) {
+    (void)pool.Acquire();
+  }
+  EXPECT_EQ(pool.Size(), 2 * kSize);
+}
+
+TEST_F(DynamicPoolTest, bulk_release_frees_exactly_its_objects_in_many_chunks) {
+  // grown to chunks of 100, 100, 200, 400 and 800
+  auto acquired = std::vector<decltype(pool)::value_type*>{16 * kSize};
+  std::for_each(acquired.begin(), acquired.end(),
+                [&](auto&& v) { v = &pool.Acquire(); });
+  ASSERT_EQ(pool.GetStats().chunk_count, 5);
+
+  // every third object, jumping between chunks
+  auto released = std::vector<decltype(pool)::value_type*>{};
+  for (std::size_t i = 0; i < acquired.size(); i += 3) {
+    released.push_back(acquired[i]);
+  }
+  std::shuffle(released.begin(), released.end(), std::mt19937{7});
+  pool.Release(released.begin(), released.end(),
+               [](auto* obj) -> const auto& { return *obj; });
+  EXPECT_EQ(pool.GetStats().live, acquired.size() - released.size());
+
+  // the released objects, and only those, are handed out again
+  auto reacquired = std::vector<decltype(pool)::value_type*>{released.size()};
+  std::for_each(reacquired.begin(), reacquired.end(),
+                [&](auto&& v) { v = &pool.Acquire(); });
+  EXPECT_EQ(pool.Size(), acquired.size());
+  std::sort(released.begin(), released.end());
+  std::sort(reacquired.begin(), reacquired.end());
+  EXPECT_EQ(reacquired, released);
+}
+
+TEST_F(DynamicPoolTest, bulk_acquire_grows_once_to_fit) {
+  auto first = &pool.Acquire();
+  auto acquired = std::vector<decltype(pool)::value_type*>{};
+  pool.Acquire(5 * kSize, [&](auto& obj) { acquired.push_back(&obj); });
+  EXPECT_EQ(acquired.size(), 5 * kSize);
+  EXPECT_TRUE(std::find(acquired.begin(), acquired.end(), first) ==
+              acquired.end());
+
+  auto stats = pool.GetStats();
+  EXPECT_EQ(stats.live, 5 * kSize + 1);
+  EXPECT_EQ(stats.growth_count, 1);
+  EXPECT_EQ(stats.chunk_count, 2);
+  std::sort(acquired.begin(), acquired.end());
+  EXPECT_TRUE(std::adjacent_find(acquired.begin(), acquired.end()) ==
+              acquired.end());
+
+  pool.Release(acquired.begin(), acquired.end(),
+               [](auto* obj) -> const auto& { return *obj; });
+  pool.Acquire(5 * kSize, [](auto&) {});
+  EXPECT_EQ(pool.GetStats().growth_count, 1);
+}
+
 }  // namespace util
 }  // namespace einu
@@ -0,0 +1,70 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/core/resources.h"
+
+#include "einu-engine/core/internal/eid_pool.h"
+#include "einu-engine/core/internal/entity_manager.h"
+#include "einu-engine/core/internal/xnent_pool.h"
+#include "einu-engine/core/internal/xnent_type_id_register.h"
+#include "gtest/gtest.h"
+#include "src/xnents.h"
+
+namespace einu {
+namespace internal {
+
+struct ResourcesTest : public testing::Test {
+  using TestSingleList = XnentList<C0, C1, C3>;
+
+  ResourcesTest() {
+    ett_mgr.SetSinglenentPool(single_pool);
+    ett_mgr.SetEIDPool(eid_pool);
+    ett_mgr.AddSinglenent<C0>().value = 1;
+    ett_mgr.AddSinglenent<C1>().value = 2.f;
+    ett_mgr.AddSinglenent<C3>();
+  }
+
+  XnentTypeIDRegister<TestSingleList> reg;
+  XnentPool<TestSingleList> single_pool;
+  EIDPool eid_pool;
+  EntityManager<16, 16> ett_mgr;
+};
+
+TEST_F(ResourcesTest, get_returns_the_singlenents) {
+  auto resources = Resources<Reads<C0>, Writes<C1>>{ett_mgr};
+  static_assert(std::is_same_v<decltype(resources.Get<C0>()), const C0&>);
+  static_assert(std::is_same_v<decltype(resources.Get<C1>()), C1&>);
+  EXPECT_EQ(&resources.Get<C0>(), &ett_mgr.GetSinglenent<C0>());
+  resources.Get<C1>().value = 3.f;
+  EXPECT_FLOAT_EQ(ett_mgr.GetSinglenent<C1>().value, 3.f);
+}
+
+TEST_F(ResourcesTest, writers_conflict_with_readers_and_writers) {
+  auto read_c0 = Resources<Reads<C0>, Writes<>>::Access();
+  auto read_c0_c1 = Resources<Reads<C0, C1>, Writes<>>::Access();
+  auto write_c0 = Resources<Reads<>, Writes<C0>>::Access();
+  auto write_c1 = Resources<Reads<C0>, Writes<C1>>::Access();
+  EXPECT_FALSE(Conflicts(read_c0, read_c0_c1));
+  EXPECT_TRUE(Conflicts(read_c0, write_c0));
+  EXPECT_TRUE(Conflicts(write_c0, write_c0));
+  EXPECT_TRUE(Conflicts(write_c1, read_c0_c1));
+  EXPECT_FALSE(Conflicts(write_c1, read_c0));
+}
+
+}  // namespace internal
+}  // namespace einu
@@ -0,0 +1,151 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/core/snapshot_history.h"
+
+#include <vector>
+
+#include "einu-engine/core/entity_view.h"
+#include "einu-engine/core/internal/eid_pool.h"
+#include "einu-engine/core/internal/entity_manager.h"
+#include "einu-engine/core/internal/xnent_pool.h"
+#include "einu-engine/core/internal/xnent_type_id_register.h"
+#include "gtest/gtest.h"
+#include "src/xnents.h"
+
+namespace einu {
+namespace internal {
+
+struct SnapshotHistoryTest : public testing::Test {
+  using TestCompList = XnentList<C0, C1, C2, C3>;
+  using TestHistory = SnapshotHistory<XnentList<C0, C1, C2>, XnentList<>>;
+  using EttMgr = EntityManager<256, 256>;
+
+  SnapshotHistoryTest() {
+    ett_mgr.SetComponentPool(comp_pool);
+    ett_mgr.SetEIDPool(eid_pool);
+    for (int i = 0; i != 100; ++i) {
+      auto eid = ett_mgr.CreateEntity();
+      ett_mgr.AddComponent<C0>(eid).value = i;
+      ett_mgr.AddComponent<C1>(eid).value = i * 2.f;
+    }
+    ett_mgr.AddComponent<C3>(0);
+  }
+
+  std::vector<char> Save() {
+    auto buffer = std::vector<char>{};
+    TestHistory::Snapshot::Save(ett_mgr, buffer);
+    return buffer;
+  }
+
+  XnentTypeIDRegister<TestCompList> reg;
+  XnentPool<TestCompList> comp_pool;
+  EIDPool eid_pool;
+  EttMgr ett_mgr;
+  TestHistory history{8};
+};
+
+TEST_F(SnapshotHistoryTest, rollback_restores_recorded_frame) {
+  history.Record(ett_mgr);
+  auto frame0 = Save();
+
+  ett_mgr.GetComponent<C0>(5).value = -1;
+  ett_mgr.DestroyEntity(7);
+  ett_mgr.RemoveComponent<C1>(0);
+  history.Record(ett_mgr);
+
+  auto eid = ett_mgr.CreateEntity();
+  ett_mgr.AddComponent<C2>(eid);
+  ett_mgr.AddComponent<C2>(1);
+  history.Record(ett_mgr);
+  EXPECT_EQ(history.FrameCount(), 3);
+
+  history.Rollback(ett_mgr, 2);
+  EXPECT_EQ(history.FrameCount(), 1);
+  EXPECT_EQ(Save(), frame0);
+  EXPECT_FALSE(ett_mgr.ContainsEntity(eid));
+  EXPECT_EQ(ett_mgr.GetComponent<C0>(5).value, 5);
+  EXPECT_TRUE(ett_mgr.ContainsEntity(7));
+  EXPECT_TRUE(ett_mgr.HasComponent<C1>(0));
+  EXPECT_FALSE(ett_mgr.HasComponent<C2>(1));
+  EXPECT_TRUE(ett_mgr.HasComponent<C3>(0));
+}
+
+TEST_F(SnapshotHistoryTest, get_frame_returns_recorded_snapshot) {
+  auto frames = std::vector<std::vector<char>>{};
+  for (int i = 0; i != 5; ++i) {
+    ett_mgr.GetComponent<C0>(i).value += 100;
+    if (i % 2) ett_mgr.DestroyEntity(50 + i);
+    history.Record(ett_mgr);
+    frames.push_back(Save());
+  }
+  for (std::size_t i = 0; i != frames.size(); ++i) {
+    EXPECT_EQ(history.GetFrame(i), frames[frames.size() - 1 - i]);
+  }
+}
+
+TEST_F(SnapshotHistoryTest, history_is_bounded_by_max_frames) {
+  for (int i = 0; i != 20; ++i) {
+    ett_mgr.GetComponent<C0>(0).value = i;
+    history.Record(ett_mgr);
+  }
+  EXPECT_EQ(history.FrameCount(), 8);
+  history.Rollback(ett_mgr, 7);
+  EXPECT_EQ(ett_mgr.GetComponent<C0>(0).value, 12);
+}
+
+TEST_F(SnapshotHistoryTest, history_of_one_frame_keeps_the_latest) {
+  auto single = TestHistory{1};
+  for (int i = 0; i != 5; ++i) {
+    ett_mgr.GetComponent<C0>(0).value = i;
+    single.Record(ett_mgr);
+    EXPECT_EQ(single.FrameCount(), 1);
+  }
+  ett_mgr.GetComponent<C0>(0).value = -1;
+  single.Rollback(ett_mgr, 0);
+  EXPECT_EQ(ett_mgr.GetComponent<C0>(0).value, 4);
+  EXPECT_EQ(single.GetFrame(0), Save());
+}
+
+TEST_F(SnapshotHistoryTest, unchanged_frame_costs_less_than_full_snapshot) {
+  history.Record(ett_mgr);
+  history.Record(ett_mgr);
+  auto usage = history.MemoryUsage();
+  history.Record(ett_mgr);
+  EXPECT_LT(history.MemoryUsage() - usage, Save().size() / 10);
+}
+
+TEST_F(SnapshotHistoryTest, full_history_reuses_its_buffers) {
+  // every frame changes the same bytes, so every delta has the same size
+  auto record = [&](int i) {
+    ett_mgr.GetComponent<C0>(0).value = i;
+    history.Record(ett_mgr);
+  };
+  for (int i = 0; i != 8; ++i) record(i);
+  auto usage = history.MemoryUsage();
+  for (int i = 8; i != 16; ++i) record(i);
+  EXPECT_EQ(history.MemoryUsage(), usage);
+
+  history.Rollback(ett_mgr, 3);
+  for (int i = 16; i != 19; ++i) record(i);
+  EXPECT_EQ(history.MemoryUsage(), usage);
+  EXPECT_EQ(history.FrameCount(), 8);
+}
+
+}  // namespace internal
+}  // namespace einu
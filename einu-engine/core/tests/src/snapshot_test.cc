@@ -0,0 +1,173 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/core/snapshot.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "einu-engine/core/entity_view.h"
+#include "einu-engine/core/internal/eid_pool.h"
+#include "einu-engine/core/internal/entity_manager.h"
+#include "einu-engine/core/internal/xnent_pool.h"
+#include "einu-engine/core/internal/xnent_type_id_register.h"
+#include "gtest/gtest.h"
+#include "src/xnents.h"
+
+namespace einu {
+
+struct Names : public Xnent {
+  std::vector<std::string> names;
+};
+
+struct Frame : public Xnent {
+  int count = 0;
+};
+
+template <>
+struct SnapshotCodec<Names> {
+  static void Encode(SnapshotWriter& writer, const Names& names) {
+    writer.Write(static_cast<std::uint64_t>(names.names.size()));
+    for (const auto& name : names.names) {
+      writer.Write(name);
+    }
+  }
+
+  static void Decode(SnapshotReader& reader, Names& names) {
+    auto size = std::uint64_t{};
+    reader.Read(size);
+    names.names.resize(size);
+    for (auto& name : names.names) {
+      reader.Read(name);
+    }
+  }
+};
+
+namespace internal {
+
+struct SnapshotTest : public testing::Test {
+  using TestCompList = XnentList<C0, C1, C2, Names>;
+  using TestSingleList = XnentList<Frame>;
+  using TestSnapshot = WorldSnapshot<TestCompList, TestSingleList>;
+  using EttMgr = EntityManager<256, 256>;
+
+  struct World {
+    World() {
+      ett_mgr.SetComponentPool(comp_pool);
+      ett_mgr.SetSinglenentPool(single_pool);
+      ett_mgr.SetEIDPool(eid_pool);
+    }
+
+    XnentPool<TestCompList> comp_pool;
+    XnentPool<TestSingleList> single_pool;
+    EIDPool eid_pool;
+    EttMgr ett_mgr;
+  };
+
+  SnapshotTest() {
+    auto& ett_mgr = src.ett_mgr;
+    for (int i = 0; i != 10; ++i) {
+      auto eid = ett_mgr.CreateEntity();
+      ett_mgr.AddComponent<C0>(eid).value = i;
+      if (i % 2 == 0) ett_mgr.AddComponent<C1>(eid).value = i * 0.5f;
+      if (i % 3 == 0) ett_mgr.AddComponent<C2>(eid);
+      if (i == 4) {
+        ett_mgr.AddComponent<Names>(eid).names = {"sheep", "wolf"};
+      }
+    }
+    ett_mgr.DestroyEntity(3);
+    ett_mgr.AddSinglenent<Frame>().count = 42;
+  }
+
+  void ExpectSameWorld(World& world) {
+    auto& ett_mgr = world.ett_mgr;
+    auto view = EntityView<XnentList<>>{};
+    view.View(ett_mgr);
+    EXPECT_EQ(view.Size(), 9);
+    for (EID eid = 0; eid != 10; ++eid) {
+      if (eid == 3) {
+        EXPECT_FALSE(ett_mgr.ContainsEntity(eid));
+        continue;
+      }
+      ASSERT_TRUE(ett_mgr.ContainsEntity(eid));
+      EXPECT_EQ(ett_mgr.GetComponent<C0>(eid).value, static_cast<int>(eid));
+      EXPECT_EQ(ett_mgr.HasComponent<C1>(eid), eid % 2 == 0);
+      if (eid % 2 == 0) {
+        EXPECT_FLOAT_EQ(ett_mgr.GetComponent<C1>(eid).value, eid * 0.5f);
+      }
+      EXPECT_EQ(ett_mgr.HasComponent<C2>(eid), eid % 3 == 0);
+      EXPECT_EQ(ett_mgr.HasComponent<Names>(eid), eid == 4);
+    }
+    EXPECT_EQ(ett_mgr.GetComponent<Names>(4).names,
+              (std::vector<std::string>{"sheep", "wolf"}));
+    EXPECT_EQ(ett_mgr.GetSinglenent<Frame>().count, 42);
+    EXPECT_EQ(ett_mgr.CreateEntity(), 10);
+  }
+
+  XnentTypeIDRegister<TestCompList> comp_reg;
+  XnentTypeIDRegister<TestSingleList> single_reg;
+  World src;
+};
+
+TEST_F(SnapshotTest, load_restores_saved_world) {
+  auto buffer = std::vector<char>{};
+  TestSnapshot::Save(src.ett_mgr, buffer);
+  auto dst = World{};
+  TestSnapshot::Load(dst.ett_mgr, buffer.data(), buffer.size());
+  ExpectSameWorld(dst);
+}
+
+TEST_F(SnapshotTest, load_file_restores_saved_file) {
+  auto path = testing::TempDir() + "snapshot_test.snap";
+  TestSnapshot::SaveFile(src.ett_mgr, path);
+  auto dst = World{};
+  TestSnapshot::LoadFile(dst.ett_mgr, path);
+  ExpectSameWorld(dst);
+  std::remove(path.c_str());
+}
+
+TEST_F(SnapshotTest, load_throws_on_bad_magic) {
+  auto buffer = std::vector<char>{};
+  TestSnapshot::Save(src.ett_mgr, buffer);
+  buffer[0] = 'X';
+  auto dst = World{};
+  EXPECT_THROW(TestSnapshot::Load(dst.ett_mgr, buffer.data(), buffer.size()),
+               SnapshotError);
+  EXPECT_FALSE(dst.ett_mgr.ContainsEntity(0));
+}
+
+TEST_F(SnapshotTest, load_throws_on_truncated_data) {
+  auto buffer = std::vector<char>{};
+  TestSnapshot::Save(src.ett_mgr, buffer);
+  auto dst = World{};
+  EXPECT_THROW(TestSnapshot::Load(dst.ett_mgr, buffer.data(), 100),
+               SnapshotError);
+}
+
+TEST_F(SnapshotTest, load_throws_when_xnent_lists_differ) {
+  auto buffer = std::vector<char>{};
+  TestSnapshot::Save(src.ett_mgr, buffer);
+  auto dst = World{};
+  using OtherSnapshot = WorldSnapshot<XnentList<C0, C1, C2>, TestSingleList>;
+  EXPECT_THROW(OtherSnapshot::Load(dst.ett_mgr, buffer.data(), buffer.size()),
+               SnapshotError);
+}
+
+}  // namespace internal
+}  // namespace einu
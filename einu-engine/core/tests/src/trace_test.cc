@@ -0,0 +1,112 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/core/trace.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace einu {
+namespace trace {
+
+struct TraceTest : public testing::Test {
+  TraceTest() {
+    Clear();
+    SetEnabled(true);
+  }
+
+  ~TraceTest() {
+    SetEnabled(false);
+    Clear();
+  }
+
+  static std::string Export() {
+    auto os = std::ostringstream{};
+    WriteChromeTrace(os);
+    return os.str();
+  }
+
+  static std::size_t Count(const std::string& str, const std::string& sub) {
+    auto count = std::size_t{0};
+    for (auto pos = str.find(sub); pos != std::string::npos;
+         pos = str.find(sub, pos + 1)) {
+      ++count;
+    }
+    return count;
+  }
+};
+
+TEST_F(TraceTest, scope_is_recorded_when_enabled) {
+  { Scope scope{"enabled zone"}; }
+  SetEnabled(false);
+  { Scope scope{"disabled zone"}; }
+  auto json = Export();
+  EXPECT_EQ(Count(json, "\"enabled zone\""), 1);
+  EXPECT_EQ(Count(json, "\"disabled zone\""), 0);
+  EXPECT_EQ(Count(json, "\"ph\":\"X\""), 1);
+}
+
+TEST_F(TraceTest, ring_buffer_keeps_latest_zones) {
+  auto thread = std::thread{[] {
+    for (int i = 0; i != 100000; ++i) {
+      Scope scope{"old"};
+    }
+    for (int i = 0; i != 10; ++i) {
+      Scope scope{"new"};
+    }
+  }};
+  thread.join();
+  auto json = Export();
+  EXPECT_EQ(Count(json, "\"new\""), 10);
+  EXPECT_EQ(Count(json, "\"old\""), internal::kDefaultBufferCapacity - 10);
+}
+
+TEST_F(TraceTest, threads_are_exported_with_their_names) {
+  auto thread = std::thread{[] {
+    SetThreadName("worker \"1\"");
+    Scope scope{"work"};
+  }};
+  thread.join();
+  // other tests and job workers may have named their threads too
+  auto json = Export();
+  EXPECT_EQ(Count(json, "\"args\":{\"name\":\"worker \\\"1\\\"\"}"), 1);
+  EXPECT_EQ(Count(json, "\"work\""), 1);
+}
+
+TEST(TraceBufferTest, buffer_grows_only_as_zones_are_recorded) {
+  auto buffer = internal::ThreadBuffer{0, 1000};
+  EXPECT_EQ(buffer.BufferBytes(), 0);
+  for (int i = 0; i != 10; ++i) buffer.Push(Zone{"zone", i, i + 1});
+  EXPECT_LT(buffer.BufferBytes(), 1000 * sizeof(Zone));
+  for (int i = 10; i != 2500; ++i) buffer.Push(Zone{"zone", i, i + 1});
+  EXPECT_EQ(buffer.BufferBytes(), 1000 * sizeof(Zone));
+  auto first = std::int64_t{-1};
+  auto count = 0;
+  buffer.ForEach([&](const Zone& zone) {
+    if (first < 0) first = zone.begin_ns;
+    ++count;
+  });
+  EXPECT_EQ(first, 1500);
+  EXPECT_EQ(count, 1000);
+}
+
+}  // namespace trace
+}  // namespace einu
@@ -0,0 +1,122 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "einu-engine/core/world.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "einu-engine/core/internal/eid_pool.h"
+#include "einu-engine/core/internal/entity_manager.h"
+#include "einu-engine/core/internal/xnent_pool.h"
+#include "einu-engine/core/internal/xnent_type_id_register.h"
+#include "gtest/gtest.h"
+#include "src/xnents.h"
+
+namespace einu {
+namespace internal {
+
+struct WorldTest : public testing::Test {
+  using TestCompList = XnentList<C0, C1, C2>;
+
+  WorldTest() {
+    ett_mgr.SetComponentPool(comp_pool);
+    ett_mgr.SetEIDPool(eid_pool);
+    for (int i = 0; i != 4; ++i) {
+      auto eid = ett_mgr.CreateEntity();
+      ett_mgr.AddComponent<C0>(eid).value = i;
+      if (i % 2) ett_mgr.AddComponent<C1>(eid);
+    }
+  }
+
+  XnentTypeIDRegister<TestCompList> reg;
+  XnentPool<TestCompList> comp_pool;
+  EIDPool eid_pool;
+  EntityManager<16, 16> ett_mgr;
+  World world{ett_mgr};
+};
+
+TEST_F(WorldTest, stages_run_in_order) {
+  auto order = std::string{};
+  world.AddSystem(Stage::RenderPrep, "d", [&] { order += 'd'; });
+  world.AddSystem(Stage::Update, "b", [&] { order += 'b'; });
+  world.AddSystem(Stage::PreUpdate, "a", [&] { order += 'a'; });
+  world.AddSystem(Stage::Update, "c", [&] { order += 'c'; });
+  world.Run();
+  EXPECT_EQ(order, "abcd");
+}
+
+TEST_F(WorldTest, systems_run_for_every_matching_entity) {
+  world.AddSystem(
+      Stage::Update, "grow", [](C0& c0, const C1&) { c0.value += 10; },
+      XnentList<C0, const C1>{});
+  auto eids = std::vector<EID>{};
+  world.AddSystem(
+      Stage::PostUpdate, "collect",
+      [&](EID eid, const C0& c0) {
+        if (c0.value >= 10) eids.push_back(eid);
+      },
+      XnentList<const C0>{});
+  world.Run();
+  EXPECT_EQ(eids, (std::vector<EID>{1, 3}));
+
+  auto stats = world.GetSystemStats();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats[0].name, "grow");
+  EXPECT_EQ(stats[0].entity_count, 2);
+  EXPECT_EQ(stats[1].entity_count, 4);
+  EXPECT_EQ(stats[1].run_count, 1);
+}
+
+TEST_F(WorldTest, views_see_entities_of_earlier_systems) {
+  world.AddSystem(Stage::PreUpdate, "spawn", [&] {
+    ett_mgr.AddComponent<C2>(ett_mgr.CreateEntity());
+  });
+  auto& view =
+      world.AddViewSystem(Stage::Update, "count", [](auto&&) {},
+                          XnentList<C2>{});
+  world.Run();
+  EXPECT_EQ(view.Size(), 1);
+  world.Run();
+  EXPECT_EQ(view.Size(), 2);
+
+  auto os = std::ostringstream{};
+  WriteSystemStats(os, world.GetSystemStats());
+  EXPECT_NE(os.str().find("count"), std::string::npos);
+}
+
+TEST_F(WorldTest, conflicting_systems_cannot_share_a_stage) {
+  auto read_c0 = Resources<Reads<C0>, Writes<>>::Access();
+  auto write_c0 = Resources<Reads<>, Writes<C0>>::Access();
+  world.AddSystem(Stage::Update, "read", [] {}, read_c0);
+  world.AddSystem(Stage::Update, "read again", [] {}, read_c0);
+  world.AddSystem(Stage::Update, "undeclared", [] {});
+  EXPECT_THROW(world.AddSystem(Stage::Update, "write", [] {}, write_c0),
+               std::logic_error);
+  EXPECT_THROW(world.AddViewSystem(
+                   Stage::Update, "write view", [](auto&&) {},
+                   XnentList<C1>{}, write_c0),
+               std::logic_error);
+  EXPECT_NO_THROW(world.AddSystem(Stage::PostUpdate, "write", [] {}, write_c0));
+  EXPECT_EQ(world.GetSystemStats().size(), 4);
+}
+
+}  // namespace internal
+}  // namespace einu
@@ -18,15 +18,23 @@
 
 #include "src/app.h"
 
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <random>
 
+#include "einu-engine/ai/path_service.h"
 #include "einu-engine/common/random.h"
+#include "einu-engine/common/sgl_frame_stats.h"
 #include "einu-engine/common/sys_movement.h"
 #include "einu-engine/common/sys_time.h"
 #include "einu-engine/core/einu_engine.h"
 #include "einu-engine/core/entity_view.h"
+#include "einu-engine/core/job_system.h"
+#include "einu-engine/core/latency_histogram.h"
+#include "einu-engine/core/trace.h"
+#include "einu-engine/core/world.h"
 #include "einu-engine/graphics/cmp_camera.h"
 #include "einu-engine/graphics/sys_render.h"
 #include "einu-engine/graphics/sys_resource.h"
@@ -76,8 +84,10 @@ void App::Run() {
   win.size.height = 1080;
 
   auto& time = ett_mgr->AddSinglenent<einu::sgl::Time>();
+  auto& frame_stats = ett_mgr->AddSinglenent<einu::sgl::FrameStats>();
   auto& world_state = ett_mgr->AddSinglenent<sgl::WorldState>();
   world_state.grid = sgl::WorldState::Grid(glm::uvec2{12, 12});
+  world_state.flow_fields = std::make_shared<einu::ai::FlowFieldCache>();
   world_state.world_size = glm::vec2{12 * 32, 12 * 32};
 
   auto& resource_table =
@@ -161,6 +171,11 @@ void App::Run() {
         world_state.grid[i][j].state = static_cast<CellState>(blocked);
       }
     }
+    world_state.passable = einu::ai::BitGrid(
+        world_state.grid.GetSize(),
+        [&world_state](std::uint32_t x, std::uint32_t y) {
+          return world_state.grid[x][y].state != CellState::Blocked;
+        });
   }
 
   // create cells
@@ -274,60 +289,147 @@ void App::Run() {
   auto cam_mat = einu::graphics::ProjectionMatrix(proj) *
                  einu::graphics::ViewMatrix(einu::graphics::View{});
 
-  // views
-  auto move_view = einu::EntityView<
-      einu::XnentList<einu::cmp::Transform, einu::cmp::Movement>>{};
+  auto starchaser_resources = sys::StarchaserResources{*ett_mgr};
+
+  // paths are searched on worker threads and handed out a few per frame
+  constexpr std::size_t kPathsPerFrame = 16;
+  auto jobs = einu::JobSystem{};
+  auto path_service = einu::ai::PathService{jobs};
+  path_service.SetGrid(
+      std::make_shared<einu::ai::GridSnapshot>(world_state.passable));
+
+  // systems
+  using einu::Stage;
+  using einu::XnentList;
+  auto world = einu::World{*ett_mgr};
+
+  world.AddSystem(Stage::PreUpdate, "deliver paths", [&] {
+    path_service.Deliver(kPathsPerFrame, [&](const auto& result) {
+      auto& path_finding =
+          ett_mgr->GetComponent<cmp::PathFinding>(result.agent);
+      sys::DeliverPath(path_finding, result);
+    });
+  });
+
+  world.AddSystem(
+      Stage::Update, "update cell blocks",
+      [&](einu::graphics::cmp::Sprite& sprite, const cmp::Cell& cell) {
+        sys::UpdateCellBlock(world_state, cell, sprite);
+      },
+      XnentList<einu::graphics::cmp::Sprite, const cmp::Cell>{});
+
+  world.AddSystem(
+      Stage::Update, "update cell frames",
+      [](einu::graphics::cmp::Sprite& sprite, const cmp::CellFrameTag&) {
+        sys::UpdateCellFrame(sprite);
+      },
+      XnentList<einu::graphics::cmp::Sprite, const cmp::CellFrameTag>{});
+
+  world.AddSystem(
+      Stage::Update, "starchaser fsm",
+      [&] {
+        sys::RunStarChaserFSM(*ett_mgr, starchaser_resources, starchaser);
+      },
+      sys::StarchaserResources::Access());
+
+  world.AddSystem(
+      Stage::Update, "move",
+      [&](einu::cmp::Transform& transform, einu::cmp::Movement& movement) {
+        sys::Move(time, world_state, transform, movement);
+        sys::Rotate(transform, movement);
+      },
+      XnentList<einu::cmp::Transform, einu::cmp::Movement>{});
+
+  world.AddSystem(Stage::PostUpdate, "request paths", [&] {
+    for (const auto& request : world_state.path_requests) {
+      path_service.Request(request);
+    }
+    world_state.path_requests.clear();
+    path_service.Schedule();
+  });
+
+  auto render_path_buffer = sys::RenderPathBuffer{};
+  world.AddSystem(Stage::PostUpdate, "render path", [&] {
+    sys::RenderPath(*ett_mgr, render_path_buffer,
+                    ett_mgr->GetComponent<cmp::PathFinding>(starchaser));
+  });
+
+  world.AddSystem(Stage::RenderPrep, "clear sprite batch", [&] {
+    einu::graphics::sys::ClearSpriteBatch(sprite_batch);
+  });
+
+  world.AddSystem(
+      Stage::RenderPrep, "prepare sprites",
+      [&](const einu::cmp::Transform& transform,
+          const einu::graphics::cmp::Sprite& sprite) {
+        einu::graphics::sys::PrepareSpriteBatch(resource_table, sprite_batch,
+                                                sprite, transform);
+      },
+      XnentList<const einu::cmp::Transform,
+                const einu::graphics::cmp::Sprite>{});
 
-  auto sprite_render_view = einu::EntityView<
-      einu::XnentList<einu::cmp::Transform, einu::graphics::cmp::Sprite>>{};
+  // press F9 to start and stop tracing
+  einu::trace::SetThreadName("main");
+  auto trace_key_down = false;
 
-  auto cell_view = einu::EntityView<
-      einu::XnentList<einu::graphics::cmp::Sprite, const cmp::Cell>>{};
+  // press F11 to print system timings
+  auto timing_key_down = false;
 
-  auto cell_frame_view = einu::EntityView<
-      einu::XnentList<einu::graphics::cmp::Sprite, const cmp::CellFrameTag>>{};
+  // press F12 to print frame time percentiles
+  auto frame_stats_key_down = false;
 
   // game loop
   while (!win.shouldClose) {
+    EINU_TRACE_SCOPE("frame");
+
     einu::window::sys::PoolEvents(win);
     einu::graphics::sys::Clear();
 
-    einu::sys::UpdateTime(time);
-
-    cell_view.View(*ett_mgr);
-    for (auto&& [sprite, cell] : cell_view.Components()) {
-      sys::UpdateCellBlock(world_state, cell, sprite);
+    using einu::window::input::KeyboardKey;
+    auto trace_key = win.input_buffer.GetKeyboardKey(KeyboardKey::F9);
+    if (trace_key && !trace_key_down) {
+      einu::trace::SetEnabled(!einu::trace::IsEnabled());
     }
+    trace_key_down = trace_key;
 
-    cell_frame_view.View(*ett_mgr);
-    for (auto&& [sprite, cell_frame_tag] : cell_frame_view.Components()) {
-      sys::UpdateCellFrame(sprite);
+    auto timing_key = win.input_buffer.GetKeyboardKey(KeyboardKey::F11);
+    if (timing_key && !timing_key_down) {
+      einu::WriteSystemStats(std::cout, world.GetSystemStats());
     }
+    timing_key_down = timing_key;
 
-    sys::RunStarChaserFSM(*ett_mgr, starchaser);
-
-    // move and rotate
-    move_view.View(*ett_mgr);
-    for (auto&& [transform, movement] : move_view.Components()) {
-      sys::Move(time, world_state, transform, movement);
-      sys::Rotate(transform, movement);
+    auto frame_stats_key = win.input_buffer.GetKeyboardKey(KeyboardKey::F12);
+    if (frame_stats_key && !frame_stats_key_down) {
+      einu::sgl::WriteFrameStats(std::cout, frame_stats);
     }
+    frame_stats_key_down = frame_stats_key;
 
-    sys::RenderPath(*ett_mgr,
-                    ett_mgr->GetComponent<cmp::PathFinding>(starchaser));
+    einu::sys::UpdateTime(time);
+    frame_stats.frame.Record(time.now - time.pre);
+
+    {
+      EINU_TRACE_SCOPE("simulate");
+      auto latency = einu::ScopedLatency{frame_stats.simulation};
+      world.RunStage(Stage::PreUpdate);
+      world.RunStage(Stage::Update);
+      world.RunStage(Stage::PostUpdate);
+    }
 
     // render sprites
-    sprite_render_view.View(*ett_mgr);
-    einu::graphics::sys::ClearSpriteBatch(sprite_batch);
-    for (auto&& [transform, sprite] : sprite_render_view.Components()) {
-      einu::graphics::sys::PrepareSpriteBatch(resource_table, sprite_batch,
-                                              sprite, transform);
+    {
+      EINU_TRACE_SCOPE("render");
+      auto latency = einu::ScopedLatency{frame_stats.render};
+      world.RunStage(Stage::RenderPrep);
+      einu::graphics::sys::RenderSpriteBatch(sprite_batch, cam_mat);
     }
-    einu::graphics::sys::RenderSpriteBatch(sprite_batch, cam_mat);
 
     einu::window::sys::SwapBuffer(win);
   }
 
+#ifdef EINU_CORE_PROFILE
+  einu::trace::WriteChromeTrace("astar-trace.json");
+#endif
+
   // TODO(Xiaoyue Chen): clean up
 }
 
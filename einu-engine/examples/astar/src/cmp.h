@@ -51,24 +51,11 @@ struct Energy : public einu::Xnent {
 };
 
 struct PathFinding : public einu::Xnent {
-  struct Node {
-    Node() = default;
-    Node(glm::uvec2 pos, Node* parent) : pos(pos), parent(parent) {}
-
-    glm::uvec2 pos;
-    Node* parent = nullptr;
-    float g = 0.0f;
-    float h = 0.0f;
-    float f = 0.0f;
-  };
-
-  using NodeList = std::vector<Node>;
-
-  NodeList open_list;
-  NodeList closed_list;
   glm::uvec2 start;
   glm::uvec2 destination;
   std::vector<glm::uvec2> path;
+  // a path to destination has been requested and not delivered yet
+  bool pending = false;
 };
 
 }  // namespace cmp
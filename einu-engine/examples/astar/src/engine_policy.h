@@ -21,6 +21,7 @@
 #include "einu-engine/ai/cmp_destination.h"
 #include "einu-engine/common/cmp_movement.h"
 #include "einu-engine/common/cmp_transform.h"
+#include "einu-engine/common/sgl_frame_stats.h"
 #include "einu-engine/common/sgl_time.h"
 #include "einu-engine/core/einu_engine.h"
 #include "einu-engine/core/xnent_list.h"
@@ -40,7 +41,8 @@ using ComponentList =
                     cmp::StarPocket, cmp::CellFrameTag>;
 
 using SinglenentList =
-    einu::XnentList<einu::sgl::Time, einu::graphics::sgl::GLResourceTable,
+    einu::XnentList<einu::sgl::Time, einu::sgl::FrameStats,
+                    einu::graphics::sgl::GLResourceTable,
                     einu::graphics::sgl::SpriteBatch, sgl::WorldState>;
 
 using NeedList = einu::NeedList<ComponentList, SinglenentList>;
@@ -19,8 +19,13 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "einu-engine/ai/bit_grid.h"
+#include "einu-engine/ai/flow_field.h"
+#include "einu-engine/ai/path_service.h"
 #include "einu-engine/common/grid.h"
 #include "einu-engine/core/eid.h"
 #include "einu-engine/core/xnent.h"
@@ -34,12 +39,24 @@ struct WorldState : public einu::Xnent {
   using Grid = einu::Grid<Cell>;
 
   Grid grid{};
+  // which cells of grid are clear, for the searches and flow fields
+  einu::ai::BitGrid passable{};
   glm::vec2 world_size{};
   einu::EID traiding_post_eid = ~einu::EID{0};
   einu::EID spaceship_eid = ~einu::EID{0};
   einu::EID star_eid = ~einu::EID{0};
+  // submitted to the path service at the end of the frame
+  std::vector<einu::ai::PathRequest> path_requests;
+  // fields to the destinations every starchaser shares; a pointer so the
+  // world state stays copyable
+  std::shared_ptr<einu::ai::FlowFieldCache> flow_fields;
 };
 
+inline bool IsPassable(const WorldState& world_state, std::uint32_t x,
+                       std::uint32_t y) noexcept {
+  return world_state.passable(x, y);
+}
+
 inline glm::vec2 GetCellSize(const WorldState& world_state) noexcept {
   return world_state.world_size / glm::vec2(world_state.grid.GetSize());
 }
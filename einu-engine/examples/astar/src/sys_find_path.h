@@ -18,17 +18,34 @@
 
 #pragma once
 
+#include <vector>
+
+#include "einu-engine/ai/path_service.h"
 #include "einu-engine/core/i_entity_manager.h"
+#include "einu-engine/graphics/cmp_sprite.h"
 #include "src/cmp.h"
 #include "src/sgl_world_state.h"
 
 namespace astar {
 namespace sys {
 
-void FindPath(sgl::WorldState& world_state, cmp::PathFinding& path_finding,
-              glm::vec2 start, glm::vec2 dest);
+// Queues a request for a path from start to dest unless one is on its way.
+void RequestPath(sgl::WorldState& world_state, cmp::PathFinding& path_finding,
+                 einu::EID eid, glm::vec2 start, glm::vec2 dest);
+
+// Drops the path and any request on its way.
+void CancelPath(cmp::PathFinding& path_finding);
+
+void DeliverPath(cmp::PathFinding& path_finding,
+                 const einu::ai::PathResult& result);
+
+// Where RenderPath looks up the cells of a path, kept between frames.
+struct RenderPathBuffer {
+  std::vector<einu::EID> eids;
+  std::vector<einu::graphics::cmp::Sprite*> sprites;
+};
 
-void RenderPath(einu::IEntityManager& ett_mgr,
+void RenderPath(einu::IEntityManager& ett_mgr, RenderPathBuffer& buffer,
                 const cmp::PathFinding& path_finding);
 
 }  // namespace sys
@@ -18,7 +18,6 @@
 
 #include "src/sys_starchaser.h"
 
-#include "einu-engine/common/sgl_time.h"
 #include "glm/glm.hpp"
 #include "src/sys_find_path.h"
 
@@ -46,6 +45,29 @@ void MoveAlongPath(const sgl::WorldState& world_state,
   }
 }
 
+// Heads for dest through the shared flow field of its cell, without a path
+// of its own.
+void FollowFlowField(sgl::WorldState& world_state,
+                     const einu::cmp::Transform& transform,
+                     einu::cmp::Movement& movement, glm::vec2 dest) {
+  const auto& field = world_state.flow_fields->Get(
+      world_state.grid.GetSize(), world_state.passable,
+      sgl::GetCoordsInGrid(world_state, dest));
+  auto cell = sgl::GetCoordsInGrid(world_state, transform.GetPosition());
+  auto next_cell = field.GetNextCell(cell);
+  // at the goal cell, or cut off from it, head straight for dest
+  auto target = dest;
+  if (next_cell != cell) {
+    glm::vec2 offset = sgl::GetCellSize(world_state) / 2.f;
+    target = glm::vec2(next_cell) * sgl::GetCellSize(world_state) + offset;
+  }
+  auto dp = glm::vec3(target, 0) - transform.GetPosition();
+  if (glm::length(dp) > 0) {
+    movement.direction = glm::normalize(dp);
+    movement.speed = movement.max_speed;
+  }
+}
+
 bool HasReached(const sgl::WorldState& world_state, glm::vec2 pos,
                 glm::vec2 target) noexcept {
   static constexpr float kReachRange = 50.0f;
@@ -53,8 +75,9 @@ bool HasReached(const sgl::WorldState& world_state, glm::vec2 pos,
   return glm::distance(pos, target) < kReachRange;
 }
 
-void CollectStar(einu::IEntityManager& ett_mgr, einu::EID eid) {
-  auto& world_state = ett_mgr.GetSinglenent<sgl::WorldState>();
+void CollectStar(einu::IEntityManager& ett_mgr,
+                 const StarchaserResources& resources, einu::EID eid) {
+  auto& world_state = resources.Get<sgl::WorldState>();
   auto& transform = ett_mgr.GetComponent<einu::cmp::Transform>(eid);
   auto& movement = ett_mgr.GetComponent<einu::cmp::Movement>(eid);
   auto& path_finding = ett_mgr.GetComponent<cmp::PathFinding>(eid);
@@ -69,21 +92,23 @@ void CollectStar(einu::IEntityManager& ett_mgr, einu::EID eid) {
     if (HasReached(world_state, transform.GetPosition(), star_pos)) {
       starchaser.state = State::Selling;
     } else {
-      FindPath(world_state, path_finding, transform.GetPosition(), star_pos);
+      RequestPath(world_state, path_finding, eid, transform.GetPosition(),
+                  star_pos);
     }
   } else {
     MoveAlongPath(world_state, transform, movement, path_finding);
   }
 }
 
-void SellStar(einu::IEntityManager& ett_mgr, einu::EID eid) {
-  auto& world_state = ett_mgr.GetSinglenent<sgl::WorldState>();
+void SellStar(einu::IEntityManager& ett_mgr,
+              const StarchaserResources& resources, einu::EID eid) {
+  auto& world_state = resources.Get<sgl::WorldState>();
   auto& transform = ett_mgr.GetComponent<einu::cmp::Transform>(eid);
   auto& movement = ett_mgr.GetComponent<einu::cmp::Movement>(eid);
   auto& path_finding = ett_mgr.GetComponent<cmp::PathFinding>(eid);
   auto& starchaser = ett_mgr.GetComponent<cmp::Starchaser>(eid);
   auto& energy = ett_mgr.GetComponent<cmp::Energy>(eid);
-  auto& time = ett_mgr.GetSinglenent<einu::sgl::Time>();
+  auto& time = resources.Get<einu::sgl::Time>();
   auto& star_transform =
       ett_mgr.GetComponent<einu::cmp::Transform>(world_state.star_eid);
   auto& trading_post_transform =
@@ -94,7 +119,7 @@ void SellStar(einu::IEntityManager& ett_mgr, einu::EID eid) {
   using State = cmp::Starchaser::State;
 
   if (energy.energy < energy.fatigue_threshold) {
-    path_finding.path.clear();
+    CancelPath(path_finding);
     starchaser.state = State::GoingHome;
   } else {
     if (path_finding.path.size() == 0) {
@@ -102,8 +127,8 @@ void SellStar(einu::IEntityManager& ett_mgr, einu::EID eid) {
                      transform.GetPosition())) {
         starchaser.state = State::Done;
       } else {
-        FindPath(world_state, path_finding, transform.GetPosition(),
-                 trading_post_transform.GetPosition());
+        RequestPath(world_state, path_finding, eid, transform.GetPosition(),
+                    trading_post_transform.GetPosition());
       }
     } else {
       MoveAlongPath(world_state, transform, movement, path_finding);
@@ -112,14 +137,15 @@ void SellStar(einu::IEntityManager& ett_mgr, einu::EID eid) {
   }
 }
 
-void GoHome(einu::IEntityManager& ett_mgr, einu::EID eid) {
-  auto& world_state = ett_mgr.GetSinglenent<sgl::WorldState>();
+void GoHome(einu::IEntityManager& ett_mgr,
+            const StarchaserResources& resources, einu::EID eid) {
+  auto& world_state = resources.Get<sgl::WorldState>();
   auto& transform = ett_mgr.GetComponent<einu::cmp::Transform>(eid);
   auto& movement = ett_mgr.GetComponent<einu::cmp::Movement>(eid);
   auto& path_finding = ett_mgr.GetComponent<cmp::PathFinding>(eid);
   auto& starchaser = ett_mgr.GetComponent<cmp::Starchaser>(eid);
   auto& energy = ett_mgr.GetComponent<cmp::Energy>(eid);
-  auto& time = ett_mgr.GetSinglenent<einu::sgl::Time>();
+  auto& time = resources.Get<einu::sgl::Time>();
   auto& star_transform =
       ett_mgr.GetComponent<einu::cmp::Transform>(world_state.star_eid);
   auto home_pos =
@@ -128,25 +154,23 @@ void GoHome(einu::IEntityManager& ett_mgr, einu::EID eid) {
 
   using State = cmp::Starchaser::State;
 
-  if (path_finding.path.size() == 0) {
-    if (HasReached(world_state, home_pos, transform.GetPosition())) {
-      starchaser.state = State::Resting;
-    } else {
-      FindPath(world_state, path_finding, transform.GetPosition(), home_pos);
-    }
+  // every starchaser shares the way home
+  if (HasReached(world_state, home_pos, transform.GetPosition())) {
+    starchaser.state = State::Resting;
   } else {
-    MoveAlongPath(world_state, transform, movement, path_finding);
+    FollowFlowField(world_state, transform, movement, home_pos);
   }
 }
 
-void Rest(einu::IEntityManager& ett_mgr, einu::EID eid) {
-  auto& world_state = ett_mgr.GetSinglenent<sgl::WorldState>();
+void Rest(einu::IEntityManager& ett_mgr,
+          const StarchaserResources& resources, einu::EID eid) {
+  auto& world_state = resources.Get<sgl::WorldState>();
   auto& transform = ett_mgr.GetComponent<einu::cmp::Transform>(eid);
   auto& movement = ett_mgr.GetComponent<einu::cmp::Movement>(eid);
   auto& path_finding = ett_mgr.GetComponent<cmp::PathFinding>(eid);
   auto& starchaser = ett_mgr.GetComponent<cmp::Starchaser>(eid);
   auto& energy = ett_mgr.GetComponent<cmp::Energy>(eid);
-  auto& time = ett_mgr.GetSinglenent<einu::sgl::Time>();
+  auto& time = resources.Get<einu::sgl::Time>();
   auto& star_transform =
       ett_mgr.GetComponent<einu::cmp::Transform>(world_state.star_eid);
 
@@ -159,8 +183,9 @@ void Rest(einu::IEntityManager& ett_mgr, einu::EID eid) {
   }
 }
 
-void RunStarChaserFSM(einu::IEntityManager& ett_mgr, einu::EID eid) {
-  auto& world_state = ett_mgr.GetSinglenent<sgl::WorldState>();
+void RunStarChaserFSM(einu::IEntityManager& ett_mgr,
+                      const StarchaserResources& resources, einu::EID eid) {
+  auto& world_state = resources.Get<sgl::WorldState>();
   auto& transform = ett_mgr.GetComponent<einu::cmp::Transform>(eid);
   auto& movement = ett_mgr.GetComponent<einu::cmp::Movement>(eid);
   auto& path_finding = ett_mgr.GetComponent<cmp::PathFinding>(eid);
@@ -173,19 +198,19 @@ void RunStarChaserFSM(einu::IEntityManager& ett_mgr, einu::EID eid) {
       break;
 
     case State::Collecting:
-      CollectStar(ett_mgr, eid);
+      CollectStar(ett_mgr, resources, eid);
       break;
 
     case State::Selling:
-      SellStar(ett_mgr, eid);
+      SellStar(ett_mgr, resources, eid);
       break;
 
     case State::GoingHome:
-      GoHome(ett_mgr, eid);
+      GoHome(ett_mgr, resources, eid);
       break;
 
     case State::Resting:
-      Rest(ett_mgr, eid);
+      Rest(ett_mgr, resources, eid);
       break;
 
     default:
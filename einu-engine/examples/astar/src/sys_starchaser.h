@@ -20,7 +20,9 @@
 
 #include "einu-engine/common/cmp_movement.h"
 #include "einu-engine/common/cmp_transform.h"
+#include "einu-engine/common/sgl_time.h"
 #include "einu-engine/core/i_entity_manager.h"
+#include "einu-engine/core/resources.h"
 #include "src/cmp.h"
 #include "src/sgl_world_state.h"
 
@@ -32,7 +34,12 @@ void MoveAlongPath(const sgl::WorldState& world_state,
                    einu::cmp::Movement& movement,
                    cmp::PathFinding& path_finding);
 
-void RunStarChaserFSM(einu::IEntityManager& ett_mgr, einu::EID eid);
+using StarchaserResources =
+    einu::Resources<einu::Reads<einu::sgl::Time>,
+                    einu::Writes<sgl::WorldState>>;
+
+void RunStarChaserFSM(einu::IEntityManager& ett_mgr,
+                      const StarchaserResources& resources, einu::EID eid);
 
 }  // namespace sys
 }  // namespace astar
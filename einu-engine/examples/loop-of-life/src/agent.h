@@ -18,7 +18,9 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "einu-engine/core/eid.h"
 #include "einu-engine/core/util/enum.h"
@@ -48,6 +50,39 @@ constexpr bool IsValid(const AgentInfo& agent_info) noexcept {
   return agent_info.eid != ~einu::EID{0};
 }
 
+// Agents as columns, the way the batched queries of point_query.h take them.
+// The types are the masks of the points.
+struct AgentColumns {
+  std::vector<float> xs;
+  std::vector<float> ys;
+  std::vector<std::uint32_t> types;
+  std::vector<einu::EID> eids;
+};
+
+inline std::size_t Size(const AgentColumns& agents) noexcept {
+  return agents.eids.size();
+}
+
+inline void Clear(AgentColumns& agents) noexcept {
+  agents.xs.clear();
+  agents.ys.clear();
+  agents.types.clear();
+  agents.eids.clear();
+}
+
+inline void PushBack(AgentColumns& agents, const AgentInfo& agent_info) {
+  agents.xs.push_back(agent_info.pos.x);
+  agents.ys.push_back(agent_info.pos.y);
+  agents.types.push_back(static_cast<std::uint32_t>(agent_info.type));
+  agents.eids.push_back(agent_info.eid);
+}
+
+inline AgentInfo GetAgentInfo(const AgentColumns& agents,
+                              std::size_t i) noexcept {
+  return AgentInfo{static_cast<AgentType>(agents.types[i]),
+                   glm::vec2{agents.xs[i], agents.ys[i]}, agents.eids[i]};
+}
+
 }  // namespace lol
 
 namespace einu {
@@ -18,13 +18,20 @@
 
 #include "src/app.h"
 
+#include <chrono>
 #include <iostream>
 #include <random>
+#include <vector>
 
+#include "einu-engine/common/sgl_frame_stats.h"
 #include "einu-engine/common/sys_movement.h"
 #include "einu-engine/common/sys_time.h"
 #include "einu-engine/core/einu_engine.h"
 #include "einu-engine/core/entity_view.h"
+#include "einu-engine/core/latency_histogram.h"
+#include "einu-engine/core/memory_report.h"
+#include "einu-engine/core/trace.h"
+#include "einu-engine/core/world.h"
 #include "einu-engine/graphics/cmp_camera.h"
 #include "einu-engine/graphics/sys_render.h"
 #include "einu-engine/graphics/sys_resource.h"
@@ -32,6 +39,7 @@
 #include "einu-engine/window/sys_window.h"
 #include "src/bt_agent.h"
 #include "src/engine_policy.h"
+#include "src/snapshot.h"
 #include "src/sys_agent_create.h"
 #include "src/sys_destroy.h"
 #include "src/sys_lose_health.h"
@@ -61,8 +69,14 @@ void App::Run() {
   win.size.height = 720;
 
   auto& time = ett_mgr->AddSinglenent<einu::sgl::Time>();
+  // the simulation ticks at 20 Hz whatever the frame rate
+  auto& fixed_step = ett_mgr->AddSinglenent<einu::sgl::FixedStep>();
+  fixed_step.step = std::chrono::milliseconds{50};
+  auto frame_time = einu::sgl::Time{};
+  auto& frame_stats = ett_mgr->AddSinglenent<einu::sgl::FrameStats>();
   auto& world_state = ett_mgr->AddSinglenent<sgl::WorldState>();
   world_state.grid = sgl::WorldState::Grid(glm::uvec2{160, 90});
+  world_state.pyramid = sgl::WorldState::Pyramid(world_state.grid.GetSize());
   world_state.world_size = glm::vec2{win.size.width, win.size.height};
 
   auto& resource_table =
@@ -77,7 +91,10 @@ void App::Run() {
     Create(win);
   }
 
-  { einu::sys::InitTime(time); }
+  {
+    einu::sys::InitTime(time);
+    einu::sys::InitTime(frame_time);
+  }
 
   // init graphics
   {
@@ -198,7 +215,8 @@ void App::Run() {
                  einu::graphics::ViewMatrix(einu::graphics::View{});
 
   // world state need this
-  auto cell_buffer = sys::CellBuffer{};
+  auto sense_buffer = sys::SenseBuffer{};
+  auto doomed = std::vector<einu::EID>{};
 
   // behavior trees
   einu::ai::bt::ArgPack sheep_bt_args;
@@ -210,138 +228,222 @@ void App::Run() {
   einu::ai::bt::ArgPack grass_bt_args;
   auto grass_bt = ai::bt::BuildGrassBT(*ett_mgr);
 
-  // views
-  auto destroy_view = einu::EntityView<einu::XnentList<const cmp::Health>>{};
-
-  auto forget_view = einu::EntityView<einu::XnentList<cmp::Memory>>{};
-
-  auto grass_view = einu::EntityView<
-      einu::XnentList<einu::cmp::Transform, cmp::Agent, cmp::Health,
-                      cmp::HealthLoss, cmp::GainHealth, cmp::Memory,
-                      cmp::Reproduce, cmp::Sense, cmp::GrassTag>>{};
-
-  auto health_loss_view =
-      einu::EntityView<einu::XnentList<const cmp::HealthLoss, cmp::Health>>{};
-
-  auto herder_view = einu::EntityView<einu::XnentList<
-      einu::cmp::Transform, einu::graphics::cmp::Sprite, einu::cmp::Movement,
-      einu::ai::cmp::Destination, cmp::Agent, cmp::Eat, cmp::Health, cmp::Hunt,
-      cmp::Memory, cmp::Sense, cmp::Wander, cmp::HerderTag>>{};
-
-  auto move_view = einu::EntityView<
-      einu::XnentList<einu::cmp::Transform, einu::cmp::Movement>>{};
-
-  auto sheep_view = einu::EntityView<einu::XnentList<
-      einu::cmp::Transform, einu::graphics::cmp::Sprite, einu::cmp::Movement,
-      einu::ai::cmp::Destination, cmp::Agent, cmp::Eat, cmp::Evade, cmp::Health,
-      cmp::HealthLoss, cmp::Hunger, cmp::Hunt, cmp::Memory, cmp::Panick,
-      cmp::Reproduce, cmp::Sense, cmp::Wander>>{};
-
-  auto sense_view = einu::EntityView<
-      einu::XnentList<einu::cmp::Transform, cmp::Sense, cmp::Memory>>{};
-
-  auto sprite_render_view = einu::EntityView<
-      einu::XnentList<einu::cmp::Transform, einu::graphics::cmp::Sprite>>{};
-
-  auto world_state_view =
-      einu::EntityView<einu::XnentList<einu::cmp::Transform, cmp::Agent>>{};
+  // hold backspace to rewind, one tick per frame
+  constexpr std::size_t kHistoryTicks = 600;
+  auto history = WorldHistory{kHistoryTicks};
+
+  // systems
+  using einu::Stage;
+  using einu::XnentList;
+  auto world = einu::World{*ett_mgr};
+
+  world.AddSystem(
+      Stage::PreUpdate, "store previous transform",
+      [](const einu::cmp::Transform& transform,
+         einu::cmp::PreviousTransform& previous) {
+        previous = einu::cmp::PreviousTransform{transform};
+      },
+      XnentList<const einu::cmp::Transform, einu::cmp::PreviousTransform>{});
+
+  // agents created and destroyed since the last frame enter and leave the
+  // grid in one pass
+  world.AddSystem(Stage::PreUpdate, "flush world state",
+                  [&] { world_state.grid.Flush(); });
+
+  world.AddSystem(Stage::PreUpdate, "pack world state",
+                  [&] { sys::PackWorldState(world_state); });
+
+  world.AddSystem(
+      Stage::PreUpdate, "forget",
+      [](cmp::Memory& memory) { sys::Forget(memory); },
+      XnentList<cmp::Memory>{});
+
+  const auto& sense_view = world.AddSystem(
+      Stage::PreUpdate, "sense",
+      [&](einu::EID eid, const einu::cmp::Transform& transform,
+          cmp::Sense& sense, cmp::Memory& memory) {
+        sys::Sense(world_state, sense_buffer, sense, transform, memory, eid);
+      },
+      XnentList<const einu::cmp::Transform, cmp::Sense, cmp::Memory>{});
+
+  const auto& grass_view = world.AddSystem(
+      Stage::Update, "grass bt",
+      [&](einu::EID eid, auto&... comps) {
+        grass_bt_args.Set(eid, std::forward_as_tuple(comps...));
+        grass_bt.Run(grass_bt_args);
+      },
+      XnentList<einu::cmp::Transform, cmp::Agent, cmp::Health,
+                cmp::HealthLoss, cmp::GainHealth, cmp::Memory, cmp::Reproduce,
+                cmp::Sense, cmp::GrassTag>{});
+
+  const auto& sheep_view = world.AddSystem(
+      Stage::Update, "sheep bt",
+      [&](einu::EID eid, auto&... comps) {
+        sheep_bt_args.Set(eid, std::forward_as_tuple(comps...));
+        sheep_bt.Run(sheep_bt_args);
+      },
+      XnentList<einu::cmp::Transform, einu::graphics::cmp::Sprite,
+                einu::cmp::Movement, einu::ai::cmp::Destination, cmp::Agent,
+                cmp::Eat, cmp::Evade, cmp::Health, cmp::HealthLoss,
+                cmp::Hunger, cmp::Hunt, cmp::Memory, cmp::Panick,
+                cmp::Reproduce, cmp::Sense, cmp::Wander>{});
+
+  const auto& herder_view = world.AddSystem(
+      Stage::Update, "herder bt",
+      [&](einu::EID eid, auto&... comps) {
+        herder_bt_args.Set(eid, std::forward_as_tuple(comps...));
+        herder_bt.Run(herder_bt_args);
+      },
+      XnentList<einu::cmp::Transform, einu::graphics::cmp::Sprite,
+                einu::cmp::Movement, einu::ai::cmp::Destination, cmp::Agent,
+                cmp::Eat, cmp::Health, cmp::Hunt, cmp::Memory, cmp::Sense,
+                cmp::Wander, cmp::HerderTag>{});
+
+  world.AddSystem(
+      Stage::Update, "lose health",
+      [&](const cmp::HealthLoss& health_loss, cmp::Health& health) {
+        sys::LoseHealth(time, health_loss, health);
+      },
+      XnentList<const cmp::HealthLoss, cmp::Health>{});
+
+  const auto& move_view = world.AddSystem(
+      Stage::Update, "move",
+      [&](einu::cmp::Transform& transform, einu::cmp::Movement& movement) {
+        sys::Move(time, world_state, transform, movement);
+        sys::Rotate(transform, movement);
+      },
+      XnentList<einu::cmp::Transform, einu::cmp::Movement>{});
+
+  // agents born this frame must be in the grid before it is updated
+  world.AddSystem(Stage::Update, "flush born agents",
+                  [&] { world_state.grid.Flush(); });
+
+  // only agents that can move need their cell checked
+  const auto& world_state_view = world.AddSystem(
+      Stage::Update, "update world state",
+      [&](einu::EID eid, const einu::cmp::Transform& transform,
+          const cmp::Agent& agent, const einu::cmp::Movement&) {
+        sys::UpdateWorldState(world_state, transform, agent, eid);
+      },
+      XnentList<const einu::cmp::Transform, const cmp::Agent,
+                const einu::cmp::Movement>{});
+
+  world.AddViewSystem(
+      Stage::PostUpdate, "destroy",
+      [&](const auto& view) {
+        sys::Destroy(*ett_mgr, world_state, view, doomed);
+      },
+      XnentList<const cmp::Health>{});
+
+  world.AddSystem(Stage::PostUpdate, "record history",
+                  [&] { history.Record(*ett_mgr); });
+
+  world.AddSystem(Stage::RenderPrep, "clear sprite batch", [&] {
+    einu::graphics::sys::ClearSpriteBatch(sprite_batch);
+  });
+
+  const auto& sprite_render_view = world.AddSystem(
+      Stage::RenderPrep, "prepare sprites",
+      [&](const einu::cmp::Transform& transform,
+          const einu::cmp::PreviousTransform& previous,
+          const einu::graphics::cmp::Sprite& sprite) {
+        auto interpolated = einu::cmp::Transform{
+            einu::Interpolate(previous, transform, fixed_step.alpha)};
+        einu::graphics::sys::PrepareSpriteBatch(resource_table, sprite_batch,
+                                                sprite, interpolated);
+      },
+      XnentList<const einu::cmp::Transform,
+                const einu::cmp::PreviousTransform,
+                const einu::graphics::cmp::Sprite>{});
+
+  // press F9 to start and stop tracing
+  einu::trace::SetThreadName("main");
+  auto trace_key_down = false;
+
+  // press F10 to print a memory report
+  auto memory_reporter = einu::MemoryReporter{*comp_pool, *sgln_pool, *ett_mgr};
+  memory_reporter.AddView("grass", grass_view);
+  memory_reporter.AddView("herder", herder_view);
+  memory_reporter.AddView("sheep", sheep_view);
+  memory_reporter.AddView("sense", sense_view);
+  memory_reporter.AddView("move", move_view);
+  memory_reporter.AddView("sprite render", sprite_render_view);
+  memory_reporter.AddView("world state", world_state_view);
+  auto report_key_down = false;
+
+  // press F11 to print system timings
+  auto timing_key_down = false;
+
+  // press F12 to print frame time percentiles
+  auto frame_stats_key_down = false;
 
   // game loop
   while (!win.shouldClose) {
+    EINU_TRACE_SCOPE("frame");
+
     einu::window::sys::PoolEvents(win);
     einu::graphics::sys::Clear();
 
-    einu::sys::UpdateTime(time);
-    std::cout << "ft: " << einu::sgl::DeltaSeconds(time) << std::endl;
-
-    // TODO(Xiaoyue Chen): implement zip iterator
-    // update world state
-    world_state_view.View(*ett_mgr);
-    sys::ClearWorldState(world_state);
-    for (auto [comp_it, eid_it] =
-             std::tuple{world_state_view.Components().begin(),
-                        world_state_view.EIDs().begin()};
-         comp_it != world_state_view.Components().end(); ++comp_it, ++eid_it) {
-      auto&& [transform, agent] = *comp_it;
-      sys::UpdateWorldState(world_state, transform, agent, *eid_it);
-    }
-
-    // clear all agents memory
-    forget_view.View(*ett_mgr);
-    for (auto&& [memory] : forget_view.Components()) {
-      sys::Forget(memory);
-    }
-
-    // all agents sense
-    sense_view.View(*ett_mgr);
-    for (auto [comps, eid] = std::tuple{sense_view.Components().begin(),
-                                        sense_view.EIDs().begin()};
-         comps != sense_view.Components().end(); ++comps, ++eid) {
-      auto&& [transform, sense, memory] = *comps;
-      sys::Sense(world_state, cell_buffer, sense, transform, memory, *eid);
-    }
-
-    // run grass behavior tree
-    grass_view.View(*ett_mgr);
-    for (auto [comps, eid] = std::tuple{grass_view.Components().begin(),
-                                        grass_view.EIDs().begin()};
-         comps != grass_view.Components().end(); ++comps, ++eid) {
-      grass_bt_args.Set(*eid, *comps);
-      grass_bt.Run(grass_bt_args);
-    }
-
-    // run sheep/wolf behavior tree
-    sheep_view.View(*ett_mgr);
-    for (auto [comp_it, eid_it] = std::tuple{sheep_view.Components().begin(),
-                                             sheep_view.EIDs().begin()};
-         comp_it != sheep_view.Components().end(); ++comp_it, ++eid_it) {
-      sheep_bt_args.Set(*eid_it, *comp_it);
-      sheep_bt.Run(sheep_bt_args);
+    using einu::window::input::KeyboardKey;
+    auto trace_key = win.input_buffer.GetKeyboardKey(KeyboardKey::F9);
+    if (trace_key && !trace_key_down) {
+      einu::trace::SetEnabled(!einu::trace::IsEnabled());
     }
+    trace_key_down = trace_key;
 
-    // run herder behavior tree
-    herder_view.View(*ett_mgr);
-    for (auto [comp_it, eid_it] = std::tuple{herder_view.Components().begin(),
-                                             herder_view.EIDs().begin()};
-         comp_it != herder_view.Components().end(); ++comp_it, ++eid_it) {
-      herder_bt_args.Set(*eid_it, *comp_it);
-      herder_bt.Run(herder_bt_args);
+    auto report_key = win.input_buffer.GetKeyboardKey(KeyboardKey::F10);
+    if (report_key && !report_key_down) {
+      memory_reporter.Write(std::cout);
     }
+    report_key_down = report_key;
 
-    // lose health
-    health_loss_view.View(*ett_mgr);
-    for (auto&& [health_loss, health] : health_loss_view.Components()) {
-      sys::LoseHealth(time, health_loss, health);
+    auto timing_key = win.input_buffer.GetKeyboardKey(KeyboardKey::F11);
+    if (timing_key && !timing_key_down) {
+      einu::WriteSystemStats(std::cout, world.GetSystemStats());
     }
+    timing_key_down = timing_key;
 
-    // move and rotate
-    move_view.View(*ett_mgr);
-    for (auto&& [transform, movement] : move_view.Components()) {
-      sys::Move(time, world_state, transform, movement);
-      sys::Rotate(transform, movement);
+    auto frame_stats_key = win.input_buffer.GetKeyboardKey(KeyboardKey::F12);
+    if (frame_stats_key && !frame_stats_key_down) {
+      einu::sgl::WriteFrameStats(std::cout, frame_stats);
     }
-
-    // entity destruction
-    destroy_view.View(*ett_mgr);
-    for (auto [comp, eid] = std::make_tuple(destroy_view.Components().begin(),
-                                            destroy_view.EIDs().begin());
-         comp != destroy_view.Components().end(); ++comp, ++eid) {
-      auto&& [health] = *comp;
-      sys::Destroy(*ett_mgr, health, *eid);
+    frame_stats_key_down = frame_stats_key;
+
+    einu::sys::UpdateTime(frame_time);
+    frame_stats.frame.Record(frame_time.now - frame_time.pre);
+    einu::sys::AdvanceFixedStep(fixed_step, frame_time);
+
+    if (win.input_buffer.GetKeyboardKey(KeyboardKey::Backspace) &&
+        history.FrameCount() > 1) {
+      EINU_TRACE_SCOPE("rollback");
+      history.Rollback(*ett_mgr, 1);
+      sys::ResetWorldState(world_state, *ett_mgr);
+    } else {
+      EINU_TRACE_SCOPE("simulate");
+      auto latency = einu::ScopedLatency{frame_stats.simulation};
+      for (std::size_t i = 0; i != fixed_step.steps; ++i) {
+        einu::sys::StepTime(time, fixed_step);
+        world.RunStage(Stage::PreUpdate);
+        world.RunStage(Stage::Update);
+        world.RunStage(Stage::PostUpdate);
+      }
     }
 
     // render sprites
-    sprite_render_view.View(*ett_mgr);
-    einu::graphics::sys::ClearSpriteBatch(sprite_batch);
-    for (auto&& [transform, sprite] : sprite_render_view.Components()) {
-      einu::graphics::sys::PrepareSpriteBatch(resource_table, sprite_batch,
-                                              sprite, transform);
+    {
+      EINU_TRACE_SCOPE("render");
+      auto latency = einu::ScopedLatency{frame_stats.render};
+      world.RunStage(Stage::RenderPrep);
+      einu::graphics::sys::RenderSpriteBatch(sprite_batch, cam_mat);
     }
-    einu::graphics::sys::RenderSpriteBatch(sprite_batch, cam_mat);
 
     einu::window::sys::SwapBuffer(win);
   }
 
+#ifdef EINU_CORE_PROFILE
+  einu::trace::WriteChromeTrace("loop-of-life-trace.json");
+#endif
+
   // TODO(Xiaoyue Chen): clean up
 }
 
@@ -18,6 +18,9 @@
 
 #include "src/bt_agent.h"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <optional>
 #include <utility>
@@ -25,6 +28,7 @@
 #include "einu-engine/ai/cmp_destination.h"
 #include "einu-engine/common/cmp_movement.h"
 #include "einu-engine/common/cmp_transform.h"
+#include "einu-engine/common/point_query.h"
 #include "einu-engine/common/random.h"
 #include "einu-engine/common/sgl_time.h"
 #include "src/cmp_agent.h"
@@ -151,14 +155,20 @@ Result EatPrey::Run(const ArgPack& args) {
 }
 
 Result FindPredator::Run(const ArgPack& args) {
+  // evading the nearest few is enough, however many there are
+  static constexpr std::size_t kMaxPredators = 8;
   auto&& [mem_comp, evade_comp, transform_comp] = args.GetComponents(
       einu::XnentList<cmp::Memory, cmp::Evade, einu::cmp::Transform>{});
+  const auto& mem = mem_comp.memory;
+  auto nearest = std::array<std::uint32_t, kMaxPredators>{};
+  auto found = einu::FindNearest(
+      mem.xs.data(), mem.ys.data(), mem.types.data(), Size(mem),
+      transform_comp.GetPosition(), std::numeric_limits<float>::infinity(),
+      static_cast<std::uint32_t>(evade_comp.predator_signature),
+      nearest.size(), nearest.data());
   evade_comp.predators.clear();
-  for (auto&& agent_info : mem_comp.memory) {
-    using einu::util::operator&;
-    if ((evade_comp.predator_signature & agent_info.type) == agent_info.type) {
-      evade_comp.predators.emplace_back(agent_info);
-    }
+  for (std::size_t i = 0; i != found; ++i) {
+    evade_comp.predators.emplace_back(GetAgentInfo(mem, nearest[i]));
   }
   if (!evade_comp.predators.empty()) {
     return Result::Success;
@@ -169,20 +179,13 @@ Result FindPredator::Run(const ArgPack& args) {
 std::optional<AgentInfo> FindClosestPrey(const cmp::Memory& mem_comp,
                                          AgentType prey_signature,
                                          glm::vec2 pos) {
-  auto prey_distance2 =
-      std::pair{AgentInfo{}, std::numeric_limits<float>::max()};
-  for (auto&& agent_info : mem_comp.memory) {
-    using einu::util::operator&;
-    if ((prey_signature & agent_info.type) == agent_info.type) {
-      auto distance2 = glm::distance2(agent_info.pos, pos);
-      if (distance2 < prey_distance2.second) {
-        prey_distance2.first = agent_info;
-        prey_distance2.second = distance2;
-      }
-    }
-  }
-  if (prey_distance2.first.eid != ~einu::EID{0}) {
-    return prey_distance2.first;
+  const auto& mem = mem_comp.memory;
+  auto nearest = std::uint32_t{};
+  if (einu::FindNearest(mem.xs.data(), mem.ys.data(), mem.types.data(),
+                        Size(mem), pos, std::numeric_limits<float>::infinity(),
+                        static_cast<std::uint32_t>(prey_signature), 1,
+                        &nearest) != 0) {
+    return GetAgentInfo(mem, nearest);
   }
   return std::nullopt;
 }
@@ -248,14 +251,14 @@ Result ChooseEvadeDestination::Run(const ArgPack& args) {
 }
 
 ChooseRandomDestination::ChooseRandomDestination(
-    const einu::IEntityManager& ett_mgr)
-    : ett_mgr_{ett_mgr} {}
+    einu::IEntityManager& ett_mgr)
+    : resources_{ett_mgr} {}
 
 Result ChooseRandomDestination::Run(const ArgPack& args) {
   auto& wander = args.GetComponent<cmp::Wander>();
   auto& transform = args.GetComponent<const einu::cmp::Transform>();
   auto& dest = args.GetComponent<einu::ai::cmp::Destination>();
-  auto& time = ett_mgr_.GetSinglenent<const einu::sgl::Time>();
+  const auto& time = resources_.Get<einu::sgl::Time>();
 
   if ((wander.time_since_last_destination_change +=
        einu::sgl::DeltaSeconds(time)) > wander.destination_change_interval) {
@@ -337,7 +340,7 @@ Result GainHealth::Run(const ArgPack& args) {
 
 Result CanSeeOtherAgent::Run(const ArgPack& args) {
   auto& memory = args.GetComponent<const cmp::Memory>();
-  if (memory.memory.size() == 0) {
+  if (Size(memory.memory) == 0) {
     return Result::Failure;
   }
   return Result::Success;
@@ -22,6 +22,7 @@
 #include "einu-engine/ai/bt_move_to.h"
 #include "einu-engine/common/sgl_time.h"
 #include "einu-engine/core/i_entity_manager.h"
+#include "einu-engine/core/resources.h"
 
 namespace lol {
 namespace ai {
@@ -83,12 +84,15 @@ class ChooseEvadeDestination final : public Node {
 
 class ChooseRandomDestination final : public Node {
  public:
-  explicit ChooseRandomDestination(const einu::IEntityManager& ett_mgr);
+  using Resources =
+      einu::Resources<einu::Reads<einu::sgl::Time>, einu::Writes<>>;
+
+  explicit ChooseRandomDestination(einu::IEntityManager& ett_mgr);
 
   Result Run(const ArgPack& args) override;
 
  private:
-  const einu::IEntityManager& ett_mgr_;
+  Resources resources_;
 };
 
 class IsPanicking final : public Node {
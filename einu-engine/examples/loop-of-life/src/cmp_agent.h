@@ -62,7 +62,8 @@ struct Hunt : public einu::Xnent {
 };
 
 struct Memory : public einu::Xnent {
-  std::vector<AgentInfo> memory;
+  // the agents sensed this tick
+  AgentColumns memory;
 };
 
 struct Reproduce : public einu::Xnent {
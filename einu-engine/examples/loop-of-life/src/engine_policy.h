@@ -21,6 +21,7 @@
 #include "einu-engine/ai/cmp_destination.h"
 #include "einu-engine/common/cmp_movement.h"
 #include "einu-engine/common/cmp_transform.h"
+#include "einu-engine/common/sgl_frame_stats.h"
 #include "einu-engine/common/sgl_time.h"
 #include "einu-engine/core/einu_engine.h"
 #include "einu-engine/core/xnent_list.h"
@@ -35,14 +36,16 @@
 namespace lol {
 
 using ComponentList = einu::XnentList<
-    einu::cmp::Transform, einu::cmp::Movement, einu::window::cmp::Window,
-    einu::graphics::cmp::Sprite, einu::ai::cmp::Destination, cmp::Agent,
-    cmp::Health, cmp::HealthLoss, cmp::Eat, cmp::Evade, cmp::Panick,
-    cmp::Hunger, cmp::Hunt, cmp::Memory, cmp::Reproduce, cmp::GainHealth,
-    cmp::Sense, cmp::Wander, cmp::GrassTag, cmp::HerderTag>;
+    einu::cmp::Transform, einu::cmp::PreviousTransform, einu::cmp::Movement,
+    einu::window::cmp::Window, einu::graphics::cmp::Sprite,
+    einu::ai::cmp::Destination, cmp::Agent, cmp::Health, cmp::HealthLoss,
+    cmp::Eat, cmp::Evade, cmp::Panick, cmp::Hunger, cmp::Hunt, cmp::Memory,
+    cmp::Reproduce, cmp::GainHealth, cmp::Sense, cmp::Wander, cmp::GrassTag,
+    cmp::HerderTag>;
 
 using SinglenentList =
-    einu::XnentList<einu::sgl::Time, einu::graphics::sgl::GLResourceTable,
+    einu::XnentList<einu::sgl::Time, einu::sgl::FixedStep,
+                    einu::sgl::FrameStats, einu::graphics::sgl::GLResourceTable,
                     einu::graphics::sgl::SpriteBatch, sgl::WorldState>;
 
 using NeedList = einu::NeedList<ComponentList, SinglenentList>;
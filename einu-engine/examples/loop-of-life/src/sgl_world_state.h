@@ -19,9 +19,9 @@
 #pragma once
 
 #include <algorithm>
-#include <vector>
 
-#include "einu-engine/common/grid.h"
+#include "einu-engine/common/cell_pyramid.h"
+#include "einu-engine/common/spatial_index.h"
 #include "einu-engine/core/eid.h"
 #include "einu-engine/core/xnent.h"
 #include "glm/glm.hpp"
@@ -31,10 +31,18 @@ namespace lol {
 namespace sgl {
 
 struct WorldState : public einu::Xnent {
-  using Cell = std::vector<AgentInfo>;
-  using Grid = einu::Grid<Cell>;
+  using Grid = einu::SpatialIndex<AgentInfo>;
+  using Pyramid = einu::CellPyramid<>;
 
+  // the agents by the cell they are in, kept up to date as they are created,
+  // move and are destroyed
   Grid grid;
+  // the agents of each type in the cells of grid and in coarser blocks of
+  // them, kept up to date with grid, so that wide senses skip what is
+  // irrelevant
+  Pyramid pyramid;
+  // the agents of grid as columns, in the same order, packed before sensing
+  AgentColumns agents;
   glm::vec2 world_size;
 };
 
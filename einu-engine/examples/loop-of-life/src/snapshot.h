@@ -0,0 +1,100 @@
+// Copyright (C) 2020  Xiaoyue Chen
+//
+// This file is part of EINU Engine.
+// See <https://github.com/xiaoyuechen/einu.git>.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+
+#include "einu-engine/ai/cmp_destination.h"
+#include "einu-engine/common/cmp_movement.h"
+#include "einu-engine/common/cmp_transform.h"
+#include "einu-engine/core/snapshot.h"
+#include "einu-engine/core/snapshot_history.h"
+#include "einu-engine/core/xnent_list.h"
+#include "einu-engine/graphics/cmp_sprite.h"
+#include "src/cmp_agent.h"
+#include "src/cmp_health.h"
+
+namespace einu {
+
+template <>
+struct SnapshotCodec<graphics::cmp::Sprite> {
+  static void Encode(SnapshotWriter& writer,
+                     const graphics::cmp::Sprite& sprite) {
+    writer.Write(sprite.sprite_name);
+    writer.Write(sprite.color);
+  }
+
+  static void Decode(SnapshotReader& reader, graphics::cmp::Sprite& sprite) {
+    reader.Read(sprite.sprite_name);
+    reader.Read(sprite.color);
+  }
+};
+
+template <>
+struct SnapshotCodec<lol::cmp::Evade> {
+  static void Encode(SnapshotWriter& writer, const lol::cmp::Evade& evade) {
+    writer.Write(evade.predator_signature);
+    writer.Write(evade.predators);
+    writer.Write(evade.evade_dest);
+    writer.Write(evade.evade_dist);
+  }
+
+  static void Decode(SnapshotReader& reader, lol::cmp::Evade& evade) {
+    reader.Read(evade.predator_signature);
+    reader.Read(evade.predators);
+    reader.Read(evade.evade_dest);
+    reader.Read(evade.evade_dist);
+  }
+};
+
+template <>
+struct SnapshotCodec<lol::cmp::Memory> {
+  static void Encode(SnapshotWriter& writer, const lol::cmp::Memory& memory) {
+    writer.Write(memory.memory.xs);
+    writer.Write(memory.memory.ys);
+    writer.Write(memory.memory.types);
+    writer.Write(memory.memory.eids);
+  }
+
+  static void Decode(SnapshotReader& reader, lol::cmp::Memory& memory) {
+    reader.Read(memory.memory.xs);
+    reader.Read(memory.memory.ys);
+    reader.Read(memory.memory.types);
+    reader.Read(memory.memory.eids);
+  }
+};
+
+}  // namespace einu
+
+namespace lol {
+
+// Everything the simulation depends on. The window is left out on purpose,
+// and so are the singlenents: time keeps running and the world state is
+// refilled from the agents after a rollback.
+using SnapshotComponentList = einu::XnentList<
+    einu::cmp::Transform, einu::cmp::PreviousTransform, einu::cmp::Movement,
+    einu::graphics::cmp::Sprite, einu::ai::cmp::Destination, cmp::Agent,
+    cmp::Health, cmp::HealthLoss, cmp::Eat, cmp::Evade, cmp::Panick,
+    cmp::Hunger, cmp::Hunt, cmp::Memory, cmp::Reproduce, cmp::GainHealth,
+    cmp::Sense, cmp::Wander, cmp::GrassTag, cmp::HerderTag>;
+
+using WorldHistory =
+    einu::SnapshotHistory<SnapshotComponentList, einu::XnentList<>>;
+
+}  // namespace lol
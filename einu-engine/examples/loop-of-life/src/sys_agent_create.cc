@@ -27,6 +27,7 @@
 #include "src/cmp_agent.h"
 #include "src/cmp_health.h"
 #include "src/sgl_world_state.h"
+#include "src/sys_world_state.h"
 
 namespace lol {
 namespace sys {
@@ -65,6 +66,13 @@ void ClampPosition(const einu::IEntityManager& ett_mgr,
   transform.SetPosition(pos);
 }
 
+// Adds a created agent to the world state, so it can be sensed at once.
+void AddToWorldState(einu::IEntityManager& ett_mgr, einu::EID eid) {
+  AddToWorldState(ett_mgr.GetSinglenent<sgl::WorldState>(),
+                  ett_mgr.GetComponent<einu::cmp::Transform>(eid),
+                  ett_mgr.GetComponent<cmp::Agent>(eid), eid);
+}
+
 einu::EID CreateSheep(einu::IEntityManager& ett_mgr,
                       const einu::Transform& transform) {
   auto ett = ett_mgr.CreateEntity();
@@ -77,6 +85,8 @@ einu::EID CreateSheep(einu::IEntityManager& ett_mgr,
   ClampPosition(ett_mgr, spawn_tranform);
   ett_mgr.AddComponent<einu::cmp::Transform>(ett) =
       einu::cmp::Transform{spawn_tranform};
+  ett_mgr.AddComponent<einu::cmp::PreviousTransform>(ett) =
+      einu::cmp::PreviousTransform{spawn_tranform};
 
   auto& movement = ett_mgr.AddComponent<einu::cmp::Movement>(ett);
   movement.max_speed = 14;
@@ -119,6 +129,8 @@ einu::EID CreateSheep(einu::IEntityManager& ett_mgr,
   wander.time_since_last_destination_change = 99999;
   wander.wander_radius = 50;
 
+  AddToWorldState(ett_mgr, ett);
+
   return ett;
 }
 
@@ -132,6 +144,8 @@ einu::EID CreateWolf(einu::IEntityManager& ett_mgr,
 
   ett_mgr.AddComponent<einu::cmp::Transform>(ett) =
       einu::cmp::Transform{transform};
+  ett_mgr.AddComponent<einu::cmp::PreviousTransform>(ett) =
+      einu::cmp::PreviousTransform{transform};
 
   auto& movement = ett_mgr.AddComponent<einu::cmp::Movement>(ett);
   movement.max_speed = 40;
@@ -173,6 +187,8 @@ einu::EID CreateWolf(einu::IEntityManager& ett_mgr,
   wander.time_since_last_destination_change = 99999;
   wander.wander_radius = 100;
 
+  AddToWorldState(ett_mgr, ett);
+
   return ett;
 }
 
@@ -190,6 +206,8 @@ einu::EID CreateGrass(einu::IEntityManager& ett_mgr,
   ClampPosition(ett_mgr, spawn_tranform);
   ett_mgr.AddComponent<einu::cmp::Transform>(ett) =
       einu::cmp::Transform{spawn_tranform};
+  ett_mgr.AddComponent<einu::cmp::PreviousTransform>(ett) =
+      einu::cmp::PreviousTransform{spawn_tranform};
 
   ett_mgr.AddComponent<cmp::Agent>(ett).type = AgentType::Grass;
 
@@ -212,6 +230,8 @@ einu::EID CreateGrass(einu::IEntityManager& ett_mgr,
       AgentType::Grass | AgentType::Herder | AgentType::Sheep | AgentType::Wolf;
   sense.sense_radius = 15.f;
 
+  AddToWorldState(ett_mgr, ett);
+
   return ett;
 }
 
@@ -227,6 +247,8 @@ einu::EID CreateHerder(einu::IEntityManager& ett_mgr,
 
   ett_mgr.AddComponent<einu::cmp::Transform>(ett) =
       einu::cmp::Transform{transform};
+  ett_mgr.AddComponent<einu::cmp::PreviousTransform>(ett) =
+      einu::cmp::PreviousTransform{transform};
 
   auto& movement = ett_mgr.AddComponent<einu::cmp::Movement>(ett);
   movement.max_speed = 30;
@@ -253,6 +275,8 @@ einu::EID CreateHerder(einu::IEntityManager& ett_mgr,
   wander.time_since_last_destination_change = 99999;
   wander.wander_radius = 50;
 
+  AddToWorldState(ett_mgr, ett);
+
   return ett;
 }
 
@@ -18,18 +18,34 @@
 
 #pragma once
 
+#include <vector>
+
+#include "einu-engine/core/entity_view.h"
 #include "einu-engine/core/i_entity_manager.h"
 #include "src/cmp_health.h"
+#include "src/sgl_world_state.h"
+#include "src/sys_world_state.h"
 
 namespace lol {
 namespace sys {
 
-inline void Destroy(einu::IEntityManager& ett_mgr, const cmp::Health& health,
-                    einu::EID eid) {
+// doomed is scratch space for the EIDs of the dead, kept between frames.
+inline void Destroy(
+    einu::IEntityManager& ett_mgr, sgl::WorldState& world_state,
+    const einu::EntityView<einu::XnentList<const cmp::Health>>& view,
+    std::vector<einu::EID>& doomed) {
   static constexpr float kDeadthHealth = 0.01f;
-  if (health.health < kDeadthHealth) {
-    ett_mgr.DestroyEntity(eid);
+  // like einu::DestroyIf, but the dead leave the world state first
+  doomed.clear();
+  auto eid_it = view.EIDs().begin();
+  for (auto&& [health] : view.Components()) {
+    auto eid = *eid_it++;
+    if (health.health < kDeadthHealth) {
+      RemoveFromWorldState(world_state, eid);
+      doomed.push_back(eid);
+    }
   }
+  ett_mgr.DestroyEntities(doomed.data(), doomed.size());
 }
 
 }  // namespace sys
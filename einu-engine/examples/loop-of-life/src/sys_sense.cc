@@ -18,58 +18,49 @@
 
 #include "src/sys_sense.h"
 
-namespace lol {
-namespace sys {
+#include <cstddef>
+#include <cstdint>
 
-void FlushCellBuffer(const sgl::WorldState& world_state,
-                     CellBuffer& cell_buffer, float sense_radius,
-                     glm::vec2 pos) {
-  auto top_left = pos - glm::vec2(sense_radius, sense_radius);
-  auto tl_coords = GetCoordsInGrid(world_state, top_left);
-  auto button_right = pos + glm::vec2(sense_radius, sense_radius);
-  auto br_coords = GetCoordsInGrid(world_state, button_right);
-  auto buffer_size = br_coords - tl_coords;
-  buffer_size += glm::uvec2(1, 1);
-
-  cell_buffer.resize(static_cast<std::size_t>(buffer_size.x) * buffer_size.y);
-  const auto& grid = world_state.grid;
-  grid.GetCells(tl_coords.x, tl_coords.y, buffer_size.x, buffer_size.y,
-                cell_buffer.data());
-}
+#include "einu-engine/common/point_query.h"
 
-bool IsRelevant(const AgentInfo& agent_info, const glm::vec2& pos,
-                const cmp::Sense& sense_comp, einu::EID eid) {
-  using namespace einu::util;  // NOLINT
-  if (eid == agent_info.eid) return false;
-  if ((agent_info.type & sense_comp.relevant_type_signature) ==
-      agent_info.type) {
-    auto dist2 = glm::distance2(pos, agent_info.pos);
-    bool within_sense_range = dist2 < glm::pow(sense_comp.sense_radius, 2);
-    if (within_sense_range) {
-      return true;
-    }
-  }
-  return false;
-}
+namespace lol {
+namespace sys {
 
-void Sense(const sgl::WorldState& world_state, CellBuffer& cell_buffer,
+void Sense(const sgl::WorldState& world_state, SenseBuffer& sense_buffer,
            cmp::Sense& sense, const einu::cmp::Transform& transform,
            cmp::Memory& memory, einu::EID eid) {
-  cell_buffer.clear();
-  FlushCellBuffer(world_state, cell_buffer, sense.sense_radius,
-                  transform.GetPosition());
+  auto pos = glm::vec2(transform.GetPosition());
+  auto radius = glm::vec2(sense.sense_radius, sense.sense_radius);
+  auto tl_coords = GetCoordsInGrid(world_state, pos - radius);
+  auto br_coords = GetCoordsInGrid(world_state, pos + radius);
+  const auto& agents = world_state.agents;
+  const auto* first_agent = world_state.grid.GetItems().begin();
+  auto type_signature =
+      static_cast<std::uint32_t>(sense.relevant_type_signature);
   auto&& mem = memory.memory;
-  mem.clear();
-  for (auto&& cell : cell_buffer) {
-    for (auto&& agent_info : *cell) {
-      if (IsRelevant(agent_info, transform.GetPosition(), sense, eid)) {
-        mem.emplace_back(agent_info);
-      }
-    }
-  }
+  Clear(mem);
+  // rows come whole where they hold nothing but relevant agents, and are cut
+  // down to the cells that hold any where they hold others
+  world_state.pyramid.ForEachRow(
+      tl_coords, br_coords, type_signature,
+      [&](std::uint32_t y, std::uint32_t x_begin, std::uint32_t x_end) {
+        auto row = world_state.grid.GetRow(y, x_begin, x_end);
+        auto first = static_cast<std::size_t>(row.begin() - first_agent);
+        sense_buffer.resize(row.size());
+        auto found = einu::FindInRadius(
+            agents.xs.data() + first, agents.ys.data() + first,
+            agents.types.data() + first, row.size(), pos, sense.sense_radius,
+            type_signature, sense_buffer.data());
+        for (std::size_t i = 0; i != found; ++i) {
+          auto agent = first + sense_buffer[i];
+          if (agents.eids[agent] != eid) {
+            PushBack(mem, GetAgentInfo(agents, agent));
+          }
+        }
+      });
 }
 
-void Forget(cmp::Memory& memory) { memory.memory.clear(); }
+void Forget(cmp::Memory& memory) { Clear(memory.memory); }
 
 }  // namespace sys
 }  // namespace lol
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 #include "einu-engine/common/cmp_transform.h"
@@ -27,9 +28,13 @@
 namespace lol {
 namespace sys {
 
-using CellBuffer = std::vector<const sgl::WorldState::Cell*>;
+// Where Sense puts the agents of a row of cells that it found, as indices
+// into the row.
+using SenseBuffer = std::vector<std::uint32_t>;
 
-void Sense(const sgl::WorldState& world_state, CellBuffer& cell_buffer,
+// Remembers the agents of the relevant types within sense radius, reading
+// the agents packed by PackWorldState.
+void Sense(const sgl::WorldState& world_state, SenseBuffer& sense_buffer,
            cmp::Sense& sense, const einu::cmp::Transform& transform,
            cmp::Memory& memory, einu::EID eid);
 
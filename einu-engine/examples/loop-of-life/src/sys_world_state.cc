@@ -18,23 +18,82 @@
 
 #include "src/sys_world_state.h"
 
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "einu-engine/core/entity_view.h"
+
 namespace lol {
 namespace sys {
 
+std::uint32_t GetTypeBit(AgentType type) noexcept {
+  return static_cast<std::uint32_t>(type);
+}
+
+AgentInfo GetAgentInfo(const einu::cmp::Transform& transform,
+                       const cmp::Agent& agent, einu::EID eid) {
+  return AgentInfo{agent.type, transform.GetPosition(), eid};
+}
+
+void AddToWorldState(sgl::WorldState& world_state,
+                     const einu::cmp::Transform& transform,
+                     const cmp::Agent& agent, einu::EID eid) {
+  auto grid_coords = GetCoordsInGrid(world_state, transform.GetPosition());
+  world_state.grid.Insert(eid, grid_coords,
+                          GetAgentInfo(transform, agent, eid));
+  world_state.pyramid.Add(grid_coords, GetTypeBit(agent.type));
+}
+
 void UpdateWorldState(sgl::WorldState& world_state,
                       const einu::cmp::Transform& transform,
                       const cmp::Agent& agent, einu::EID eid) {
-  const auto& pos = transform.GetPosition();
-  auto grid_coords = GetCoordsInGrid(world_state, pos);
-  auto& grid = world_state.grid;
-  auto& cell_data = grid[grid_coords.y][grid_coords.x];
-  cell_data.emplace_back(AgentInfo{agent.type, pos, eid});
+  const auto* old_info = world_state.grid.Find(eid);
+  assert(old_info && "agent not in the world state");
+  auto old_coords = GetCoordsInGrid(world_state, old_info->pos);
+  auto grid_coords = GetCoordsInGrid(world_state, transform.GetPosition());
+  if (world_state.grid.Update(eid, grid_coords,
+                              GetAgentInfo(transform, agent, eid))) {
+    world_state.pyramid.Move(old_coords, grid_coords, GetTypeBit(agent.type));
+  }
+}
+
+void RemoveFromWorldState(sgl::WorldState& world_state, einu::EID eid) {
+  // an agent born since the last flush is only queued for insertion, and was
+  // counted in the pyramid where it was queued
+  if (auto dropped = world_state.grid.Erase(eid)) {
+    world_state.pyramid.Remove(dropped->cell, GetTypeBit(dropped->item.type));
+  } else if (const auto* info = world_state.grid.Find(eid)) {
+    world_state.pyramid.Remove(GetCoordsInGrid(world_state, info->pos),
+                               GetTypeBit(info->type));
+  }
+}
+
+void PackWorldState(sgl::WorldState& world_state) {
+  auto& agents = world_state.agents;
+  Clear(agents);
+  for (const auto& agent_info : world_state.grid.GetItems()) {
+    PushBack(agents, agent_info);
+  }
 }
 
-void ClearWorldState(sgl::WorldState& world_state) noexcept {
-  for (auto&& cell : world_state.grid) {
-    cell.clear();
+void ResetWorldState(sgl::WorldState& world_state,
+                     einu::IEntityManager& ett_mgr) {
+  using ComponentList =
+      einu::XnentList<const einu::cmp::Transform, const cmp::Agent>;
+  auto view = einu::EntityView<ComponentList>{};
+  view.View(ett_mgr);
+  auto entries = std::vector<sgl::WorldState::Grid::Entry>{};
+  entries.reserve(view.Size());
+  auto eid_it = view.EIDs().begin();
+  world_state.pyramid.Clear();
+  for (auto&& [transform, agent] : view.Components()) {
+    auto eid = *eid_it++;
+    auto grid_coords = GetCoordsInGrid(world_state, transform.GetPosition());
+    entries.push_back({eid, grid_coords, GetAgentInfo(transform, agent, eid)});
+    world_state.pyramid.Add(grid_coords, GetTypeBit(agent.type));
   }
+  world_state.grid.Assign(entries);
 }
 
 }  // namespace sys
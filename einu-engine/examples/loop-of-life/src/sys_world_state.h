@@ -19,17 +19,33 @@
 #pragma once
 
 #include "einu-engine/common/cmp_transform.h"
+#include "einu-engine/core/i_entity_manager.h"
 #include "src/cmp_agent.h"
 #include "src/sgl_world_state.h"
 
 namespace lol {
 namespace sys {
 
+// Called when an agent is created.
+void AddToWorldState(sgl::WorldState& world_state,
+                     const einu::cmp::Transform& transform,
+                     const cmp::Agent& agent, einu::EID eid);
+
+// Called after an agent moves. Only moves it to another cell if it has left
+// its own.
 void UpdateWorldState(sgl::WorldState& world_state,
                       const einu::cmp::Transform& transform,
                       const cmp::Agent& agent, einu::EID eid);
 
-void ClearWorldState(sgl::WorldState& world_state) noexcept;
+// Called before an agent is destroyed.
+void RemoveFromWorldState(sgl::WorldState& world_state, einu::EID eid);
+
+// Copies the agents of the grid into the columns that sensing reads.
+void PackWorldState(sgl::WorldState& world_state);
+
+// Refills the world state with every agent, e.g. after a rollback.
+void ResetWorldState(sgl::WorldState& world_state,
+                     einu::IEntityManager& ett_mgr);
 
 }  // namespace sys
 }  // namespace lol